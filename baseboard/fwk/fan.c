@@ -11,6 +11,7 @@
 #include "common.h"
 #include "console.h"
 #include "fan.h"
+#include "fan_pid.h"
 #include "gpio.h"
 #include "hooks.h"
 #include "host_command.h"
@@ -42,25 +43,46 @@
 #define TACH_TO_RPM(tach) ((2*100000*60) / MAX((tach), 1))
 
 
-#define FAN_PID_I_INV	100
-#define FAN_PID_I_MAX	(10*FAN_PID_I_INV)
-
 #define STABLE_RPM 2200
 
+/*
+ * Tuned for one step a second. The integral term may pull the duty up to
+ * 10% away from fan_rpm_to_percent(); the fan is left alone while it is
+ * within 50 rpm of the target.
+ */
+static const struct fan_pid_params fan_pid_params = {
+	.kp = 2,
+	.ki = 10,
+	.kd = 1,
+	.i_max = 10 * FAN_PID_SCALE,
+	.slew = 10 * FAN_PID_SCALE,
+	.deadband = 50,
+};
+
 static int rpm_setting[FAN_CH_COUNT];
 static int duty_setting[FAN_CH_COUNT];
-static int integral_factor[FAN_CH_COUNT];
+static struct fan_pid fan_pid[FAN_CH_COUNT];
+/* Channels the RPM controller is allowed to drive */
+static uint8_t fan_enabled[FAN_CH_COUNT];
 
 static int in_rpm_mode = 1;
 
+static void fan_control_step(int ch);
+
 void fan_set_enabled(int ch, int enabled)
 {
+	fan_enabled[ch] = enabled;
+
 	if (in_rpm_mode) {
 		if (enabled) {
-			fan_set_rpm_target(ch, rpm_setting[ch]);
 			pwm_enable(ch, enabled);
+			/* The target may be unchanged, so step explicitly. */
+			fan_control_step(ch);
 		} else {
-			integral_factor[ch] = 0;
+			/* Nothing steps a disabled fan, so stop it here. */
+			fan_pid_reset(&fan_pid[ch]);
+			pwm_enable(ch, enabled);
+			fan_set_duty(ch, 0);
 		}
 	} else {
 		if (enabled) {
@@ -161,70 +183,68 @@ int fan_get_rpm_target(int ch)
 	return rpm_setting[ch];
 }
 timestamp_t fan_spindown_time;
-/**
- * fan gain should not be greater than 1 for stability
- * since fan goes up to 5500rpm and pwm is 0-100%
- * then we can choose something less than
- * 1/(100/5500)
- * This is called at Hhz from the thermal task if active
+
+/*
+ * Run the RPM controller once, and only touch the PWM when the duty it
+ * asks for actually changes.
  */
-void fan_set_rpm_target(int ch, int rpm)
+static void fan_control_step(int ch)
 {
-	int delta;
-	int pct = 0;
-	bool requested_rpm_same = rpm_setting[ch] == rpm;
+	int rpm = rpm_setting[ch];
+	int pct;
+
+	/* Keep the fan spinning at low speed for a minute after it's off. */
+	if (chipset_in_state(CHIPSET_STATE_ON) && rpm == 0 &&
+		!timestamp_expired(fan_spindown_time, NULL)) {
+		rpm = 1200;
+	}
 
+	pct = fan_pid_step(&fan_pid[ch], rpm, fan_rpm_to_percent(ch, rpm),
+			   fan_get_rpm_actual(ch));
+	if (pct != duty_setting[ch])
+		fan_set_duty(ch, pct);
+}
+
+void fan_set_rpm_target(int ch, int rpm)
+{
 	if (ch < 0 || ch > MCHP_TACH_ID_MAX || ch > FAN_CH_COUNT)
 		return;
+	if (rpm == rpm_setting[ch])
+		return;
+
 	/* Keep the fan spinning at min speed for a minute after we transition to 0 rpm*/
-	if (rpm == 0 && rpm_setting[ch] != rpm) {
+	if (rpm == 0) {
 		timestamp_t now = get_time();
 
 		fan_spindown_time.val = now.val + 60*SECOND;
 	}
 	rpm_setting[ch] = rpm;
-	if (chipset_in_state(CHIPSET_STATE_ON) && rpm == 0 &&
-		!timestamp_expired(fan_spindown_time, NULL)) {
-		rpm = 1200;
-	}
 
-	pct = fan_rpm_to_percent(ch, rpm);
-	delta = rpm - fan_get_rpm_actual(ch);
-	/**
-	 * Only integrate in steady state
-	 * allow the fan to ramp naturally in response to a step
-	 * assuming a time delta of around a second or so otherwise
-	 * we will integrate during the fan ramp up/ramp down time
-	 * also do not integrate when the fan is off
-	 */
-	if (requested_rpm_same && rpm > 0)
-		integral_factor[ch] += delta;
-
-	duty_setting[ch] = pct;
-
-	/*Cap integral factor at FAN_PID_I_MAX, to prevent runaway conditions */
-	integral_factor[ch] = MIN(MAX(integral_factor[ch], -FAN_PID_I_MAX),
-							FAN_PID_I_MAX);
-
-#if 0
-	CPRINTS(" Fan delta : %drpm %dintegral, commanded %d",
-			delta, integral_factor[ch],
-			pct +
-			integral_factor[ch]/FAN_PID_I_INV);
-#endif
-
-	if (rpm == 0)
-		integral_factor[ch] = 0;
-	
-	fan_set_duty(ch, pct + integral_factor[ch]/FAN_PID_I_INV);
+	/* React to the new target now rather than on the next second. */
+	if (in_rpm_mode && fan_enabled[ch])
+		fan_control_step(ch);
+}
+
+static void fan_control_second(void)
+{
+	int ch;
+
+	if (!in_rpm_mode)
+		return;
+
+	for (ch = 0; ch < FAN_CH_COUNT; ch++)
+		if (fan_enabled[ch])
+			fan_control_step(ch);
 }
+DECLARE_HOOK(HOOK_SECOND, fan_control_second, HOOK_PRIO_DEFAULT);
 
 enum fan_status fan_get_status(int ch)
 {
 	/* TODO */
 	if (fan_get_rpm_actual(ch) == 0)
 		return FAN_STATUS_STOPPED;
-	if (ABS(integral_factor[ch]) >= FAN_PID_I_MAX)
+	if (ABS(fan_pid[ch].integral * fan_pid_params.ki) >=
+	    fan_pid_params.i_max)
 		return FAN_STATUS_FRUSTRATED;
 	if (ABS(fan_get_rpm_actual(ch)-fan_get_rpm_target(ch)) > 200)
 		return FAN_STATUS_CHANGING;
@@ -246,6 +266,8 @@ void fan_channel_setup(int ch, unsigned int flags)
 	int i;
 
 	for (i = 0; i < FAN_CH_COUNT; ++i) {
+		fan_pid[i].params = &fan_pid_params;
+		fan_pid_reset(&fan_pid[i]);
 		pwm_slp_en(pwm_channels[i].channel, 0);
 		pwm_configure(pwm_channels[i].channel,
 			      pwm_channels[i].flags & PWM_CONFIG_ACTIVE_LOW,
@@ -12,6 +12,7 @@
 #include "spi.h"
 #include "spi_chip.h"
 #include "spi_flash.h"
+#include "timer.h"
 
 #include "flash_storage.h"
 
@@ -23,6 +24,9 @@
 #define CPRINTS(format, args...) cprints(CC_SYSTEM, format, ## args)
 #define CPRINTF(format, args...) cprintf(CC_SYSTEM, format, ## args)
 
+/* How long to wait for a background erase (ectool flasherase) to finish */
+#define BG_ERASE_WAIT_US (5 * SECOND)
+
 static struct ec_flash_flags_info current_flags;
 bool flash_storage_dirty;
 
@@ -95,19 +99,12 @@ int flash_storage_commit(void)
 
 		spi_mux_control(1);
 
-		rv = spi_flash_erase(SPI_FLAGS_REGION, 0x1000);
-
-		if (rv != EC_SUCCESS) {
-			CPRINTS("SPI fail to erase");
-			goto fail;
-		}
-
 		current_flags.update_number += 1;
 
-		rv = spi_flash_write(SPI_FLAGS_REGION,
-								sizeof(current_flags),
-								(void *)&current_flags);
-
+		rv = spi_flash_rewrite(SPI_FLAGS_REGION, 0x1000,
+				       (void *)&current_flags,
+				       sizeof(current_flags),
+				       BG_ERASE_WAIT_US);
 		if (rv != EC_SUCCESS) {
 			CPRINTS("SPI fail to write");
 			goto fail;
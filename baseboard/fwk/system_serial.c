@@ -11,6 +11,7 @@
 #include "uart.h"
 #include "util.h"
 #include "spi_flash.h"
+#include "timer.h"
 
 #include "system_serial.h"
 #define CPRINTS(format, args...) cprints(CC_SYSTEM, format, ##args)
@@ -18,6 +19,10 @@
 #define SLOT_A_ADDRESS (0x3D000)
 #define SLOT_B_ADDRESS (0x3E000)
 #define SLOT_INVALID (-1)
+
+/* How long to wait for a background erase (ectool flasherase) to finish */
+#define BG_ERASE_WAIT_US (5 * SECOND)
+
 /**
  * The type of the CRC values.
  *
@@ -115,15 +120,13 @@ static int current_slot = SLOT_INVALID;
 
 int write_slot(int address)
 {
-	int i;
+	int rv;
 
-	if (spi_flash_erase(address, 0x1000) != EC_SUCCESS) {
-		CPRINTS("Failed Erase");
-		return EC_ERROR_INVAL;
-	}
-	for (i = 0; i < sizeof(serials_info); i += 256) {
-		spi_flash_write(address + i, MIN(256, i - sizeof(serials_info)),
-				(void *)(&serials_info) + i);
+	rv = spi_flash_rewrite(address, 0x1000, (uint8_t *)&serials_info,
+			       sizeof(serials_info), BG_ERASE_WAIT_US);
+	if (rv != EC_SUCCESS) {
+		CPRINTS("Failed Write");
+		return rv;
 	}
 	current_slot = address;
 	return EC_SUCCESS;
@@ -135,7 +138,7 @@ int read_slot(int address)
 
 	for (i = 0; i < sizeof(serials_info); i += 256) {
 		spi_flash_read((void *)(&serials_info) + i, address + i,
-			       MIN(256, i - sizeof(serials_info)));
+			       MIN(256, sizeof(serials_info) - i));
 	}
 	return EC_SUCCESS;
 }
@@ -231,8 +234,7 @@ int update_serial(int idx, char *serial)
 	} else {
 		new_slot = SLOT_A_ADDRESS;
 	}
-	write_slot(new_slot);
-	return EC_SUCCESS;
+	return write_slot(new_slot);
 }
 
 int print_serial(int address)
@@ -278,7 +280,7 @@ static int cmd_systemserial(int argc, char **argv)
 		/* we are writing a new serial number*/
 		i = strtoi(argv[1], &e, 0);
 		serial = argv[2];
-		update_serial(i, serial);
+		return update_serial(i, serial);
 	}
 	return EC_SUCCESS;
 }
@@ -42,9 +42,15 @@ test_mockable_static int mock_temp_get_val(int idx, int *temp_ptr)
 	return EC_SUCCESS;
 }
 
+/* CPU and Board are two channels of the same mock part. */
+test_mockable_static void mock_temp_update(void)
+{
+}
+
 const struct temp_sensor_t temp_sensors[] = {
-	{"CPU", TEMP_SENSOR_TYPE_CPU, mock_temp_get_val, 0},
-	{"Board", TEMP_SENSOR_TYPE_BOARD, mock_temp_get_val, 1},
+	{"CPU", TEMP_SENSOR_TYPE_CPU, mock_temp_get_val, 0, mock_temp_update},
+	{"Board", TEMP_SENSOR_TYPE_BOARD, mock_temp_get_val, 1,
+	 mock_temp_update},
 	{"Case", TEMP_SENSOR_TYPE_CASE, mock_temp_get_val, 2},
 	{"Battery", TEMP_SENSOR_TYPE_BOARD, mock_temp_get_val, 3},
 };
@@ -70,6 +76,9 @@ const struct i2c_port_t i2c_ports[] = {
 #elif defined I2C_PORT_EEPROM
 	{"eeprom", I2C_PORT_EEPROM, 100, 0, 0},
 #endif
+#ifdef I2C_PORT_AUX
+	{"aux", I2C_PORT_AUX, 400, 0, 0},
+#endif
 };
 
 const unsigned int i2c_ports_used = ARRAY_SIZE(i2c_ports);
@@ -392,6 +392,7 @@
 
 /* Support FAN */
 #define CONFIG_FANS 1
+#define CONFIG_FAN_PID
 #undef CONFIG_FAN_INIT_SPEED
 #define CONFIG_FAN_INIT_SPEED 15
 #define FAN_HARDARE_MAX 7100
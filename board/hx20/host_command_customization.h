@@ -5,6 +5,8 @@
 
 /* host command customization configuration */
 
+/* 0x3E18 and up are taken by common code, see ec_commands_private.h */
+
 #ifndef __HOST_COMMAND_CUSTOMIZATION_H
 #define __HOST_COMMAND_CUSTOMIZATION_H
 
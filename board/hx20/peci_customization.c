@@ -37,7 +37,9 @@ int peci_Rd_Pkg_Config(uint8_t index, uint16_t parameter, int rlen, uint8_t *in)
 	out[2] = (parameter & 0xff);
 	out[3] = ((parameter >> 8) & 0xff);
 
+	peci_lock(1);
 	rv = peci_transaction(&peci);
+	peci_lock(0);
 	if (rv)
 		return rv;
 
@@ -69,7 +71,9 @@ int peci_Wr_Pkg_Config(uint8_t index, uint16_t parameter, uint32_t data, int wle
 	for (clen = 4; clen < wlen - 1; clen++)
 		out[clen] = ((data >> ((clen - 4) * 8)) & 0xFF);
 
+	peci_lock(1);
 	rv = peci_transaction(&peci);
+	peci_lock(0);
 	if (rv)
 		return rv;
 
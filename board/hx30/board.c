@@ -1008,19 +1008,22 @@ const struct temp_sensor_t temp_sensors[] = {
 		.name = "F75303_Local",
 		.type = TEMP_SENSOR_TYPE_BOARD,
 		.read = f75303_get_val,
-		.idx = F75303_IDX_LOCAL
+		.idx = F75303_IDX_LOCAL,
+		.update = f75303_update_temps,
 	},
 	[TEMP_SENSOR_CPU] = {
 		.name = "F75303_CPU",
 		.type = TEMP_SENSOR_TYPE_CPU,
 		.read = f75303_get_val,
-		.idx = F75303_IDX_REMOTE2
+		.idx = F75303_IDX_REMOTE2,
+		.update = f75303_update_temps,
 	},
 	[TEMP_SENSOR_DDR] = {
 		.name = "F75303_DDR",
 		.type = TEMP_SENSOR_TYPE_BOARD,
 		.read = f75303_get_val,
-		.idx = F75303_IDX_REMOTE1
+		.idx = F75303_IDX_REMOTE1,
+		.update = f75303_update_temps,
 	},
 	[TEMP_SENSOR_BATTERY] = {
 		.name = "Battery",
@@ -1040,7 +1043,8 @@ const struct temp_sensor_t temp_sensors[] = {
 		.name = "F75397_VCCGT",
 		.type = TEMP_SENSOR_TYPE_BOARD,
 		.read = f75397_get_val,
-		.idx = F75397_IDX_REMOTE1
+		.idx = F75397_IDX_REMOTE1,
+		.update = f75397_update_temps,
 	},
 };
 BUILD_ASSERT(ARRAY_SIZE(temp_sensors) == TEMP_SENSOR_COUNT);
@@ -164,6 +164,7 @@
 
 #define CONFIG_BATTERY_CUT_OFF
 #define CONFIG_BATTERY_SMART
+#define CONFIG_BATTERY_SMART_STRING_CACHE
 #define CONFIG_BATTERY_PRESENT_CUSTOM
 #define CONFIG_BOARD_VERSION_CUSTOM
 #define CONFIG_CHARGE_MANAGER
@@ -203,8 +204,11 @@
 #define CONFIG_HOSTCMD_ESPI_VW_SLP_S3
 #define CONFIG_HOSTCMD_ESPI_VW_SLP_S4
 #define CONFIG_HOSTCMD_ESPI_VW_SLP_S5
+/* Batch battery/PD/UCSI event bursts into one SCI */
+#define CONFIG_HOST_EVENT_COALESCE_MS 10
 
 #define CONFIG_POWER_S0IX
+#define CONFIG_HOOK_TIMING
 #define CONFIG_POWER_TRACK_HOST_SLEEP_STATE
 
 #define CONFIG_CLOCK_CRYSTAL
@@ -337,6 +341,13 @@
  */
 #define CONFIG_FLASH_SIZE 0x100000
 #define CONFIG_SPI_FLASH_W25Q80
+/* Dual output fast read, QE is not set so IO2/IO3 stay WP#/HOLD# */
+#define CONFIG_SPI_FLASH_FAST_READ 2
+/* Every flash read is a SPI transaction; keep recent pages in RAM */
+#define CONFIG_FLASH_READ_CACHE
+/* W25Q80 supports erase suspend, so reads need not wait for erases */
+#define CONFIG_FLASH_DEFERRED_ERASE
+#define CONFIG_FLASH_BACKGROUND_ERASE
 #define SPI_BIOS_SETUP 0x00
 
 #define BIOS_SETUP_AC_BOOT	BIT(0)
@@ -404,11 +415,14 @@
 
 /* Support FAN */
 #define CONFIG_FANS 1
+#define CONFIG_FAN_PID
 #undef CONFIG_FAN_INIT_SPEED
 #define CONFIG_FAN_INIT_SPEED 15
 #define FAN_HARDARE_MAX 7100
 #define CONFIG_TEMP_SENSOR
+#define CONFIG_TEMP_SENSOR_CACHE
 #define CONFIG_DPTF
+#define CONFIG_THERMAL_FAST_POLL_MARGIN 3
 #define CONFIG_TEMP_SENSOR_F75303
 #define CONFIG_TEMP_SENSOR_F75397
 #define F75303_I2C_ADDR_FLAGS 0x4D
@@ -510,6 +524,12 @@
  * All other ports set to 0xff (not used)
  */
 #define CONFIG_I2C_DEBUG
+#define CONFIG_I2C_STATS
+/* One interrupt per transfer, and i2c_xfer_submit() returns early */
+#define CONFIG_MCHP_I2C_DMA
+#define CONFIG_I2C_XFER_ASYNC
+/* PD interrupt servicing goes ahead of battery polling */
+#define CONFIG_I2C_SCHED
 #define I2C_PORT_TOUCHPAD		MCHP_I2C_PORT2
 #define I2C_PORT_PD_MCU0        MCHP_I2C_PORT6
 #define I2C_PORT_PD_MCU1        MCHP_I2C_PORT7
@@ -579,6 +599,9 @@
 /* Ambient Light Sensor address */
 #define OPT3001_I2C_ADDR_FLAGS	OPT3001_I2C_ADDR1_FLAGS
 
+/* Let production test scripts use the framed console */
+#define CONFIG_CONSOLE_FRAMED
+
 /* Modules we want to exclude */
 #undef CONFIG_CMD_HASH
 #undef CONFIG_CMD_TEMP_SENSOR
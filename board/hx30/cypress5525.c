@@ -1290,6 +1290,8 @@ void cypd_interrupt_handler_task(void *p)
 {
 	int i, j, evt, events;
 	cypd_int_task_id = task_get_current();
+	/* PD controller interrupts go ahead of other users of the port */
+	i2c_set_priority(I2C_PRIO_URGENT);
 
 	/* Initialize all charge suppliers to 0 */
 	for (i = 0; i < CHARGE_PORT_COUNT; i++) {
@@ -5,6 +5,8 @@
 
 /* host command customization configuration */
 
+/* 0x3E18 and up are taken by common code, see ec_commands_private.h */
+
 #ifndef __HOST_COMMAND_CUSTOMIZATION_H
 #define __HOST_COMMAND_CUSTOMIZATION_H
 
@@ -229,4 +231,51 @@ struct ec_response_chassis_counter {
 	uint8_t press_counter;
 } __ec_align1;
 
+/*
+ * Timestamps of the last power-on (or S3 resume) sequence, in the order the
+ * steps completed. Times are in us since the sequence started.
+ */
+#define EC_CMD_BOOT_PROFILE 0x3E16
+
+#define EC_BOOT_PROFILE_MAX_ENTRIES 24
+
+enum ec_boot_profile_seq {
+	EC_BOOT_PROFILE_SEQ_G3S5 = 0,
+	EC_BOOT_PROFILE_SEQ_S3S0,
+	/* Not a sequence: step is the power state reached */
+	EC_BOOT_PROFILE_SEQ_STATE,
+};
+
+/* The step's power good inputs never showed up */
+#define EC_BOOT_PROFILE_FLAG_TIMEOUT BIT(0)
+
+struct ec_boot_profile_entry {
+	uint8_t seq;		/* enum ec_boot_profile_seq */
+	uint8_t step;		/* Index in the sequence */
+	uint8_t flags;		/* EC_BOOT_PROFILE_FLAG_* */
+	uint8_t reserved;
+	uint32_t time_us;
+} __ec_align4;
+
+struct ec_response_boot_profile {
+	uint8_t count;
+	uint8_t reserved[3];
+	struct ec_boot_profile_entry entry[EC_BOOT_PROFILE_MAX_ENTRIES];
+} __ec_align4;
+
+/* Timing of the last S0ix transitions, and a histogram of resume times */
+#define EC_CMD_S0IX_LATENCY 0x3E17
+
+#define EC_S0IX_LATENCY_BUCKETS 10
+
+struct ec_response_s0ix_latency {
+	uint32_t last_entry_us;
+	uint32_t last_exit_us;
+	/*
+	 * Resumes, from the host asking until S0: bucket i counts those
+	 * under 2^i ms, the last bucket all slower ones.
+	 */
+	uint16_t resume_hist[EC_S0IX_LATENCY_BUCKETS];
+} __ec_align4;
+
 #endif /* __HOST_COMMAND_CUSTOMIZATION_H */
@@ -3,6 +3,7 @@
  * found in the LICENSE file.
  */
 
+#include "atomic.h"
 #include "chipset.h"
 #include "console.h"
 #include "board.h"
@@ -10,6 +11,7 @@
 #include "host_command.h"
 #include "peci.h"
 #include "peci_customization.h"
+#include "task.h"
 #include "timer.h"
 #include "util.h"
 
@@ -17,10 +19,79 @@
 #define CPUTS(outstr) cputs(CC_THERMAL, outstr)
 #define CPRINTS(format, args...) cprints(CC_THERMAL, format, ## args)
 
+/* Nominal CPU temperature poll period and the upper bound of its backoff */
+#define PECI_TEMP_POLL_US		SECOND
+#define PECI_TEMP_POLL_MAX_US		(8 * SECOND)
+
+/* Attempts to deliver one power limit write before giving up on it */
+#define PECI_PL_MAX_RETRY		3
+
+#define PECI_TASK_EVENT_PL_UPDATE	TASK_EVENT_CUSTOM_BIT(0)
+
 static int peci_temp;
 static int peci_select_count;
 static int peci_select_flags;
 
+/*
+ * Power limit registers owned by the PECI task. Callers only post the
+ * requested value; the task writes it when it differs from the value the CPU
+ * last acknowledged, so repeated updates with the same limit cost nothing.
+ */
+enum peci_pl_id {
+	PECI_PL_PL1,
+	PECI_PL_PL2,
+	PECI_PL_PL4,
+	PECI_PL_PSYS_PL2,
+	PECI_PL_COUNT
+};
+
+struct peci_pl_entry {
+	const char *name;
+	uint8_t index;
+	uint16_t parameter;
+	uint8_t written_valid;
+	uint8_t retry;
+	uint32_t data;
+	uint32_t written;
+};
+
+static struct peci_pl_entry peci_pl[PECI_PL_COUNT] = {
+	[PECI_PL_PL1] = {
+		.name = "PL1",
+		.index = PECI_INDEX_POWER_LIMITS_PL1,
+		.parameter = PECI_PARAMS_POWER_LIMITS_PL1,
+	},
+	[PECI_PL_PL2] = {
+		.name = "PL2",
+		.index = PECI_INDEX_POWER_LIMITS_PL2,
+		.parameter = PECI_PARAMS_POWER_LIMITS_PL2,
+	},
+	[PECI_PL_PL4] = {
+		.name = "PL4",
+		.index = PECI_INDEX_POWER_LIMITS_PL4,
+		.parameter = PECI_PARAMS_POWER_LIMITS_PL4,
+	},
+	[PECI_PL_PSYS_PL2] = {
+		.name = "PsysPL2",
+		.index = PECI_INDEX_POWER_LIMITS_PSYS_PL2,
+		.parameter = PECI_PARAMS_POWER_LIMITS_PSYS_PL2,
+	},
+};
+
+/* Bitmask of peci_pl[] entries waiting to be written */
+static uint32_t peci_pl_pending;
+
+/* Statistics, reported by the pecisched console command */
+static struct {
+	uint32_t pl_writes;
+	uint32_t pl_skipped;
+	uint32_t pl_errors;
+	uint32_t temp_reads;
+	uint32_t temp_errors;
+} peci_stats;
+
+static int peci_temp_poll_us = PECI_TEMP_POLL_US;
+
 /*****************************************************************************/
 /* Internal functions */
 
@@ -44,7 +115,9 @@ int peci_Rd_Pkg_Config(uint8_t index, uint16_t parameter, int rlen, uint8_t *in)
 	out[2] = (parameter & 0xff);
 	out[3] = ((parameter >> 8) & 0xff);
 
+	peci_lock(1);
 	rv = peci_transaction(&peci);
+	peci_lock(0);
 	if (rv)
 		return rv;
 
@@ -77,6 +150,7 @@ int peci_Wr_Pkg_Config(uint8_t index, uint16_t parameter, uint32_t data, int wle
 		out[clen] = ((data >> ((clen - 4) * 8)) & 0xFF);
 
 
+	peci_lock(1);
 	if (peci_select_count < 10 || peci_select_flags) {
 		rv = peci_transaction(&peci);
 
@@ -90,6 +164,7 @@ int peci_Wr_Pkg_Config(uint8_t index, uint16_t parameter, uint32_t data, int wle
 	} else {
 		rv = espi_oob_peci_transaction(&peci);
 	}
+	peci_lock(0);
 
 	if (rv)
 		return rv;
@@ -112,6 +187,7 @@ static int peci_over_espi_get_cpu_temp(int *cpu_temp)
 		.timeout_us = PECI_GET_TEMP_TIMEOUT_US,
 	};
 
+	peci_lock(1);
 	if (peci_select_count < 10 || peci_select_flags) {
 		rv = peci_transaction(&peci);
 
@@ -123,13 +199,13 @@ static int peci_over_espi_get_cpu_temp(int *cpu_temp)
 			peci_select_flags = 1;
 		}
 	} else {
+		/*
+		 * A timed out OOB request is not retried here; the task backs
+		 * off the next poll instead of spinning on the OOB channel.
+		 */
 		rv = espi_oob_peci_transaction(&peci);
-
-		if (rv == EC_ERROR_TIMEOUT) {
-			CPRINTS("ESPI GET VALUE TIMEOUT!");
-			espi_oob_retry_receive_date(r_buf);
-		}
 	}
+	peci_lock(0);
 
 	if (rv)
 		return rv;
@@ -163,84 +239,61 @@ int check_system_power(void)
 /*****************************************************************************/
 /* External functions */
 
-int peci_update_PL1(int watt)
+static int peci_post_power_limit(enum peci_pl_id id, uint32_t data)
 {
-	int rv;
-	uint32_t data;
-
 	if (!chipset_in_state(CHIPSET_STATE_ON) || check_system_power())
 		return EC_ERROR_NOT_POWERED;
 
-	data = PECI_PL1_CONTROL_TIME_WINDOWS | PECI_PL1_POWER_LIMIT_ENABLE |
-		PECI_PL1_POWER_LIMIT(watt);
-
-	rv = peci_Wr_Pkg_Config(PECI_INDEX_POWER_LIMITS_PL1, PECI_PARAMS_POWER_LIMITS_PL1,
-		data, PECI_WR_PKG_CONFIG_WRITE_LENGTH_DWORD);
-
-	if (rv)
-		return rv;
+	peci_pl[id].data = data;
+	peci_pl[id].retry = 0;
+	deprecated_atomic_or(&peci_pl_pending, BIT(id));
+	task_set_event(TASK_ID_PECI, PECI_TASK_EVENT_PL_UPDATE, 0);
 
 	return EC_SUCCESS;
 }
 
-int peci_update_PL2(int watt)
+int peci_update_PL1(int watt)
 {
-	int rv;
-	uint32_t data;
-
-	if (!chipset_in_state(CHIPSET_STATE_ON) || check_system_power())
-		return EC_ERROR_NOT_POWERED;
-
-	data = PECI_PL2_CONTROL_TIME_WINDOWS | PECI_PL2_POWER_LIMIT_ENABLE |
-		PECI_PL2_POWER_LIMIT(watt);
-
-	rv = peci_Wr_Pkg_Config(PECI_INDEX_POWER_LIMITS_PL2, PECI_PARAMS_POWER_LIMITS_PL2,
-		data, PECI_WR_PKG_CONFIG_WRITE_LENGTH_DWORD);
-
-	if (rv)
-		return rv;
+	return peci_post_power_limit(PECI_PL_PL1,
+		PECI_PL1_CONTROL_TIME_WINDOWS | PECI_PL1_POWER_LIMIT_ENABLE |
+		PECI_PL1_POWER_LIMIT(watt));
+}
 
-	return EC_SUCCESS;
+int peci_update_PL2(int watt)
+{
+	return peci_post_power_limit(PECI_PL_PL2,
+		PECI_PL2_CONTROL_TIME_WINDOWS | PECI_PL2_POWER_LIMIT_ENABLE |
+		PECI_PL2_POWER_LIMIT(watt));
 }
 
 int peci_update_PL4(int watt)
 {
-	int rv;
-	uint32_t data;
-
-	if (!chipset_in_state(CHIPSET_STATE_ON) || check_system_power())
-		return EC_ERROR_NOT_POWERED;
-
-	data = PECI_PL4_POWER_LIMIT(watt);
-
-	rv = peci_Wr_Pkg_Config(PECI_INDEX_POWER_LIMITS_PL4, PECI_PARAMS_POWER_LIMITS_PL4,
-		data, PECI_WR_PKG_CONFIG_WRITE_LENGTH_DWORD);
-
-	if (rv)
-		return rv;
-
-	return EC_SUCCESS;
+	return peci_post_power_limit(PECI_PL_PL4, PECI_PL4_POWER_LIMIT(watt));
 }
 
 int peci_update_PsysPL2(int watt)
 {
-	int rv;
-	uint32_t data;
-
-	if (!chipset_in_state(CHIPSET_STATE_ON) || check_system_power())
-		return EC_ERROR_NOT_POWERED;
-
-	data = PECI_PSYS_PL2_CONTROL_TIME_WINDOWS | PECI_PSYS_PL2_POWER_LIMIT_ENABLE |
-		PECI_PSYS_PL2_POWER_LIMIT(watt);
-
-	rv = peci_Wr_Pkg_Config(PECI_INDEX_POWER_LIMITS_PSYS_PL2,
-		PECI_PARAMS_POWER_LIMITS_PSYS_PL2, data, PECI_WR_PKG_CONFIG_WRITE_LENGTH_DWORD);
+	return peci_post_power_limit(PECI_PL_PSYS_PL2,
+		PECI_PSYS_PL2_CONTROL_TIME_WINDOWS |
+		PECI_PSYS_PL2_POWER_LIMIT_ENABLE |
+		PECI_PSYS_PL2_POWER_LIMIT(watt));
+}
 
-	if (rv)
-		return rv;
+/*
+ * The CPU drops its power limits across a platform reset, so the cached
+ * copies must not suppress the first write after the host comes back.
+ */
+static void peci_invalidate_power_limits(void)
+{
+	int i;
 
-	return EC_SUCCESS;
+	for (i = 0; i < PECI_PL_COUNT; i++)
+		peci_pl[i].written_valid = 0;
 }
+DECLARE_HOOK(HOOK_CHIPSET_SHUTDOWN, peci_invalidate_power_limits,
+	HOOK_PRIO_DEFAULT);
+DECLARE_HOOK(HOOK_CHIPSET_RESUME, peci_invalidate_power_limits,
+	HOOK_PRIO_FIRST);
 
 __override int stop_read_peci_temp(void)
 {
@@ -288,7 +341,52 @@ int peci_over_espi_temp_sensor_get_val(int idx, int *temp_ptr)
 }
 
 
-void read_peci_over_espi_gettemp(void)
+static void peci_flush_power_limits(void)
+{
+	struct peci_pl_entry *pl;
+	uint32_t pending;
+	uint32_t data;
+	int rv;
+	int i;
+
+	pending = deprecated_atomic_read_clear(&peci_pl_pending);
+
+	/* Issue every queued write back to back in one pass */
+	for (i = 0; i < PECI_PL_COUNT; i++) {
+		if (!(pending & BIT(i)))
+			continue;
+
+		pl = &peci_pl[i];
+		data = pl->data;
+
+		if (pl->written_valid && pl->written == data) {
+			peci_stats.pl_skipped++;
+			continue;
+		}
+
+		if (!chipset_in_state(CHIPSET_STATE_ON) || check_system_power())
+			continue;
+
+		rv = peci_Wr_Pkg_Config(pl->index, pl->parameter, data,
+			PECI_WR_PKG_CONFIG_WRITE_LENGTH_DWORD);
+		peci_stats.pl_writes++;
+
+		if (rv == EC_SUCCESS) {
+			pl->written = data;
+			pl->written_valid = 1;
+		} else {
+			peci_stats.pl_errors++;
+			pl->written_valid = 0;
+			/* Retry with the next temperature poll */
+			if (++pl->retry < PECI_PL_MAX_RETRY)
+				deprecated_atomic_or(&peci_pl_pending, BIT(i));
+			else
+				CPRINTS("PECI %s write failed", pl->name);
+		}
+	}
+}
+
+static void read_peci_over_espi_gettemp(void)
 {
 	int rv;
 	int i;
@@ -297,16 +395,80 @@ void read_peci_over_espi_gettemp(void)
 
 	if (rv != EC_SUCCESS) {
 		peci_temp = 0xfffe;
+		peci_temp_poll_us = PECI_TEMP_POLL_US;
+		return;
+	}
+
+	for (i = 0; i < 2; i++) {
+		int t;
+
+		peci_stats.temp_reads++;
+		rv = peci_over_espi_get_cpu_temp(&t);
+		if (!rv) {
+			/* Publish only complete readings to thermal consumers */
+			peci_temp = t;
+			break;
+		}
+		peci_stats.temp_errors++;
+		msleep(10);
+	}
+
+	if (rv != EC_SUCCESS) {
+		peci_temp = 0xffff;
+		/* Back off while the CPU or the OOB channel is unresponsive */
+		peci_temp_poll_us = MIN(peci_temp_poll_us * 2,
+					PECI_TEMP_POLL_MAX_US);
 	} else {
-		for (i = 0; i < 2; i++) {
-			rv = peci_over_espi_get_cpu_temp(&peci_temp);
-			if (!rv)
-				break;
-			msleep(10);
+		peci_temp_poll_us = PECI_TEMP_POLL_US;
+	}
+}
+
+/*
+ * PECI transaction scheduler. Issues the board's GetTemp and WrPkgConfig
+ * requests so they never block the hook task or each other; each transaction
+ * takes peci_lock() so the peci console commands can't interleave with it.
+ */
+void peci_task(void *u)
+{
+	timestamp_t next_temp = get_time();
+	int timeout;
+
+	while (1) {
+		peci_flush_power_limits();
+
+		if (timestamp_expired(next_temp, NULL)) {
+			read_peci_over_espi_gettemp();
+			next_temp.val = get_time().val + peci_temp_poll_us;
 		}
 
-		if (rv != EC_SUCCESS)
-			peci_temp = 0xffff;
+		timeout = next_temp.val - get_time().val;
+		if (timeout > 0)
+			task_wait_event(timeout);
 	}
 }
-DECLARE_HOOK(HOOK_SECOND, read_peci_over_espi_gettemp, HOOK_PRIO_DEFAULT);
+
+/*****************************************************************************/
+/* Console commands */
+
+static int cmd_pecisched(int argc, char **argv)
+{
+	int i;
+
+	ccprintf("CPU temp: %d (poll %d ms)\n", peci_temp,
+		 peci_temp_poll_us / MSEC);
+	ccprintf("temp reads %d errors %d\n", peci_stats.temp_reads,
+		 peci_stats.temp_errors);
+	ccprintf("PL writes %d skipped %d errors %d pending 0x%x\n",
+		 peci_stats.pl_writes, peci_stats.pl_skipped,
+		 peci_stats.pl_errors, peci_pl_pending);
+
+	for (i = 0; i < PECI_PL_COUNT; i++)
+		ccprintf("  %-8s req 0x%08x cpu 0x%08x%s\n", peci_pl[i].name,
+			 peci_pl[i].data, peci_pl[i].written,
+			 peci_pl[i].written_valid ? "" : " (stale)");
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(pecisched, cmd_pecisched,
+			NULL,
+			"Show PECI scheduler state");
@@ -53,9 +53,15 @@
 
 int peci_Rd_Pkg_Config(uint8_t index, uint16_t parameter, int rlen, uint8_t *in);
 int peci_Wr_Pkg_Config(uint8_t index, uint16_t parameter, uint32_t data, int wlen);
-int espi_oob_retry_receive_date(uint8_t *readBuf);
 int espi_oob_peci_transaction(struct peci_data *peci);
 
+/**
+ * Queue a PL1/PL2/PL4/PsysPL2 update for the PECI task. The write is
+ * skipped when the CPU already holds the same value.
+ *
+ * @param watt		power limit in watts
+ * @return int		EC_ERROR_NOT_POWERED if the CPU is off, else EC_SUCCESS
+ */
 int peci_update_PL1(int watt);
 int peci_update_PL2(int watt);
 int peci_update_PL4(int watt);
@@ -63,7 +69,7 @@ int peci_update_PsysPL2(int watt);
 
 /**
  * This function return the peci gettemp value from global variant, the
- * actually value is read from read_peci_over_espi_gettemp();
+ * actually value is polled by peci_task();
  *
  * @param idx		no used
  * @param temp_ptr	return temp value pointer
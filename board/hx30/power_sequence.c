@@ -5,6 +5,7 @@
 
 /* X86 chipset power control module for Chrome EC */
 
+#include "atomic.h"
 #include "battery.h"
 #include "board.h"
 #include "charge_state.h"
@@ -192,46 +193,177 @@ void update_prevent_power_on_flag(int status)
 	system_prevent_power_on_flag = status;
 }
 
-int board_chipset_power_on(void)
+/*****************************************************************************/
+/* Power sequencer */
+
+struct power_seq_step {
+	const char *name;
+	/* Output to drive when the step starts, GPIO_COUNT for none */
+	enum gpio_signal gpio;
+	int level;
+	/* Other work to do when the step starts, may be NULL */
+	void (*action)(void);
+	/* Time to leave after the previous step completed, in ms */
+	int min_ms;
+	/* Power good inputs to wait for, and for how long, in ms */
+	uint32_t wait;
+	int max_ms;
+	/* Diagnostic to raise if the inputs don't show up */
+	enum diagnostics_device_idx diag;
+};
+
+static struct ec_boot_profile_entry boot_profile[EC_BOOT_PROFILE_MAX_ENTRIES];
+static int boot_profile_count;
+static int boot_profile_open;
+static timestamp_t boot_profile_start;
+
+static void boot_profile_begin(void)
 {
-	/*gpio_set_level(GPIO_VS_ON, 1); Todo fix vson noboot*/
+	boot_profile_start = get_time();
+	boot_profile_count = 0;
+	boot_profile_open = 1;
+}
+
+static void boot_profile_add(int seq, int step, int flags, timestamp_t t)
+{
+	struct ec_boot_profile_entry *e;
 
-	msleep(5);
+	if (!boot_profile_open ||
+	    boot_profile_count >= EC_BOOT_PROFILE_MAX_ENTRIES)
+		return;
 
-	if (power_wait_signals(IN_PGOOD_PWR_3V5V)) {
-		CPRINTS("PH Timeout PWR_3V5V_PG");
-		set_hw_diagnostic(DIAGNOSTICS_HW_PGOOD_3V5V, 1);
-		chipset_force_g3();
-		return false;
+	e = &boot_profile[boot_profile_count++];
+	e->seq = seq;
+	e->step = step;
+	e->flags = flags;
+	e->time_us = t.val - boot_profile_start.val;
+}
+
+/* Record reaching a power state; S0 completes the profile. */
+static void boot_profile_state(enum power_state state)
+{
+	boot_profile_add(EC_BOOT_PROFILE_SEQ_STATE, state, 0, get_time());
+	if (state == POWER_S0 || state == POWER_G3)
+		boot_profile_open = 0;
+}
+
+/**
+ * Run a power sequence.
+ *
+ * Each step's minimum delay counts from the time the previous step
+ * completed, i.e. from the power good edge when it waited for one, so time
+ * spent elsewhere in between is not added on top.
+ *
+ * @return the index of the step whose inputs timed out, or -1 on success.
+ */
+static int power_seq_run(int seq, const struct power_seq_step *steps,
+			 int count)
+{
+	const struct power_seq_step *step;
+	timestamp_t last = get_time();
+	timestamp_t now;
+	int64_t left;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		step = steps + i;
+
+		now = get_time();
+		left = (int64_t)step->min_ms * MSEC - (now.val - last.val);
+		if (left > 0)
+			usleep(left);
+
+		if (step->gpio != GPIO_COUNT)
+			gpio_set_level(step->gpio, step->level);
+		if (step->action)
+			step->action();
+
+		if (step->wait && power_wait_signals_timeout(step->wait,
+				step->max_ms * MSEC) != EC_SUCCESS) {
+			CPRINTS("PH Timeout %s", step->name);
+			set_hw_diagnostic(step->diag, 1);
+			boot_profile_add(seq, i, EC_BOOT_PROFILE_FLAG_TIMEOUT,
+					 get_time());
+			return i;
+		}
+
+		last = get_time();
+		boot_profile_add(seq, i, 0, last);
 	}
 
-	gpio_set_level(GPIO_PCH_PWR_EN, 1);
+	return -1;
+}
 
-	msleep(10);
+static void power_seq_me_mode(void)
+{
+	me_gpio_change(me_change & ME_UNLOCK ? GPIO_OUT_HIGH : GPIO_OUT_LOW);
+}
 
-	gpio_set_level(GPIO_PCH_PWRBTN_L, 1);
+/* G3 -> S5: bring up the PCH rails and release RSMRST# */
+static const struct power_seq_step g3s5_seq[] = {
+	{ .name = "PWR_3V5V_PG", .gpio = GPIO_COUNT, .min_ms = 5,
+	  .wait = IN_PGOOD_PWR_3V5V, .max_ms = 1000,
+	  .diag = DIAGNOSTICS_HW_PGOOD_3V5V },
+	{ .name = "PCH_PWR_EN", .gpio = GPIO_PCH_PWR_EN, .level = 1 },
+	{ .name = "PCH_PWRBTN_L", .gpio = GPIO_PCH_PWRBTN_L, .level = 1,
+	  .min_ms = 10 },
+	{ .name = "PCH_DPWROK", .gpio = GPIO_PCH_DPWROK, .level = 1,
+	  .min_ms = 30 },
+	{ .name = "VCCIN_AUX_VR_PG", .gpio = GPIO_COUNT, .min_ms = 5,
+	  .wait = IN_PGOOD_VCCIN_AUX_VR, .max_ms = 1000,
+	  .diag = DIAGNOSTICS_VCCIN_AUX_VR },
+	{ .name = "ME", .gpio = GPIO_COUNT, .action = power_seq_me_mode },
+	/* At least 10ms between SUSP_VR and RSMRST */
+	{ .name = "PCH_RSMRST_L", .gpio = GPIO_PCH_RSMRST_L, .level = 1,
+	  .min_ms = 20 },
+};
+
+static void power_seq_sensors_on(void)
+{
+	f75303_set_enabled(1);
+	f75397_set_enabled(1);
+}
 
-	msleep(30);
+static void power_seq_resume_hooks(void)
+{
+	/* Call hooks now that rails are up */
+	hook_notify(HOOK_CHIPSET_RESUME);
+}
 
-	gpio_set_level(GPIO_PCH_DPWROK, 1);
+/* S3 -> S0: CPU rails, then PCH and system power OK */
+static const struct power_seq_step s3s0_seq[] = {
+	{ .name = "SUSP_L", .gpio = GPIO_SUSP_L, .level = 1 },
+	{ .name = "SENSORS", .gpio = GPIO_COUNT,
+	  .action = power_seq_sensors_on, .min_ms = 10 },
+	{ .name = "EC_VCCST_PG", .gpio = GPIO_EC_VCCST_PG, .level = 1 },
+	{ .name = "VR_ON", .gpio = GPIO_VR_ON, .level = 1, .min_ms = 30 },
+	{ .name = "PWR_VR_PG", .gpio = GPIO_COUNT,
+	  .action = power_seq_resume_hooks,
+	  .wait = IN_PGOOD_PWR_VR, .max_ms = 1000,
+	  .diag = DIAGNOSTICS_HW_PGOOD_VR },
+	{ .name = "PCH_PWROK", .gpio = GPIO_PCH_PWROK, .level = 1 },
+	{ .name = "SYS_PWROK", .gpio = GPIO_SYS_PWROK, .level = 1,
+	  .min_ms = 10 },
+};
+
+static const struct power_seq_step *const power_seqs[] = {
+	[EC_BOOT_PROFILE_SEQ_G3S5] = g3s5_seq,
+	[EC_BOOT_PROFILE_SEQ_S3S0] = s3s0_seq,
+};
+
+int board_chipset_power_on(void)
+{
+	/*gpio_set_level(GPIO_VS_ON, 1); Todo fix vson noboot*/
 
-	msleep(5);
+	boot_profile_begin();
 
-	if (power_wait_signals(IN_PGOOD_VCCIN_AUX_VR)) {
-		CPRINTS("PH Timeout VCCIN_AUX_VR_PG");
-		set_hw_diagnostic(DIAGNOSTICS_VCCIN_AUX_VR, 1);
+	if (power_seq_run(EC_BOOT_PROFILE_SEQ_G3S5, g3s5_seq,
+			  ARRAY_SIZE(g3s5_seq)) >= 0) {
 		chipset_force_g3();
+		boot_profile_open = 0;
 		return false;
 	}
 
-	me_gpio_change(me_change & ME_UNLOCK ? GPIO_OUT_HIGH : GPIO_OUT_LOW);
-
-	/* Add 10ms delay between SUSP_VR and RSMRST */
-	msleep(20);
-
-	/* Deassert RSMRST# */
-	gpio_set_level(GPIO_PCH_RSMRST_L, 1);
-
 	if (extpower_is_present())
 		gpio_set_level(GPIO_AC_PRESENT_OUT, 1);
 
@@ -256,6 +388,47 @@ int board_chipset_power_on(void)
 	return !system_prevent_power_on_flag;
 }
 
+static enum ec_status
+boot_profile_get(struct host_cmd_handler_args *args)
+{
+	struct ec_response_boot_profile *r = args->response;
+
+	r->count = boot_profile_count;
+	memcpy(r->entry, boot_profile,
+	       boot_profile_count * sizeof(boot_profile[0]));
+	args->response_size = sizeof(*r) -
+		(EC_BOOT_PROFILE_MAX_ENTRIES - boot_profile_count) *
+		sizeof(boot_profile[0]);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_BOOT_PROFILE, boot_profile_get,
+		     EC_VER_MASK(0));
+
+static int cmd_bootprofile(int argc, char **argv)
+{
+	const struct ec_boot_profile_entry *e;
+	uint32_t prev = 0;
+	int i;
+
+	for (i = 0; i < boot_profile_count; i++) {
+		e = &boot_profile[i];
+		ccprintf("%8d us (+%6d) ", e->time_us, e->time_us - prev);
+		if (e->seq == EC_BOOT_PROFILE_SEQ_STATE)
+			ccprintf("state %d\n", e->step);
+		else
+			ccprintf("%s%s\n", power_seqs[e->seq][e->step].name,
+				 e->flags & EC_BOOT_PROFILE_FLAG_TIMEOUT ?
+				 " timeout" : "");
+		prev = e->time_us;
+		cflush();
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(bootprofile, cmd_bootprofile, NULL,
+			"Print the timestamps of the last power sequence");
+
 enum power_state power_chipset_init(void)
 {
 	chipset_force_g3();
@@ -318,6 +491,9 @@ void power_state_clear(int state)
 static int enter_ms_flag;
 static int resume_ms_flag;
 
+/* When the host asked to leave S0ix, 0 if it hasn't */
+static timestamp_t s0ix_resume_request;
+
 static int check_s0ix_statsus(void)
 {
 	int power_status;
@@ -334,8 +510,12 @@ static int check_s0ix_statsus(void)
 		if (power_status & EC_PS_ENTER_S0ix)
 			enter_ms_flag++;
 
-		if (power_status & EC_PS_RESUME_S0ix)
+		if (power_status & EC_PS_RESUME_S0ix) {
 			resume_ms_flag++;
+			if (!s0ix_resume_request.val &&
+			    chipset_in_state(CHIPSET_STATE_STANDBY))
+				s0ix_resume_request = get_time();
+		}
 
 		clear_flag = power_status & (EC_PS_ENTER_S0ix | EC_PS_RESUME_S0ix);
 
@@ -361,6 +541,189 @@ void s0ix_status_handle(void)
 }
 DECLARE_HOOK(HOOK_TICK, s0ix_status_handle, HOOK_PRIO_DEFAULT);
 
+/*
+ * S0ix transition timing. The last entry and exit each keep the run time of
+ * every board step and hook routine; resume times also go into a histogram
+ * which is kept across sysjumps.
+ */
+enum s0ix_transition {
+	S0IX_ENTRY,
+	S0IX_EXIT,
+	S0IX_TRANSITION_COUNT,
+};
+
+#define S0IX_TIMING_STEPS 32
+
+static struct s0ix_timing {
+	uint32_t total_us;
+	int count;
+	struct hook_timing step[S0IX_TIMING_STEPS];
+} s0ix_timing[S0IX_TRANSITION_COUNT];
+
+static uint16_t s0ix_resume_hist[EC_S0IX_LATENCY_BUCKETS];
+
+#define S0IX_SYSJUMP_TAG 0x5358 /* "SX" */
+#define S0IX_HIST_VERSION 1
+
+static void s0ix_step(enum s0ix_transition t, void (*routine)(void))
+{
+	struct s0ix_timing *tm = &s0ix_timing[t];
+	timestamp_t start = get_time();
+
+	routine();
+
+	if (tm->count < S0IX_TIMING_STEPS) {
+		tm->step[tm->count].routine = routine;
+		tm->step[tm->count].us = get_time().val - start.val;
+		tm->count++;
+	}
+}
+
+static void s0ix_hooks(enum s0ix_transition t, enum hook_type type,
+		       int max_prio)
+{
+#ifdef CONFIG_HOOK_TIMING
+	struct s0ix_timing *tm = &s0ix_timing[t];
+
+	hook_timing_start(tm->step + tm->count, S0IX_TIMING_STEPS - tm->count);
+	hook_notify_range(type, HOOK_PRIO_FIRST, max_prio);
+	tm->count += hook_timing_stop();
+#else
+	hook_notify_range(type, HOOK_PRIO_FIRST, max_prio);
+#endif
+}
+
+static void s0ix_pd_active(void)
+{
+	cypd_set_power_active(POWER_S0);
+}
+
+static void s0ix_pd_idle(void)
+{
+	cypd_set_power_active(POWER_S3);
+}
+
+static void s0ix_record_resume(uint32_t us)
+{
+	int b = 0;
+
+	while (b < EC_S0IX_LATENCY_BUCKETS - 1 && us >= (MSEC << b))
+		b++;
+	if (s0ix_resume_hist[b] < UINT16_MAX)
+		s0ix_resume_hist[b]++;
+}
+
+#ifdef CONFIG_POWER_S0IX_FAST_RESUME_PRIO
+static uint32_t s0ix_late_resume_pending;
+
+/* Resume hooks held back by a fast resume */
+static void s0ix_late_resume(void)
+{
+	if (!deprecated_atomic_read_clear(&s0ix_late_resume_pending))
+		return;
+
+	hook_notify_range(HOOK_CHIPSET_RESUME,
+			  CONFIG_POWER_S0IX_FAST_RESUME_PRIO + 1,
+			  HOOK_PRIO_LAST);
+}
+DECLARE_DEFERRED(s0ix_late_resume);
+#endif
+
+static void s0ix_suspend(void)
+{
+	struct s0ix_timing *tm = &s0ix_timing[S0IX_ENTRY];
+	timestamp_t start = get_time();
+
+	tm->count = 0;
+
+#ifdef CONFIG_POWER_S0IX_FAST_RESUME_PRIO
+	/* Finish a fast resume before undoing it. */
+	hook_call_deferred(&s0ix_late_resume_data, -1);
+	s0ix_late_resume();
+#endif
+
+	s0ix_step(S0IX_ENTRY, lpc_s0ix_suspend_clear_masks);
+	s0ix_hooks(S0IX_ENTRY, HOOK_CHIPSET_SUSPEND, HOOK_PRIO_LAST);
+	if (enter_ms_flag > 0)
+		enter_ms_flag--;
+	s0ix_step(S0IX_ENTRY, s0ix_pd_idle);
+
+	tm->total_us = get_time().val - start.val;
+}
+
+static void s0ix_resume(void)
+{
+	struct s0ix_timing *tm = &s0ix_timing[S0IX_EXIT];
+	timestamp_t start = get_time();
+
+	tm->count = 0;
+
+	s0ix_step(S0IX_EXIT, lpc_s0ix_resume_restore_masks);
+#ifdef CONFIG_POWER_S0IX_FAST_RESUME_PRIO
+	/* Only what the host needs to see us awake, the rest comes later. */
+	s0ix_hooks(S0IX_EXIT, HOOK_CHIPSET_RESUME,
+		   CONFIG_POWER_S0IX_FAST_RESUME_PRIO);
+	s0ix_late_resume_pending = 1;
+	hook_call_deferred(&s0ix_late_resume_data, 0);
+#else
+	s0ix_hooks(S0IX_EXIT, HOOK_CHIPSET_RESUME, HOOK_PRIO_LAST);
+#endif
+	if (resume_ms_flag > 0)
+		resume_ms_flag--;
+	s0ix_step(S0IX_EXIT, s0ix_pd_active);
+
+	if (!s0ix_resume_request.val)
+		s0ix_resume_request = start;
+	tm->total_us = get_time().val - s0ix_resume_request.val;
+	s0ix_resume_request.val = 0;
+
+	s0ix_record_resume(tm->total_us);
+}
+
+DECLARE_PRESERVED_STATE(s0ix_hist, S0IX_SYSJUMP_TAG, S0IX_HIST_VERSION,
+			s0ix_resume_hist);
+
+static enum ec_status s0ix_latency_get(struct host_cmd_handler_args *args)
+{
+	struct ec_response_s0ix_latency *r = args->response;
+
+	r->last_entry_us = s0ix_timing[S0IX_ENTRY].total_us;
+	r->last_exit_us = s0ix_timing[S0IX_EXIT].total_us;
+	memcpy(r->resume_hist, s0ix_resume_hist, sizeof(r->resume_hist));
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_S0IX_LATENCY, s0ix_latency_get,
+		     EC_VER_MASK(0));
+
+static int cmd_s0ixtime(int argc, char **argv)
+{
+	static const char * const names[] = { "Entry", "Exit" };
+	const struct s0ix_timing *tm;
+	int t, i;
+
+	for (t = 0; t < S0IX_TRANSITION_COUNT; t++) {
+		tm = &s0ix_timing[t];
+		ccprintf("%s: %d us\n", names[t], tm->total_us);
+		for (i = 0; i < tm->count; i++)
+			ccprintf("  %pP %8d us\n", tm->step[i].routine,
+				 tm->step[i].us);
+		cflush();
+	}
+
+	ccprintf("Resume histogram:\n");
+	for (i = 0; i < EC_S0IX_LATENCY_BUCKETS; i++)
+		ccprintf("  %c%4d ms: %d\n",
+			 i < EC_S0IX_LATENCY_BUCKETS - 1 ? '<' : '>',
+			 1 << MIN(i, EC_S0IX_LATENCY_BUCKETS - 2),
+			 s0ix_resume_hist[i]);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(s0ixtime, cmd_s0ixtime, NULL,
+			"Print S0ix transition timing");
+
 #endif /* CONFIG_POWER_S0IX */
 
 enum power_state power_handle_state(enum power_state state)
@@ -381,6 +744,7 @@ enum power_state power_handle_state(enum power_state state)
 			 */
 			if (resume_ms_flag > 0)
 				resume_ms_flag--;
+			s0ix_resume_request.val = 0;
 			return POWER_S0;
 		}		
 		if (check_s0ix_statsus())
@@ -390,24 +754,16 @@ enum power_state power_handle_state(enum power_state state)
 
 	case POWER_S0ixS0:
 		CPRINTS("PH S0ixS0");
-		lpc_s0ix_resume_restore_masks();
-		hook_notify(HOOK_CHIPSET_RESUME);
-		if (resume_ms_flag > 0)
-			resume_ms_flag--;
+		s0ix_resume();
 		CPRINTS("PH S0ixS0->S0");
-		cypd_set_power_active(POWER_S0);
 		return POWER_S0;
 
 		break;
 
 	case POWER_S0S0ix:
 		CPRINTS("PH S0->S0ix");
-		lpc_s0ix_suspend_clear_masks();
-		hook_notify(HOOK_CHIPSET_SUSPEND);
-		if (enter_ms_flag > 0)
-			enter_ms_flag--;
+		s0ix_suspend();
 		CPRINTS("PH S0S0ix->S0ix");
-		cypd_set_power_active(POWER_S3);
 		return POWER_S0ix;
 
 		break;
@@ -445,7 +801,7 @@ enum power_state power_handle_state(enum power_state state)
 							 */
 							chipset_force_g3();
 							intel_x86_rtc_reset();
-							udelay(10 * MSEC);
+							msleep(10);
 							return POWER_G3S5;
 						}
 
@@ -515,6 +871,7 @@ enum power_state power_handle_state(enum power_state state)
 		if (board_chipset_power_on()) {
 			cancel_board_power_off();
 			CPRINTS("PH G3S5->S5");
+			boot_profile_state(POWER_S5);
 			
 			return POWER_S5;
 		} else {
@@ -531,43 +888,28 @@ enum power_state power_handle_state(enum power_state state)
         /* Call hooks now that rails are up */
 		hook_notify(HOOK_CHIPSET_STARTUP);
 		CPRINTS("PH S5S3->S3");
+		boot_profile_state(POWER_S3);
 		return POWER_S3;
 
 		break;
 
 	case POWER_S3S0:
 		CPRINTS("PH S3S0");
-        gpio_set_level(GPIO_SUSP_L, 1);
-
-        msleep(10);
-		f75303_set_enabled(1);
-		f75397_set_enabled(1);
-
-        gpio_set_level(GPIO_EC_VCCST_PG, 1);
-
-        msleep(30);
-
-        gpio_set_level(GPIO_VR_ON, 1);
-
-		/* Call hooks now that rails are up */
-		hook_notify(HOOK_CHIPSET_RESUME);
-
-        if (power_wait_signals(IN_PGOOD_PWR_VR)) {
-			set_hw_diagnostic(DIAGNOSTICS_HW_PGOOD_VR, true);
+		/* A resume from S3 gets a profile of its own. */
+		if (!boot_profile_open)
+			boot_profile_begin();
 
+		if (power_seq_run(EC_BOOT_PROFILE_SEQ_S3S0, s3s0_seq,
+				  ARRAY_SIZE(s3s0_seq)) >= 0) {
 			gpio_set_level(GPIO_SUSP_L, 0);
 			gpio_set_level(GPIO_EC_VCCST_PG, 0);
 			gpio_set_level(GPIO_VR_ON, 0);
 			f75303_set_enabled(0);
 			f75397_set_enabled(0);
+			boot_profile_open = 0;
 			return POWER_S3;
 		}
 
-        gpio_set_level(GPIO_PCH_PWROK, 1);
-
-        msleep(10);
-
-        gpio_set_level(GPIO_SYS_PWROK, 1);
 #ifdef CONFIG_EMI_REGION1
 		clear_rtcwake();
 #endif
@@ -577,7 +919,8 @@ enum power_state power_handle_state(enum power_state state)
 
 		cypd_set_power_active(POWER_S0);
 		CPRINTS("PH S3S0->S0");
-        return POWER_S0;
+		boot_profile_state(POWER_S0);
+		return POWER_S0;
 
 		break;
 
@@ -53,6 +53,6 @@ extern char __host_flash[CONFIG_FLASH_SIZE];
 #define GPIO_PIN(port, index) GPIO_##port, BIT(index)
 #define GPIO_PIN_MASK(p, m) .port = GPIO_##p, .mask = (m)
 
-#define I2C_PORT_COUNT 1
+#define I2C_PORT_COUNT 2
 
 #endif /* __CROS_EC_CONFIG_CHIP_H */
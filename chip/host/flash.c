@@ -77,6 +77,8 @@ int flash_physical_write(int offset, int size, const char *data)
 
 	memcpy(__host_flash + offset, data, size);
 	flash_set_persistent();
+	if (IS_ENABLED(CONFIG_FLASH_READ_CACHE))
+		flash_cache_invalidate(offset, size);
 
 	return EC_SUCCESS;
 }
@@ -93,6 +95,8 @@ int flash_physical_erase(int offset, int size)
 
 	memset(__host_flash + offset, 0xff, size);
 	flash_set_persistent();
+	if (IS_ENABLED(CONFIG_FLASH_READ_CACHE))
+		flash_cache_invalidate(offset, size);
 
 	return EC_SUCCESS;
 }
@@ -9,6 +9,7 @@
 #include "i2c.h"
 #include "i2c_private.h"
 #include "link_defs.h"
+#include "task.h"
 #include "test_util.h"
 
 #define MAX_DETACHED_DEV_COUNT 3
@@ -96,6 +97,41 @@ int chip_i2c_xfer(const int port, const uint16_t slave_addr_flags,
 	return EC_ERROR_UNKNOWN;
 }
 
+#ifdef CONFIG_I2C_XFER_ASYNC
+/*
+ * The emulated devices answer immediately, so the transfer runs at start and
+ * the completion interrupt is modelled by posting TASK_EVENT_I2C_IDLE to the
+ * caller, like a controller that signals the end of the whole transfer.
+ */
+static int async_rv[I2C_PORT_COUNT];
+
+int chip_i2c_xfer_start(const int port, const uint16_t slave_addr_flags,
+			const uint8_t *out, int out_size,
+			uint8_t *in, int in_size, int flags)
+{
+	if (port < 0 || port >= I2C_PORT_COUNT)
+		return EC_ERROR_UNIMPLEMENTED;
+
+	async_rv[port] = chip_i2c_xfer(port, slave_addr_flags,
+				       out, out_size, in, in_size, flags);
+	task_set_event(task_get_current(), TASK_EVENT_I2C_IDLE, 0);
+
+	return EC_SUCCESS;
+}
+
+int chip_i2c_xfer_finish(const int port)
+{
+	/*
+	 * Completions of transfers started together by one task may be
+	 * collected by a single wake-up.
+	 */
+	if (*task_get_event_bitmap(task_get_current()) & TASK_EVENT_I2C_IDLE)
+		task_wait_event_mask(TASK_EVENT_I2C_IDLE, 0);
+
+	return async_rv[port];
+}
+#endif /* CONFIG_I2C_XFER_ASYNC */
+
 int chip_i2c_set_freq(int port, enum i2c_freq freq)
 {
 	return EC_ERROR_UNIMPLEMENTED;
@@ -61,6 +61,11 @@ const char *test_get_captured_console(void)
 	return (const char *)capture_buf;
 }
 
+int test_get_captured_console_size(void)
+{
+	return capture_size;
+}
+
 static void uart_interrupt(void)
 {
 	uart_process_input();
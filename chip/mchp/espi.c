@@ -1022,36 +1022,14 @@ void espi_vw_evt2_dflt(uint32_t wire_state, uint32_t bpos)
 	MCHP_INT_DISABLE(25) = (1ul << bpos);
 }
 
-int espi_oob_retry_receive_date(uint8_t *readBuf)
-{
-	int retry = 2;
-	int i;
-	/* Clear slave OOB Dn/Up buffers */
-	memset(espi_slave_oobDn, 0, sizeof(espi_slave_oobDn));
+/* Maximum time to wait for the PCH to answer an OOB PECI request */
+#define ESPI_OOB_PECI_TIMEOUT_MS 5
 
-	/**
-	 * Init OOB RX to be read to rx data packet from master
-	 * note: espi_OOB_RxDn_BufferAddress = &espi_slave_oobDn[]
-	 */
-	MCHP_ESPI_OOB_RX_ADDR_LO = espi_OOB_RxDn_BufferAddress;
-	MCHP_ESPI_OOB_RX_LEN |= (0xFF << 16);
-	MCHP_ESPI_OOB_RX_CTL |= BIT(0); /* SET_RECEIVE_AVAILABLE */
+/* OOB RX status: a complete packet has been written to the RX buffer */
+#define ESPI_OOB_RX_STS_DONE BIT(0)
 
-		/* wait eSPI Tx done */
-	while (retry--) {
-		msleep(5);
-		if (espi_slave_oobDn[0] != 0) {
-			if (espi_slave_oobDn[1] == 0x01) {
-				/* only process peci cmd */
-				for (i = 0; i < espi_slave_oobDn[2]-2; i++)
-					readBuf[i] = espi_slave_oobDn[i+5];
-			}
-			return EC_SUCCESS;
-		}
-	}
-
-	return EC_ERROR_UNKNOWN;
-}
+/* Latched by the OOB RX ISR, which clears the status register itself */
+static volatile int espi_oob_rx_done;
 
 int espi_oob_build_peci_command(uint8_t srcAddr, uint8_t destAddr, uint8_t cmdCode,
 		uint8_t nWrite, uint8_t *writeBuf, uint8_t *readBuf)
@@ -1118,20 +1096,37 @@ int espi_oob_build_peci_command(uint8_t srcAddr, uint8_t destAddr, uint8_t cmdCo
 	espi_slave_oobUp[3] = srcAddr;	/* Source slave address */
 	memcpy(espi_slave_oobUp + 4, writeBuf, nWrite); /* Copy the other datas */
 
+	/* Drop any stale RX done left over from an earlier packet */
+	MCHP_ESPI_OOB_RX_STATUS = ESPI_OOB_RX_STS_DONE;
+	espi_oob_rx_done = 0;
+
 	MCHP_ESPI_OOB_TX_STATUS = 0x2F;	/* Write clear register, reset status */
 	MCHP_ESPI_OOB_TX_CTL |= 0x01;	/* TRANSMIT_START */
 
-	/* wait eSPI Tx done */
-	msleep(5);
-
-	if (espi_slave_oobDn[0] != 0) {
-		if (espi_slave_oobDn[1] == 0x01) {
-			/* only process peci cmd */
-			for (i = 0; i < espi_slave_oobDn[2]-2; i++)
-				readBuf[i] = espi_slave_oobDn[i+5];
+	/*
+	 * Wait for the PCH response. Poll in 1 ms steps so a fast reply does
+	 * not pay for the worst case turnaround time. The buffer is only
+	 * complete once the controller reports RX done; a non-zero first
+	 * byte may be a packet still being written.
+	 */
+	for (i = 0; i < ESPI_OOB_PECI_TIMEOUT_MS; i++) {
+		msleep(1);
+		if (MCHP_ESPI_OOB_RX_STATUS & ESPI_OOB_RX_STS_DONE) {
+			MCHP_ESPI_OOB_RX_STATUS = ESPI_OOB_RX_STS_DONE;
+			espi_oob_rx_done = 1;
 		}
-	} else {
+		if (espi_oob_rx_done)
+			break;
+	}
+
+	if (!espi_oob_rx_done)
 		return EC_ERROR_TIMEOUT;
+	espi_oob_rx_done = 0;
+
+	if (espi_slave_oobDn[1] == 0x01) {
+		/* only process peci cmd */
+		for (i = 0; i < espi_slave_oobDn[2]-2; i++)
+			readBuf[i] = espi_slave_oobDn[i+5];
 	}
 
 	return EC_SUCCESS;
@@ -1419,6 +1414,8 @@ void espi_oob_rx_isr(void)
 	sts = MCHP_ESPI_OOB_RX_STATUS;
 	MCHP_ESPI_OOB_RX_STATUS = sts;
 	MCHP_INT_SOURCE(MCHP_ESPI_GIRQ) = MCHP_ESPI_OOB_RX_GIRQ_BIT;
+	if (sts & ESPI_OOB_RX_STS_DONE)
+		espi_oob_rx_done = 1;
 	/* Handle OOB Up transmit status: done and/or errors, if any */
 	CPRINTS("eSPI OOB_DN status = 0x%x", sts);
 	trace11(0, ESPI, 0, "eSPI OOB_RX Status = 0x%08x", sts);
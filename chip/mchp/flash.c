@@ -101,6 +101,22 @@ int flash_physical_erase(int offset, int size)
 	return ret;
 }
 
+#ifdef CONFIG_FLASH_BACKGROUND_ERASE
+int flash_physical_erase_background(int offset, int size,
+				    void (*done)(int rv))
+{
+	if (entire_flash_locked)
+		return EC_ERROR_ACCESS_DENIED;
+
+	return spi_flash_erase_background(offset, size, done);
+}
+
+void flash_physical_erase_progress(uint32_t *erased, uint32_t *size)
+{
+	spi_flash_erase_progress(erased, size);
+}
+#endif
+
 /**
  * Read physical write protect setting for a flash bank.
  *
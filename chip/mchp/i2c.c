@@ -9,9 +9,12 @@
 
 #include "common.h"
 #include "console.h"
+#include "dma.h"
+#include "dma_chip.h"
 #include "gpio.h"
 #include "hooks.h"
 #include "i2c.h"
+#include "i2c_private.h"
 #include "registers.h"
 #include "task.h"
 #include "timer.h"
@@ -67,9 +70,15 @@
 #define COMP_MCEN	BIT(3) /* enable master cumulative timeouts */
 #define COMP_SCEN	BIT(4) /* enable slave cumulative timeouts */
 #define COMP_BIDEN	BIT(5) /* enable Bus idle timeouts */
+#define COMP_TIMERR	BIT(6) /* any of the HW timeouts fired */
+#define COMP_BER	BIT(13) /* bus error */
+#define COMP_LAB	BIT(14) /* lost arbitration */
 #define COMP_R_WR   BIT(21) /* completed repeat start write */
 #define COMP_R_RE   BIT(20) /* completed repeat start read */
+#define COMP_MNAKX	BIT(24) /* slave NACK'd master transmit */
 #define COMP_IDLE	BIT(29)  /* i2c bus is idle */
+#define COMP_MDONE	BIT(30) /* master command done or paused */
+#define COMP_MERR	(COMP_TIMERR | COMP_BER | COMP_LAB | COMP_MNAKX)
 #define COMP_SLAVE  BIT(31)
 #define COMP_RW_BITS_MASK 0x3C /* R/W bits mask */
 /* Configuration */
@@ -116,6 +125,39 @@
 
 #define I2C_MAX_HOST_PACKET_SIZE_EXTEND 350
 
+#ifdef CONFIG_MCHP_I2C_DMA
+/*
+ * Controllers 0 to I2C_DMA_CTRL_COUNT - 1 have a master DMA channel.
+ * Their master DMA device ID is the same as the channel number.
+ */
+#ifdef CHIP_FAMILY_MEC152X
+#define I2C_DMA_CTRL_COUNT 3
+#else
+#define I2C_DMA_CTRL_COUNT 4
+#endif
+#define I2C_DMA_CHAN(ctrl) (MCHP_DMAC_I2C0_MASTER + ((ctrl) << 1))
+
+/*
+ * Largest write done by DMA. The network layer sends the address bytes from
+ * the master TX buffer too, so writes are copied to a bounce buffer with the
+ * write address in front and the read address behind.
+ */
+#define I2C_DMA_MAX_OUT 32
+#define I2C_DMA_MAX_IN MCMD_RCNT_MASK0
+
+enum i2c_dma_state {
+	I2C_DMA_IDLE,
+	/* Sending address and write data */
+	I2C_DMA_TX,
+	/* Receiving read data */
+	I2C_DMA_RX,
+	/* Master command finished, dma_rv holds the result */
+	I2C_DMA_DONE,
+};
+
+static uint8_t dma_out[I2C_DMA_CTRL_COUNT][I2C_DMA_MAX_OUT + 2];
+#endif /* CONFIG_MCHP_I2C_DMA */
+
 enum i2c_transaction_state {
 	/* Stop condition was sent in previous transaction */
 	I2C_TRANSACTION_STOPPED,
@@ -154,6 +196,11 @@ static struct {
 	uint8_t hwsts4;
 	uint8_t lines;
 	uint8_t slave_mode;
+#ifdef CONFIG_MCHP_I2C_DMA
+	uint8_t dma_state; /* ISR write */
+	uint8_t dma_wcnt; /* Bytes to write, address included */
+	int dma_rv; /* ISR write */
+#endif
 } cdata[I2C_CONTROLLER_COUNT];
 
 static struct {
@@ -519,6 +566,21 @@ static int wait_byte_done(int controller, uint8_t mask, uint8_t expected)
 	return rv;
 }
 
+/*
+ * Wait for the slave address byte. A NACK of the address means the slave
+ * is absent or busy, and is returned as EC_ERROR_BUSY so callers can retry.
+ * A NACK of a data byte is left as EC_ERROR_UNKNOWN by wait_byte_done(),
+ * since the slave rejected a transfer it had already started.
+ */
+static int wait_addr_done(int controller)
+{
+	int rv = wait_byte_done(controller, 0xff, 0x00);
+
+	if (rv == EC_ERROR_UNKNOWN && cdata[controller].hwsts == STS_LRB)
+		rv = EC_ERROR_BUSY;
+	return rv;
+}
+
 /*
  * Select port on controller. If controller configured
  * for port do nothing.
@@ -639,7 +701,10 @@ static int i2c_mtx(int ctrl)
 	}
 
 	for (i = 0; i < cdata[ctrl].out_size; ++i) {
-		rv = wait_byte_done(ctrl, 0xff, 0x00);
+		if (i == 0 && (cdata[ctrl].xflags & I2C_XFER_START))
+			rv = wait_addr_done(ctrl);
+		else
+			rv = wait_byte_done(ctrl, 0xff, 0x00);
 		if (rv) {
 			cdata[ctrl].flags |= (1ul << 17);
 			MCHP_I2C_CTRL(ctrl) = CTRL_PIN | CTRL_ESO |
@@ -650,7 +715,11 @@ static int i2c_mtx(int ctrl)
 		MCHP_I2C_DATA(ctrl) = cdata[ctrl].outp[i];
 	}
 
-	rv = wait_byte_done(ctrl, 0xff, 0x00);
+	if (cdata[ctrl].out_size == 0 &&
+	    (cdata[ctrl].xflags & I2C_XFER_START))
+		rv = wait_addr_done(ctrl);
+	else
+		rv = wait_byte_done(ctrl, 0xff, 0x00);
 	if (rv) {
 		cdata[ctrl].flags |= (1ul << 18);
 		MCHP_I2C_CTRL(ctrl) = CTRL_PIN | CTRL_ESO | CTRL_ENI |
@@ -752,7 +821,7 @@ static int i2c_mrx_start(int ctrl)
 	 * in I2C.Data
 	 */
 	cdata[ctrl].flags |= (1ul << 7);
-	rv = wait_byte_done(ctrl, 0xff, 0x00);
+	rv = wait_addr_done(ctrl);
 	if (rv) {
 		cdata[ctrl].flags |= (1ul << 19);
 		MCHP_I2C_CTRL(ctrl) = CTRL_PIN | CTRL_ESO |
@@ -823,22 +892,13 @@ static int i2c_mrx_data(int ctrl)
 }
 
 /*
- * Called from common/i2c_master
+ * Record the transfer context in cdata[ctrl], select the port and, if a
+ * START from idle is requested, make sure the bus is usable.
  */
-int chip_i2c_xfer(int port, uint16_t slave_addr_flags,
-		  const uint8_t *out, int out_size,
-		  uint8_t *in, int in_size, int flags)
+static int i2c_xfer_prepare(int port, int ctrl, uint16_t slave_addr_flags,
+			    const uint8_t *out, int out_size,
+			    uint8_t *in, int in_size, int flags)
 {
-	int ctrl;
-	int ret_done;
-
-	if (out_size == 0 && in_size == 0)
-		return EC_SUCCESS;
-
-	ctrl = i2c_port_to_controller(port);
-	if (ctrl < 0)
-		return EC_ERROR_INVAL;
-
 	cdata[ctrl].flags = (1ul << 0);
 	disable_controller_irq(ctrl);
 	select_port(port, ctrl);
@@ -860,12 +920,243 @@ int chip_i2c_xfer(int port, uint16_t slave_addr_flags,
 	if ((flags & I2C_XFER_START) &&
 		cdata[ctrl].transaction_state == I2C_TRANSACTION_STOPPED) {
 		wait_idle(ctrl);
-		ret_done = i2c_check_recover(port, ctrl);
-		if (ret_done)
-			goto err_chip_i2c_xfer;
+		return i2c_check_recover(port, ctrl);
 	}
+	return EC_SUCCESS;
+}
+
+/*
+ * Clean up after a failed transfer: record status, send STOP and
+ * reset the controller on bus error. A NACK of the slave address is
+ * returned as EC_ERROR_BUSY so callers can retry, and a timeout as
+ * EC_ERROR_TIMEOUT.
+ * Anything else is EC_ERROR_UNKNOWN.
+ */
+static int i2c_xfer_failed(int ctrl, int rv)
+{
+	cdata[ctrl].flags |= (1ul << 22);
+	cdata[ctrl].hwsts2 = MCHP_I2C_STATUS(ctrl); /* record status */
+	/* NOTE: writing I2C.Ctrl.PIN=1 will clear all bits
+	 * except NBB in I2C.Status
+	 */
+	MCHP_I2C_CTRL(ctrl) = CTRL_PIN | CTRL_ESO |
+				       CTRL_STO | CTRL_ACK;
+	cdata[ctrl].transaction_state = I2C_TRANSACTION_STOPPED;
+	/* record status after STOP */
+	cdata[ctrl].hwsts4 = MCHP_I2C_STATUS(ctrl);
+
+	/* record line levels.
+	 * Note line levels may reflect STOP condition
+	 */
+	cdata[ctrl].lines = (uint8_t)get_line_level(cdata[ctrl].port);
+	if (cdata[ctrl].hwsts2 & STS_BER) {
+		cdata[ctrl].flags |= (1ul << 23);
+		reset_controller(ctrl);
+		return EC_ERROR_UNKNOWN;
+	}
+	if (rv == EC_ERROR_BUSY || rv == EC_ERROR_TIMEOUT)
+		return rv;
+	return EC_ERROR_UNKNOWN;
+}
+
+#ifdef CONFIG_MCHP_I2C_DMA
+/*
+ * DMA engine: the controller's network layer runs the whole transaction
+ * (START, address, write data, Repeated-START, address, read data, STOP)
+ * from a single master command, fed by the master DMA channel. The ISR
+ * switches the channel from transmit to receive when the controller pauses
+ * between the write and read phases, so the task sees one completion event
+ * per transfer instead of one per byte.
+ */
+static int i2c_dma_usable(int ctrl, int out_size, int in_size, int flags)
+{
+	return ctrl < I2C_DMA_CTRL_COUNT && !cdata[ctrl].slave_mode &&
+	       flags == I2C_XFER_SINGLE &&
+	       cdata[ctrl].transaction_state == I2C_TRANSACTION_STOPPED &&
+	       out_size <= I2C_DMA_MAX_OUT && in_size <= I2C_DMA_MAX_IN;
+}
+
+/*
+ * Start the transfer stored in cdata[ctrl] by i2c_xfer_prepare().
+ * Completion is reported by the ISR through dma_state.
+ */
+static void i2c_dma_start(int ctrl)
+{
+	enum dma_channel ch = I2C_DMA_CHAN(ctrl);
+	uint8_t *buf = dma_out[ctrl];
+	uint32_t cmd = MCMD_MRUN | MCMD_MPROCEED | MCMD_START0 | MCMD_STOP;
+	uint32_t wcnt = 0;
+
+	if (cdata[ctrl].out_size) {
+		buf[wcnt++] = cdata[ctrl].slv_addr_8bit;
+		memcpy(buf + wcnt, cdata[ctrl].outp, cdata[ctrl].out_size);
+		wcnt += cdata[ctrl].out_size;
+	}
+	if (cdata[ctrl].in_size) {
+		/* Repeated-START before the last byte written */
+		if (wcnt)
+			cmd |= MCMD_STARTN;
+		buf[wcnt++] = cdata[ctrl].slv_addr_8bit | 0x01;
+	}
+	cdata[ctrl].dma_wcnt = wcnt;
+	cmd |= (wcnt << MCMD_WCNT_BITPOS) |
+	       ((uint32_t)cdata[ctrl].in_size << MCMD_RCNT_BITPOS);
+
+	dma_clr_chan(ch);
+	dma_cfg_buffers(ch, buf, wcnt, (void *)&MCHP_I2C_MASTER_TX_BUF(ctrl));
+	dma_cfg_xfr(ch, 1, ch, DMA_FLAG_M2D | DMA_FLAG_INCR_MEM);
+	dma_run(ch);
+
+	cdata[ctrl].flags |= (1ul << 24);
+	cdata[ctrl].dma_state = I2C_DMA_TX;
+	cdata[ctrl].dma_rv = EC_ERROR_UNKNOWN;
+	cdata[ctrl].transaction_state = I2C_TRANSACTION_OPEN;
+	cdata[ctrl].task_waiting = task_get_current();
+
+	MCHP_I2C_COMPLETE(ctrl) = MCHP_I2C_COMPLETE(ctrl);
+	MCHP_INT_SOURCE(MCHP_I2C_GIRQ) = MCHP_I2C_GIRQ_BIT(ctrl);
+	MCHP_I2C_CONFIG(ctrl) |= CFG_ENMI;
+	enable_controller_irq(ctrl);
+
+	MCHP_I2C_MASTER_CMD(ctrl) = cmd;
+}
+
+/* Stop the network layer and the DMA channel, ISR or task context */
+static void i2c_dma_stop(int ctrl)
+{
+	MCHP_I2C_CONFIG(ctrl) &= ~CFG_ENMI;
+	disable_controller_irq(ctrl);
+	MCHP_I2C_MASTER_CMD(ctrl) = 0;
+	dma_clr_chan(I2C_DMA_CHAN(ctrl));
+}
+
+static void i2c_dma_interrupt(int ctrl)
+{
+	enum dma_channel ch = I2C_DMA_CHAN(ctrl);
+	uint32_t comp, cmd;
+	int id = cdata[ctrl].task_waiting;
+
+	cdata[ctrl].hwsts3 = MCHP_I2C_STATUS(ctrl);
+	comp = MCHP_I2C_COMPLETE(ctrl);
+	MCHP_I2C_COMPLETE(ctrl) = comp;
+	cdata[ctrl].i2c_complete = comp;
+	MCHP_INT_SOURCE(MCHP_I2C_GIRQ) = MCHP_I2C_GIRQ_BIT(ctrl);
+
+	cmd = MCHP_I2C_MASTER_CMD(ctrl);
+	if (!(comp & COMP_MERR) && (cmd & MCMD_MRUN)) {
+		/*
+		 * Write phase done, the controller waits for MPROCEED
+		 * before clocking in the read data.
+		 */
+		if (cdata[ctrl].dma_state == I2C_DMA_TX &&
+		    !(cmd & MCMD_MPROCEED)) {
+			dma_clr_chan(ch);
+			dma_cfg_buffers(ch, cdata[ctrl].inp,
+					cdata[ctrl].in_size,
+					(void *)&MCHP_I2C_MASTER_RX_BUF(ctrl));
+			dma_cfg_xfr(ch, 1, ch,
+				    DMA_FLAG_D2M | DMA_FLAG_INCR_MEM);
+			dma_run(ch);
+			cdata[ctrl].dma_state = I2C_DMA_RX;
+			MCHP_I2C_MASTER_CMD(ctrl) = cmd | MCMD_MPROCEED;
+		}
+		return;
+	}
+
+	if (!(comp & COMP_MERR))
+		cdata[ctrl].dma_rv = EC_SUCCESS;
+	else if ((comp & COMP_MERR) == COMP_MNAKX &&
+		 cdata[ctrl].dma_wcnt - ((cmd & MCMD_WCNT_MASK) >>
+					 MCMD_WCNT_BITPOS) <= 1)
+		/*
+		 * WCNT counts down the bytes taken from the TX buffer, so at
+		 * most one taken means the address was NACKed.
+		 */
+		cdata[ctrl].dma_rv = EC_ERROR_BUSY;
+	else if ((comp & COMP_MERR) == COMP_TIMERR)
+		cdata[ctrl].dma_rv = EC_ERROR_TIMEOUT;
+	else
+		cdata[ctrl].dma_rv = EC_ERROR_UNKNOWN;
+	i2c_dma_stop(ctrl);
+	cdata[ctrl].dma_state = I2C_DMA_DONE;
+
+	if (id != TASK_ID_INVALID)
+		task_set_event(id, TASK_EVENT_I2C_IDLE, 0);
+}
+
+/*
+ * Wait for the DMA transfer to finish. Several transfers started by one
+ * task share TASK_EVENT_I2C_IDLE, so check the state rather than trusting
+ * the event.
+ */
+static int i2c_dma_finish(int ctrl)
+{
+	uint64_t deadline = get_time().val + cdata[ctrl].timeout_us;
+	int64_t left;
+	int rv;
+
+	while (cdata[ctrl].dma_state != I2C_DMA_DONE) {
+		left = deadline - get_time().val;
+		if (left <= 0) {
+			interrupt_disable();
+			if (cdata[ctrl].dma_state != I2C_DMA_DONE) {
+				i2c_dma_stop(ctrl);
+				cdata[ctrl].dma_rv = EC_ERROR_TIMEOUT;
+				cdata[ctrl].dma_state = I2C_DMA_DONE;
+			}
+			interrupt_enable();
+			break;
+		}
+		task_wait_event_mask(TASK_EVENT_I2C_IDLE, left);
+	}
+
+	cdata[ctrl].task_waiting = TASK_ID_INVALID;
+	cdata[ctrl].dma_state = I2C_DMA_IDLE;
+	cdata[ctrl].transaction_state = I2C_TRANSACTION_STOPPED;
+	rv = cdata[ctrl].dma_rv;
+	if (rv == EC_SUCCESS) {
+		/* MCHP wait for STOP to complete */
+		wait_idle(ctrl);
+		if (MCHP_I2C_STATUS(ctrl) & (STS_LAB | STS_BER))
+			rv = EC_ERROR_UNKNOWN;
+	}
+	if (rv)
+		return i2c_xfer_failed(ctrl, rv);
+
+	cdata[ctrl].flags |= (1ul << 14);
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_MCHP_I2C_DMA */
+
+/*
+ * Called from common/i2c_master
+ */
+int chip_i2c_xfer(int port, uint16_t slave_addr_flags,
+		  const uint8_t *out, int out_size,
+		  uint8_t *in, int in_size, int flags)
+{
+	int ctrl;
+	int ret_done;
+
+	if (out_size == 0 && in_size == 0)
+		return EC_SUCCESS;
+
+	ctrl = i2c_port_to_controller(port);
+	if (ctrl < 0)
+		return EC_ERROR_INVAL;
+
+	ret_done = i2c_xfer_prepare(port, ctrl, slave_addr_flags,
+				    out, out_size, in, in_size, flags);
+	if (ret_done)
+		goto err_chip_i2c_xfer;
+
+#ifdef CONFIG_MCHP_I2C_DMA
+	if (i2c_dma_usable(ctrl, out_size, in_size, flags)) {
+		i2c_dma_start(ctrl);
+		return i2c_dma_finish(ctrl);
+	}
+#endif
 
-	ret_done = EC_SUCCESS;
 	if (out_size) {
 		ret_done = i2c_mtx(ctrl);
 		if (ret_done)
@@ -899,27 +1190,44 @@ int chip_i2c_xfer(int port, uint16_t slave_addr_flags,
 	return EC_SUCCESS;
 
 err_chip_i2c_xfer:
-	cdata[ctrl].flags |= (1ul << 22);
-	cdata[ctrl].hwsts2 = MCHP_I2C_STATUS(ctrl); /* record status */
-	/* NOTE: writing I2C.Ctrl.PIN=1 will clear all bits
-	 * except NBB in I2C.Status
-	 */
-	MCHP_I2C_CTRL(ctrl) = CTRL_PIN | CTRL_ESO |
-				       CTRL_STO | CTRL_ACK;
-	cdata[ctrl].transaction_state = I2C_TRANSACTION_STOPPED;
-	/* record status after STOP */
-	cdata[ctrl].hwsts4 = MCHP_I2C_STATUS(ctrl);
+	return i2c_xfer_failed(ctrl, ret_done);
+}
 
-	/* record line levels.
-	 * Note line levels may reflect STOP condition
-	 */
-	cdata[ctrl].lines = (uint8_t)get_line_level(cdata[ctrl].port);
-	if (cdata[ctrl].hwsts2 & STS_BER) {
-		cdata[ctrl].flags |= (1ul << 23);
-		reset_controller(ctrl);
-	}
+#ifdef CONFIG_I2C_XFER_ASYNC
+int chip_i2c_xfer_start(int port, uint16_t slave_addr_flags,
+			const uint8_t *out, int out_size,
+			uint8_t *in, int in_size, int flags)
+{
+#ifdef CONFIG_MCHP_I2C_DMA
+	int ctrl = i2c_port_to_controller(port);
+	int rv;
+
+	if (ctrl < 0 || (out_size == 0 && in_size == 0) ||
+	    !i2c_dma_usable(ctrl, out_size, in_size, flags))
+		return EC_ERROR_UNIMPLEMENTED;
+
+	rv = i2c_xfer_prepare(port, ctrl, slave_addr_flags,
+			      out, out_size, in, in_size, flags);
+	if (rv)
+		return i2c_xfer_failed(ctrl, rv);
+
+	i2c_dma_start(ctrl);
+	return EC_SUCCESS;
+#else
+	return EC_ERROR_UNIMPLEMENTED;
+#endif
+}
+
+int chip_i2c_xfer_finish(int port)
+{
+#ifdef CONFIG_MCHP_I2C_DMA
+	return i2c_dma_finish(i2c_port_to_controller(port));
+#else
 	return EC_ERROR_UNKNOWN;
+#endif
 }
+#endif /* CONFIG_I2C_XFER_ASYNC */
+
 /*
  * A safe method of reading port's SCL pin level.
  */
@@ -1104,6 +1412,13 @@ static void handle_interrupt(int controller)
 		return;
 	}
 #endif /* CONFIG_I2C_SLAVE */
+#ifdef CONFIG_MCHP_I2C_DMA
+	if (cdata[controller].dma_state == I2C_DMA_TX ||
+	    cdata[controller].dma_state == I2C_DMA_RX) {
+		i2c_dma_interrupt(controller);
+		return;
+	}
+#endif
 	/*
 	 * Write to control register interferes with I2C transaction.
 	 * Instead, let's disable IRQ from the core until the next time
@@ -417,6 +417,75 @@ uint8_t qmspi_xfr(const struct spi_device_t *spi_device,
 
 	return (uint8_t)(did & 0xFF);
 }
+
+#ifdef CONFIG_SPI_FLASH_FAST_READ
+/*
+ * Start a SPI flash fast read as one descriptor mode transaction. See the
+ * note on SPI flash commands below.
+ * Descriptor 0 transmits opcode + 24-bit address on IO0 from TX FIFO.
+ * Descriptor 1 outputs 8 clocks with IO tri-stated: 1, 2 or 4 bytes in
+ * 1x, 2x or 4x mode.
+ * Descriptors 2 and up receive the data on data_pins lines. The RX DMA
+ * channel moves it from the RX FIFO straight into rxdata.
+ * Caller must call qmspi_transaction_flush to wait for the end.
+ */
+int qmspi_fast_read_async(const struct spi_device_t *spi_device,
+			  uint8_t opcode, int data_pins, uint32_t addr,
+			  uint8_t *rxdata, uint32_t rxlen)
+{
+	const struct dma_option *opdma;
+	uint32_t d, did, dma_cfg;
+
+	if ((rxdata == NULL) || (rxlen == 0))
+		return EC_ERROR_INVAL;
+
+	if ((data_pins != 1) && (data_pins != 2) && (data_pins != 4))
+		return EC_ERROR_INVAL;
+
+	qmspi_descr_mode_ready();
+
+	MCHP_QMSPI0_DESCR(0) = MCHP_QMSPI_C_1X + MCHP_QMSPI_C_TX_DATA +
+		MCHP_QMSPI_C_XFRU_1B + (4 << MCHP_QMSPI_C_NUM_UNITS_BITPOS) +
+		(1 << MCHP_QMSPI_C_NEXT_DESCR_BITPOS);
+	MCHP_QMSPI0_TX_FIFO8 = opcode;
+	MCHP_QMSPI0_TX_FIFO8 = (uint8_t)(addr >> 16);
+	MCHP_QMSPI0_TX_FIFO8 = (uint8_t)(addr >> 8);
+	MCHP_QMSPI0_TX_FIFO8 = (uint8_t)addr;
+
+	d = qmspi_pins_encoding(data_pins);
+	MCHP_QMSPI0_DESCR(1) = d + MCHP_QMSPI_C_TX_DIS +
+		MCHP_QMSPI_C_XFRU_1B +
+		(data_pins << MCHP_QMSPI_C_NUM_UNITS_BITPOS) +
+		(2 << MCHP_QMSPI_C_NEXT_DESCR_BITPOS);
+
+	/* compute DMA units: 1 or 4 */
+	if (((uint32_t)rxdata | rxlen) & 0x03) {
+		dma_cfg = 1;
+		d |= (MCHP_QMSPI_C_RX_EN + MCHP_QMSPI_C_RX_DMA_1B);
+	} else {
+		dma_cfg = 4;
+		d |= (MCHP_QMSPI_C_RX_EN + MCHP_QMSPI_C_RX_DMA_4B);
+	}
+	did = qmspi_descr_alloc(2, d, rxlen);
+	if (did & QMSPI_ERR_ANY)
+		return EC_ERROR_OVERFLOW;
+
+	opdma = spi_dma_option(spi_device, SPI_DMA_OPTION_RD);
+	dma_clr_chan(opdma->channel);
+	dma_cfg_buffers(opdma->channel, rxdata, rxlen,
+		(void *)MCHP_QMSPI0_RX_FIFO_ADDR);
+	dma_cfg_xfr(opdma->channel, dma_cfg,
+		MCHP_DMA_QMSPI0_RX_REQ_ID,
+		(DMA_FLAG_D2M + DMA_FLAG_INCR_MEM));
+	dma_run(opdma->channel);
+
+	MCHP_QMSPI0_DESCR(did) |= (MCHP_QMSPI_C_DESCR_LAST +
+		MCHP_QMSPI_C_CLOSE);
+	qmspi_cfg_irq_start(1u << 2);
+
+	return EC_SUCCESS;
+}
+#endif /* #ifdef CONFIG_SPI_FLASH_FAST_READ */
 #endif /* #ifdef CONFIG_MCHP_QMSPI_TX_DMA */
 
 /*
@@ -34,6 +34,10 @@ int qmspi_transaction_async(const struct spi_device_t *spi_device,
 
 int qmspi_enable(int port, int enable);
 
+int qmspi_fast_read_async(const struct spi_device_t *spi_device,
+			  uint8_t opcode, int data_pins, uint32_t addr,
+			  uint8_t *rxdata, uint32_t rxlen);
+
 /*
  * QMSPI0 Start
  * flags
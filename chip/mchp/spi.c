@@ -264,6 +264,43 @@ int spi_transaction(const struct spi_device_t *spi_device,
 	return rc;
 }
 
+#ifdef CONFIG_SPI_FLASH_FAST_READ
+/*
+ * called from common/spi_flash.c
+ * Only QMSPI can drive the flash on more than one data line.
+ */
+int spi_transaction_fast_read(const struct spi_device_t *spi_device,
+			      uint8_t opcode, int data_pins, uint32_t addr,
+			      uint8_t *rxdata, int rxlen)
+{
+	int rc;
+
+	if (spi_device == NULL)
+		return EC_ERROR_PARAM1;
+
+	if ((spi_device->port & 0xF0) != QMSPI_CLASS)
+		return EC_ERROR_UNIMPLEMENTED;
+
+	if (rxlen <= 0)
+		return EC_ERROR_PARAM6;
+
+#ifndef LFW
+	spi_mutex_lock(spi_device->port);
+#endif
+
+	rc = qmspi_fast_read_async(spi_device, opcode, data_pins, addr,
+				   rxdata, (uint32_t)rxlen);
+	if (rc == EC_SUCCESS)
+		rc = qmspi_transaction_flush(spi_device);
+
+#ifndef LFW
+	spi_mutex_unlock(spi_device->port);
+#endif
+
+	return rc;
+}
+#endif /* #ifdef CONFIG_SPI_FLASH_FAST_READ */
+
 /**
  * Enable SPI port and associated controller
  *
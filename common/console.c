@@ -7,12 +7,13 @@
 
 #include "clock.h"
 #include "console.h"
-#ifdef CONFIG_EXPERIMENTAL_CONSOLE
+#if defined(CONFIG_EXPERIMENTAL_CONSOLE) || defined(CONFIG_CONSOLE_FRAMED)
 #include "crc8.h"
-#endif /* defined(CONFIG_EXPERIMENTAL_CONSOLE) */
+#endif
 #include "link_defs.h"
 #include "system.h"
 #include "task.h"
+#include "timer.h"
 #include "uart.h"
 #include "usb_console.h"
 #include "util.h"
@@ -26,6 +27,13 @@
 #define EC_ACK 0xC0
 #endif /* defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
+#if defined(CONFIG_CONSOLE_FRAMED) && defined(CONFIG_EXPERIMENTAL_CONSOLE)
+#error "The framed console does not work with the experimental console"
+#endif
+
+/* Drop a partial request frame after this long without more bytes */
+#define FRAME_RX_TIMEOUT (100 * MSEC)
+
 /* ASCII control character; for example, CTRL('C') = ^C */
 #define CTRL(c) ((c) - '@')
 
@@ -115,6 +123,29 @@ static int split_words(char *input, int *argc, char **argv)
 	return EC_SUCCESS;
 }
 
+/**
+ * Compare the start of a command name with a (possibly partial) name.
+ *
+ * Only the first len characters of name are compared, ignoring their case.
+ * Command names are lower case, so this is the byte order the linker uses to
+ * sort the .rodata.cmds.* sections into __cmds.
+ *
+ * @return <0, 0 or >0 if cmd_name sorts before, starts with or sorts after
+ *	   name.
+ */
+static int cmdcmp(const char *cmd_name, const char *name, int len)
+{
+	int i, d;
+
+	for (i = 0; i < len; i++) {
+		d = (uint8_t)cmd_name[i] - (uint8_t)tolower(name[i]);
+		if (d || !cmd_name[i])
+			return d;
+	}
+
+	return 0;
+}
+
 /**
  * Find a command by name.
  *
@@ -122,30 +153,39 @@ static int split_words(char *input, int *argc, char **argv)
  * command.  So "foo" will match "foobar" as long as there isn't also a
  * command "food".
  *
+ * The command table is sorted by name at link time, so all the commands
+ * starting with name are next to each other and a binary search finds the
+ * first of them.
+ *
  * @param name		Command name to find.
  *
  * @return A pointer to the command structure, or NULL if no match found.
  */
-static const struct console_command *find_command(char *name)
+test_export_static const struct console_command *find_command(char *name)
 {
-	const struct console_command *cmd, *match = NULL;
+	const struct console_command *lo = __cmds, *hi = __cmds_end, *mid;
 	int match_length = strlen(name);
 
-	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
-		if (!strncasecmp(name, cmd->name, match_length)) {
-			if (match)
-				return NULL;
-			/*
-			 * Check if 'cmd->name' is of the same length as
-			 * 'name'. If yes, then we have a full match.
-			 */
-			if (cmd->name[match_length] == '\0')
-				return cmd;
-			match = cmd;
-		}
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (cmdcmp(mid->name, name, match_length) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
 
-	return match;
+	if (lo == __cmds_end || cmdcmp(lo->name, name, match_length))
+		return NULL;
+
+	/* A full match sorts before any longer command it is a prefix of */
+	if (lo->name[match_length] == '\0')
+		return lo;
+
+	/* Otherwise the partial match has to be unique */
+	if (lo + 1 < __cmds_end && !cmdcmp(lo[1].name, name, match_length))
+		return NULL;
+
+	return lo;
 }
 
 
@@ -459,8 +499,145 @@ static int handle_esc(int c)
 }
 #endif /* !defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
+#ifdef CONFIG_CONSOLE_FRAMED
+/* Request frame being received */
+static struct {
+	uint8_t buf[CONSOLE_FRAME_HEADER_SIZE +
+		    CONFIG_CONSOLE_INPUT_LINE_SIZE + 1];
+	/* Bytes received so far, including any that did not fit in buf */
+	int pos;
+	timestamp_t last;
+} frame_rx;
+
+/* Output of the command being run from a request frame */
+static struct {
+	uint8_t buf[CONSOLE_FRAME_MAX_OUTPUT];
+	int len;
+	uint8_t seq;
+	uint8_t active;
+} frame_tx;
+
+static void console_frame_send(enum console_frame_type type, uint8_t seq,
+			       const void *data, int len)
+{
+	uint8_t frame[CONSOLE_FRAME_HEADER_SIZE + CONSOLE_FRAME_MAX_OUTPUT + 1];
+	uint8_t *p = frame + CONSOLE_FRAME_HEADER_SIZE;
+
+	frame[0] = CONSOLE_FRAME_SOF0;
+	frame[1] = CONSOLE_FRAME_SOF1;
+	frame[2] = type;
+	frame[3] = seq;
+	frame[4] = len & 0xff;
+	frame[5] = len >> 8;
+	memcpy(p, data, len);
+	p[len] = crc8(frame + 2, CONSOLE_FRAME_HEADER_SIZE - 2 + len);
+
+	uart_put_frame((const char *)frame,
+		       CONSOLE_FRAME_HEADER_SIZE + len + 1);
+}
+
+static void console_frame_flush(void)
+{
+	if (!frame_tx.len)
+		return;
+
+	console_frame_send(CONSOLE_FRAME_OUTPUT, frame_tx.seq, frame_tx.buf,
+			   frame_tx.len);
+	frame_tx.len = 0;
+}
+
+int console_frame_active(void)
+{
+	return frame_tx.active && !in_interrupt_context() &&
+	       task_get_current() == TASK_ID_CONSOLE;
+}
+
+int console_frame_putc(void *context, int c)
+{
+	frame_tx.buf[frame_tx.len++] = c;
+	if (frame_tx.len == sizeof(frame_tx.buf))
+		console_frame_flush();
+
+	return 0;
+}
+
+/* Run the command in a complete request frame */
+static void console_frame_run(void)
+{
+	uint8_t *hdr = frame_rx.buf;
+	char *cmd = (char *)frame_rx.buf + CONSOLE_FRAME_HEADER_SIZE;
+	int len = frame_rx.pos - CONSOLE_FRAME_HEADER_SIZE - 1;
+	int32_t rv;
+
+	if (hdr[2] != CONSOLE_FRAME_REQUEST ||
+	    len >= CONFIG_CONSOLE_INPUT_LINE_SIZE ||
+	    crc8(hdr + 2, CONSOLE_FRAME_HEADER_SIZE - 2 + len) !=
+	    (uint8_t)cmd[len]) {
+		console_frame_send(CONSOLE_FRAME_NAK, hdr[3], NULL, 0);
+		return;
+	}
+	cmd[len] = '\0';
+
+	frame_tx.seq = hdr[3];
+	frame_tx.len = 0;
+	frame_tx.active = 1;
+	rv = handle_command(cmd);
+	console_frame_flush();
+	frame_tx.active = 0;
+
+	console_frame_send(CONSOLE_FRAME_DONE, hdr[3], &rv, sizeof(rv));
+}
+
+/**
+ * Feed a received character to the request frame parser.
+ *
+ * @return 1 if the character was part of a frame, 0 if it is console input.
+ */
+static int console_frame_rx(int c)
+{
+	timestamp_t now = get_time();
+	int len;
+
+	/* Where char is signed, uart_getc() sign extends */
+	c &= 0xff;
+
+	/* Forget a frame the host gave up on half way */
+	if (frame_rx.pos && now.val - frame_rx.last.val > FRAME_RX_TIMEOUT)
+		frame_rx.pos = 0;
+
+	if (!frame_rx.pos && c != CONSOLE_FRAME_SOF0)
+		return 0;
+
+	frame_rx.last = now;
+	if (frame_rx.pos < sizeof(frame_rx.buf))
+		frame_rx.buf[frame_rx.pos] = c;
+	frame_rx.pos++;
+
+	if (frame_rx.pos == 2 && c != CONSOLE_FRAME_SOF1) {
+		frame_rx.pos = 0;
+		return 1;
+	}
+	if (frame_rx.pos < CONSOLE_FRAME_HEADER_SIZE)
+		return 1;
+
+	len = frame_rx.buf[4] | frame_rx.buf[5] << 8;
+	if (frame_rx.pos < CONSOLE_FRAME_HEADER_SIZE + len + 1)
+		return 1;
+
+	console_frame_run();
+	frame_rx.pos = 0;
+
+	return 1;
+}
+#endif /* CONFIG_CONSOLE_FRAMED */
+
 static void console_handle_char(int c)
 {
+#ifdef CONFIG_CONSOLE_FRAMED
+	if (console_frame_rx(c))
+		return;
+#endif
+
 #ifdef CONFIG_EXPERIMENTAL_CONSOLE
 	/*
 	 * If we receive a EC_SYN, we should respond immediately with a EC_ACK.
@@ -6,6 +6,7 @@
 /* Console output module for Chrome EC */
 
 #include "console.h"
+#include "printf.h"
 #include "uart.h"
 #include "usb_console.h"
 #include "util.h"
@@ -50,6 +51,14 @@ int cputs(enum console_channel channel, const char *outstr)
 		return EC_SUCCESS;
 #endif
 
+#ifdef CONFIG_CONSOLE_FRAMED
+	if (console_frame_active()) {
+		while (*outstr)
+			console_frame_putc(NULL, *outstr++);
+		return EC_SUCCESS;
+	}
+#endif
+
 	rv1 = usb_puts(outstr);
 	rv2 = uart_puts(outstr);
 
@@ -67,6 +76,15 @@ int cprintf(enum console_channel channel, const char *format, ...)
 		return EC_SUCCESS;
 #endif
 
+#ifdef CONFIG_CONSOLE_FRAMED
+	if (console_frame_active()) {
+		va_start(args, format);
+		rv1 = vfnprintf(console_frame_putc, NULL, format, args);
+		va_end(args);
+		return rv1;
+	}
+#endif
+
 	usb_va_start(args, format);
 	rv1 = usb_vprintf(format, args);
 	usb_va_end(args);
@@ -91,6 +109,16 @@ int cprints(enum console_channel channel, const char *format, ...)
 
 	rv = cprintf(channel, "[%pT ", PRINTF_TIMESTAMP_NOW);
 
+#ifdef CONFIG_CONSOLE_FRAMED
+	if (console_frame_active()) {
+		va_start(args, format);
+		r = vfnprintf(console_frame_putc, NULL, format, args);
+		va_end(args);
+		cputs(channel, "]\n");
+		return r ? r : rv;
+	}
+#endif
+
 	va_start(args, format);
 	r = uart_vprintf(format, args);
 	if (r)
@@ -5,10 +5,34 @@
 /* CRC-32 implementation with USB constants */
 
 #include "common.h"
+#include "crc.h"
 
 /* Constants matching USB3 and USB PD definitions */
 #define CRC32_INITIAL 0xFFFFFFFF
 
+#ifdef CONFIG_SW_CRC_TABLE_NIBBLE
+/* CRC of each low nibble value, for polynom 0x04C11DB7 */
+static const uint32_t crc32_nibble[16] = {
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+	0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+	0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+};
+
+static uint32_t crc32_hash(uint32_t crc, const void *buf, int size)
+{
+	const uint8_t *p;
+
+	p = buf;
+
+	while (size--) {
+		crc ^= *p++;
+		crc = crc32_nibble[crc & 0xF] ^ (crc >> 4);
+		crc = crc32_nibble[crc & 0xF] ^ (crc >> 4);
+	}
+
+	return crc;
+}
+#else
 /* Pre-computed values for polynom 0x04C11DB7 */
 static const uint32_t crc32_tab[] = {
 	0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
@@ -56,12 +80,58 @@ static const uint32_t crc32_tab[] = {
 	0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
+#ifdef CONFIG_SW_CRC_SLICE_BY_4
+/*
+ * crc32_slice[n - 1][i] is the CRC of byte i followed by n zero bytes.  The
+ * tables are derived from crc32_tab the first time they are needed, so they
+ * cost RAM rather than flash.
+ */
+static uint32_t crc32_slice[3][256];
+static int crc32_slice_ready;
+
+static void crc32_slice_init(void)
+{
+	int i, n;
+
+	for (i = 0; i < 256; i++) {
+		uint32_t crc = crc32_tab[i];
+
+		for (n = 0; n < 3; n++) {
+			crc = crc32_tab[crc & 0xFF] ^ (crc >> 8);
+			crc32_slice[n][i] = crc;
+		}
+	}
+
+	/* Racing callers just compute the same values again */
+	crc32_slice_ready = 1;
+}
+
 static uint32_t crc32_hash(uint32_t crc, const void *buf, int size)
 {
 	const uint8_t *p;
 
 	p = buf;
 
+	if (size >= 8) {
+		if (!crc32_slice_ready)
+			crc32_slice_init();
+
+		/* Go byte by byte up to a word boundary */
+		for (; (uintptr_t)p & 3; size--) {
+			crc ^= *p++;
+			crc = crc32_tab[crc & 0xFF] ^ (crc >> 8);
+		}
+
+		/* Then a (little-endian) word at a time */
+		for (; size >= 4; size -= 4, p += 4) {
+			crc ^= *(const uint32_t *)p;
+			crc = crc32_slice[2][crc & 0xFF] ^
+			      crc32_slice[1][(crc >> 8) & 0xFF] ^
+			      crc32_slice[0][(crc >> 16) & 0xFF] ^
+			      crc32_tab[crc >> 24];
+		}
+	}
+
 	while (size--) {
 		crc ^= *p++;
 		crc = crc32_tab[crc & 0xFF] ^ (crc >> 8);
@@ -69,6 +139,22 @@ static uint32_t crc32_hash(uint32_t crc, const void *buf, int size)
 
 	return crc;
 }
+#else
+static uint32_t crc32_hash(uint32_t crc, const void *buf, int size)
+{
+	const uint8_t *p;
+
+	p = buf;
+
+	while (size--) {
+		crc ^= *p++;
+		crc = crc32_tab[crc & 0xFF] ^ (crc >> 8);
+	}
+
+	return crc;
+}
+#endif /* CONFIG_SW_CRC_SLICE_BY_4 */
+#endif /* CONFIG_SW_CRC_TABLE_NIBBLE */
 
 void crc32_ctx_init(uint32_t *crc)
 {
@@ -95,6 +181,21 @@ uint32_t crc32_ctx_result(uint32_t *crc)
 	return *crc ^ 0xFFFFFFFF;
 }
 
+void crc32_ctx_hash(uint32_t *crc, const void *buf, int size)
+{
+	*crc = crc32_hash(*crc, buf, size);
+}
+
+uint32_t crc32_bufs(const struct crc32_buf *bufs, int count)
+{
+	uint32_t crc = CRC32_INITIAL;
+
+	for (; count; count--, bufs++)
+		crc = crc32_hash(crc, bufs->data, bufs->size);
+
+	return crc ^ 0xFFFFFFFF;
+}
+
 /* Accumulator for the CRC */
 static uint32_t crc_;
 
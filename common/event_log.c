@@ -3,6 +3,7 @@
  * found in the LICENSE file.
  */
 
+#include "atomic.h"
 #include "common.h"
 #include "console.h"
 #include "event_log.h"
@@ -21,54 +22,65 @@ BUILD_ASSERT(POWER_OF_TWO(UNIT_COUNT));
 /*
  * The FIFO pointers are defined as following :
  * "log_head" is the next available event to dequeue.
- * "log_tail" is marking the end of the FIFO content (after last committed
- *  event)
- * "log_tail_next" is the next available spot to enqueue events.
+ * "log_tail" is the next available spot to enqueue events.
  * The pointers are not wrapped until they are used, so we don't need an extra
  * entry to disambiguate between full and empty FIFO.
  *
- * For concurrency, several tasks might try to enqueue events in parallel with
- * log_add_event(). Only one task is dequeuing events (host commands, VDM,
- * TPM command handler). When the FIFO is full, log_add_event() will discard
- * the oldest events, so "log_head" is incremented/decremented in a critical
- * section since it is accessed from both log_add_event() and
- * log_dequeue_event(). log_tail_next is also protected as several writers can
- * race to add an event to the queue.
- * When a writer is done adding its event, it is updating log_tail,
- * so the event can be consumed by log_dequeue_event().
+ * For concurrency, several tasks and interrupt handlers might try to enqueue
+ * events in parallel with log_add_event(). A writer reserves its space by
+ * moving "log_tail" forward with a compare-and-swap, so writers never block
+ * each other or disable interrupts. When the FIFO is full, the new event is
+ * dropped and counted in "log_dropped".
+ *
+ * Writers can finish out of order, so each entry is published by setting the
+ * bit of its first unit in "log_committed" once it has been filled in.
+ * Only one task is dequeuing events (host commands, VDM, TPM command
+ * handler), so "log_head" is only written by the reader, after it has copied
+ * the entry out and cleared its committed bit.
  */
-static size_t log_head;
-static size_t log_tail;
-static size_t log_tail_next;
+static uint32_t log_head;
+static uint32_t log_tail;
+static uint32_t log_dropped;
+static volatile uint32_t log_committed[DIV_ROUND_UP(UNIT_COUNT, 32)];
 
 /* Size of one FIFO entry */
 #define ENTRY_SIZE(payload_sz) (1+DIV_ROUND_UP((payload_sz), UNIT_SIZE))
 
+/* Keep the compiler from moving FIFO accesses across a publish point */
+#define log_barrier() __asm__ __volatile__("" : : : "memory")
+
+#define COMMITTED_WORD(unit) (&log_committed[((unit) & UNIT_COUNT_MASK) / 32])
+#define COMMITTED_BIT(unit) BIT(((unit) & UNIT_COUNT_MASK) % 32)
+
+static int log_is_committed(uint32_t unit)
+{
+	return !!(*COMMITTED_WORD(unit) & COMMITTED_BIT(unit));
+}
+
 void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 			  void *payload, uint32_t timestamp)
 {
 	struct event_log_entry *r;
 	size_t payload_size = EVENT_LOG_SIZE(size);
 	size_t total_size = ENTRY_SIZE(payload_size);
-	size_t current_tail, first;
-
-	/* --- critical section : reserve queue space --- */
-	interrupt_disable();
-	current_tail = log_tail_next;
-	log_tail_next = current_tail + total_size;
-	interrupt_enable();
-	/* --- end of critical section --- */
-
-	/* Out of space : discard the oldest entry */
-	while ((UNIT_COUNT - (current_tail - log_head)) < total_size) {
-		struct event_log_entry *oldest;
-		/* --- critical section : atomically free-up space --- */
-		interrupt_disable();
-		oldest = log_events + (log_head & UNIT_COUNT_MASK);
-		log_head += ENTRY_SIZE(EVENT_LOG_SIZE(oldest->size));
-		interrupt_enable();
-		/* --- end of critical section --- */
-	}
+	size_t first;
+	uint32_t current_head, current_tail;
+
+	/* Reserve queue space, or drop the event if the FIFO is full */
+	do {
+		/*
+		 * Sample the head first: it never passes the tail, so the
+		 * used space computed below can only be over-estimated.
+		 */
+		current_head = log_head;
+		log_barrier();
+		current_tail = log_tail;
+		if (current_tail + total_size - current_head > UNIT_COUNT) {
+			deprecated_atomic_add(&log_dropped, 1);
+			return;
+		}
+	} while (!bool_compare_and_swap_u32(&log_tail, current_tail,
+					    current_tail + total_size));
 
 	r = log_events + (current_tail & UNIT_COUNT_MASK);
 
@@ -77,50 +89,67 @@ void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 	r->size = size;
 	r->data = data;
 	/* copy the payload into the FIFO */
-	first = MIN(total_size - 1, (UNIT_COUNT -
-		    (current_tail & UNIT_COUNT_MASK)) - 1);
+	first = MIN(payload_size, (UNIT_COUNT - 1 -
+		    (current_tail & UNIT_COUNT_MASK)) * UNIT_SIZE);
 	if (first)
-		memcpy(r->payload, payload, first * UNIT_SIZE);
-	if (first < total_size - 1)
-		memcpy(log_events, ((uint8_t *)payload) + first * UNIT_SIZE,
-			(total_size - first) * UNIT_SIZE);
-	/* mark the entry available in the queue if nobody is behind us */
-	if (current_tail == log_tail)
-		log_tail = log_tail_next;
+		memcpy(r->payload, payload, first);
+	if (first < payload_size)
+		memcpy(log_events, ((uint8_t *)payload) + first,
+		       payload_size - first);
+
+	/* make the entry available to the reader */
+	log_barrier();
+	deprecated_atomic_or(COMMITTED_WORD(current_tail),
+			     COMMITTED_BIT(current_tail));
 }
 
-int log_dequeue_event(struct event_log_entry *r)
+/*
+ * Copy the oldest entry into r if it has been committed and takes at most
+ * max_units, then free its space in the FIFO.
+ *
+ * Returns the size of the entry in units, or 0 if nothing was dequeued.
+ */
+static size_t log_dequeue_one(struct event_log_entry *r, size_t max_units)
 {
-	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
-	unsigned int total_size, first;
+	uint32_t current_head = log_head;
 	struct event_log_entry *entry;
-	size_t current_head;
+	size_t total_size, first;
 
-retry:
-	current_head = log_head;
-	/* The log FIFO is empty */
-	if (log_tail == current_head) {
-		memset(r, 0, UNIT_SIZE);
-		r->type = EVENT_LOG_NO_ENTRY;
-		return UNIT_SIZE;
-	}
+	/* The log FIFO is empty, or the oldest entry is still being written */
+	if (!log_is_committed(current_head))
+		return 0;
+	log_barrier();
 
 	entry = log_events + (current_head & UNIT_COUNT_MASK);
 	total_size = ENTRY_SIZE(EVENT_LOG_SIZE(entry->size));
+	if (total_size > max_units)
+		return 0;
+
 	first = MIN(total_size, UNIT_COUNT - (current_head & UNIT_COUNT_MASK));
 	memcpy(r, entry, first * UNIT_SIZE);
 	if (first < total_size)
-		memcpy(r + first, log_events, (total_size-first) * UNIT_SIZE);
+		memcpy(r + first, log_events, (total_size - first) * UNIT_SIZE);
+
+	/* release the space only once the entry has been copied out */
+	deprecated_atomic_clear_bits(COMMITTED_WORD(current_head),
+				     COMMITTED_BIT(current_head));
+	log_barrier();
+	log_head = current_head + total_size;
 
-	/* --- critical section : remove the entry from the queue --- */
-	interrupt_disable();
-	if (log_head != current_head) { /* our entry was thrown away */
-		interrupt_enable();
-		goto retry;
+	return total_size;
+}
+
+int log_dequeue_event(struct event_log_entry *r)
+{
+	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
+	size_t total_size;
+
+	total_size = log_dequeue_one(r, ENTRY_SIZE(EVENT_LOG_SIZE_MASK));
+	if (!total_size) {
+		memset(r, 0, UNIT_SIZE);
+		r->type = EVENT_LOG_NO_ENTRY;
+		return UNIT_SIZE;
 	}
-	log_head += total_size;
-	interrupt_enable();
-	/* --- end of critical section --- */
 
 	/* fixup the timestamp : number of milliseconds in the past */
 	r->timestamp = now - r->timestamp;
@@ -128,6 +157,29 @@ retry:
 	return total_size * UNIT_SIZE;
 }
 
+int log_dequeue_events(void *buf, int max_bytes, int *count)
+{
+	uint32_t now = get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
+	struct event_log_entry *r = buf;
+	size_t room = max_bytes / UNIT_SIZE;
+	size_t total_size;
+
+	*count = 0;
+	while ((total_size = log_dequeue_one(r, room))) {
+		r->timestamp = now - r->timestamp;
+		r += total_size;
+		room -= total_size;
+		(*count)++;
+	}
+
+	return (uint8_t *)r - (uint8_t *)buf;
+}
+
+uint32_t log_take_dropped(void)
+{
+	return deprecated_atomic_read_clear(&log_dropped);
+}
+
 #ifdef CONFIG_CMD_DLOG
 /*
  * Display TPM event logs.
@@ -140,9 +192,11 @@ static int command_dlog(int argc, char **argv)
 
 	if (argc > 1) {
 		if (!strcasecmp(argv[1], "clear")) {
-			interrupt_disable();
-			log_head = log_tail = log_tail_next = 0;
-			interrupt_enable();
+			struct event_log_entry r[ENTRY_SIZE(EVENT_LOG_SIZE_MASK)];
+
+			while (log_dequeue_one(r, ARRAY_SIZE(r)))
+				;
+			log_take_dropped();
 
 			return EC_SUCCESS;
 		}
@@ -152,7 +206,7 @@ static int command_dlog(int argc, char **argv)
 
 	ccprintf(" TIMESTAMP | TYPE |  DATA | SIZE | PAYLOAD\n");
 	log_cur = log_head;
-	while (log_cur != log_tail) {
+	while (log_cur != log_tail && log_is_committed(log_cur)) {
 		struct event_log_entry *r;
 		uint8_t *payload;
 		uint32_t payload_bytes;
@@ -175,6 +229,7 @@ static int command_dlog(int argc, char **argv)
 		}
 		ccprintf("\n");
 	}
+	ccprintf("Dropped: %d\n", log_dropped);
 	return EC_SUCCESS;
 }
 DECLARE_CONSOLE_COMMAND(dlog,
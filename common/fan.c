@@ -28,6 +28,10 @@ int is_thermal_control_enabled(int idx)
 	return thermal_control_enabled[idx];
 }
 
+/* Number of times each fan has been seen stalling */
+static int fan_stall_count[CONFIG_FANS];
+static int fan_was_stalled[CONFIG_FANS];
+
 #ifdef CONFIG_FAN_UPDATE_PERIOD
 /* Should we ignore the fans for a while? */
 static int fan_update_counter[CONFIG_FANS];
@@ -101,6 +105,10 @@ test_mockable void fan_set_percent_needed(int fan, int pct)
 	    new_rpm < fans[fan].rpm->rpm_start)
 		new_rpm = fans[fan].rpm->rpm_start;
 
+	/* Leave the fan controller alone while the target doesn't move. */
+	if (new_rpm == fan_get_rpm_target(FAN_CH(fan)))
+		return;
+
 	fan_set_rpm_target(FAN_CH(fan), new_rpm);
 }
 
@@ -197,6 +205,7 @@ static int cc_faninfo(int argc, char **argv)
 			 fan_get_rpm_target(FAN_CH(fan)));
 		ccprintf("%sDuty:   %d%%\n", leader,
 			 fan_get_duty(FAN_CH(fan)));
+		ccprintf("%sStalls: %d\n", leader, fan_stall_count[fan]);
 		tmp = fan_get_status(FAN_CH(fan));
 		ccprintf("%sStatus: %d (%s)\n", leader,
 			 tmp, human_status[tmp]);
@@ -478,12 +487,14 @@ struct pwm_fan_state {
 #define FAN_STATE_FLAG_ENABLED	BIT(0)
 #define FAN_STATE_FLAG_THERMAL	BIT(1)
 
+static struct pwm_fan_state fan_preserved;
+DECLARE_PRESERVED_STATE(pwm_fan, PWMFAN_SYSJUMP_TAG, PWM_HOOK_VERSION,
+			fan_preserved);
+
 static void pwm_fan_init(void)
 {
-	const struct pwm_fan_state *prev;
 	struct pwm_fan_state state;
 	uint16_t *mapped;
-	int version, size;
 	int i;
 	int fan;
 
@@ -494,10 +505,8 @@ static void pwm_fan_init(void)
 		fan_channel_setup(FAN_CH(fan), fans[fan].conf->flags);
 
 	/* Restore previous state. */
-	prev = (const struct pwm_fan_state *)
-		system_get_jump_tag(PWMFAN_SYSJUMP_TAG, &version, &size);
-	if (prev && version == PWM_HOOK_VERSION && size == sizeof(*prev)) {
-		memcpy(&state, prev, sizeof(state));
+	if (system_preserved_state_restored(PWMFAN_SYSJUMP_TAG)) {
+		state = fan_preserved;
 	} else {
 		memset(&state, 0, sizeof(state));
 	}
@@ -529,8 +538,12 @@ static void pwm_fan_second(void)
 			rpm = EC_FAN_SPEED_STALLED;
 			stalled = 1;
 			cprints(CC_PWM, "Fan %d stalled!", fan);
+			if (!fan_was_stalled[fan])
+				fan_stall_count[fan]++;
+			fan_was_stalled[fan] = 1;
 		} else {
 			rpm = fan_get_rpm_actual(FAN_CH(fan));
+			fan_was_stalled[fan] = 0;
 		}
 
 		mapped[fan] = rpm;
@@ -550,18 +563,16 @@ static void pwm_fan_preserve_state(void)
 	struct pwm_fan_state state = {0};
 	int fan = 0;
 
-	if (fan_count == 0)
-		return;
+	if (fan_count > 0) {
+		/* TODO(crosbug.com/p/23530): Still treating all fans as one. */
+		if (fan_get_enabled(FAN_CH(fan)))
+			state.flag |= FAN_STATE_FLAG_ENABLED;
+		if (is_thermal_control_enabled(fan))
+			state.flag |= FAN_STATE_FLAG_THERMAL;
+		state.rpm = fan_get_rpm_target(FAN_CH(fan));
+	}
 
-	/* TODO(crosbug.com/p/23530): Still treating all fans as one. */
-	if (fan_get_enabled(FAN_CH(fan)))
-		state.flag |= FAN_STATE_FLAG_ENABLED;
-	if (is_thermal_control_enabled(fan))
-		state.flag |= FAN_STATE_FLAG_THERMAL;
-	state.rpm = fan_get_rpm_target(FAN_CH(fan));
-
-	system_add_jump_tag(PWMFAN_SYSJUMP_TAG, PWM_HOOK_VERSION,
-			    sizeof(state), &state);
+	fan_preserved = state;
 }
 DECLARE_HOOK(HOOK_SYSJUMP, pwm_fan_preserve_state, HOOK_PRIO_DEFAULT);
 
@@ -601,9 +612,11 @@ static void pwm_fan_stop(void)
 	 * continuing to run CPU heavy tasks for value added features
 	 * causing excessive heat.
 	 */
+#ifdef CONFIG_POWER_S0IX
 	if (power_get_state() == POWER_S0ix ||
 		power_get_state() == POWER_S0S0ix)
 		return;
+#endif
 
 	pwm_fan_control(0); /* crosbug.com/p/8097 */
 }
@@ -0,0 +1,68 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Software fan RPM controller */
+
+#include "common.h"
+#include "fan_pid.h"
+#include "math_util.h"
+#include "util.h"
+
+void fan_pid_reset(struct fan_pid *pid)
+{
+	pid->target = 0;
+	pid->last_rpm = 0;
+	pid->integral = 0;
+	pid->duty = 0;
+}
+
+int fan_pid_step(struct fan_pid *pid, int target, int feedforward, int rpm)
+{
+	const struct fan_pid_params *p = pid->params;
+	int running = pid->target > 0;
+	int settled = running && target == pid->target;
+	int err, out, delta;
+
+	if (target <= 0) {
+		fan_pid_reset(pid);
+		return 0;
+	}
+
+	err = target - rpm;
+	if (ABS(err) <= p->deadband)
+		err = 0;
+
+	/*
+	 * Only integrate once the target has settled. While it moves, the
+	 * fan is still ramping and the error says nothing about how far off
+	 * the feed-forward is.
+	 */
+	if (settled && p->ki) {
+		pid->integral += err;
+		pid->integral = CLAMP(pid->integral, -p->i_max / p->ki,
+				      p->i_max / p->ki);
+	}
+
+	out = feedforward * FAN_PID_SCALE + p->kp * err +
+	      p->ki * pid->integral;
+
+	/* Damp on the measurement, so target steps don't kick the output. */
+	if (settled && err)
+		out -= p->kd * (rpm - pid->last_rpm);
+
+	/* A fan starting from rest gets its feed-forward right away. */
+	if (running && p->slew) {
+		delta = CLAMP(out - pid->duty, -p->slew, p->slew);
+		out = pid->duty + delta;
+	}
+
+	out = CLAMP(out, 0, 100 * FAN_PID_SCALE);
+
+	pid->target = target;
+	pid->last_rpm = rpm;
+	pid->duty = out;
+
+	return (out + FAN_PID_SCALE / 2) / FAN_PID_SCALE;
+}
@@ -7,6 +7,7 @@
 
 #include "common.h"
 #include "console.h"
+#include "ec_commands_private.h"
 #include "flash.h"
 #include "gpio.h"
 #include "hooks.h"
@@ -618,6 +619,8 @@ int flash_read(int offset, int size, char *data)
 	memcpy(data, src, size);
 	flash_lock_mapped_storage(0);
 	return EC_SUCCESS;
+#elif defined(CONFIG_FLASH_READ_CACHE)
+	return flash_cache_read(offset, size, data);
 #else
 	return flash_physical_read(offset, size, data);
 #endif
@@ -956,8 +959,15 @@ int flash_set_protect(uint32_t mask, uint32_t flags)
 	return retval;
 }
 
+#if defined(CONFIG_FLASH_BACKGROUND_ERASE) && \
+	!defined(CONFIG_FLASH_DEFERRED_ERASE)
+#error "CONFIG_FLASH_BACKGROUND_ERASE requires CONFIG_FLASH_DEFERRED_ERASE"
+#endif
+
 #ifdef CONFIG_FLASH_DEFERRED_ERASE
 static volatile enum ec_status erase_rc = EC_RES_SUCCESS;
+
+#ifndef CONFIG_FLASH_BACKGROUND_ERASE
 static struct ec_params_flash_erase_v1 erase_info;
 
 static void flash_erase_deferred(void)
@@ -969,7 +979,38 @@ static void flash_erase_deferred(void)
 		erase_rc = EC_RES_SUCCESS;
 }
 DECLARE_DEFERRED(flash_erase_deferred);
-#endif
+#else
+static struct ec_params_flash_erase erase_range;
+
+static void flash_erase_background_done(int rv)
+{
+	erase_rc = rv ? EC_RES_ERROR : EC_RES_SUCCESS;
+}
+
+/*
+ * Nothing to defer: starting the erase takes no time, the flash does the
+ * work and reports back through flash_erase_background_done().
+ */
+static enum ec_status flash_erase_background(int offset, int size)
+{
+	if (!flash_range_ok(offset, size, CONFIG_FLASH_ERASE_SIZE))
+		return EC_RES_INVALID_PARAM;
+
+	flash_abort_or_invalidate_hash(offset, size);
+
+	erase_range.offset = offset;
+	erase_range.size = size;
+	erase_rc = EC_RES_BUSY;
+	if (flash_physical_erase_background(offset, size,
+					    flash_erase_background_done)) {
+		erase_rc = EC_RES_SUCCESS;
+		return EC_RES_ERROR;
+	}
+
+	return EC_RES_SUCCESS;
+}
+#endif /* CONFIG_FLASH_BACKGROUND_ERASE */
+#endif /* CONFIG_FLASH_DEFERRED_ERASE */
 
 /*****************************************************************************/
 /* Console commands */
@@ -1415,9 +1456,13 @@ static enum ec_status flash_command_erase(struct host_cmd_handler_args *args)
 	case FLASH_ERASE_SECTOR_ASYNC:
 		rc = erase_rc;
 		if (rc == EC_RES_SUCCESS) {
+#ifdef CONFIG_FLASH_BACKGROUND_ERASE
+			rc = flash_erase_background(offset, p->size);
+#else
 			memcpy(&erase_info, p_1, sizeof(*p_1));
 			hook_call_deferred(&flash_erase_deferred_data,
 					   100 * MSEC);
+#endif
 		} else {
 			/*
 			 * Not our job to return the result of
@@ -1447,6 +1492,20 @@ DECLARE_HOST_COMMAND(EC_CMD_FLASH_ERASE, flash_command_erase,
 #endif
 		);
 
+#ifdef CONFIG_FLASH_BACKGROUND_ERASE
+static enum ec_status
+flash_command_erase_progress(struct host_cmd_handler_args *args)
+{
+	struct ec_response_flash_erase_progress *r = args->response;
+
+	flash_physical_erase_progress(&r->erased, &r->size);
+	args->response_size = sizeof(*r);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_FLASH_ERASE_PROGRESS, flash_command_erase_progress,
+		     EC_VER_MASK(0));
+#endif
+
 static enum ec_status flash_command_protect(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_flash_protect *p = args->params;
@@ -0,0 +1,131 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Read cache for flash that is not mapped into the EC address space.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "flash.h"
+#include "task.h"
+#include "util.h"
+
+#define PAGE_SIZE CONFIG_FLASH_READ_CACHE_PAGE_SIZE
+#define PAGE_COUNT CONFIG_FLASH_READ_CACHE_PAGES
+
+/* Larger reads are streamed (e.g. hashing) and would only flush the cache */
+#define BYPASS_SIZE (PAGE_SIZE * PAGE_COUNT / 2)
+
+BUILD_ASSERT(POWER_OF_TWO(PAGE_SIZE));
+BUILD_ASSERT(CONFIG_FLASH_SIZE % PAGE_SIZE == 0);
+
+struct flash_cache_page {
+	int offset;		/* Flash offset of the page */
+	uint32_t last_used;	/* use_count when last read, 0 if empty */
+};
+
+static struct flash_cache_page pages[PAGE_COUNT];
+static uint8_t page_data[PAGE_COUNT][PAGE_SIZE] __aligned(4);
+static uint32_t use_count;
+static struct mutex cache_lock;
+
+static uint32_t hits, misses, bypassed;
+
+/* Return the page caching offset, reading it in if needed. Call locked. */
+static int flash_cache_page(int offset)
+{
+	int i, victim = 0;
+
+	for (i = 0; i < PAGE_COUNT; i++) {
+		if (pages[i].last_used && pages[i].offset == offset) {
+			hits++;
+			pages[i].last_used = ++use_count;
+			return i;
+		}
+		if (pages[i].last_used < pages[victim].last_used)
+			victim = i;
+	}
+
+	misses++;
+	pages[victim].last_used = 0;
+	if (flash_physical_read(offset, PAGE_SIZE,
+				(char *)page_data[victim]) != EC_SUCCESS)
+		return -1;
+
+	pages[victim].offset = offset;
+	pages[victim].last_used = ++use_count;
+	return victim;
+}
+
+int flash_cache_read(int offset, int size, char *data)
+{
+	int rv = EC_SUCCESS;
+
+	if (size > BYPASS_SIZE || offset < 0 ||
+	    offset + size > CONFIG_FLASH_SIZE) {
+		bypassed++;
+		return flash_physical_read(offset, size, data);
+	}
+
+	mutex_lock(&cache_lock);
+
+	while (size > 0) {
+		int base = offset & ~(PAGE_SIZE - 1);
+		int chunk = MIN(size, base + PAGE_SIZE - offset);
+		int i = flash_cache_page(base);
+
+		if (i < 0) {
+			rv = EC_ERROR_UNKNOWN;
+			break;
+		}
+
+		memcpy(data, page_data[i] + offset - base, chunk);
+		data += chunk;
+		offset += chunk;
+		size -= chunk;
+	}
+
+	mutex_unlock(&cache_lock);
+	return rv;
+}
+
+void flash_cache_invalidate(int offset, int size)
+{
+	int i;
+
+	mutex_lock(&cache_lock);
+	for (i = 0; i < PAGE_COUNT; i++) {
+		if (pages[i].offset < offset + size &&
+		    pages[i].offset + PAGE_SIZE > offset)
+			pages[i].last_used = 0;
+	}
+	mutex_unlock(&cache_lock);
+}
+
+static int command_flash_cache(int argc, char **argv)
+{
+	int i, used = 0;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		mutex_lock(&cache_lock);
+		memset(pages, 0, sizeof(pages));
+		hits = misses = bypassed = 0;
+		mutex_unlock(&cache_lock);
+		return EC_SUCCESS;
+	}
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		if (pages[i].last_used)
+			used++;
+
+	ccprintf("%d of %d pages of %d bytes used\n", used, PAGE_COUNT,
+		 PAGE_SIZE);
+	ccprintf("hits %u misses %u bypassed %u\n", hits, misses, bypassed);
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(flashcache, command_flash_cache,
+			"[clear]",
+			"Show or clear the flash read cache");
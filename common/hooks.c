@@ -9,6 +9,7 @@
 #include "console.h"
 #include "hooks.h"
 #include "link_defs.h"
+#include "task.h"
 #include "timer.h"
 #include "util.h"
 
@@ -102,11 +103,66 @@ static void record_hook_delay(uint64_t now, uint64_t last, uint64_t interval,
 }
 #endif
 
-void hook_notify(enum hook_type type)
+#ifdef CONFIG_HOOK_TIMING
+/*
+ * Only hook_notify() calls made directly by the task which started timing
+ * are recorded; other tasks and nested notifies run untimed. Only that task
+ * touches timing_count and timing_depth, so they need no locking.
+ */
+static struct hook_timing *timing_buf;
+static task_id_t timing_task;
+static int timing_max;
+static int timing_count;
+static int timing_depth;
+
+void hook_timing_start(struct hook_timing *buf, int max)
+{
+	timing_count = 0;
+	timing_depth = 0;
+	timing_max = max;
+	timing_task = task_get_current();
+	timing_buf = buf;
+}
+
+int hook_timing_stop(void)
+{
+	timing_buf = NULL;
+	return timing_count;
+}
+
+static void hook_call(void (*routine)(void))
+{
+	struct hook_timing *buf = timing_buf;
+	timestamp_t start;
+
+	if (!buf || timing_task != task_get_current() || timing_depth) {
+		routine();
+		return;
+	}
+
+	timing_depth++;
+	start = get_time();
+	routine();
+	timing_depth--;
+
+	if (timing_buf && timing_count < timing_max) {
+		buf[timing_count].routine = routine;
+		buf[timing_count].us = get_time().val - start.val;
+		timing_count++;
+	}
+}
+#else
+static inline void hook_call(void (*routine)(void))
+{
+	routine();
+}
+#endif
+
+void hook_notify_range(enum hook_type type, int min_prio, int max_prio)
 {
 	const struct hook_data *start, *end, *p;
 	int count, called = 0;
-	int last_prio = HOOK_PRIO_FIRST - 1, prio;
+	int last_prio = min_prio - 1, prio;
 #ifdef CONFIG_HOOK_DEBUG
 	uint64_t start_time = get_time().val;
 	uint64_t run_time;
@@ -125,13 +181,15 @@ void hook_notify(enum hook_type type)
 			if (p->priority < prio && p->priority > last_prio)
 				prio = p->priority;
 		}
+		if (prio > max_prio)
+			break;
 		last_prio = prio;
 
 		/* Call all the hooks with that priority */
 		for (p = start; p < end; p++) {
 			if (p->priority == prio) {
 				called++;
-				p->routine();
+				hook_call(p->routine);
 			}
 		}
 	}
@@ -144,6 +202,11 @@ void hook_notify(enum hook_type type)
 #endif
 }
 
+void hook_notify(enum hook_type type)
+{
+	hook_notify_range(type, HOOK_PRIO_FIRST, HOOK_PRIO_LAST);
+}
+
 int hook_call_deferred(const struct deferred_data *data, int us)
 {
 	int i = data - __deferred_funcs;
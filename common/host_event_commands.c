@@ -14,6 +14,7 @@
 #include "power.h"
 #include "system.h"
 #include "task.h"
+#include "timer.h"
 #include "util.h"
 
 /* Console output macros */
@@ -153,12 +154,9 @@ int lpc_get_next_host_event(void)
 	return evt_idx;
 }
 
-static void lpc_sysjump_save_mask(void)
-{
-	system_add_jump_tag(LPC_SYSJUMP_TAG, LPC_SYSJUMP_VERSION,
-			    sizeof(lpc_host_event_mask), lpc_host_event_mask);
-}
-DECLARE_HOOK(HOOK_SYSJUMP, lpc_sysjump_save_mask, HOOK_PRIO_DEFAULT);
+/* The masks are copied back in place before lpc_init_mask() runs. */
+DECLARE_PRESERVED_STATE(lpc_mask, LPC_SYSJUMP_TAG, LPC_SYSJUMP_VERSION,
+			lpc_host_event_mask);
 
 /*
  * Restore various LPC masks if they were saved before the sysjump.
@@ -173,16 +171,19 @@ static int lpc_post_sysjump_restore_mask(void)
 	const host_event_t *prev_mask;
 	int size, version;
 
+	if (system_preserved_state_restored(LPC_SYSJUMP_TAG))
+		return 1;
+
+	/* Images without always report mask saved an older version. */
 	prev_mask = (const host_event_t *)system_get_jump_tag(LPC_SYSJUMP_TAG,
 			&version, &size);
 	if (!prev_mask || size != sizeof(lpc_host_event_mask) ||
-	    (version != LPC_SYSJUMP_VERSION &&
-	     version != LPC_SYSJUMP_OLD_VERSION))
+	    version != LPC_SYSJUMP_OLD_VERSION)
 		return 0;
 
 	memcpy(lpc_host_event_mask, prev_mask, sizeof(lpc_host_event_mask));
 
-	return version == LPC_SYSJUMP_VERSION;
+	return 0;
 }
 
 host_event_t __attribute__((weak)) lpc_override_always_report_mask(void)
@@ -303,6 +304,101 @@ host_event_t host_get_events(void)
 	return events;
 }
 
+/**
+ * Make the events visible to the host and notify it (SCI or MKBP).
+ */
+static void host_events_deliver(host_event_t mask)
+{
+	HOST_EVENT_CPRINTS("event set", mask);
+
+	host_events_atomic_or(&events, mask);
+	host_events_atomic_or(&events_copy_b, mask);
+
+#ifdef CONFIG_HOSTCMD_X86
+	lpc_set_host_event_state(events);
+#else
+	*(host_event_t *)host_get_memmap(EC_MEMMAP_HOST_EVENTS) = events;
+#ifdef CONFIG_MKBP_EVENT
+#ifdef CONFIG_MKBP_USE_HOST_EVENT
+#error "Config error: MKBP must not be on top of host event"
+#endif
+	host_events_send_mkbp_event(events);
+#endif  /* CONFIG_MKBP_EVENT */
+#endif  /* !CONFIG_HOSTCMD_X86 */
+}
+
+#ifdef CONFIG_HOST_EVENT_COALESCE_MS
+/*
+ * Events that are not urgent and show up within CONFIG_HOST_EVENT_COALESCE_MS
+ * of the previous delivery are held here and delivered together, so a burst
+ * (battery, PD, UCSI...) costs the host one SCI and one round of queries.
+ */
+static host_event_t coalesced_events;
+/*
+ * host_set_events() may run in interrupt context, so the time of the last
+ * delivery is kept as the low word of the timer, which is stored atomically;
+ * 0 means nothing was delivered yet. The counters are updated atomically too.
+ * A delivery raises at most one SCI or MKBP event; whether it does depends
+ * on the host's masks, so these count deliveries rather than SCIs.
+ */
+static uint32_t last_delivery;
+static uint32_t delivery_count;
+static uint32_t held_back_count;
+
+static host_event_t host_events_take_coalesced(void)
+{
+	uint32_t *ptr = (uint32_t *)&coalesced_events;
+	host_event_t e = deprecated_atomic_read_clear(ptr);
+
+#ifdef CONFIG_HOST_EVENT64
+	e |= (host_event_t)deprecated_atomic_read_clear(ptr + 1) << 32;
+#endif
+	return e;
+}
+
+static void host_events_flush(void)
+{
+	host_event_t e = host_events_take_coalesced();
+
+	if (e) {
+		last_delivery = get_time().le.lo;
+		deprecated_atomic_add(&delivery_count, 1);
+		host_events_deliver(e);
+	}
+}
+DECLARE_DEFERRED(host_events_flush);
+
+/**
+ * Return the events to deliver right away, holding back the rest.
+ */
+static host_event_t host_events_coalesce(host_event_t mask)
+{
+	host_event_t urgent = CONFIG_HOST_EVENT_URGENT_MASK;
+	uint32_t now = get_time().le.lo;
+	uint32_t last = last_delivery;
+	int32_t wait = last + CONFIG_HOST_EVENT_COALESCE_MS * MSEC - now;
+
+#ifdef CONFIG_HOSTCMD_X86
+	/* Anything that wakes the AP must not wait */
+	urgent |= lpc_get_host_event_mask(LPC_HOST_EVENT_WAKE);
+#endif
+
+	if (last && wait > 0 && !(mask & urgent)) {
+		host_events_atomic_or(&coalesced_events, mask);
+		deprecated_atomic_add(&held_back_count, 1);
+		hook_call_deferred(&host_events_flush_data, wait);
+		return 0;
+	}
+
+	/* Take anything held back along */
+	hook_call_deferred(&host_events_flush_data, -1);
+	last_delivery = now;
+	deprecated_atomic_add(&delivery_count, 1);
+
+	return mask | host_events_take_coalesced();
+}
+#endif /* CONFIG_HOST_EVENT_COALESCE_MS */
+
 void host_set_events(host_event_t mask)
 {
 	/* ignore host events the rest of board doesn't care about */
@@ -328,22 +424,13 @@ void host_set_events(host_event_t mask)
 	if (!((events & mask) != mask || (events_copy_b & mask) != mask))
 		return;
 
-	HOST_EVENT_CPRINTS("event set", mask);
-
-	host_events_atomic_or(&events, mask);
-	host_events_atomic_or(&events_copy_b, mask);
-
-#ifdef CONFIG_HOSTCMD_X86
-	lpc_set_host_event_state(events);
-#else
-	*(host_event_t *)host_get_memmap(EC_MEMMAP_HOST_EVENTS) = events;
-#ifdef CONFIG_MKBP_EVENT
-#ifdef CONFIG_MKBP_USE_HOST_EVENT
-#error "Config error: MKBP must not be on top of host event"
+#ifdef CONFIG_HOST_EVENT_COALESCE_MS
+	mask = host_events_coalesce(mask);
+	if (!mask)
+		return;
 #endif
-	host_events_send_mkbp_event(events);
-#endif  /* CONFIG_MKBP_EVENT */
-#endif  /* !CONFIG_HOSTCMD_X86 */
+
+	host_events_deliver(mask);
 }
 
 void host_set_single_event(enum host_event_code event)
@@ -371,6 +458,11 @@ void host_clear_events(host_event_t mask)
 	mask &= CONFIG_HOST_EVENT_REPORT_MASK;
 #endif
 
+#ifdef CONFIG_HOST_EVENT_COALESCE_MS
+	/* Events cleared before they were delivered are simply dropped */
+	host_events_atomic_clear(&coalesced_events, mask);
+#endif
+
 	/* return early if nothing changed */
 	if (!(events & mask))
 		return;
@@ -496,6 +588,11 @@ static int command_host_event(int argc, char **argv)
 		 lpc_get_host_event_mask(LPC_HOST_EVENT_WAKE));
 	HOST_EVENT_CCPRINTF("Always report mask: ",
 		 lpc_get_host_event_mask(LPC_HOST_EVENT_ALWAYS_REPORT));
+#endif
+#ifdef CONFIG_HOST_EVENT_COALESCE_MS
+	HOST_EVENT_CCPRINTF("Held back:          ", coalesced_events);
+	ccprintf("Deliveries: %d, held back: %d\n", delivery_count,
+		 held_back_count);
 #endif
 	return EC_SUCCESS;
 }
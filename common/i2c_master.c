@@ -49,6 +49,33 @@ static uint32_t i2c_port_active_list;
 BUILD_ASSERT(ARRAY_SIZE(port_mutex) < 32);
 static uint8_t port_protected[I2C_PORT_COUNT + I2C_BITBANG_PORT_COUNT];
 
+#ifdef CONFIG_I2C_SCHED
+/*
+ * Port scheduler state, one per port_mutex. Tasks waiting for a port defer
+ * to waiters of a higher priority, so urgent requests get the bus as soon as
+ * the current holder unlocks it.
+ */
+static struct i2c_sched {
+	/* Number of tasks waiting for the lock, per priority */
+	uint8_t waiting[I2C_PRIO_COUNT];
+	/* Tasks deferring to higher-priority waiters */
+	uint32_t deferred;
+	/* Statistics */
+	uint8_t max_depth;
+	uint32_t locks;
+	uint32_t waits;
+	uint32_t deferrals;
+	uint32_t total_wait_us;
+	uint32_t max_wait_us;
+} i2c_sched[ARRAY_SIZE(port_mutex)];
+/* i2c_sched.deferred is a bitmap of task IDs */
+BUILD_ASSERT(TASK_ID_COUNT <= 32);
+
+static uint8_t task_i2c_prio[TASK_ID_COUNT] = {
+	[0 ... (TASK_ID_COUNT - 1)] = I2C_PRIO_NORMAL,
+};
+#endif /* CONFIG_I2C_SCHED */
+
 /**
  * Non-deterministically test the lock status of the port.  If another task
  * has locked the port and the caller is accessing it illegally, then this test
@@ -97,10 +124,14 @@ static int chip_i2c_xfer_with_notify(const int port,
 	int ret;
 	uint16_t addr_flags = slave_addr_flags;
 	const struct i2c_port_t *i2c_port = get_i2c_port(port);
+	uint32_t start_us = 0;
 
 	if (IS_ENABLED(CONFIG_I2C_XFER_BOARD_CALLBACK))
 		i2c_start_xfer_notify(port, slave_addr_flags);
 
+	if (IS_ENABLED(CONFIG_I2C_DEBUG) || IS_ENABLED(CONFIG_I2C_STATS))
+		start_us = get_time().le.lo;
+
 	if (IS_ENABLED(CONFIG_SMBUS_PEC))
 		/*
 		 * Since we've done PEC processing here,
@@ -117,9 +148,13 @@ static int chip_i2c_xfer_with_notify(const int port,
 	if (IS_ENABLED(CONFIG_I2C_XFER_BOARD_CALLBACK))
 		i2c_end_xfer_notify(port, slave_addr_flags);
 
+	if (IS_ENABLED(CONFIG_I2C_STATS))
+		i2c_stats_record(port, slave_addr_flags, out_size, in_size,
+				 ret, start_us);
+
 	if (IS_ENABLED(CONFIG_I2C_DEBUG)) {
 		i2c_trace_notify(port, slave_addr_flags, out, out_size,
-				 in, in_size);
+				 in, in_size, ret, start_us);
 	}
 
 	return ret;
@@ -204,6 +239,210 @@ int i2c_xfer(const int port,
 	return rv;
 }
 
+#ifdef CONFIG_I2C_XFER_ASYNC
+/*
+ * Hand the transfer to the chip driver if it can run it in the background.
+ * PEC, board-level port drivers and reads that need splitting go through
+ * i2c_xfer_unlocked() instead.
+ */
+static int i2c_xfer_start_async(struct i2c_xfer_async *x)
+{
+	const struct i2c_port_t *i2c_port = get_i2c_port(x->port);
+	int rv;
+
+	if (!i2c_port || i2c_port->drv || I2C_USE_PEC(x->slave_addr_flags) ||
+	    x->in_size > CONFIG_I2C_CHIP_MAX_READ_SIZE)
+		return EC_ERROR_UNIMPLEMENTED;
+
+	if (IS_ENABLED(CONFIG_I2C_XFER_BOARD_CALLBACK))
+		i2c_start_xfer_notify(x->port, x->slave_addr_flags);
+
+	if (IS_ENABLED(CONFIG_I2C_DEBUG) || IS_ENABLED(CONFIG_I2C_STATS))
+		x->start_us = get_time().le.lo;
+
+	rv = chip_i2c_xfer_start(x->port, x->slave_addr_flags,
+				 x->out, x->out_size, x->in, x->in_size,
+				 I2C_XFER_SINGLE);
+
+	if (rv != EC_SUCCESS && IS_ENABLED(CONFIG_I2C_XFER_BOARD_CALLBACK))
+		i2c_end_xfer_notify(x->port, x->slave_addr_flags);
+
+	return rv;
+}
+
+static int i2c_xfer_finish_async(struct i2c_xfer_async *x)
+{
+	int rv = chip_i2c_xfer_finish(x->port);
+
+	if (IS_ENABLED(CONFIG_I2C_XFER_BOARD_CALLBACK))
+		i2c_end_xfer_notify(x->port, x->slave_addr_flags);
+
+	if (IS_ENABLED(CONFIG_I2C_STATS))
+		i2c_stats_record(x->port, x->slave_addr_flags, x->out_size,
+				 x->in_size, rv, x->start_us);
+
+	if (IS_ENABLED(CONFIG_I2C_DEBUG))
+		i2c_trace_notify(x->port, x->slave_addr_flags,
+				 x->out, x->out_size, x->in, x->in_size,
+				 rv, x->start_us);
+
+	return rv;
+}
+#endif /* CONFIG_I2C_XFER_ASYNC */
+
+void i2c_xfer_submit(struct i2c_xfer_async *x)
+{
+	i2c_lock(x->port, 1);
+
+	x->pending = 0;
+	x->rv = EC_ERROR_UNIMPLEMENTED;
+#ifdef CONFIG_I2C_XFER_ASYNC
+	x->rv = i2c_xfer_start_async(x);
+	if (x->rv == EC_SUCCESS) {
+		x->pending = 1;
+		return;
+	}
+#endif
+	if (x->rv == EC_ERROR_UNIMPLEMENTED)
+		x->rv = i2c_xfer_unlocked(x->port, x->slave_addr_flags,
+					  x->out, x->out_size,
+					  x->in, x->in_size, I2C_XFER_SINGLE);
+}
+
+int i2c_xfer_complete(struct i2c_xfer_async *x)
+{
+#ifdef CONFIG_I2C_XFER_ASYNC
+	if (x->pending) {
+		x->pending = 0;
+		x->rv = i2c_xfer_finish_async(x);
+		/* Let the synchronous path do the NACK retries */
+		if (x->rv == EC_ERROR_BUSY && CONFIG_I2C_NACK_RETRY_COUNT)
+			x->rv = i2c_xfer_unlocked(x->port, x->slave_addr_flags,
+						  x->out, x->out_size,
+						  x->in, x->in_size,
+						  I2C_XFER_SINGLE);
+	}
+#endif
+	i2c_lock(x->port, 0);
+
+	return x->rv;
+}
+
+#ifdef CONFIG_I2C_SCHED
+enum i2c_prio i2c_set_priority(enum i2c_prio prio)
+{
+	task_id_t tid = task_get_current();
+	enum i2c_prio old;
+
+	if (tid >= TASK_ID_COUNT)
+		return I2C_PRIO_NORMAL;
+
+	old = task_i2c_prio[tid];
+	task_i2c_prio[tid] = prio;
+	return old;
+}
+
+/* Return true if a request of higher priority than prio is waiting */
+static int i2c_sched_outranked(const struct i2c_sched *s, int prio)
+{
+	int i;
+
+	for (i = prio + 1; i < I2C_PRIO_COUNT; i++)
+		if (s->waiting[i])
+			return 1;
+	return 0;
+}
+
+static void i2c_sched_lock(int port)
+{
+	struct i2c_sched *s = i2c_sched + port;
+	task_id_t tid = task_get_current();
+	int prio = I2C_PRIO_NORMAL;
+	timestamp_t start;
+	uint32_t wait_us;
+	int i, depth = 0;
+
+	if (task_start_called() && tid < TASK_ID_COUNT)
+		prio = task_i2c_prio[tid];
+
+	start = get_time();
+	interrupt_disable();
+	s->waiting[prio]++;
+	for (i = 0; i < I2C_PRIO_COUNT; i++)
+		depth += s->waiting[i];
+	if (port_mutex[port].lock)
+		depth++;
+	s->max_depth = MAX(s->max_depth, depth);
+	s->locks++;
+	if (depth > 1)
+		s->waits++;
+	interrupt_enable();
+
+	while (1) {
+		/* Let higher-priority requests take the port first */
+		interrupt_disable();
+		while (i2c_sched_outranked(s, prio)) {
+			s->deferred |= BIT(tid);
+			s->deferrals++;
+			interrupt_enable();
+			task_wait_event_mask(TASK_EVENT_MUTEX, 0);
+			interrupt_disable();
+		}
+		interrupt_enable();
+
+		mutex_lock(port_mutex + port);
+		/*
+		 * The mutex goes to the highest priority task, not request.
+		 * Hand it over if an urgent request slipped in meanwhile.
+		 */
+		if (!i2c_sched_outranked(s, prio))
+			break;
+		mutex_unlock(port_mutex + port);
+	}
+
+	wait_us = get_time().val - start.val;
+	interrupt_disable();
+	s->waiting[prio]--;
+	s->total_wait_us += wait_us;
+	s->max_wait_us = MAX(s->max_wait_us, wait_us);
+	interrupt_enable();
+}
+
+static void i2c_sched_unlock(int port)
+{
+	struct i2c_sched *s = i2c_sched + port;
+	uint32_t deferred;
+	int i;
+
+	mutex_unlock(port_mutex + port);
+
+	interrupt_disable();
+	deferred = s->deferred;
+	s->deferred = 0;
+	interrupt_enable();
+
+	/* Deferred tasks check again who is next */
+	for (i = 0; deferred; i++, deferred >>= 1)
+		if (deferred & 1)
+			task_set_event(i, TASK_EVENT_MUTEX, 0);
+}
+#else
+enum i2c_prio i2c_set_priority(enum i2c_prio prio)
+{
+	return I2C_PRIO_NORMAL;
+}
+
+static void i2c_sched_lock(int port)
+{
+	mutex_lock(port_mutex + port);
+}
+
+static void i2c_sched_unlock(int port)
+{
+	mutex_unlock(port_mutex + port);
+}
+#endif /* CONFIG_I2C_SCHED */
+
 void i2c_lock(int port, int lock)
 {
 #ifdef CONFIG_I2C_MULTI_PORT_CONTROLLER
@@ -214,7 +453,7 @@ void i2c_lock(int port, int lock)
 		return;
 
 	if (lock) {
-		mutex_lock(port_mutex + port);
+		i2c_sched_lock(port);
 
 		/* Disable interrupt during changing counter for preemption. */
 		interrupt_disable();
@@ -234,7 +473,7 @@ void i2c_lock(int port, int lock)
 
 		interrupt_enable();
 
-		mutex_unlock(port_mutex + port);
+		i2c_sched_unlock(port);
 	}
 }
 
@@ -645,6 +884,54 @@ int i2c_write_offset16_block(const int port,
 	return rv;
 }
 
+/* SMBus block reads carry at most 32 data bytes */
+#define SMBUS_MAX_BLOCK_SIZE 32
+
+/* PEC of a block read of reg, computed over the length byte and the data */
+static uint8_t smbus_block_pec(const uint16_t slave_addr_flags, uint8_t reg,
+			       const uint8_t *block, int size)
+{
+	uint8_t addr_8bit = I2C_GET_ADDR(slave_addr_flags) << 1;
+	uint8_t out[3] = {addr_8bit, reg, addr_8bit | 1};
+
+	return crc8_arg(block, size, crc8(out, sizeof(out)));
+}
+
+/*
+ * Read the length byte, up to SMBUS_MAX_BLOCK_SIZE data bytes and the PEC in
+ * a single transfer (CONFIG_SMBUS_BLOCK_READ_SINGLE_XFER). Shorter blocks are
+ * followed by filler bytes, which are dropped. Return EC_ERROR_OVERFLOW if
+ * the block does not fit, so the caller can read it piecewise.
+ */
+static int i2c_read_string_single_xfer(const int port,
+				       const uint16_t slave_addr_flags,
+				       uint8_t reg, uint8_t *data, int len)
+{
+	uint8_t buf[1 + SMBUS_MAX_BLOCK_SIZE + 1];
+	int use_pec = IS_ENABLED(CONFIG_SMBUS_PEC) &&
+		      I2C_USE_PEC(slave_addr_flags);
+	int max = SMBUS_MAX_BLOCK_SIZE;
+	int rv;
+
+	if (len)
+		max = MIN(len - 1, max);
+
+	rv = i2c_xfer_unlocked(port, slave_addr_flags, &reg, 1,
+			       buf, 1 + max + use_pec, I2C_XFER_SINGLE);
+	if (rv)
+		return rv;
+	if (buf[0] > max)
+		return EC_ERROR_OVERFLOW;
+
+	if (use_pec && buf[1 + buf[0]] !=
+	    smbus_block_pec(slave_addr_flags, reg, buf, 1 + buf[0]))
+		return EC_ERROR_CRC;
+
+	memcpy(data, buf + 1, buf[0]);
+	data[buf[0]] = 0;
+	return EC_SUCCESS;
+}
+
 int i2c_read_string(const int port,
 		    const uint16_t slave_addr_flags,
 		    int offset, uint8_t *data, int len)
@@ -661,6 +948,15 @@ int i2c_read_string(const int port,
 	for (i = 0; i <= CONFIG_I2C_NACK_RETRY_COUNT; i++) {
 		int data_length;
 
+		if (IS_ENABLED(CONFIG_SMBUS_BLOCK_READ_SINGLE_XFER)) {
+			rv = i2c_read_string_single_xfer(port, slave_addr_flags,
+							 reg, data, len);
+			if (rv == EC_SUCCESS)
+				break;
+			if (rv != EC_ERROR_OVERFLOW)
+				continue;
+		}
+
 		/*
 		 * Send device reg space offset, and read back block length.
 		 * Keep this session open without a stop.
@@ -678,18 +974,38 @@ int i2c_read_string(const int port,
 
 		if (IS_ENABLED(CONFIG_SMBUS_PEC) &&
 				I2C_USE_PEC(slave_addr_flags)) {
-			uint8_t addr_8bit = I2C_GET_ADDR(slave_addr_flags) << 1;
-			uint8_t out[3] = {addr_8bit, reg, addr_8bit | 1};
 			uint8_t pec, pec_remote;
 
+			pec = smbus_block_pec(slave_addr_flags, reg,
+					      &block_length, 1);
+
+			if (data_length == block_length) {
+				/*
+				 * The whole block fits: read the data and the
+				 * PEC together, the PEC lands where the
+				 * terminating 0 goes.
+				 */
+				rv = i2c_xfer_unlocked(port, slave_addr_flags,
+						       NULL, 0, data,
+						       data_length + 1,
+						       I2C_XFER_STOP);
+				pec_remote = data[data_length];
+				data[data_length] = 0;
+				if (rv)
+					continue;
+
+				pec = crc8_arg(data, data_length, pec);
+				if (pec != pec_remote)
+					rv = EC_ERROR_CRC;
+				break;
+			}
+
 			rv = i2c_xfer_unlocked(port, slave_addr_flags,
 					       0, 0, data, data_length, 0);
 			data[data_length] = 0;
 			if (rv)
 				continue;
 
-			pec = crc8(out, sizeof(out));
-			pec = crc8_arg(&block_length, 1, pec);
 			pec = crc8_arg(data, data_length, pec);
 
 			/* read all remaining bytes */
@@ -928,6 +1244,9 @@ int i2c_unwedge(int port)
 	}
 #endif /* CONFIG_I2C_BUS_MAY_BE_UNPOWERED */
 
+	if (IS_ENABLED(CONFIG_I2C_STATS))
+		i2c_stats_unwedge(port);
+
 	/* Try to put port in to raw bit bang mode. */
 	if (i2c_raw_mode(port, 1) != EC_SUCCESS)
 		return EC_ERROR_UNKNOWN;
@@ -1415,6 +1734,44 @@ DECLARE_CONSOLE_COMMAND(i2cscan, command_scan,
 			"Scan I2C ports for devices");
 #endif
 
+#if defined(CONFIG_I2C_SCHED) && defined(CONFIG_CMD_I2C_SCHED)
+static int command_i2csched(int argc, char **argv)
+{
+	const struct i2c_sched *s;
+	int i;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		interrupt_disable();
+		for (i = 0; i < ARRAY_SIZE(i2c_sched); i++) {
+			i2c_sched[i].max_depth = 0;
+			i2c_sched[i].locks = 0;
+			i2c_sched[i].waits = 0;
+			i2c_sched[i].deferrals = 0;
+			i2c_sched[i].total_wait_us = 0;
+			i2c_sched[i].max_wait_us = 0;
+		}
+		interrupt_enable();
+		return EC_SUCCESS;
+	}
+
+	ccprintf("lock   locks   waits  defer depth  avg_us  max_us\n");
+	for (i = 0; i < ARRAY_SIZE(i2c_sched); i++) {
+		s = i2c_sched + i;
+		if (!s->locks)
+			continue;
+		ccprintf("%4d %7u %7u %6u %5u %7u %7u\n", i, s->locks,
+			 s->waits, s->deferrals, s->max_depth,
+			 s->total_wait_us / s->locks, s->max_wait_us);
+	}
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(i2csched, command_i2csched,
+			"[clear]",
+			"Show I2C port lock queue statistics");
+#endif
+
 #ifdef CONFIG_CMD_I2C_XFER
 static int command_i2cxfer(int argc, char **argv)
 {
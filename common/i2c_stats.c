@@ -0,0 +1,172 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Per-device I2C bus statistics.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands_private.h"
+#include "host_command.h"
+#include "i2c.h"
+#include "task.h"
+#include "timer.h"
+#include "util.h"
+
+#ifndef CONFIG_I2C_BITBANG
+#define I2C_BITBANG_PORT_COUNT 0
+#endif
+
+#define I2C_STATS_PORTS (I2C_PORT_COUNT + I2C_BITBANG_PORT_COUNT)
+
+BUILD_ASSERT(CONFIG_I2C_STATS_DEVICES <= UINT8_MAX);
+
+static struct ec_i2c_stats_device devs[CONFIG_I2C_STATS_DEVICES];
+static int dev_count;
+static uint32_t untracked;
+static timestamp_t since;
+
+/* Index + 1 of the device that used each port last, 0 for none */
+static uint8_t last_dev[I2C_STATS_PORTS];
+
+/* Find or add a device. Must be called with interrupts disabled. */
+static struct ec_i2c_stats_device *i2c_stats_dev(int port, uint16_t addr)
+{
+	struct ec_i2c_stats_device *d;
+	int i;
+
+	/* Most transfers go to the same device as the last one */
+	if (port < I2C_STATS_PORTS && last_dev[port]) {
+		d = devs + last_dev[port] - 1;
+		if (d->addr == addr)
+			return d;
+	}
+
+	for (i = 0; i < dev_count; i++)
+		if (devs[i].port == port && devs[i].addr == addr)
+			break;
+
+	if (i == dev_count) {
+		if (dev_count == CONFIG_I2C_STATS_DEVICES)
+			return NULL;
+		dev_count++;
+		devs[i].port = port;
+		devs[i].addr = addr;
+	}
+
+	if (port < I2C_STATS_PORTS)
+		last_dev[port] = i + 1;
+	return devs + i;
+}
+
+void i2c_stats_record(int port, uint16_t slave_addr_flags,
+		      int out_size, int in_size, int ret, uint32_t start_us)
+{
+	struct ec_i2c_stats_device *d;
+	uint32_t us = get_time().le.lo - start_us;
+
+	interrupt_disable();
+	d = i2c_stats_dev(port, I2C_GET_ADDR(slave_addr_flags));
+	if (d) {
+		d->xfers++;
+		d->bytes += out_size + in_size;
+		d->busy_us += us;
+		d->max_us = MAX(d->max_us, us);
+		/* Chip drivers report a NACK as busy */
+		if (ret == EC_ERROR_BUSY)
+			d->nacks++;
+		else if (ret == EC_ERROR_TIMEOUT)
+			d->timeouts++;
+		else if (ret != EC_SUCCESS)
+			d->errors++;
+	} else {
+		untracked++;
+	}
+	interrupt_enable();
+}
+
+void i2c_stats_unwedge(int port)
+{
+	interrupt_disable();
+	if (port < I2C_STATS_PORTS && last_dev[port])
+		devs[last_dev[port] - 1].unwedges++;
+	interrupt_enable();
+}
+
+static void i2c_stats_clear(void)
+{
+	interrupt_disable();
+	memset(devs, 0, sizeof(devs));
+	memset(last_dev, 0, sizeof(last_dev));
+	dev_count = 0;
+	untracked = 0;
+	since = get_time();
+	interrupt_enable();
+}
+
+static enum ec_status i2c_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_i2c_stats *p = args->params;
+	struct ec_response_i2c_stats *r = args->response;
+	int max = (args->response_max - sizeof(*r)) / sizeof(r->devices[0]);
+	int count = 0;
+	int offset;
+
+	if (args->params_size < sizeof(*p))
+		return EC_RES_INVALID_PARAM;
+
+	/* The response may overwrite the params */
+	offset = p->offset;
+	if (p->flags & EC_I2C_STATS_CLEAR)
+		i2c_stats_clear();
+
+	interrupt_disable();
+	r->period_ms = (get_time().val - since.val) / MSEC;
+	r->untracked = untracked;
+	r->total = dev_count;
+	if (offset < dev_count) {
+		count = MIN(max, dev_count - offset);
+		memcpy(r->devices, devs + offset,
+		       count * sizeof(r->devices[0]));
+	}
+	interrupt_enable();
+	r->count = count;
+	memset(r->reserved, 0, sizeof(r->reserved));
+
+	args->response_size = sizeof(*r) + count * sizeof(r->devices[0]);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_I2C_STATS, i2c_stats, EC_VER_MASK(0));
+
+static int command_i2cstats(int argc, char **argv)
+{
+	struct ec_i2c_stats_device d;
+	uint32_t period_ms = (get_time().val - since.val) / MSEC;
+	int i;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		i2c_stats_clear();
+		return EC_SUCCESS;
+	}
+
+	ccprintf("Over %u ms, %u transfers untracked\n", period_ms, untracked);
+	ccprintf("port addr   xfers    bytes  busy_us max_us "
+		 "nack tmo err wedge\n");
+	for (i = 0; i < dev_count; i++) {
+		interrupt_disable();
+		d = devs[i];
+		interrupt_enable();
+		ccprintf("%4d 0x%02x %7u %8u %8u %6u %4u %3u %3u %5u\n",
+			 d.port, d.addr, d.xfers, d.bytes, d.busy_us, d.max_us,
+			 d.nacks, d.timeouts, d.errors, d.unwedges);
+		cflush();
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(i2cstats, command_i2cstats,
+			"[clear]",
+			"Show per-device I2C bus statistics");
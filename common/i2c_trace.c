@@ -5,15 +5,15 @@
 
 #include "common.h"
 #include "console.h"
+#include "ec_commands_private.h"
+#include "host_command.h"
 #include "i2c.h"
 #include "stddef.h"
 #include "stdbool.h"
+#include "task.h"
+#include "timer.h"
 #include "util.h"
 
-#define CPUTS(outstr) cputs(CC_I2C, outstr)
-#define CPRINTS(format, args...) cprints(CC_I2C, format, ## args)
-#define CPRINTF(format, args...) cprintf(CC_I2C, format, ## args)
-
 struct i2c_trace_range {
 	bool enabled;
 	int port;
@@ -23,34 +23,146 @@ struct i2c_trace_range {
 
 static struct i2c_trace_range trace_entries[8];
 
-void i2c_trace_notify(int port, uint16_t slave_addr_flags,
-		      const uint8_t *out_data, size_t out_size,
-		      const uint8_t *in_data, size_t in_size)
+/*
+ * Capture ring. Transactions are recorded in binary and only formatted when
+ * read out, so tracing does not stretch the transactions or flood the UART.
+ */
+BUILD_ASSERT(POWER_OF_TWO(CONFIG_I2C_TRACE_ENTRIES));
+static struct ec_i2c_trace_entry trace_ring[CONFIG_I2C_TRACE_ENTRIES];
+static uint32_t trace_head;	/* Next entry to write */
+static uint32_t trace_tail;	/* Oldest entry */
+static uint32_t trace_overwritten;
+
+static bool i2c_trace_match(int port, uint16_t addr)
 {
 	size_t i;
-	uint16_t addr = I2C_GET_ADDR(slave_addr_flags);
 
 	for (i = 0; i < ARRAY_SIZE(trace_entries); i++)
 		if (trace_entries[i].enabled
 		    && trace_entries[i].port == port
 		    && trace_entries[i].slave_addr_lo <= addr
 		    && trace_entries[i].slave_addr_hi >= addr)
-			goto trace_enabled;
-	return;
-
-trace_enabled:
-	CPRINTF("i2c: %d:0x%X ", port, addr);
-	if (out_size) {
-		CPRINTF("wr ");
-		for (i = 0; i < out_size; i++)
-			CPRINTF("0x%02X ", out_data[i]);
+			return true;
+	return false;
+}
+
+void i2c_trace_notify(int port, uint16_t slave_addr_flags,
+		      const uint8_t *out_data, size_t out_size,
+		      const uint8_t *in_data, size_t in_size,
+		      int ret, uint32_t start_us)
+{
+	struct ec_i2c_trace_entry *e;
+	size_t out_copy, in_copy;
+	uint32_t end_us;
+
+	if (!i2c_trace_match(port, I2C_GET_ADDR(slave_addr_flags)))
+		return;
+
+	end_us = get_time().le.lo;
+	out_copy = MIN(out_size, EC_I2C_TRACE_DATA_MAX);
+	in_copy = MIN(in_size, EC_I2C_TRACE_DATA_MAX - out_copy);
+
+	interrupt_disable();
+	if (trace_head - trace_tail == CONFIG_I2C_TRACE_ENTRIES) {
+		trace_tail++;
+		trace_overwritten++;
 	}
-	if (in_size) {
-		CPRINTF("  rd ");
-		for (i = 0; i < in_size; i++)
-			CPRINTF("0x%02X ", in_data[i]);
+	e = trace_ring + (trace_head++ & (CONFIG_I2C_TRACE_ENTRIES - 1));
+	e->start_us = start_us;
+	e->end_us = end_us;
+	e->port = port;
+	e->result = (ret >= 0 && ret <= UINT8_MAX) ? ret : EC_ERROR_UNKNOWN;
+	e->addr_flags = slave_addr_flags;
+	e->out_size = out_size;
+	e->in_size = in_size;
+	memcpy(e->data, out_data, out_copy);
+	memcpy(e->data + out_copy, in_data, in_copy);
+	interrupt_enable();
+}
+
+/* Remove the oldest entry from the ring. Return false if it is empty. */
+static bool i2c_trace_pop(struct ec_i2c_trace_entry *e)
+{
+	bool found = false;
+
+	interrupt_disable();
+	if (trace_tail != trace_head) {
+		*e = trace_ring[trace_tail++ & (CONFIG_I2C_TRACE_ENTRIES - 1)];
+		found = true;
 	}
-	CPRINTF("\n");
+	interrupt_enable();
+
+	return found;
+}
+
+static uint32_t i2c_trace_take_overwritten(void)
+{
+	uint32_t n;
+
+	interrupt_disable();
+	n = trace_overwritten;
+	trace_overwritten = 0;
+	interrupt_enable();
+
+	return n;
+}
+
+static enum ec_status i2c_trace_read(struct host_cmd_handler_args *args)
+{
+	struct ec_response_i2c_trace_read *r = args->response;
+	int max = (args->response_max - sizeof(*r)) / sizeof(r->entries[0]);
+	int count = 0;
+
+	max = MIN(max, UINT8_MAX);
+	r->overwritten = i2c_trace_take_overwritten();
+	while (count < max && i2c_trace_pop(&r->entries[count]))
+		count++;
+	r->count = count;
+	memset(r->reserved, 0, sizeof(r->reserved));
+
+	args->response_size = sizeof(*r) + count * sizeof(r->entries[0]);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_I2C_TRACE_READ, i2c_trace_read,
+		     EC_VER_MASK(0));
+
+static int command_i2ctrace_dump(void)
+{
+	struct ec_i2c_trace_entry e;
+	uint32_t overwritten = i2c_trace_take_overwritten();
+	int out_copy, in_copy, i;
+
+	if (overwritten)
+		ccprintf("(%u entries overwritten)\n", overwritten);
+
+	while (i2c_trace_pop(&e)) {
+		out_copy = MIN(e.out_size, EC_I2C_TRACE_DATA_MAX);
+		in_copy = MIN(e.in_size, EC_I2C_TRACE_DATA_MAX - out_copy);
+
+		ccprintf("%10u +%4uus %d:0x%X", e.start_us,
+			 e.end_us - e.start_us, e.port,
+			 I2C_GET_ADDR(e.addr_flags));
+		if (e.out_size) {
+			ccprintf(" wr");
+			for (i = 0; i < out_copy; i++)
+				ccprintf(" 0x%02X", e.data[i]);
+			if (e.out_size > out_copy)
+				ccprintf(" ..(%d)", e.out_size);
+		}
+		if (e.in_size) {
+			ccprintf(" rd");
+			for (i = 0; i < in_copy; i++)
+				ccprintf(" 0x%02X", e.data[out_copy + i]);
+			if (e.in_size > in_copy)
+				ccprintf(" ..(%d)", e.in_size);
+		}
+		if (e.result)
+			ccprintf(" err %d", e.result);
+		ccprintf("\n");
+		cflush();
+	}
+
+	return EC_SUCCESS;
 }
 
 static int command_i2ctrace_list(void)
@@ -173,6 +285,9 @@ static int command_i2ctrace(int argc, char **argv)
 	if (!strcasecmp(argv[1], "list") && argc == 2)
 		return command_i2ctrace_list();
 
+	if (!strcasecmp(argv[1], "dump") && argc == 2)
+		return command_i2ctrace_dump();
+
 	if (argc < 3)
 		return EC_ERROR_PARAM_COUNT;
 
@@ -206,6 +321,6 @@ static int command_i2ctrace(int argc, char **argv)
 }
 DECLARE_CONSOLE_COMMAND(i2ctrace,
 			command_i2ctrace,
-			"[list | disable <id> | enable <port> <address> | "
+			"[list | dump | disable <id> | enable <port> <address> | "
 			"enable <port> <address-low> <address-high>]",
 			"Trace I2C transactions");
@@ -1332,16 +1332,15 @@ DECLARE_CONSOLE_COMMAND(8042, command_8042,
  *     - KB/TP disabled
  *     - KB/TP IRQ enabled
  */
+static struct kb_state kb_preserved;
+DECLARE_PRESERVED_STATE(kb_8042, KB_SYSJUMP_TAG, KB_HOOK_VERSION,
+			kb_preserved);
+
 static void keyboard_preserve_state(void)
 {
-	struct kb_state state;
-
-	state.codeset = scancode_set;
-	state.ctlram = controller_ram[0];
-	state.keystroke_enabled = keystroke_enabled;
-
-	system_add_jump_tag(KB_SYSJUMP_TAG, KB_HOOK_VERSION,
-			    sizeof(state), &state);
+	kb_preserved.codeset = scancode_set;
+	kb_preserved.ctlram = controller_ram[0];
+	kb_preserved.keystroke_enabled = keystroke_enabled;
 }
 DECLARE_HOOK(HOOK_SYSJUMP, keyboard_preserve_state, HOOK_PRIO_DEFAULT);
 
@@ -1350,16 +1349,11 @@ DECLARE_HOOK(HOOK_SYSJUMP, keyboard_preserve_state, HOOK_PRIO_DEFAULT);
  */
 static void keyboard_restore_state(void)
 {
-	const struct kb_state *prev;
-	int version, size;
-
-	prev = (const struct kb_state *)system_get_jump_tag(KB_SYSJUMP_TAG,
-							    &version, &size);
-	if (prev && version == KB_HOOK_VERSION && size == sizeof(*prev)) {
+	if (system_preserved_state_restored(KB_SYSJUMP_TAG)) {
 		/* Coming back from a sysjump, so restore settings. */
-		scancode_set = prev->codeset;
-		update_ctl_ram(0, prev->ctlram);
-		keystroke_enabled = prev->keystroke_enabled;
+		scancode_set = kb_preserved.codeset;
+		update_ctl_ram(0, kb_preserved.ctlram);
+		keystroke_enabled = kb_preserved.keystroke_enabled;
 	}
 }
 DECLARE_HOOK(HOOK_INIT, keyboard_restore_state, HOOK_PRIO_DEFAULT);
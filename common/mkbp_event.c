@@ -319,11 +319,19 @@ static int take_event_if_set(uint8_t event_type)
 	return taken;
 }
 
-static enum ec_status mkbp_get_next_event(struct host_cmd_handler_args *args)
+/**
+ * Take the next pending event.
+ *
+ * @param type		Set to the event type
+ * @param data		Filled with the event data (up to 16 bytes)
+ * @param size		Set to the size of the event data
+ * @return EC_RES_SUCCESS, EC_RES_UNAVAILABLE if there is no event pending or
+ *	   EC_RES_ERROR.
+ */
+static enum ec_status take_next_event(uint8_t *type, uint8_t *data, int *size)
 {
 	static int last;
 	int i, evt;
-	uint8_t *resp = args->response;
 	const struct mkbp_event_source *src;
 
 	int data_size = -EC_ERROR_BUSY;
@@ -356,7 +364,7 @@ static enum ec_status mkbp_get_next_event(struct host_cmd_handler_args *args)
 		if (src == __mkbp_evt_srcs_end)
 			return EC_RES_ERROR;
 
-		resp[0] = evt; /* Event type */
+		*type = evt;
 
 		/*
 		 * get_data() can return -EC_ERROR_BUSY which indicates that the
@@ -366,7 +374,7 @@ static enum ec_status mkbp_get_next_event(struct host_cmd_handler_args *args)
 		 * event instead.  Therefore, we have to service that button
 		 * event first.
 		 */
-		data_size = src->get_data(resp + 1);
+		data_size = src->get_data(data);
 		if (data_size == -EC_ERROR_BUSY) {
 			mutex_lock(&state.lock);
 			state.events |= BIT(evt);
@@ -374,19 +382,83 @@ static enum ec_status mkbp_get_next_event(struct host_cmd_handler_args *args)
 		}
 	} while (data_size == -EC_ERROR_BUSY);
 
+	if (data_size < 0)
+		return EC_RES_ERROR;
+	*size = data_size;
+
+	return EC_RES_SUCCESS;
+}
+
+/* Drain as many events as fit in the response (version 3) */
+static enum ec_status mkbp_get_next_events(struct host_cmd_handler_args *args)
+{
+	struct ec_response_get_next_event_v3 *r = args->response;
+	struct ec_mkbp_event_record *rec;
+	const int max_rec = sizeof(*rec) +
+			    sizeof(union ec_response_get_next_data_v1);
+	int used = sizeof(*r);
+	uint32_t pending;
+	int size, rv;
+
+	if (args->response_max < sizeof(*r) + max_rec)
+		return EC_RES_RESPONSE_TOO_BIG;
+
+	r->count = 0;
+	while (args->response_max - used >= max_rec && r->count < UINT8_MAX) {
+		rec = (struct ec_mkbp_event_record *)
+			((uint8_t *)args->response + used);
+		rv = take_next_event(&rec->event_type, rec->data, &size);
+		if (rv != EC_RES_SUCCESS) {
+			/* Report what we already have, the rest can wait */
+			if (r->count)
+				break;
+			return rv;
+		}
+		rec->size = size;
+		used += sizeof(*rec) + size;
+		r->count++;
+	}
+
+	set_inactive_if_no_events();
+
+	r->pending_types = 0;
+	mutex_lock(&state.lock);
+	for (pending = state.events; pending; pending &= pending - 1)
+		r->pending_types++;
+	mutex_unlock(&state.lock);
+
+	args->response_size = used;
+
+	return EC_RES_SUCCESS;
+}
+
+static enum ec_status mkbp_get_next_event(struct host_cmd_handler_args *args)
+{
+	uint8_t *resp = args->response;
+	int data_size;
+	int rv;
+
+	if (args->version >= 3)
+		return mkbp_get_next_events(args);
+
+	rv = take_next_event(&resp[0], resp + 1, &data_size);
+	if (rv == EC_RES_UNAVAILABLE)
+		return rv;
+
 	/* If there are no more events and we support the "more" flag, set it */
 	if (!set_inactive_if_no_events() && args->version >= 2)
 		resp[0] |= EC_MKBP_HAS_MORE_EVENTS;
 
-	if (data_size < 0)
-		return EC_RES_ERROR;
+	if (rv != EC_RES_SUCCESS)
+		return rv;
 	args->response_size = 1 + data_size;
 
 	return EC_RES_SUCCESS;
 }
 DECLARE_HOST_COMMAND(EC_CMD_GET_NEXT_EVENT,
 		     mkbp_get_next_event,
-		     EC_VER_MASK(0) | EC_VER_MASK(1) | EC_VER_MASK(2));
+		     EC_VER_MASK(0) | EC_VER_MASK(1) | EC_VER_MASK(2) |
+		     EC_VER_MASK(3));
 
 #ifdef CONFIG_MKBP_HOST_EVENT_WAKEUP_MASK
 #ifdef CONFIG_MKBP_USE_HOST_EVENT
@@ -20,6 +20,8 @@ BUILD_ASSERT(sizeof(struct ec_response_pd_log) ==
 BUILD_ASSERT(PD_LOG_SIZE_MASK == EVENT_LOG_SIZE_MASK);
 BUILD_ASSERT(PD_LOG_TIMESTAMP_SHIFT == EVENT_LOG_TIMESTAMP_SHIFT);
 BUILD_ASSERT(PD_EVENT_NO_ENTRY == EVENT_LOG_NO_ENTRY);
+BUILD_ASSERT(PD_LOG_ENTRY_SIZE(PD_LOG_SIZE_MASK) ==
+	     EVENT_LOG_ENTRY_SIZE(EVENT_LOG_SIZE_MASK));
 
 void pd_log_event(uint8_t type, uint8_t size_port,
 		  uint16_t data, void *payload)
@@ -57,25 +59,77 @@ void pd_log_recv_vdm(int port, int cnt, uint32_t *payload)
 	}
 }
 
+/*
+ * Ask the connected accessories for their log entries.
+ *
+ * Returns EC_RES_BUSY if the host should retry later, else EC_RES_SUCCESS
+ * with incoming_logs telling whether new entries were queued.
+ */
+static enum ec_status fetch_acc_log_entries(void)
+{
+	int i, res;
+
+	incoming_logs = 0;
+	for (i = 0; i < board_get_usb_pd_port_count(); ++i) {
+		/* only accessories who knows Google logging format */
+		if (pd_get_identity_vid(i) != USB_VID_GOOGLE)
+			continue;
+		res = pd_fetch_acc_log_entry(i);
+		if (res == EC_RES_BUSY) /* host should retry */
+			return EC_RES_BUSY;
+	}
+
+	return EC_RES_SUCCESS;
+}
+
+/* Drain as many entries as fit in the response buffer */
+static enum ec_status hc_pd_get_log_entries(struct host_cmd_handler_args *args)
+{
+	struct ec_response_pd_log_v1 *r = args->response;
+	int count, size;
+
+	BUILD_ASSERT(CONFIG_EVENT_LOG_SIZE / sizeof(struct event_log_entry) <=
+		     UINT8_MAX);
+
+	/* make sure the largest entry can always go through */
+	if (args->response_max <
+	    sizeof(*r) + EVENT_LOG_ENTRY_SIZE(EVENT_LOG_SIZE_MASK))
+		return EC_RES_RESPONSE_TOO_BIG;
+
+dequeue_retry:
+	size = log_dequeue_events(r->entries, args->response_max - sizeof(*r),
+				  &count);
+	/* if the MCU log no longer has entries, try connected accessories */
+	if (!count) {
+		if (fetch_acc_log_entries() == EC_RES_BUSY)
+			return EC_RES_BUSY;
+		/* we have received new entries from an accessory */
+		if (incoming_logs)
+			goto dequeue_retry;
+	}
+
+	r->dropped = log_take_dropped();
+	r->count = count;
+	memset(r->reserved, 0, sizeof(r->reserved));
+	args->response_size = sizeof(*r) + size;
+
+	return EC_RES_SUCCESS;
+}
+
 /* we are a PD MCU/EC, send back the events to the host */
 static enum ec_status hc_pd_get_log_entry(struct host_cmd_handler_args *args)
 {
 	struct ec_response_pd_log *r = args->response;
 
+	if (args->version == 1)
+		return hc_pd_get_log_entries(args);
+
 dequeue_retry:
 	args->response_size = log_dequeue_event((struct event_log_entry *)r);
 	/* if the MCU log no longer has entries, try connected accessories */
 	if (r->type == PD_EVENT_NO_ENTRY) {
-		int i, res;
-		incoming_logs = 0;
-		for (i = 0; i < board_get_usb_pd_port_count(); ++i) {
-			/* only accessories who knows Google logging format */
-			if (pd_get_identity_vid(i) != USB_VID_GOOGLE)
-				continue;
-			res = pd_fetch_acc_log_entry(i);
-			if (res == EC_RES_BUSY) /* host should retry */
-				return EC_RES_BUSY;
-		}
+		if (fetch_acc_log_entries() == EC_RES_BUSY)
+			return EC_RES_BUSY;
 		/* we have received new entries from an accessory */
 		if (incoming_logs)
 			goto dequeue_retry;
@@ -86,7 +140,7 @@ dequeue_retry:
 }
 DECLARE_HOST_COMMAND(EC_CMD_PD_GET_LOG_ENTRY,
 		     hc_pd_get_log_entry,
-		     EC_VER_MASK(0));
+		     EC_VER_MASK(0) | EC_VER_MASK(1));
 
 static enum ec_status hc_pd_write_log_entry(struct host_cmd_handler_args *args)
 {
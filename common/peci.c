@@ -8,8 +8,19 @@
 #include "chipset.h"
 #include "console.h"
 #include "peci.h"
+#include "task.h"
 #include "util.h"
 
+static struct mutex peci_mutex;
+
+void peci_lock(int lock)
+{
+	if (lock)
+		mutex_lock(&peci_mutex);
+	else
+		mutex_unlock(&peci_mutex);
+}
+
 static int peci_get_cpu_temp(int *cpu_temp)
 {
 	int rv;
@@ -24,7 +35,9 @@ static int peci_get_cpu_temp(int *cpu_temp)
 		.timeout_us = PECI_GET_TEMP_TIMEOUT_US,
 	};
 
+	peci_lock(1);
 	rv = peci_transaction(&peci);
+	peci_lock(0);
 	if (rv)
 		return rv;
 
@@ -93,6 +106,7 @@ static int peci_cmd(int argc, char **argv)
 
 	int param;
 	char *e;
+	int rv;
 
 	if ((argc < 6) || (argc > 8))
 		return EC_ERROR_PARAM_COUNT;
@@ -146,7 +160,10 @@ static int peci_cmd(int argc, char **argv)
 		peci.w_len = 0x00;
 	}
 
-	if (peci_transaction(&peci)) {
+	peci_lock(1);
+	rv = peci_transaction(&peci);
+	peci_lock(0);
+	if (rv) {
 		ccprintf("PECI transaction error\n");
 		return EC_ERROR_UNKNOWN;
 	}
@@ -42,6 +42,48 @@ static int ge_mod(const struct rsa_public_key *key, const uint32_t *a)
 	return 1;  /* equal */
 }
 
+/*
+ * One step of the multiply-accumulate kernels below: word j of t[] gets
+ * m * b[j] plus the running carry, the high half becomes the next carry.
+ */
+#define MAC_STEP(t, m, b, j, A) do {				\
+		A = mulaa32(m, (b)[j], (t)[j], (A) >> 32);	\
+		(t)[j] = (uint32_t)(A);				\
+	} while (0)
+
+/**
+ * t[] += m * b[], len words; returns the carry out of the top word.
+ *
+ * Unrolled four words at a time, RSANUMWORDS is always a multiple of 4 so
+ * the tail loop only runs for the short rows of the squaring.
+ */
+static uint32_t mul_add_row(uint32_t *t, uint32_t m, const uint32_t *b,
+			    int len)
+{
+	uint64_t A = 0;
+
+	for (; len >= 4; len -= 4, t += 4, b += 4) {
+		MAC_STEP(t, m, b, 0, A);
+		MAC_STEP(t, m, b, 1, A);
+		MAC_STEP(t, m, b, 2, A);
+		MAC_STEP(t, m, b, 3, A);
+	}
+	for (; len > 0; len--, t++, b++)
+		MAC_STEP(t, m, b, 0, A);
+
+	return A >> 32;
+}
+
+/*
+ * One word of mont_mul_add(): accumulate a * b[i] into c[i], add the
+ * reduction term and shift the result down one word.
+ */
+#define MONT_STEP(i) do {						\
+		A = mulaa32(a, b[i], c[i], A >> 32);			\
+		B = mulaa32(d0, key->n[i], A, B >> 32);			\
+		c[(i) - 1] = (uint32_t)B;				\
+	} while (0)
+
 /**
  * Montgomery c[] += a * b[] / R % mod
  */
@@ -55,11 +97,14 @@ static void mont_mul_add(const struct rsa_public_key *key,
 	uint64_t B = mula32(d0, key->n[0], A);
 	uint32_t i;
 
-	for (i = 1; i < RSANUMWORDS; ++i) {
-		A = mulaa32(a, b[i], c[i], A >> 32);
-		B = mulaa32(d0, key->n[i], A, B >> 32);
-		c[i - 1] = (uint32_t)B;
+	for (i = 1; i + 4 <= RSANUMWORDS; i += 4) {
+		MONT_STEP(i);
+		MONT_STEP(i + 1);
+		MONT_STEP(i + 2);
+		MONT_STEP(i + 3);
 	}
+	for (; i < RSANUMWORDS; ++i)
+		MONT_STEP(i);
 
 	A = (A >> 32) + (B >> 32);
 
@@ -69,62 +114,106 @@ static void mont_mul_add(const struct rsa_public_key *key,
 		sub_mod(key, c);
 }
 
-#ifdef CONFIG_RSA_EXPONENT_3
 /**
- * Montgomery c[] += 0 * b[] / R % mod
+ * Montgomery c[] = a[] * b[] / R % mod
  */
-static void mont_mul_add_0(const struct rsa_public_key *key,
-			 uint32_t *c,
-			 const uint32_t *b)
+static void mont_mul(const struct rsa_public_key *key,
+		     uint32_t *c,
+		     const uint32_t *a,
+		     const uint32_t *b)
 {
-	uint32_t d0 = c[0] * key->n0inv;
-	uint64_t B = mula32(d0, key->n[0], c[0]);
 	uint32_t i;
+	for (i = 0; i < RSANUMWORDS; ++i)
+		c[i] = 0;
 
-	for (i = 1; i < RSANUMWORDS; ++i) {
-		B = mulaa32(d0, key->n[i], c[i], B >> 32);
-		c[i - 1] = (uint32_t)B;
-	}
-
-	c[i - 1] = B >> 32;
+	for (i = 0; i < RSANUMWORDS; ++i)
+		mont_mul_add(key, c, a[i], b);
 }
 
-/* Montgomery c[] = a[] * 1 / R % key. */
-static void mont_mul_1(const struct rsa_public_key *key,
-		       uint32_t *c,
-		       const uint32_t *a)
+/**
+ * Montgomery c[] = a[] * a[] / R % mod
+ *
+ * Each cross product a[i] * a[j] is only computed once and doubled, so a
+ * squaring costs about 3/4 of mont_mul().
+ *
+ * @param t	Scratch space, 2 x RSANUMWORDS words; must not overlap a[]
+ *		or c[]. c[] may be the same buffer as a[].
+ */
+static void mont_sqr(const struct rsa_public_key *key,
+		     uint32_t *c,
+		     const uint32_t *a,
+		     uint32_t *t)
 {
+	uint64_t A;
+	uint32_t carry = 0, top = 0;
+	uint32_t lo, hi;
 	int i;
 
+	/* t[] = sum of a[i] * a[j] for i < j. */
 	for (i = 0; i < RSANUMWORDS; ++i)
-		c[i] = 0;
+		t[i] = 0;
+	for (i = 0; i < RSANUMWORDS; ++i)
+		t[i + RSANUMWORDS] = mul_add_row(t + 2 * i + 1, a[i],
+						 a + i + 1,
+						 RSANUMWORDS - i - 1);
+
+	/* Double it and add the squares on the diagonal. */
+	for (i = 0; i < RSANUMWORDS; ++i) {
+		lo = (t[2 * i] << 1) | top;
+		top = t[2 * i] >> 31;
+		hi = (t[2 * i + 1] << 1) | top;
+		top = t[2 * i + 1] >> 31;
+
+		A = mulaa32(a[i], a[i], lo, carry);
+		t[2 * i] = (uint32_t)A;
+		A = (uint64_t)hi + (A >> 32);
+		t[2 * i + 1] = (uint32_t)A;
+		carry = A >> 32;
+	}
+
+	/* Reduce: clear one low word per row, carries ripple into top. */
+	top = 0;
+	for (i = 0; i < RSANUMWORDS; ++i) {
+		carry = mul_add_row(t + i, t[i] * key->n0inv, key->n,
+				    RSANUMWORDS);
+		A = (uint64_t)t[i + RSANUMWORDS] + carry + top;
+		t[i + RSANUMWORDS] = (uint32_t)A;
+		top = A >> 32;
+	}
+
+	for (i = 0; i < RSANUMWORDS; ++i)
+		c[i] = t[i + RSANUMWORDS];
 
-	mont_mul_add(key, c, 1, a);
-	for (i = 1; i < RSANUMWORDS; ++i)
-		mont_mul_add_0(key, c, a);
+	if (top)
+		sub_mod(key, c);
 }
-#endif
 
 /**
- * Montgomery c[] = a[] * b[] / R % mod
+ * Convert from big endian byte array to little endian word array.
  */
-static void mont_mul(const struct rsa_public_key *key,
-		     uint32_t *c,
-		     const uint32_t *a,
-		     const uint32_t *b)
+static void load_words(uint32_t *a, const uint8_t *in)
 {
-	uint32_t i;
-	for (i = 0; i < RSANUMWORDS; ++i)
-		c[i] = 0;
+	int i;
 
-	for (i = 0; i < RSANUMWORDS; ++i)
-		mont_mul_add(key, c, a[i], b);
+	for (i = 0; i < RSANUMWORDS; ++i) {
+		uint32_t tmp =
+			(in[((RSANUMWORDS - 1 - i) * 4) + 0] << 24) |
+			(in[((RSANUMWORDS - 1 - i) * 4) + 1] << 16) |
+			(in[((RSANUMWORDS - 1 - i) * 4) + 2] << 8) |
+			(in[((RSANUMWORDS - 1 - i) * 4) + 3] << 0);
+		a[i] = tmp;
+	}
 }
 
 /**
  * In-place public exponentiation.
  * Exponent depends on the configuration (65537 (default), or 3).
  *
+ * The only per-key constants needed, n0inv and RR = R^2 mod n, are computed
+ * when the key is generated and come with it. Both exponents are a chain of
+ * squarings followed by one multiply by the plain (not Montgomery) input,
+ * which also takes the result out of the Montgomery domain for free.
+ *
  * @param key		Key to use in signing
  * @param inout		Input and output big-endian byte array
  * @param workbuf32	Work buffer; caller must verify this is
@@ -134,35 +223,24 @@ static void mod_pow(const struct rsa_public_key *key, uint8_t *inout,
 		    uint32_t *workbuf32)
 {
 	uint32_t *a = workbuf32;
-	uint32_t *a_r = a + RSANUMWORDS;
-	uint32_t *aa_r = a_r + RSANUMWORDS;
-	uint32_t *aaa = aa_r;  /* Re-use location. */
+	uint32_t *t = workbuf32;  /* mont_sqr() scratch, overlaps a and aaa */
+	uint32_t *aaa = a + RSANUMWORDS;
+	uint32_t *a_r = aaa + RSANUMWORDS;
 	int i;
 
-	/* Convert from big endian byte array to little endian word array. */
-	for (i = 0; i < RSANUMWORDS; ++i) {
-		uint32_t tmp =
-			(inout[((RSANUMWORDS - 1 - i) * 4) + 0] << 24) |
-			(inout[((RSANUMWORDS - 1 - i) * 4) + 1] << 16) |
-			(inout[((RSANUMWORDS - 1 - i) * 4) + 2] << 8) |
-			(inout[((RSANUMWORDS - 1 - i) * 4) + 3] << 0);
-		a[i] = tmp;
-	}
+	load_words(a, inout);
 
-	/* TODO(drinkcat): This operation could be precomputed to save time. */
 	mont_mul(key, a_r, a, key->rr);  /* a_r = a * RR / R mod M */
 #ifdef CONFIG_RSA_EXPONENT_3
-	mont_mul(key, aa_r, a_r, a_r);
-	mont_mul(key, a, aa_r, a_r);
-	mont_mul_1(key, aaa, a);
+	mont_sqr(key, a_r, a_r, t);	 /* a_r = a^2 * R mod M */
 #else
 	/* Exponent 65537 */
-	for (i = 0; i < 16; i += 2) {
-		mont_mul(key, aa_r, a_r, a_r); /* aa_r = a_r * a_r / R mod M */
-		mont_mul(key, a_r, aa_r, aa_r);/* a_r = aa_r * aa_r / R mod M */
-	}
-	mont_mul(key, aaa, a_r, a);  /* aaa = a_r * a / R mod M */
+	for (i = 0; i < 16; ++i)
+		mont_sqr(key, a_r, a_r, t); /* a_r = a^(2^16) * R mod M */
 #endif
+	/* The squarings used a as scratch space, reload it. */
+	load_words(a, inout);
+	mont_mul(key, aaa, a_r, a);  /* aaa = a_r * a / R mod M */
 
 	/* Make sure aaa < mod; aaa is at most 1x mod too large. */
 	if (ge_mod(key, aaa))
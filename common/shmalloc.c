@@ -8,7 +8,10 @@
 #include <stdint.h>
 
 #include "common.h"
+#include "console.h"
+#include "ec_commands_private.h"
 #include "hooks.h"
+#include "host_command.h"
 #include "link_defs.h"
 #include "shared_mem.h"
 #include "system.h"
@@ -37,18 +40,155 @@ TEST_GLOBAL struct shm_buffer *allocced_buf_chain;
 /* The size of the biggest ever allocated buffer. */
 static int max_allocated_size;
 
+/* Bytes currently allocated from the chain, and the most ever allocated. */
+static size_t chain_allocated;
+static size_t chain_high_water;
+
+#ifdef CONFIG_MALLOC_SLAB
+/*
+ * Size-class slabs. Class i holds CONFIG_MALLOC_SLAB_OBJS objects of
+ * SLAB_OBJ_SIZE(i) bytes. All classes live in one contiguous arena taken from
+ * the top of the pool at init, so a released pointer is identified by a range
+ * check alone. Free objects are linked through their first word.
+ */
+#define SLAB_MIN_SHIFT 5
+#define SLAB_CLASSES EC_SHARED_MEM_SLAB_MAX_CLASSES
+#define SLAB_OBJ_SIZE(i) (1 << (SLAB_MIN_SHIFT + (i)))
+#define SLAB_MAX_SIZE SLAB_OBJ_SIZE(SLAB_CLASSES - 1)
+/* Sizes double per class, so the classes below i add up to this. */
+#define SLAB_CLASS_OFFSET(i) \
+	(CONFIG_MALLOC_SLAB_OBJS * (SLAB_OBJ_SIZE(i) - SLAB_OBJ_SIZE(0)))
+#define SLAB_ARENA_SIZE SLAB_CLASS_OFFSET(SLAB_CLASSES)
+
+BUILD_ASSERT(CONFIG_MALLOC_SLAB_OBJS <= UINT8_MAX);
+
+struct slab_obj {
+	struct slab_obj *next;
+};
+
+static struct {
+	struct slab_obj *free_list;
+	uint8_t in_use;
+	uint8_t high_water;
+	uint32_t fallbacks;
+} slabs[SLAB_CLASSES];
+
+/* NULL if the pool was too small to host the slabs. */
+static uint8_t *slab_arena;
+
+/* Bytes slab_init() takes from a pool of the given size. */
+static size_t slab_arena_size(size_t pool_size)
+{
+	if (pool_size < SLAB_ARENA_SIZE + 2 * CONFIG_SHAREDMEM_MINIMUM_SIZE)
+		return 0;
+	return SLAB_ARENA_SIZE;
+}
+
+/* Called with the free chain holding the whole pool. */
+static void slab_init(void)
+{
+	struct slab_obj *obj;
+	int i, j;
+
+	if (!slab_arena_size(free_buf_chain->buffer_size))
+		return;
+
+	free_buf_chain->buffer_size -= SLAB_ARENA_SIZE;
+	slab_arena = (uint8_t *)free_buf_chain + free_buf_chain->buffer_size;
+
+	for (i = 0; i < SLAB_CLASSES; i++) {
+		slabs[i].free_list = NULL;
+		for (j = CONFIG_MALLOC_SLAB_OBJS - 1; j >= 0; j--) {
+			obj = (struct slab_obj *)(slab_arena +
+				SLAB_CLASS_OFFSET(i) + j * SLAB_OBJ_SIZE(i));
+			obj->next = slabs[i].free_list;
+			slabs[i].free_list = obj;
+		}
+	}
+}
+
+/* Called with the mutex lock acquired. */
+static void *slab_acquire(int size)
+{
+	struct slab_obj *obj;
+	int i;
+
+	if (!slab_arena || size > SLAB_MAX_SIZE)
+		return NULL;
+
+	i = size <= SLAB_OBJ_SIZE(0) ? 0 :
+		__fls(size - 1) + 1 - SLAB_MIN_SHIFT;
+
+	obj = slabs[i].free_list;
+	if (!obj) {
+		slabs[i].fallbacks++;
+		return NULL;
+	}
+
+	slabs[i].free_list = obj->next;
+	if (++slabs[i].in_use > slabs[i].high_water)
+		slabs[i].high_water = slabs[i].in_use;
+
+	return obj;
+}
+
+/*
+ * Called with the mutex lock acquired. Returns 0 if the pointer does not
+ * belong to the slab arena and should be released to the chain.
+ */
+static int slab_release(void *ptr)
+{
+	struct slab_obj *obj = ptr;
+	uintptr_t offset;
+	int i;
+
+	if (!slab_arena || (uint8_t *)ptr < slab_arena ||
+	    (uint8_t *)ptr >= slab_arena + SLAB_ARENA_SIZE)
+		return 0;
+
+	offset = (uint8_t *)ptr - slab_arena;
+	for (i = SLAB_CLASSES - 1; offset < SLAB_CLASS_OFFSET(i); i--)
+		;
+
+	obj->next = slabs[i].free_list;
+	slabs[i].free_list = obj;
+	slabs[i].in_use--;
+
+	return 1;
+}
+
+#ifdef TEST_SHMALLOC
+int shared_mem_is_slab(const void *ptr)
+{
+	return slab_arena && (const uint8_t *)ptr >= slab_arena &&
+		(const uint8_t *)ptr < slab_arena + SLAB_ARENA_SIZE;
+}
+#endif
+#else
+static inline size_t slab_arena_size(size_t pool_size) { return 0; }
+static inline void slab_init(void) {}
+static inline void *slab_acquire(int size) { return NULL; }
+static inline int slab_release(void *ptr) { return 0; }
+#endif /* CONFIG_MALLOC_SLAB */
+
+/*
+ * Use all the RAM we can. The shared memory buffer is the last thing
+ * allocated from the start of RAM, so we can use everything up to the
+ * jump data at the end of RAM.
+ */
+static size_t shared_mem_pool_size(void)
+{
+	return system_usable_ram_end() - (uintptr_t)__shared_mem_buf;
+}
+
 static void shared_mem_init(void)
 {
-	/*
-	 * Use all the RAM we can. The shared memory buffer is the last thing
-	 * allocated from the start of RAM, so we can use everything up to the
-	 * jump data at the end of RAM.
-	 */
 	free_buf_chain = (struct shm_buffer *)__shared_mem_buf;
 	free_buf_chain->next_buffer = NULL;
 	free_buf_chain->prev_buffer = NULL;
-	free_buf_chain->buffer_size = system_usable_ram_end() -
-		(uintptr_t)__shared_mem_buf;
+	free_buf_chain->buffer_size = shared_mem_pool_size();
+
+	slab_init();
 }
 DECLARE_HOOK(HOOK_INIT, shared_mem_init, HOOK_PRIO_FIRST);
 
@@ -95,6 +235,7 @@ static void do_release(struct shm_buffer *ptr)
 	 * for quick reference.
 	 */
 	released_size = ptr->buffer_size;
+	chain_allocated -= released_size;
 	if (!free_buf_chain) {
 		/*
 		 * All memory had been allocated - this buffer is going to be
@@ -293,6 +434,15 @@ int shared_mem_size(void)
 
 	mutex_lock(&shmem_lock);
 
+	/*
+	 * Before init (e.g. from chip clock setup) there is no chain yet;
+	 * report what the chain will hold once the slabs are carved out.
+	 */
+	if (!free_buf_chain && !allocced_buf_chain) {
+		max_available = shared_mem_pool_size();
+		max_available -= slab_arena_size(max_available);
+	}
+
 	/* Find the maximum available buffer size. */
 	pfb = free_buf_chain;
 	while (pfb) {
@@ -317,10 +467,23 @@ int shared_mem_acquire(int size, char **dest_ptr)
 	if (in_interrupt_context())
 		return EC_ERROR_INVAL;
 
-	if (!free_buf_chain)
+	mutex_lock(&shmem_lock);
+
+	if (size > max_allocated_size)
+		max_allocated_size = size;
+
+	/* Small requests are served in O(1) by the slabs when possible. */
+	*dest_ptr = slab_acquire(size);
+	if (*dest_ptr) {
+		mutex_unlock(&shmem_lock);
+		return EC_SUCCESS;
+	}
+
+	if (!free_buf_chain) {
+		mutex_unlock(&shmem_lock);
 		return EC_ERROR_BUSY;
+	}
 
-	mutex_lock(&shmem_lock);
 	rv = do_acquire(size, &new_buf);
 	if (rv == EC_SUCCESS) {
 		new_buf->next_buffer = allocced_buf_chain;
@@ -332,8 +495,9 @@ int shared_mem_acquire(int size, char **dest_ptr)
 
 		*dest_ptr = (void *)(new_buf + 1);
 
-		if (size > max_allocated_size)
-			max_allocated_size = size;
+		chain_allocated += new_buf->buffer_size;
+		if (chain_allocated > chain_high_water)
+			chain_high_water = chain_allocated;
 	}
 	mutex_unlock(&shmem_lock);
 
@@ -346,44 +510,88 @@ void shared_mem_release(void *ptr)
 		return;
 
 	mutex_lock(&shmem_lock);
-	do_release((struct shm_buffer *)ptr - 1);
+	if (!slab_release(ptr))
+		do_release((struct shm_buffer *)ptr - 1);
 	mutex_unlock(&shmem_lock);
 }
 
-#ifdef CONFIG_CMD_SHMEM
-
-static int command_shmem(int argc, char **argv)
+static void shared_mem_get_info(struct ec_response_shared_mem_info *r)
 {
-	size_t allocated_size;
-	size_t free_size;
-	size_t max_free;
 	struct shm_buffer *buf;
 
-	allocated_size = free_size = max_free = 0;
+	memset(r, 0, sizeof(*r));
 
 	mutex_lock(&shmem_lock);
 
 	for (buf = free_buf_chain; buf; buf = buf->next_buffer) {
-		size_t buf_room;
-
-		buf_room = buf->buffer_size;
-
-		free_size += buf_room;
-		if (buf_room > max_free)
-			max_free = buf_room;
+		r->free += buf->buffer_size;
+		r->free_buffers++;
+		if (buf->buffer_size > r->max_free)
+			r->max_free = buf->buffer_size;
 	}
 
-	for (buf = allocced_buf_chain; buf;
-	     buf = buf->next_buffer)
-		allocated_size += buf->buffer_size;
+	r->allocated = chain_allocated;
+	r->total = r->allocated + r->free;
+	r->high_water = chain_high_water;
+	r->max_allocated = max_allocated_size;
+
+#ifdef CONFIG_MALLOC_SLAB
+	if (slab_arena) {
+		int i;
+
+		r->slab_classes = SLAB_CLASSES;
+		for (i = 0; i < SLAB_CLASSES; i++) {
+			r->slab[i].obj_size = SLAB_OBJ_SIZE(i);
+			r->slab[i].objs = CONFIG_MALLOC_SLAB_OBJS;
+			r->slab[i].in_use = slabs[i].in_use;
+			r->slab[i].high_water = slabs[i].high_water;
+			r->slab[i].fallbacks = slabs[i].fallbacks;
+		}
+	}
+#endif
 
 	mutex_unlock(&shmem_lock);
+}
+
+static enum ec_status
+hc_shared_mem_info(struct host_cmd_handler_args *args)
+{
+	struct ec_response_shared_mem_info *r = args->response;
+
+	shared_mem_get_info(r);
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_SHARED_MEM_INFO,
+		     hc_shared_mem_info,
+		     EC_VER_MASK(0));
+
+#ifdef CONFIG_CMD_SHMEM
+
+static int command_shmem(int argc, char **argv)
+{
+	struct ec_response_shared_mem_info info;
+	int i;
+
+	shared_mem_get_info(&info);
+
+	ccprintf("Total:         %6d\n", info.total);
+	ccprintf("Allocated:     %6d\n", info.allocated);
+	ccprintf("Free:          %6d\n", info.free);
+	ccprintf("Max free buf:  %6d\n", info.max_free);
+	ccprintf("Max allocated: %6d\n", info.max_allocated);
+	ccprintf("High water:    %6d\n", info.high_water);
+	/* Share of free memory unusable for a request of max free size */
+	ccprintf("Free bufs:     %6d (%d%% fragmented)\n", info.free_buffers,
+		 info.free ? 100 - info.max_free * 100 / info.free : 0);
+
+	for (i = 0; i < info.slab_classes; i++)
+		ccprintf("Slab %4d:     %d/%d used, max %d, fallbacks %d\n",
+			 info.slab[i].obj_size, info.slab[i].in_use,
+			 info.slab[i].objs, info.slab[i].high_water,
+			 info.slab[i].fallbacks);
 
-	ccprintf("Total:         %6zd\n", allocated_size + free_size);
-	ccprintf("Allocated:     %6zd\n", allocated_size);
-	ccprintf("Free:          %6zd\n", free_size);
-	ccprintf("Max free buf:  %6zd\n", max_free);
-	ccprintf("Max allocated: %6d\n", max_allocated_size);
 	return EC_SUCCESS;
 }
 DECLARE_SAFE_CONSOLE_COMMAND(shmem, command_shmem,
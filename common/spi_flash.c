@@ -8,11 +8,13 @@
 
 #include "common.h"
 #include "console.h"
+#include "hooks.h"
 #include "host_command.h"
 #include "shared_mem.h"
 #include "spi.h"
 #include "spi_flash.h"
 #include "spi_flash_reg.h"
+#include "task.h"
 #include "timer.h"
 #include "util.h"
 #include "watchdog.h"
@@ -29,20 +31,146 @@
  */
 #define SPI_FLASH_TIMEOUT_USEC	(800*MSEC)
 
+/*
+ * Long reads let other tasks run once they have been going for this long,
+ * rather than sleeping after every chunk.
+ */
+#define SPI_FLASH_READ_BUDGET_USEC	(10*MSEC)
+
+#ifdef CONFIG_SPI_FLASH_FAST_READ
+#if CONFIG_SPI_FLASH_FAST_READ == 1
+#define SPI_FLASH_FAST_READ_OPCODE	SPI_FLASH_FAST_READ
+#elif CONFIG_SPI_FLASH_FAST_READ == 2
+#define SPI_FLASH_FAST_READ_OPCODE	SPI_FLASH_FAST_READ_DUAL
+#elif CONFIG_SPI_FLASH_FAST_READ == 4
+#define SPI_FLASH_FAST_READ_OPCODE	SPI_FLASH_FAST_READ_QUAD
+#else
+#error "CONFIG_SPI_FLASH_FAST_READ must be 1, 2 or 4"
+#endif
+
+/* Largest fast read, so one transaction does not hold the bus too long */
+#define SPI_FLASH_READ_CHUNK	(16 * 1024)
+#else
+#define SPI_FLASH_READ_CHUNK	SPI_FLASH_MAX_READ_SIZE
+#endif
+
+/* Sector size, the smallest erase unit */
+#define SPI_FLASH_SECTOR_SIZE	(4 * 1024)
+
+/*
+ * Erase units, largest first. Typical erase times are from the W25Q
+ * datasheets; they are only used to choose between one block erase and a
+ * few sector erases.
+ */
+static const struct {
+	uint8_t opcode;
+	uint8_t kb;
+	uint16_t typ_ms;
+	uint32_t timeout_usec;
+} erase_units[] = {
+	{SPI_FLASH_ERASE_64KB, 64, 150, 2 * SPI_FLASH_TIMEOUT_USEC},
+	{SPI_FLASH_ERASE_32KB, 32, 120, SPI_FLASH_TIMEOUT_USEC},
+	{SPI_FLASH_ERASE_4KB, 4, 45, SPI_FLASH_TIMEOUT_USEC},
+};
+
 /* Internal buffer used by SPI flash driver */
 static uint8_t buf[SPI_FLASH_MAX_MESSAGE_SIZE];
 
+/* Sectors and pages left alone because they already held the right data */
+static struct {
+	uint32_t sectors_erased;
+	uint32_t sectors_skipped;
+	uint32_t pages_written;
+	uint32_t pages_skipped;
+} spi_flash_stats;
+
+/*
+ * Sectors erased since boot and not programmed since. Only these may be
+ * skipped as blank: a sector reading all 0xff after an erase that was cut
+ * short by a reset can still be marginal, so it is erased again.
+ */
+static uint32_t erased_map[DIV_ROUND_UP(CONFIG_FLASH_SIZE /
+					SPI_FLASH_SECTOR_SIZE, 32)];
+
+static void spi_flash_mark_erased(unsigned int offset, unsigned int bytes,
+				  int erased)
+{
+	unsigned int s;
+
+	for (s = offset / SPI_FLASH_SECTOR_SIZE;
+	     s < (offset + bytes) / SPI_FLASH_SECTOR_SIZE; s++) {
+		if (erased)
+			erased_map[s / 32] |= BIT(s % 32);
+		else
+			erased_map[s / 32] &= ~BIT(s % 32);
+	}
+}
+
+#ifdef CONFIG_FLASH_BACKGROUND_ERASE
+/* Interval between checks for the end of a background erase */
+#define SPI_FLASH_ERASE_POLL_USEC	(5*MSEC)
+
+/* Max time for the flash to suspend an erase (tSUS) */
+#define SPI_FLASH_SUSPEND_USEC		20
+
+/*
+ * Background erase. The flash erases one unit at a time on its own; the EC
+ * only issues each erase from a deferred call and polls for its end, and
+ * suspends it whenever flash has to be read in the meantime.
+ */
+static struct {
+	unsigned int start;
+	unsigned int offset;	/* Start of the unit being erased, or next */
+	unsigned int end;
+	unsigned int unit;	/* Size of the unit being erased, 0 if none */
+	int busy;
+	timestamp_t deadline;
+	timestamp_t suspended;
+	timestamp_t resumed;
+	void (*done)(int rv);
+} bg_erase;
+
+/* Serializes flash accesses with the background erase */
+static struct mutex bg_erase_lock;
+
+static void spi_flash_erase_step(void);
+DECLARE_DEFERRED(spi_flash_erase_step);
+
 /**
- * Waits for chip to finish current operation. Must be called after
- * erase/write operations to ensure successive commands are executed.
+ * Lock the flash for a program or erase operation.
  *
- * @return EC_SUCCESS or error on timeout
+ * @return EC_SUCCESS, or EC_ERROR_BUSY if a background erase is running.
  */
-int spi_flash_wait(void)
+static int spi_flash_lock_idle(void)
+{
+	mutex_lock(&bg_erase_lock);
+	if (bg_erase.busy) {
+		mutex_unlock(&bg_erase_lock);
+		return EC_ERROR_BUSY;
+	}
+	return EC_SUCCESS;
+}
+
+static void spi_flash_unlock(void)
+{
+	mutex_unlock(&bg_erase_lock);
+}
+#else
+static int spi_flash_lock_idle(void)
+{
+	return EC_SUCCESS;
+}
+
+static void spi_flash_unlock(void)
+{
+}
+#endif /* CONFIG_FLASH_BACKGROUND_ERASE */
+
+static int spi_flash_wait_timeout(uint32_t timeout_usec)
 {
 	timestamp_t timeout;
 
-	timeout.val = get_time().val + SPI_FLASH_TIMEOUT_USEC;
+	timeout.val = get_time().val + timeout_usec;
 	/* Wait until chip is not busy */
 	while (spi_flash_get_status1() & SPI_FLASH_SR1_BUSY) {
 		usleep(SPI_FLASH_SLEEP_USEC);
@@ -54,6 +182,17 @@ int spi_flash_wait(void)
 	return EC_SUCCESS;
 }
 
+/**
+ * Waits for chip to finish current operation. Must be called after
+ * erase/write operations to ensure successive commands are executed.
+ *
+ * @return EC_SUCCESS or error on timeout
+ */
+int spi_flash_wait(void)
+{
+	return spi_flash_wait_timeout(SPI_FLASH_TIMEOUT_USEC);
+}
+
 /**
  * Set the write enable latch
  */
@@ -99,15 +238,14 @@ uint8_t spi_flash_get_status2(void)
 }
 
 /**
- * Sets the SPI flash status registers (non-volatile bits only)
- * Pass reg2 == -1 to only set reg1.
+ * Set the status registers of SPI flash, which must not be busy.
  *
  * @param reg1 Status register 1
- * @param reg2 Status register 2 (optional)
+ * @param reg2 Status register 2, or -1 to only set reg1
  *
  * @return EC_SUCCESS, or non-zero if any error.
  */
-int spi_flash_set_status(int reg1, int reg2)
+static int spi_flash_set_status_idle(int reg1, int reg2)
 {
 	uint8_t cmd[3] = {SPI_FLASH_WRITE_SR, reg1, reg2};
 	int rv = EC_SUCCESS;
@@ -141,7 +279,27 @@ int spi_flash_set_status(int reg1, int reg2)
 }
 
 /**
- * Returns the content of SPI flash
+ * Sets the SPI flash status registers (non-volatile bits only)
+ * Pass reg2 == -1 to only set reg1.
+ *
+ * @param reg1 Status register 1
+ * @param reg2 Status register 2 (optional)
+ *
+ * @return EC_SUCCESS, or non-zero if any error.
+ */
+int spi_flash_set_status(int reg1, int reg2)
+{
+	int rv = spi_flash_lock_idle();
+
+	if (rv)
+		return rv;
+	rv = spi_flash_set_status_idle(reg1, reg2);
+	spi_flash_unlock();
+	return rv;
+}
+
+/**
+ * Read SPI flash, which must not be busy.
  *
  * @param buf_usr Buffer to write flash contents
  * @param offset Flash offset to start reading from
@@ -149,135 +307,529 @@ int spi_flash_set_status(int reg1, int reg2)
  *
  * @return EC_SUCCESS, or non-zero if any error.
  */
-int spi_flash_read(uint8_t *buf_usr, unsigned int offset, unsigned int bytes)
+static int spi_flash_read_idle(uint8_t *buf_usr, unsigned int offset,
+			       unsigned int bytes)
 {
-	int i, read_size, ret, spi_addr;
+	int i, read_size, spi_addr;
+	int ret = EC_SUCCESS;
+	timestamp_t deadline;
+#ifndef CONFIG_SPI_FLASH_FAST_READ
 	uint8_t cmd[4];
+#endif
+
 	if (offset + bytes > CONFIG_FLASH_SIZE)
 		return EC_ERROR_INVAL;
-	cmd[0] = SPI_FLASH_READ;
+
+	deadline.val = get_time().val + SPI_FLASH_READ_BUDGET_USEC;
 	for (i = 0; i < bytes; i += read_size) {
 		spi_addr = offset + i;
+		read_size = MIN((bytes - i), SPI_FLASH_READ_CHUNK);
+#ifdef CONFIG_SPI_FLASH_FAST_READ
+		ret = spi_transaction_fast_read(SPI_FLASH_DEVICE,
+			SPI_FLASH_FAST_READ_OPCODE,
+			CONFIG_SPI_FLASH_FAST_READ,
+			spi_addr,
+			buf_usr + i,
+			read_size);
+#else
+		cmd[0] = SPI_FLASH_READ;
 		cmd[1] = (spi_addr >> 16) & 0xFF;
 		cmd[2] = (spi_addr >> 8) & 0xFF;
 		cmd[3] = spi_addr & 0xFF;
-		read_size = MIN((bytes - i), SPI_FLASH_MAX_READ_SIZE);
 		ret = spi_transaction(SPI_FLASH_DEVICE,
 			cmd,
 			4,
 			buf_usr + i,
 			read_size);
+#endif
 		if (ret != EC_SUCCESS)
 			break;
-		msleep(1);
+
+		if (timestamp_expired(deadline, NULL)) {
+			msleep(1);
+			deadline.val = get_time().val +
+				       SPI_FLASH_READ_BUDGET_USEC;
+		}
 	}
 	return ret;
 }
 
+#ifdef CONFIG_FLASH_BACKGROUND_ERASE
+/**
+ * Suspend the background erase, if the flash is still busy with it.
+ *
+ * @return 1 if suspended, 0 if there was nothing to suspend, or negative
+ * on error.
+ */
+static int spi_flash_suspend(void)
+{
+	uint8_t cmd = SPI_FLASH_ERASE_SUSPEND;
+	uint64_t ran;
+
+	if (!bg_erase.unit ||
+	    !(spi_flash_get_status1() & SPI_FLASH_SR1_BUSY))
+		return 0;
+
+	/* The erase must be left to run for tSUS after each resume */
+	ran = get_time().val - bg_erase.resumed.val;
+	if (ran < SPI_FLASH_SUSPEND_USEC)
+		udelay(SPI_FLASH_SUSPEND_USEC - ran);
+
+	if (spi_transaction(SPI_FLASH_DEVICE, &cmd, 1, NULL, 0))
+		return -1;
+	if (spi_flash_wait_timeout(SPI_FLASH_SUSPEND_USEC * 10))
+		return -1;
+	bg_erase.suspended = get_time();
+	return 1;
+}
+
+static void spi_flash_resume(void)
+{
+	uint8_t cmd = SPI_FLASH_ERASE_RESUME;
+
+	spi_transaction(SPI_FLASH_DEVICE, &cmd, 1, NULL, 0);
+	bg_erase.resumed = get_time();
+
+	/* Time spent suspended doesn't count against the erase timeout */
+	bg_erase.deadline.val += bg_erase.resumed.val -
+		bg_erase.suspended.val;
+}
+#endif
+
+/**
+ * Returns the content of SPI flash
+ *
+ * If a background erase is running, it is suspended during the read. Data
+ * in the range it has yet to erase is undefined while the erase is
+ * suspended, so reads overlapping that range fail with EC_ERROR_BUSY.
+ *
+ * @param buf_usr Buffer to write flash contents
+ * @param offset Flash offset to start reading from
+ * @param bytes Number of bytes to read.
+ *
+ * @return EC_SUCCESS, or non-zero if any error.
+ */
+int spi_flash_read(uint8_t *buf_usr, unsigned int offset, unsigned int bytes)
+{
+#ifdef CONFIG_FLASH_BACKGROUND_ERASE
+	int suspended, rv;
+
+	mutex_lock(&bg_erase_lock);
+	if (bg_erase.busy && offset < bg_erase.end &&
+	    offset + bytes > bg_erase.offset) {
+		mutex_unlock(&bg_erase_lock);
+		return EC_ERROR_BUSY;
+	}
+	suspended = spi_flash_suspend();
+	if (suspended < 0)
+		rv = EC_ERROR_BUSY;
+	else
+		rv = spi_flash_read_idle(buf_usr, offset, bytes);
+	if (suspended)
+		spi_flash_resume();
+	mutex_unlock(&bg_erase_lock);
+	return rv;
+#else
+	return spi_flash_read_idle(buf_usr, offset, bytes);
+#endif
+}
+
+/**
+ * Start erasing a unit of SPI flash, without waiting for the end.
+ *
+ * @param offset Flash offset to start erasing, aligned to the unit
+ * @param unit Index in erase_units[]
+ *
+ * @return EC_SUCCESS, or non-zero if any error.
+ */
+static int spi_flash_erase_start(unsigned int offset, int unit)
+{
+	uint8_t cmd[4];
+	int rv;
+
+	/* Enable writing to SPI flash */
+	rv = spi_flash_write_enable();
+	if (rv)
+		return rv;
+
+	/* Compose instruction */
+	cmd[0] = erase_units[unit].opcode;
+	cmd[1] = (offset >> 16) & 0xFF;
+	cmd[2] = (offset >> 8) & 0xFF;
+	cmd[3] = offset & 0xFF;
+
+	/* Until it is seen to complete, the unit may be left half erased */
+	spi_flash_mark_erased(offset, erase_units[unit].kb * 1024, 0);
+	return spi_transaction(SPI_FLASH_DEVICE, cmd, 4, NULL, 0);
+}
+
+/**
+ * Largest erase unit aligned at offset that fits in bytes.
+ *
+ * @return index in erase_units[]; a sector always fits.
+ */
+static int spi_flash_erase_unit(unsigned int offset, unsigned int bytes)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(erase_units) - 1; i++) {
+		unsigned int size = erase_units[i].kb * 1024;
+
+		if (offset % size == 0 && bytes >= size)
+			break;
+	}
+
+	return i;
+}
+
 /**
  * Erase a block of SPI flash.
  *
  * @param offset Flash offset to start erasing
- * @param block Block size in kb (4 or 32)
+ * @param block Block size in kb (4, 32 or 64)
  *
  * @return EC_SUCCESS, or non-zero if any error.
  */
 static int spi_flash_erase_block(unsigned int offset, unsigned int block)
 {
-	uint8_t cmd[4];
 	int rv = EC_SUCCESS;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(erase_units); i++)
+		if (erase_units[i].kb == block)
+			break;
 
 	/* Invalid block size */
-	if (block != 4 && block != 32)
+	if (i == ARRAY_SIZE(erase_units))
 		return EC_ERROR_INVAL;
 
 	/* Not block aligned */
 	if ((offset % (block * 1024)) != 0)
 		return EC_ERROR_INVAL;
 
-	/* Enable writing to SPI flash */
-	rv = spi_flash_write_enable();
+	rv = spi_flash_erase_start(offset, i);
 	if (rv)
 		return rv;
 
-	/* Compose instruction */
-	cmd[0] = (block == 4) ? SPI_FLASH_ERASE_4KB : SPI_FLASH_ERASE_32KB;
-	cmd[1] = (offset >> 16) & 0xFF;
-	cmd[2] = (offset >> 8) & 0xFF;
-	cmd[3] = offset & 0xFF;
+	/* Wait for previous operation to complete */
+	return spi_flash_wait_timeout(erase_units[i].timeout_usec);
+}
 
-	rv = spi_transaction(SPI_FLASH_DEVICE, cmd, 4, NULL, 0);
-	if (rv)
-		return rv;
+/**
+ * Check whether a sector of SPI flash can be left as it is.
+ *
+ * @param offset Flash offset of the sector
+ *
+ * @return 1 if the sector was erased since boot and every byte still reads
+ * 0xff, 0 if not or if it can't be read.
+ */
+static int spi_flash_sector_is_erased(unsigned int offset)
+{
+	unsigned int s = offset / SPI_FLASH_SECTOR_SIZE;
+	int i, j;
 
-	/* Wait for previous operation to complete */
-	return spi_flash_wait();
+	if (!(erased_map[s / 32] & BIT(s % 32)))
+		return 0;
+
+	for (i = 0; i < SPI_FLASH_SECTOR_SIZE; i += SPI_FLASH_MAX_READ_SIZE) {
+		if (spi_flash_read_idle(buf, offset + i,
+					SPI_FLASH_MAX_READ_SIZE))
+			return 0;
+
+		for (j = 0; j < SPI_FLASH_MAX_READ_SIZE; j++)
+			if (buf[j] != 0xff)
+				return 0;
+	}
+
+	return 1;
 }
 
 /**
  * Erase SPI flash.
  *
+ * Uses the largest erase unit that fits at each offset. Sectors which were
+ * already erased since boot and are still blank are not erased again: if
+ * only a few sectors of a block need erasing, they are erased one by one
+ * instead of the whole block.
+ *
  * @param offset Flash offset to start erasing
  * @param bytes Number of bytes to erase
  *
  * @return EC_SUCCESS, or non-zero if any error.
  */
-int spi_flash_erase(unsigned int offset, unsigned int bytes)
+static int spi_flash_erase_idle(unsigned int offset, unsigned int bytes)
 {
+	const int sector_ms = erase_units[ARRAY_SIZE(erase_units) - 1].typ_ms;
+	uint32_t dirty;
 	int rv = EC_SUCCESS;
+	int i, s, size, sectors, ndirty;
 
 	/* Invalid input */
 	if (offset + bytes > CONFIG_FLASH_SIZE)
 		return EC_ERROR_INVAL;
 
 	/* Not aligned to sector (4kb) */
-	if (offset % 4096 || bytes % 4096)
+	if (offset % SPI_FLASH_SECTOR_SIZE || bytes % SPI_FLASH_SECTOR_SIZE)
 		return EC_ERROR_INVAL;
 
-	/* Largest unit is block (32kb) */
-	if (offset % (32 * 1024) == 0) {
-		while (bytes != (bytes % (32 * 1024))) {
-			rv = spi_flash_erase_block(offset, 32);
+	while (bytes) {
+		i = spi_flash_erase_unit(offset, bytes);
+		size = erase_units[i].kb * 1024;
+		sectors = size / SPI_FLASH_SECTOR_SIZE;
+
+		/*
+		 * Find the sectors still holding data. Stop looking as soon as
+		 * erasing them one by one would be slower than the whole unit.
+		 */
+		dirty = 0;
+		ndirty = 0;
+		for (s = 0; s < sectors; s++) {
+			if (spi_flash_sector_is_erased(offset +
+						s * SPI_FLASH_SECTOR_SIZE))
+				continue;
+			dirty |= BIT(s);
+			if (++ndirty * sector_ms >= erase_units[i].typ_ms)
+				break;
+		}
+
+		if (ndirty * sector_ms >= erase_units[i].typ_ms) {
+			rv = spi_flash_erase_block(offset, erase_units[i].kb);
 			if (rv)
 				return rv;
+			spi_flash_mark_erased(offset, size, 1);
+			spi_flash_stats.sectors_erased += sectors;
+		} else {
+			for (s = 0; s < sectors; s++) {
+				if (!(dirty & BIT(s)))
+					continue;
+				rv = spi_flash_erase_block(offset +
+					s * SPI_FLASH_SECTOR_SIZE,
+					SPI_FLASH_SECTOR_SIZE / 1024);
+				if (rv)
+					return rv;
+				spi_flash_mark_erased(offset +
+					s * SPI_FLASH_SECTOR_SIZE,
+					SPI_FLASH_SECTOR_SIZE, 1);
+			}
+			spi_flash_stats.sectors_erased += ndirty;
+			spi_flash_stats.sectors_skipped += sectors - ndirty;
+		}
+
+		bytes -= size;
+		offset += size;
+		/*
+		 * Refresh watchdog since we may be erasing a large
+		 * number of blocks.
+		 */
+		watchdog_reload();
+	}
+
+	return rv;
+}
+
+int spi_flash_erase(unsigned int offset, unsigned int bytes)
+{
+	int rv = spi_flash_lock_idle();
+
+	if (rv)
+		return rv;
+	rv = spi_flash_erase_idle(offset, bytes);
+	spi_flash_unlock();
+	if (IS_ENABLED(CONFIG_FLASH_READ_CACHE))
+		flash_cache_invalidate(offset, bytes);
+	return rv;
+}
 
-			bytes -= 32 * 1024;
-			offset += 32 * 1024;
-			/*
-			 * Refresh watchdog since we may be erasing a large
-			 * number of blocks.
-			 */
-			watchdog_reload();
+#ifdef CONFIG_FLASH_BACKGROUND_ERASE
+/*
+ * Step the background erase: account for the unit which just finished and
+ * start the next one. Sectors already erased since boot and still blank are
+ * skipped, one per step so that each step stays short; unlike
+ * spi_flash_erase(), larger blocks are not checked since that means reading
+ * all of them.
+ */
+static void spi_flash_erase_step(void)
+{
+	void (*done)(int rv) = NULL;
+	int rv = EC_SUCCESS;
+	int i, size;
+	int finished = 0;
+	unsigned int start = 0, end = 0;
+
+	mutex_lock(&bg_erase_lock);
+
+	if (!bg_erase.busy)
+		goto out;
+
+	if (bg_erase.unit) {
+		if (spi_flash_get_status1() & SPI_FLASH_SR1_BUSY) {
+			if (timestamp_expired(bg_erase.deadline, NULL)) {
+				rv = EC_ERROR_TIMEOUT;
+				goto finish;
+			}
+			hook_call_deferred(&spi_flash_erase_step_data,
+					   SPI_FLASH_ERASE_POLL_USEC);
+			goto out;
 		}
+		spi_flash_mark_erased(bg_erase.offset, bg_erase.unit, 1);
+		bg_erase.offset += bg_erase.unit;
+		bg_erase.unit = 0;
 	}
 
-	/* Largest unit is sector (4kb) */
-	while (bytes != (bytes % (4 * 1024))) {
-		rv = spi_flash_erase_block(offset, 4);
-		if (rv)
-			return rv;
+	if (bg_erase.offset >= bg_erase.end)
+		goto finish;
 
-		bytes -= 4 * 1024;
-		offset += 4 * 1024;
+	i = spi_flash_erase_unit(bg_erase.offset,
+				 bg_erase.end - bg_erase.offset);
+	size = erase_units[i].kb * 1024;
+
+	if (size == SPI_FLASH_SECTOR_SIZE &&
+	    spi_flash_sector_is_erased(bg_erase.offset)) {
+		spi_flash_stats.sectors_skipped++;
+		bg_erase.offset += size;
+		hook_call_deferred(&spi_flash_erase_step_data, 0);
+		goto out;
 	}
 
+	rv = spi_flash_erase_start(bg_erase.offset, i);
+	if (rv)
+		goto finish;
+	spi_flash_stats.sectors_erased += size / SPI_FLASH_SECTOR_SIZE;
+
+	bg_erase.unit = size;
+	bg_erase.deadline.val = get_time().val + erase_units[i].timeout_usec;
+	bg_erase.resumed = get_time();
+	hook_call_deferred(&spi_flash_erase_step_data,
+			   erase_units[i].typ_ms * MSEC);
+	goto out;
+
+finish:
+	bg_erase.busy = 0;
+	bg_erase.unit = 0;
+	done = bg_erase.done;
+	start = bg_erase.start;
+	end = bg_erase.end;
+	finished = 1;
+out:
+	mutex_unlock(&bg_erase_lock);
+	if (IS_ENABLED(CONFIG_FLASH_READ_CACHE) && finished)
+		flash_cache_invalidate(start, end - start);
+	if (done)
+		done(rv);
+}
+
+int spi_flash_erase_background(unsigned int offset, unsigned int bytes,
+			       void (*done)(int rv))
+{
+	int rv;
+
+	/* Invalid input */
+	if (offset + bytes > CONFIG_FLASH_SIZE)
+		return EC_ERROR_INVAL;
+
+	/* Not aligned to sector (4kb) */
+	if (offset % SPI_FLASH_SECTOR_SIZE || bytes % SPI_FLASH_SECTOR_SIZE)
+		return EC_ERROR_INVAL;
+
+	rv = spi_flash_lock_idle();
+	if (rv)
+		return rv;
+
+	bg_erase.start = offset;
+	bg_erase.offset = offset;
+	bg_erase.end = offset + bytes;
+	bg_erase.unit = 0;
+	bg_erase.done = done;
+	bg_erase.busy = 1;
+
+	rv = hook_call_deferred(&spi_flash_erase_step_data, 0);
+	if (rv)
+		bg_erase.busy = 0;
+	spi_flash_unlock();
 	return rv;
 }
 
+void spi_flash_erase_progress(uint32_t *erased, uint32_t *size)
+{
+	mutex_lock(&bg_erase_lock);
+	*erased = bg_erase.offset - bg_erase.start;
+	*size = bg_erase.end - bg_erase.start;
+	mutex_unlock(&bg_erase_lock);
+}
+
+int spi_flash_wait_background_erase(int timeout_us)
+{
+	timestamp_t deadline;
+
+	deadline.val = get_time().val + timeout_us;
+	while (bg_erase.busy) {
+		if (timestamp_expired(deadline, NULL))
+			return EC_ERROR_TIMEOUT;
+		/*
+		 * Step the erase from here too, the caller may be the hook
+		 * task which runs the deferred steps.
+		 */
+		spi_flash_erase_step();
+		if (bg_erase.busy)
+			usleep(SPI_FLASH_ERASE_POLL_USEC);
+		watchdog_reload();
+	}
+
+	return EC_SUCCESS;
+}
+#else
+int spi_flash_wait_background_erase(int timeout_us)
+{
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_FLASH_BACKGROUND_ERASE */
+
+/**
+ * Check whether the flash already holds some data.
+ *
+ * @param offset Flash offset to compare at
+ * @param bytes Number of bytes to compare
+ * @param data Data to compare with
+ *
+ * @return 1 if identical, 0 if not or if the flash can't be read.
+ */
+static int spi_flash_matches(unsigned int offset, unsigned int bytes,
+			     const uint8_t *data)
+{
+	uint32_t cur[16];
+	int len;
+
+	while (bytes) {
+		len = MIN(bytes, sizeof(cur));
+		if (spi_flash_read_idle((uint8_t *)cur, offset, len))
+			return 0;
+		if (memcmp(cur, data, len))
+			return 0;
+		offset += len;
+		data += len;
+		bytes -= len;
+	}
+
+	return 1;
+}
+
 /**
  * Write to SPI flash. Assumes already erased.
  * Limited to SPI_FLASH_MAX_WRITE_SIZE by chip.
  *
+ * Leading and trailing 0xff bytes of each page are not programmed, and the
+ * page is skipped entirely if the flash already holds the data.
+ *
  * @param offset Flash offset to write
  * @param bytes Number of bytes to write
  * @param data Data to write to flash
  *
  * @return EC_SUCCESS, or non-zero if any error.
  */
-int spi_flash_write(unsigned int offset, unsigned int bytes,
-	const uint8_t *data)
+static int spi_flash_write_idle(unsigned int offset, unsigned int bytes,
+				const uint8_t *data)
 {
-	int rv, write_size;
+	int rv, write_size, skip, len;
 
 	/* Invalid input */
 	if (!data || offset + bytes > CONFIG_FLASH_SIZE ||
@@ -290,30 +842,50 @@ int spi_flash_write(unsigned int offset, unsigned int bytes,
 		write_size = MIN(bytes, SPI_FLASH_MAX_WRITE_SIZE -
 		(offset & (SPI_FLASH_MAX_WRITE_SIZE - 1)));
 
+		/*
+		 * Programming 0xff is a no-op, so trim it off both ends. This
+		 * runs while the previous page is still being programmed.
+		 */
+		for (skip = 0; skip < write_size && data[skip] == 0xff; skip++)
+			;
+		for (len = write_size - skip;
+		     len > 0 && data[skip + len - 1] == 0xff; len--)
+			;
+
 		/* Wait for previous operation to complete */
 		rv = spi_flash_wait();
 		if (rv)
 			return rv;
 
+		if (!len || spi_flash_matches(offset + skip, len,
+					      data + skip)) {
+			spi_flash_stats.pages_skipped++;
+			goto next;
+		}
+
 		/* Enable writing to SPI flash */
 		rv = spi_flash_write_enable();
 		if (rv)
 			return rv;
 
 		/* Copy data to send buffer; buffers may overlap */
-		memmove(buf + 4, data, write_size);
+		memmove(buf + 4, data + skip, len);
 
 		/* Compose instruction */
 		buf[0] = SPI_FLASH_PAGE_PRGRM;
-		buf[1] = (offset) >> 16;
-		buf[2] = (offset) >> 8;
-		buf[3] = offset;
+		buf[1] = (offset + skip) >> 16;
+		buf[2] = (offset + skip) >> 8;
+		buf[3] = offset + skip;
 
+		spi_flash_mark_erased(offset & ~(SPI_FLASH_SECTOR_SIZE - 1),
+				      SPI_FLASH_SECTOR_SIZE, 0);
 		rv = spi_transaction(SPI_FLASH_DEVICE,
-				     buf, 4 + write_size, NULL, 0);
+				     buf, 4 + len, NULL, 0);
 		if (rv)
 			return rv;
+		spi_flash_stats.pages_written++;
 
+next:
 		data += write_size;
 		offset += write_size;
 		bytes -= write_size;
@@ -323,6 +895,46 @@ int spi_flash_write(unsigned int offset, unsigned int bytes,
 	return spi_flash_wait();
 }
 
+int spi_flash_write(unsigned int offset, unsigned int bytes,
+	const uint8_t *data)
+{
+	int rv = spi_flash_lock_idle();
+
+	if (rv)
+		return rv;
+	rv = spi_flash_write_idle(offset, bytes, data);
+	spi_flash_unlock();
+	if (IS_ENABLED(CONFIG_FLASH_READ_CACHE))
+		flash_cache_invalidate(offset, bytes);
+	return rv;
+}
+
+int spi_flash_rewrite(unsigned int offset, unsigned int erase_bytes,
+		      const uint8_t *data, unsigned int bytes, int timeout_us)
+{
+	unsigned int i;
+	int rv;
+
+	if (bytes > erase_bytes)
+		return EC_ERROR_INVAL;
+
+	rv = spi_flash_lock_idle();
+	if (rv == EC_ERROR_BUSY &&
+	    !spi_flash_wait_background_erase(timeout_us))
+		rv = spi_flash_lock_idle();
+	if (rv)
+		return rv;
+
+	rv = spi_flash_erase_idle(offset, erase_bytes);
+	for (i = 0; !rv && i < bytes; i += SPI_FLASH_MAX_WRITE_SIZE)
+		rv = spi_flash_write_idle(offset + i,
+			MIN(SPI_FLASH_MAX_WRITE_SIZE, bytes - i), data + i);
+	spi_flash_unlock();
+	if (IS_ENABLED(CONFIG_FLASH_READ_CACHE))
+		flash_cache_invalidate(offset, erase_bytes);
+	return rv;
+}
+
 /**
  * Gets the SPI flash JEDEC ID (manufacturer ID, memory type, and capacity)
  *
@@ -332,8 +944,13 @@ int spi_flash_write(unsigned int offset, unsigned int bytes,
 int spi_flash_get_jedec_id(uint8_t *dest)
 {
 	uint8_t cmd = SPI_FLASH_JEDEC_ID;
+	int rv = spi_flash_lock_idle();
 
-	return spi_transaction(SPI_FLASH_DEVICE, &cmd, 1, dest, 3);
+	if (rv)
+		return rv;
+	rv = spi_transaction(SPI_FLASH_DEVICE, &cmd, 1, dest, 3);
+	spi_flash_unlock();
+	return rv;
 }
 
 /**
@@ -345,8 +962,13 @@ int spi_flash_get_jedec_id(uint8_t *dest)
 int spi_flash_get_mfr_dev_id(uint8_t *dest)
 {
 	uint8_t cmd[4] = {SPI_FLASH_MFR_DEV_ID, 0, 0, 0};
+	int rv = spi_flash_lock_idle();
 
-	return spi_transaction(SPI_FLASH_DEVICE, cmd, sizeof(cmd), dest, 2);
+	if (rv)
+		return rv;
+	rv = spi_transaction(SPI_FLASH_DEVICE, cmd, sizeof(cmd), dest, 2);
+	spi_flash_unlock();
+	return rv;
 }
 
 /**
@@ -358,8 +980,13 @@ int spi_flash_get_mfr_dev_id(uint8_t *dest)
 int spi_flash_get_unique_id(uint8_t *dest)
 {
 	uint8_t cmd[5] = {SPI_FLASH_UNIQUE_ID, 0, 0, 0, 0};
+	int rv = spi_flash_lock_idle();
 
-	return spi_transaction(SPI_FLASH_DEVICE, cmd, sizeof(cmd), dest, 8);
+	if (rv)
+		return rv;
+	rv = spi_transaction(SPI_FLASH_DEVICE, cmd, sizeof(cmd), dest, 8);
+	spi_flash_unlock();
+	return rv;
 }
 
 /**
@@ -391,8 +1018,14 @@ enum spi_flash_wp spi_flash_check_wp(void)
  */
 int spi_flash_set_wp(enum spi_flash_wp w)
 {
-	int sr1 = spi_flash_get_status1();
-	int sr2 = spi_flash_get_status2();
+	int sr1, sr2, rv;
+
+	rv = spi_flash_lock_idle();
+	if (rv)
+		return rv;
+
+	sr1 = spi_flash_get_status1();
+	sr2 = spi_flash_get_status2();
 
 	switch (w) {
 	case SPI_WP_NONE:
@@ -412,10 +1045,14 @@ int spi_flash_set_wp(enum spi_flash_wp w)
 		sr2 |= SPI_FLASH_SR2_SRP1;
 		break;
 	default:
-		return EC_ERROR_INVAL;
+		rv = EC_ERROR_INVAL;
+		goto out;
 	}
 
-	return spi_flash_set_status(sr1, sr2);
+	rv = spi_flash_set_status_idle(sr1, sr2);
+out:
+	spi_flash_unlock();
+	return rv;
 }
 
 /**
@@ -461,20 +1098,27 @@ int spi_flash_check_protect(unsigned int offset, unsigned int bytes)
  */
 int spi_flash_set_protect(unsigned int offset, unsigned int bytes)
 {
+	uint8_t sr1, sr2;
 	int rv;
-	uint8_t sr1 = spi_flash_get_status1();
-	uint8_t sr2 = spi_flash_get_status2();
-
-	/* Invalid values */
-	if (sr1 == 0xff || sr2 == 0xff || offset + bytes > CONFIG_FLASH_SIZE)
-		return EC_ERROR_INVAL;
 
-	/* Compute desired protect range */
-	rv = spi_flash_protect_to_reg(offset, bytes, &sr1, &sr2);
+	rv = spi_flash_lock_idle();
 	if (rv)
 		return rv;
 
-	return spi_flash_set_status(sr1, sr2);
+	sr1 = spi_flash_get_status1();
+	sr2 = spi_flash_get_status2();
+
+	/* Invalid values */
+	if (sr1 == 0xff || sr2 == 0xff || offset + bytes > CONFIG_FLASH_SIZE)
+		rv = EC_ERROR_INVAL;
+	else
+		/* Compute desired protect range */
+		rv = spi_flash_protect_to_reg(offset, bytes, &sr1, &sr2);
+	if (!rv)
+		rv = spi_flash_set_status_idle(sr1, sr2);
+
+	spi_flash_unlock();
+	return rv;
 }
 
 static int command_spi_flashinfo(int argc, char **argv)
@@ -490,8 +1134,11 @@ static int command_spi_flashinfo(int argc, char **argv)
 	if (rv)
 		return rv;
 
-	spi_flash_get_jedec_id(jedec);
-	spi_flash_get_unique_id(unique);
+	rv = spi_flash_get_jedec_id(jedec);
+	if (!rv)
+		rv = spi_flash_get_unique_id(unique);
+	if (rv)
+		return rv;
 
 	ccprintf("Manufacturer ID: %02x\nDevice ID: %02x %02x\n",
 		 jedec[0], jedec[1], jedec[2]);
@@ -499,6 +1146,12 @@ static int command_spi_flashinfo(int argc, char **argv)
 		 unique[0], unique[1], unique[2], unique[3],
 		 unique[4], unique[5], unique[6], unique[7]);
 	ccprintf("Capacity: %4d kB\n", SPI_FLASH_SIZE(jedec[2]) / 1024);
+	ccprintf("Sectors erased: %d skipped: %d\n",
+		 spi_flash_stats.sectors_erased,
+		 spi_flash_stats.sectors_skipped);
+	ccprintf("Pages written: %d skipped: %d\n",
+		 spi_flash_stats.pages_written,
+		 spi_flash_stats.pages_skipped);
 
 	return rv;
 }
@@ -510,10 +1163,14 @@ DECLARE_CONSOLE_COMMAND(spi_flashinfo, command_spi_flashinfo,
 static enum ec_status flash_command_spi_info(struct host_cmd_handler_args *args)
 {
 	struct ec_response_flash_spi_info *r = args->response;
+	int rv;
 
-	spi_flash_get_jedec_id(r->jedec);
+	rv = spi_flash_get_jedec_id(r->jedec);
+	if (!rv)
+		rv = spi_flash_get_mfr_dev_id(r->mfr_dev_id);
+	if (rv)
+		return rv == EC_ERROR_BUSY ? EC_RES_BUSY : EC_RES_ERROR;
 	r->reserved0 = 0;
-	spi_flash_get_mfr_dev_id(r->mfr_dev_id);
 	r->sr1 = spi_flash_get_status1();
 	r->sr2 = spi_flash_get_status2();
 
@@ -651,6 +1308,49 @@ DECLARE_CONSOLE_COMMAND(spi_flashread, command_spi_flashread,
 	"offset bytes",
 	"Read flash");
 
+static int command_spi_flashbench(int argc, char **argv)
+{
+	int offset = -1;
+	int bytes = -1;
+	int chunk, done, rv;
+	char *data;
+	timestamp_t start;
+	uint32_t us;
+
+	rv = parse_offset_size(argc, argv, 1, &offset, &bytes);
+	if (rv)
+		return rv;
+
+	if (offset < 0 || bytes <= 0 || offset + bytes > CONFIG_FLASH_SIZE)
+		return EC_ERROR_INVAL;
+
+	chunk = MIN(bytes, shared_mem_size());
+	rv = shared_mem_acquire(chunk, &data);
+	if (rv)
+		return rv;
+
+	spi_enable(CONFIG_SPI_FLASH_PORT, 1);
+
+	rv = spi_flash_wait();
+	start = get_time();
+	for (done = 0; !rv && done < bytes; done += chunk) {
+		chunk = MIN(chunk, bytes - done);
+		rv = spi_flash_read((uint8_t *)data, offset + done, chunk);
+	}
+	us = get_time().val - start.val;
+
+	shared_mem_release(data);
+	if (rv)
+		return rv;
+
+	ccprintf("Read %d bytes in %d us (%d KB/s)\n", bytes, us,
+		 (int)((uint32_t)bytes * 1000 / MAX(us, 1) * 1000 / 1024));
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(spi_flashbench, command_spi_flashbench,
+	"offset bytes",
+	"Time a flash read");
+
 static int command_spi_flashread_sr(int argc, char **argv)
 {
 	spi_enable(CONFIG_SPI_FLASH_PORT, 1);
@@ -19,6 +19,7 @@
 #include "host_command.h"
 #include "i2c.h"
 #include "keyboard_scan.h"
+#include "link_defs.h"
 #include "lpc.h"
 #include "otp.h"
 #include "rwsig.h"
@@ -86,34 +87,9 @@ uint32_t system_get_sku_id(void)
 #define AP_SKUID_SYSJUMP_TAG		0x4153 /* AS */
 #define AP_SKUID_HOOK_VERSION		1
 
-/**
- * Preserve AP SKUID across a sysjump.
- */
-
-static void ap_sku_id_preserve_state(void)
-{
-	system_add_jump_tag(AP_SKUID_SYSJUMP_TAG, AP_SKUID_HOOK_VERSION,
-			    sizeof(ap_sku_id), &ap_sku_id);
-}
-DECLARE_HOOK(HOOK_SYSJUMP, ap_sku_id_preserve_state, HOOK_PRIO_DEFAULT);
-
-/**
- * Restore AP SKUID after a sysjump.
- */
-static void ap_sku_id_restore_state(void)
-{
-	const uint32_t *prev_ap_sku_id;
-	int size, version;
-
-	prev_ap_sku_id = (const uint32_t *)system_get_jump_tag(
-		AP_SKUID_SYSJUMP_TAG, &version, &size);
-
-	if (prev_ap_sku_id && version == AP_SKUID_HOOK_VERSION &&
-		size == sizeof(prev_ap_sku_id)) {
-		memcpy(&ap_sku_id, prev_ap_sku_id, sizeof(ap_sku_id));
-	}
-}
-DECLARE_HOOK(HOOK_INIT, ap_sku_id_restore_state, HOOK_PRIO_DEFAULT);
+/* Preserve AP SKUID across a sysjump. */
+DECLARE_PRESERVED_STATE(ap_sku_id, AP_SKUID_SYSJUMP_TAG,
+			AP_SKUID_HOOK_VERSION, ap_sku_id);
 #endif
 
 /**
@@ -293,25 +269,43 @@ int system_jumped_late(void)
 	return !(reset_flags & EC_RESET_FLAG_EFS) && jumped_to_image;
 }
 
-int system_add_jump_tag(uint16_t tag, int version, int size, const void *data)
+/**
+ * Make room for a jump tag and return a pointer to its data, or NULL.
+ */
+static uint8_t *system_alloc_jump_tag(uint16_t tag, int version, int size)
 {
 	struct jump_tag *t;
 
 	/* Only allowed during a sysjump */
 	if (!jdata || jdata->magic != JUMP_DATA_MAGIC)
-		return EC_ERROR_UNKNOWN;
+		return NULL;
 
 	/* Make room for the new tag */
 	if (size > 255)
-		return EC_ERROR_INVAL;
+		return NULL;
 	jdata->jump_tag_total += ROUNDUP4(size) + sizeof(struct jump_tag);
 
 	t = (struct jump_tag *)system_usable_ram_end();
 	t->tag = tag;
 	t->data_size = size;
 	t->data_version = version;
+
+	return (uint8_t *)(t + 1);
+}
+
+int system_add_jump_tag(uint16_t tag, int version, int size, const void *data)
+{
+	uint8_t *d;
+
+	if (size > 255)
+		return EC_ERROR_INVAL;
+
+	d = system_alloc_jump_tag(tag, version, size);
+	if (!d)
+		return EC_ERROR_UNKNOWN;
+
 	if (size)
-		memcpy(t + 1, data, size);
+		memcpy(d, data, size);
 
 	return EC_SUCCESS;
 }
@@ -345,6 +339,204 @@ const uint8_t *system_get_jump_tag(uint16_t tag, int *version, int *size)
 	return NULL;
 }
 
+/*
+ * Preserved state is packed into a single jump tag:
+ *
+ *   struct preserved_state_hdr
+ *   struct preserved_state_entry[count]
+ *   data of each entry, back to back
+ */
+#define PRESERVED_STATE_TAG 0x5053  /* "PS" */
+#define PRESERVED_STATE_VERSION 1
+
+struct preserved_state_hdr {
+	uint8_t count;
+	uint8_t reserved;
+	/* Fletcher-16 over everything after the header */
+	uint16_t checksum;
+};
+
+struct preserved_state_entry {
+	uint16_t tag;
+	uint8_t version;
+	uint8_t size;
+	/* Index in the saving image's table, to find the match directly */
+	uint8_t index;
+} __packed;
+
+/* Bit i set if __preserved_state[i] was restored */
+static uint32_t preserved_state_restored;
+
+/*
+ * Most variables an image may declare, one bit each in the mask above. The
+ * count is only known at link time; system_common_pre_init() checks it.
+ */
+#define PRESERVED_STATE_MAX 32
+BUILD_ASSERT(PRESERVED_STATE_MAX <= sizeof(preserved_state_restored) * 8);
+
+static uint16_t preserved_state_checksum(const uint8_t *data, int len)
+{
+	uint16_t sum1 = 0, sum2 = 0;
+
+	while (len--) {
+		sum1 = (sum1 + *data++) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+
+	return (sum2 << 8) | sum1;
+}
+
+static int preserved_state_count(void)
+{
+	return __preserved_state_end - __preserved_state;
+}
+
+static int preserved_state_index(uint16_t tag, int hint)
+{
+	int i;
+
+	if (hint < preserved_state_count() &&
+	    __preserved_state[hint].tag == tag)
+		return hint;
+
+	for (i = 0; i < preserved_state_count(); i++)
+		if (__preserved_state[i].tag == tag)
+			return i;
+
+	return -1;
+}
+
+int system_preserved_state_restored(uint16_t tag)
+{
+	int i = preserved_state_index(tag, 0);
+
+	return i >= 0 && i < PRESERVED_STATE_MAX &&
+		(preserved_state_restored & BIT(i));
+}
+
+/**
+ * Pack all preserved state into a jump tag. Called after HOOK_SYSJUMP, so
+ * modules can still update their variables from their sysjump hooks.
+ *
+ * The jump tag data is limited to 255 bytes. State past that is dropped, and
+ * reported on the console.
+ */
+static void preserved_state_save(void)
+{
+	const struct preserved_state *s;
+	struct preserved_state_hdr *hdr;
+	struct preserved_state_entry *e;
+	uint8_t *d;
+	int size = sizeof(*hdr);
+	int count = 0;
+	int i;
+
+	/* Work out how many fit */
+	for (i = 0; i < preserved_state_count(); i++) {
+		s = __preserved_state + i;
+		if (size + sizeof(*e) + s->size > 255)
+			break;
+		size += sizeof(*e) + s->size;
+		count++;
+	}
+
+	if (count < preserved_state_count())
+		CPRINTS("Preserved state too large, %d of %d dropped",
+			preserved_state_count() - count,
+			preserved_state_count());
+
+	if (!count)
+		return;
+
+	hdr = (struct preserved_state_hdr *)system_alloc_jump_tag(
+		PRESERVED_STATE_TAG, PRESERVED_STATE_VERSION, size);
+	if (!hdr)
+		return;
+
+	e = (struct preserved_state_entry *)(hdr + 1);
+	d = (uint8_t *)(e + count);
+	for (i = 0; i < count; i++, e++) {
+		s = __preserved_state + i;
+		e->tag = s->tag;
+		e->version = s->version;
+		e->size = s->size;
+		e->index = i;
+		memcpy(d, s->data, s->size);
+		d += s->size;
+	}
+
+	hdr->count = count;
+	hdr->reserved = 0;
+	hdr->checksum = preserved_state_checksum((uint8_t *)(hdr + 1),
+						 size - sizeof(*hdr));
+}
+
+static void preserved_state_restore_one(int i, int version, int size,
+					const uint8_t *data)
+{
+	const struct preserved_state *s;
+
+	if (i < 0 || i >= PRESERVED_STATE_MAX)
+		return;
+
+	s = __preserved_state + i;
+	if (version != s->version || size != s->size)
+		return;
+
+	memcpy(s->data, data, size);
+	preserved_state_restored |= BIT(i);
+}
+
+/**
+ * Copy preserved state from the previous image back in place.
+ */
+static void preserved_state_restore(void)
+{
+	const struct preserved_state_hdr *hdr;
+	const struct preserved_state_entry *e;
+	const uint8_t *d;
+	int version, size, used;
+	int i;
+
+	hdr = (const struct preserved_state_hdr *)system_get_jump_tag(
+		PRESERVED_STATE_TAG, &version, &size);
+	if (!hdr) {
+		/*
+		 * Jumped from an image older than the packed tag, which saved
+		 * each variable as a tag of its own.
+		 */
+		for (i = 0; i < preserved_state_count() &&
+			    i < PRESERVED_STATE_MAX; i++) {
+			d = system_get_jump_tag(__preserved_state[i].tag,
+						&version, &size);
+			if (d)
+				preserved_state_restore_one(i, version, size,
+							    d);
+		}
+		return;
+	}
+
+	if (version != PRESERVED_STATE_VERSION ||
+	    size < (int)(sizeof(*hdr) + hdr->count * sizeof(*e)) ||
+	    hdr->checksum != preserved_state_checksum(
+		    (const uint8_t *)(hdr + 1), size - sizeof(*hdr)))
+		return;
+
+	e = (const struct preserved_state_entry *)(hdr + 1);
+	d = (const uint8_t *)(e + hdr->count);
+	used = sizeof(*hdr) + hdr->count * sizeof(*e);
+
+	for (i = 0; i < hdr->count; i++, e++) {
+		if (used + e->size > size)
+			break;
+		preserved_state_restore_one(
+			preserved_state_index(e->tag, e->index),
+			e->version, e->size, d);
+		d += e->size;
+		used += e->size;
+	}
+}
+
 void system_disable_jump(void)
 {
 	disable_jump = 1;
@@ -549,6 +741,9 @@ static void jump_to_image(uintptr_t init_addr)
 	/* Call other hooks; these may add tags */
 	hook_notify(HOOK_SYSJUMP);
 
+	/* Pack up the preserved state, now that the hooks updated it */
+	preserved_state_save();
+
 	/* Disable interrupts before jump */
 	interrupt_disable();
 
@@ -866,6 +1061,9 @@ void system_common_pre_init(void)
 		 * disallows use of system_add_jump_tag().
 		 */
 		jdata->magic = 0;
+
+		ASSERT(preserved_state_count() <= PRESERVED_STATE_MAX);
+		preserved_state_restore();
 	} else {
 		/* Clear the whole jump_data struct */
 		memset(jdata, 0, sizeof(struct jump_data));
@@ -1354,7 +1552,10 @@ DECLARE_SAFE_CONSOLE_COMMAND(sleepmask, command_sleepmask,
 static int command_jumptags(int argc, char **argv)
 {
 	const struct jump_tag *t;
+	const struct preserved_state *s;
 	int used = 0;
+	int total = 0;
+	int i;
 
 	/* Jump tags valid only after a sysjump */
 	if (!jdata)
@@ -1371,6 +1572,17 @@ static int command_jumptags(int argc, char **argv)
 			 t->data_version, t->data_size);
 	}
 
+	ccprintf("Preserved state:\n");
+	for (i = 0; i < preserved_state_count(); i++) {
+		s = __preserved_state + i;
+		total += s->size;
+		ccprintf("  %-12s %c%c.%d %3d%s\n", s->name,
+			 s->tag >> 8, (uint8_t)s->tag, s->version, s->size,
+			 system_preserved_state_restored(s->tag) ?
+			 " restored" : "");
+	}
+	ccprintf("  %d bytes\n", total);
+
 	return EC_SUCCESS;
 }
 DECLARE_CONSOLE_COMMAND(jumptags, command_jumptags,
@@ -15,6 +15,27 @@
 #include "timer.h"
 #include "util.h"
 
+#ifdef CONFIG_TEMP_SENSOR_CACHE
+/* Last reading of each sensor, with the error code the driver gave. */
+static struct {
+	int temp;
+	int rv;
+} temp_cache[TEMP_SENSOR_COUNT];
+
+/* Seconds until the next cache refresh */
+static int temp_cache_countdown;
+
+int temp_sensor_read(enum temp_sensor_id id, int *temp_ptr)
+{
+	if (id < 0 || id >= TEMP_SENSOR_COUNT)
+		return EC_ERROR_INVAL;
+
+	if (temp_cache[id].rv == EC_SUCCESS)
+		*temp_ptr = temp_cache[id].temp;
+
+	return temp_cache[id].rv;
+}
+#else
 int temp_sensor_read(enum temp_sensor_id id, int *temp_ptr)
 {
 	const struct temp_sensor_t *sensor;
@@ -25,6 +46,29 @@ int temp_sensor_read(enum temp_sensor_id id, int *temp_ptr)
 
 	return sensor->read(sensor->idx, temp_ptr);
 }
+#endif
+
+int temp_sensor_read_fresh(enum temp_sensor_id id, int *temp_ptr)
+{
+	const struct temp_sensor_t *sensor;
+	int rv;
+
+	if (id < 0 || id >= TEMP_SENSOR_COUNT)
+		return EC_ERROR_INVAL;
+	sensor = temp_sensors + id;
+
+	if (sensor->update)
+		sensor->update();
+	rv = sensor->read(sensor->idx, temp_ptr);
+
+#ifdef CONFIG_TEMP_SENSOR_CACHE
+	temp_cache[id].rv = rv;
+	if (rv == EC_SUCCESS)
+		temp_cache[id].temp = *temp_ptr;
+#endif
+
+	return rv;
+}
 
 static void update_mapped_memory(void)
 {
@@ -57,8 +101,50 @@ static void update_mapped_memory(void)
 		}
 	}
 }
+
+#ifdef CONFIG_TEMP_SENSOR_CACHE
+void temp_sensor_update_cache(void)
+{
+	const struct temp_sensor_t *sensor;
+	int i, j, t;
+
+	for (i = 0; i < TEMP_SENSOR_COUNT; i++) {
+		sensor = temp_sensors + i;
+		if (!sensor->update)
+			continue;
+
+		/* Refresh a part shared by several sensors only once. */
+		for (j = 0; j < i; j++)
+			if (temp_sensors[j].update == sensor->update)
+				break;
+		if (j == i)
+			sensor->update();
+	}
+
+	for (i = 0; i < TEMP_SENSOR_COUNT; i++) {
+		sensor = temp_sensors + i;
+		temp_cache[i].rv = sensor->read(sensor->idx, &t);
+		if (temp_cache[i].rv == EC_SUCCESS)
+			temp_cache[i].temp = t;
+	}
+
+	update_mapped_memory();
+}
+
+static void temp_sensor_poll(void)
+{
+	if (--temp_cache_countdown > 0)
+		return;
+
+	temp_cache_countdown = CONFIG_TEMP_SENSOR_UPDATE_PERIOD;
+	temp_sensor_update_cache();
+}
+/* Run after drivers polling on their own, and before consumers. */
+DECLARE_HOOK(HOOK_SECOND, temp_sensor_poll, HOOK_PRIO_TEMP_SENSOR_CACHE);
+#else
 /* Run after other TEMP tasks, so sensors will have updated first. */
 DECLARE_HOOK(HOOK_SECOND, update_mapped_memory, HOOK_PRIO_TEMP_SENSOR_DONE);
+#endif
 
 static void temp_sensor_init(void)
 {
@@ -89,6 +175,12 @@ static void temp_sensor_init(void)
 				EC_TEMP_SENSOR_NOT_PRESENT;
 	}
 
+#ifdef CONFIG_TEMP_SENSOR_CACHE
+	/* Nothing has been read yet. */
+	for (i = 0; i < TEMP_SENSOR_COUNT; ++i)
+		temp_cache[i].rv = EC_ERROR_BUSY;
+#endif
+
 	/* Temp sensor data is present, with B range supported. */
 	*host_get_memmap(EC_MEMMAP_THERMAL_VERSION) = 2;
 }
@@ -49,7 +49,103 @@ BUILD_ASSERT(EC_TEMP_THRESH_COUNT == 3);
 /* Keep track of which thresholds have triggered */
 static cond_t cond_hot[EC_TEMP_THRESH_COUNT];
 
-static void thermal_control(void)
+#ifndef CONFIG_THERMAL_POLL_PERIOD_CPU
+#define CONFIG_THERMAL_POLL_PERIOD_CPU 1
+#endif
+#ifndef CONFIG_THERMAL_POLL_PERIOD_BOARD
+#define CONFIG_THERMAL_POLL_PERIOD_BOARD 1
+#endif
+#ifndef CONFIG_THERMAL_POLL_PERIOD_CASE
+#define CONFIG_THERMAL_POLL_PERIOD_CASE 1
+#endif
+#ifndef CONFIG_THERMAL_POLL_PERIOD_BATTERY
+#define CONFIG_THERMAL_POLL_PERIOD_BATTERY 1
+#endif
+
+/*
+ * A reading which failed with anything but EC_ERROR_NOT_POWERED is replaced
+ * by the last good one, as long as that is not older than this.
+ */
+#define THERMAL_STALE_PERIODS 2
+
+/* Last reading of each sensor, evaluated in one pass by thermal_evaluate() */
+static struct {
+	int temp;		/* Last good reading in K */
+	int rv;			/* Result of the last read */
+	uint8_t age;		/* Seconds since temp was read */
+	uint8_t countdown;	/* Seconds until the next scheduled read */
+	uint8_t fast;		/* Near a threshold, read every hook tick */
+} sensor_cache[TEMP_SENSOR_COUNT];
+
+static int thermal_poll_period(int id)
+{
+	switch (temp_sensors[id].type) {
+	case TEMP_SENSOR_TYPE_CPU:
+		return CONFIG_THERMAL_POLL_PERIOD_CPU;
+	case TEMP_SENSOR_TYPE_CASE:
+		return CONFIG_THERMAL_POLL_PERIOD_CASE;
+	case TEMP_SENSOR_TYPE_BATTERY:
+		return CONFIG_THERMAL_POLL_PERIOD_BATTERY;
+	default:
+		return CONFIG_THERMAL_POLL_PERIOD_BOARD;
+	}
+}
+
+/*
+ * Read a sensor into the thermal cache. A fresh read goes to the hardware;
+ * otherwise the latest reading of the 1 Hz sensor refresh is used.
+ */
+static void thermal_read_sensor(int id, int fresh)
+{
+	int t, rv;
+
+	rv = fresh ? temp_sensor_read_fresh(id, &t) : temp_sensor_read(id, &t);
+	sensor_cache[id].rv = rv;
+	if (rv == EC_ERROR_NOT_POWERED)
+		sensor_cache[id].fast = 0;
+	if (rv != EC_SUCCESS)
+		return;
+
+	sensor_cache[id].temp = t;
+	sensor_cache[id].age = 0;
+
+#ifdef CONFIG_THERMAL_FAST_POLL_MARGIN
+	{
+		int j, limit;
+
+		sensor_cache[id].fast = 0;
+		for (j = 0; j < EC_TEMP_THRESH_COUNT; j++) {
+			limit = thermal_params[id].temp_host[j];
+			if (limit &&
+			    t + CONFIG_THERMAL_FAST_POLL_MARGIN >= limit)
+				sensor_cache[id].fast = 1;
+		}
+	}
+#endif
+}
+
+/* Get the reading to evaluate for a sensor; non-zero if there is none. */
+static int thermal_cached_temp(int id, int *temp_ptr)
+{
+	int rv = sensor_cache[id].rv;
+
+	if (rv == EC_ERROR_NOT_POWERED)
+		return rv;
+
+	if (rv != EC_SUCCESS && sensor_cache[id].age >=
+	    THERMAL_STALE_PERIODS * thermal_poll_period(id))
+		return rv;
+
+	*temp_ptr = sensor_cache[id].temp;
+	return EC_SUCCESS;
+}
+
+/*
+ * Evaluate every threshold of every sensor against the cached readings.
+ * Fans and the missing sensor warning are only handled by the once a second
+ * pass, so CONFIG_FAN_UPDATE_PERIOD keeps counting in seconds.
+ */
+static void thermal_evaluate(int once_a_second)
 {
 	int i, j, t, rv, f;
 	int count_over[EC_TEMP_THRESH_COUNT];
@@ -74,12 +170,11 @@ static void thermal_control(void)
 	/* go through all the sensors */
 	for (i = 0; i < TEMP_SENSOR_COUNT; ++i) {
 
-		/* read one */
-		rv = temp_sensor_read(i, &t);
+		rv = thermal_cached_temp(i, &t);
 
 #ifdef CONFIG_CUSTOM_FAN_CONTROL
 		/* Store all sensors value */
-		temp[i] = K_TO_C(t);
+		temp[i] = K_TO_C(sensor_cache[i].temp);
 #endif
 
 		if (rv != EC_SUCCESS)
@@ -136,7 +231,7 @@ static void thermal_control(void)
 		 * on if the AP is out of G3. Note this could be 'ANY_OFF' as
 		 * well, but that causes the thermal unit test to fail.
 		 */
-		if (!chipset_in_state(CHIPSET_STATE_HARD_OFF))
+		if (once_a_second && !chipset_in_state(CHIPSET_STATE_HARD_OFF))
 			smi_sensor_failure_warning();
 		return;
 	}
@@ -182,7 +277,7 @@ static void thermal_control(void)
 		throttle_ap(THROTTLE_OFF, THROTTLE_SOFT, THROTTLE_SRC_THERMAL);
 	}
 
-	if (temp_fan_configured) {
+	if (temp_fan_configured && once_a_second) {
 #ifdef CONFIG_FANS
 #ifdef CONFIG_CUSTOM_FAN_CONTROL
 		for (i = 0; i < fan_get_count(); i++) {
@@ -205,9 +300,76 @@ static void thermal_control(void)
 	}
 }
 
+static void thermal_control(void)
+{
+	int i;
+
+	/* Read the sensors which are due this second */
+	for (i = 0; i < TEMP_SENSOR_COUNT; ++i) {
+		if (sensor_cache[i].age < UINT8_MAX)
+			sensor_cache[i].age++;
+
+		if (sensor_cache[i].countdown > 1 && !sensor_cache[i].fast) {
+			sensor_cache[i].countdown--;
+			continue;
+		}
+
+		sensor_cache[i].countdown = thermal_poll_period(i);
+		thermal_read_sensor(i, 0);
+	}
+
+	thermal_evaluate(1);
+}
 /* Wait until after the sensors have been read */
 DECLARE_HOOK(HOOK_SECOND, thermal_control, HOOK_PRIO_TEMP_SENSOR_DONE);
 
+#ifdef CONFIG_THERMAL_FAST_POLL_MARGIN
+/*
+ * Between the once a second passes, re-read only the sensors close to a
+ * threshold, so throttling reacts within a hook tick without polling every
+ * sensor at that rate. These reads go to the hardware: the regular readings
+ * only change once a second.
+ */
+static void thermal_fast_poll(void)
+{
+	int i, read = 0;
+
+	for (i = 0; i < TEMP_SENSOR_COUNT; ++i) {
+		if (!sensor_cache[i].fast)
+			continue;
+
+		thermal_read_sensor(i, 1);
+		/*
+		 * Leave a failed fast read to the once-a-second pass, so the
+		 * other sensors' cached values are never judged on their own.
+		 */
+		if (sensor_cache[i].rv != EC_SUCCESS)
+			return;
+		read = 1;
+	}
+
+	if (read)
+		thermal_evaluate(0);
+}
+DECLARE_HOOK(HOOK_TICK, thermal_fast_poll, HOOK_PRIO_DEFAULT);
+#endif
+
+static void thermal_init(void)
+{
+	int i;
+
+	/*
+	 * Spread sensors with the same period over different seconds, so
+	 * slow buses are not hit by every sensor at once.
+	 */
+	for (i = 0; i < TEMP_SENSOR_COUNT; ++i) {
+		sensor_cache[i].rv = EC_ERROR_NOT_POWERED;
+		sensor_cache[i].age = UINT8_MAX;
+		sensor_cache[i].countdown = 1 + i % thermal_poll_period(i);
+	}
+}
+DECLARE_HOOK(HOOK_INIT, thermal_init, HOOK_PRIO_DEFAULT);
+
 /*****************************************************************************/
 /* Console commands */
 
@@ -316,6 +316,39 @@ int uart_put_raw(const char *out, int len)
 	return len ? EC_ERROR_OVERFLOW : EC_SUCCESS;
 }
 
+#ifdef CONFIG_CONSOLE_FRAMED
+int uart_put_frame(const char *out, int len)
+{
+	int i;
+
+	if (len >= CONFIG_UART_TX_BUF_SIZE)
+		return EC_ERROR_OVERFLOW;
+
+	/*
+	 * Output from other tasks must not end up in the middle of the frame,
+	 * and the frame must not be cut short by a full buffer. Wait for room
+	 * and then put it in with interrupts off.
+	 */
+	while (1) {
+		interrupt_disable();
+		if (IS_ENABLED(CONFIG_POLLING_UART) ||
+		    CONFIG_UART_TX_BUF_SIZE - 1 -
+		    TX_BUF_DIFF(tx_buf_head, tx_buf_tail) >= len)
+			break;
+		interrupt_enable();
+		uart_flush_output();
+	}
+
+	for (i = 0; i < len; i++)
+		__tx_char_raw(NULL, out[i]);
+	interrupt_enable();
+
+	uart_tx_start();
+
+	return EC_SUCCESS;
+}
+#endif /* CONFIG_CONSOLE_FRAMED */
+
 int uart_vprintf(const char *format, va_list args)
 {
 	int rv = vfnprintf(__tx_char, NULL, format, args);
@@ -6,6 +6,7 @@
 /* High-priority interrupt tasks implementations */
 
 #include "console.h"
+#include "i2c.h"
 #include "task.h"
 #include "timer.h"
 #include "usb_mux.h"
@@ -56,6 +57,8 @@ void pd_interrupt_handler_task(void *p)
 		return;
 
 	pd_int_task_id[port] = task_get_current();
+	/* TCPC alerts go ahead of other users of the port */
+	i2c_set_priority(I2C_PRIO_URGENT);
 
 	while (1) {
 		const int evt = task_wait_event(-1);
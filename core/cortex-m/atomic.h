@@ -73,4 +73,28 @@ static inline uint32_t deprecated_atomic_read_clear(uint32_t volatile *addr)
 
 	return ret;
 }
+
+/**
+ * Atomically replace *var with new_value if it still holds old_value.
+ *
+ * Returns non-zero if the swap happened.
+ */
+static inline int bool_compare_and_swap_u32(uint32_t *var, uint32_t old_value,
+		uint32_t new_value)
+{
+	uint32_t val, tmp;
+
+	__asm__ __volatile__("1: ldrex   %0, [%2]\n"
+			     "   cmp     %0, %3\n"
+			     "   bne     2f\n"
+			     "   strex   %1, %4, [%2]\n"
+			     "   teq     %1, #0\n"
+			     "   bne     1b\n"
+			     "2: clrex"
+			     : "=&r" (val), "=&r" (tmp)
+			     : "r" (var), "r" (old_value), "r" (new_value)
+			     : "cc", "memory");
+
+	return val == old_value;
+}
 #endif  /* __CROS_EC_ATOMIC_H */
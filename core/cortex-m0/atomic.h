@@ -70,4 +70,18 @@ static inline uint32_t deprecated_atomic_read_clear(uint32_t volatile *addr)
 
 	return ret;
 }
+
+static inline int bool_compare_and_swap_u32(uint32_t *var, uint32_t old_value,
+		uint32_t new_value)
+{
+	uint32_t val;
+
+	__asm__ __volatile__("cpsid i" : : : "memory");
+	val = *var;
+	if (val == old_value)
+		*var = new_value;
+	__asm__ __volatile__("cpsie i" : : : "memory");
+
+	return val == old_value;
+}
 #endif  /* __CROS_EC_ATOMIC_H */
@@ -43,4 +43,10 @@ static inline uint32_t deprecated_atomic_read_clear(uint32_t volatile *addr)
 {
 	return __sync_fetch_and_and(addr, 0);
 }
+
+static inline int bool_compare_and_swap_u32(uint32_t *var, uint32_t old_value,
+		uint32_t new_value)
+{
+	return __sync_bool_compare_and_swap(var, old_value, new_value);
+}
 #endif  /* __CROS_EC_ATOMIC_H */
@@ -53,6 +53,7 @@ static void (*pending_isr)(void);
 static int generator_sleeping;
 static timestamp_t generator_sleep_deadline;
 static int has_interrupt_generator = 1;
+static uint32_t task_switches;
 
 /* thread local task id */
 static __thread task_id_t my_task_id = TASK_ID_INVALID;
@@ -218,6 +219,7 @@ uint32_t task_wait_event(int timeout_us)
 	pthread_mutex_lock(&interrupt_lock);
 	if (timeout_us > 0)
 		tasks[tid].wake_time.val = get_time().val + timeout_us;
+	task_switches++;
 
 	/* Transfer control to scheduler */
 	pthread_cond_signal(&scheduler_cond);
@@ -229,6 +231,11 @@ uint32_t task_wait_event(int timeout_us)
 	return ret;
 }
 
+uint32_t task_get_switch_count(void)
+{
+	return task_switches;
+}
+
 uint32_t task_wait_event_mask(uint32_t event_mask, int timeout_us)
 {
 	uint64_t deadline = get_time().val + timeout_us;
@@ -63,4 +63,17 @@ static inline uint32_t deprecated_atomic_read_clear(uint32_t volatile *addr)
 	set_int_mask(int_mask);
 	return val;
 }
+
+static inline int bool_compare_and_swap_u32(uint32_t *var, uint32_t old_value,
+		uint32_t new_value)
+{
+	uint32_t val;
+	uint32_t int_mask = read_clear_int_mask();
+
+	val = *var;
+	if (val == old_value)
+		*var = new_value;
+	set_int_mask(int_mask);
+	return val == old_value;
+}
 #endif  /* __CROS_EC_ATOMIC_H */
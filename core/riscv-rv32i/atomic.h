@@ -68,4 +68,22 @@ static inline uint32_t deprecated_atomic_read_sub(volatile uint32_t *addr,
 	return ATOMIC_OP(add, -value, addr);
 }
 
+static inline int bool_compare_and_swap_u32(uint32_t *var, uint32_t old_value,
+		uint32_t new_value)
+{
+	uint32_t val, tmp;
+
+	asm volatile (
+		"1: lr.w.aqrl %0, %2\n"
+		"   bne       %0, %3, 2f\n"
+		"   sc.w.aqrl %1, %4, %2\n"
+		"   bnez      %1, 1b\n"
+		"2:"
+		: "=&r" (val), "=&r" (tmp), "+A" (*var)
+		: "r" (old_value), "r" (new_value)
+		: "memory");
+
+	return val == old_value;
+}
+
 #endif  /* __CROS_EC_ATOMIC_H */
@@ -81,6 +81,8 @@ test_mockable int sb_write(int cmd, int param)
 int sb_read_string(int offset, uint8_t *data, int len)
 {
 	uint16_t addr_flags = BATTERY_ADDR_FLAGS;
+	enum i2c_prio prio;
+	int rv;
 
 #ifdef CONFIG_BATTERY_CUT_OFF
 	/*
@@ -92,7 +94,12 @@ int sb_read_string(int offset, uint8_t *data, int len)
 	if (battery_supports_pec())
 		addr_flags |= I2C_FLAG_PEC;
 
-	return i2c_read_string(I2C_PORT_BATTERY, addr_flags, offset, data, len);
+	/* Strings are long reads that nobody waits on, let others go first */
+	prio = i2c_set_priority(I2C_PRIO_BACKGROUND);
+	rv = i2c_read_string(I2C_PORT_BATTERY, addr_flags, offset, data, len);
+	i2c_set_priority(prio);
+
+	return rv;
 }
 
 int sb_read_mfgacc(int cmd, int block, uint8_t *data, int len)
@@ -301,21 +308,63 @@ test_mockable int battery_manufacture_date(int *year, int *month, int *day)
 	return EC_SUCCESS;
 }
 
+#ifdef CONFIG_BATTERY_SMART_STRING_CACHE
+/* These strings don't change while the same battery is attached */
+static struct sb_string {
+	uint8_t reg;
+	uint8_t valid;
+	char str[32 + 1];
+} sb_strings[] = {
+	{ .reg = SB_MANUFACTURER_NAME },
+	{ .reg = SB_DEVICE_NAME },
+	{ .reg = SB_DEVICE_CHEMISTRY },
+};
+
+static int sb_read_cached_string(int reg, char *dest, int size)
+{
+	struct sb_string *s;
+	int rv;
+
+	for (s = sb_strings; s->reg != reg; s++)
+		;
+
+	if (!s->valid) {
+		rv = sb_read_string(reg, s->str, sizeof(s->str));
+		if (rv)
+			return rv;
+		s->valid = 1;
+	}
+
+	strzcpy(dest, s->str, size);
+	return EC_SUCCESS;
+}
+
+static void sb_string_cache_clear(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(sb_strings); i++)
+		sb_strings[i].valid = 0;
+}
+#else
+#define sb_read_cached_string sb_read_string
+#endif
+
 int get_battery_manufacturer_name(char *dest, int size)
 {
-	return sb_read_string(SB_MANUFACTURER_NAME, dest, size);
+	return sb_read_cached_string(SB_MANUFACTURER_NAME, dest, size);
 }
 
 /* Read device name */
 test_mockable int battery_device_name(char *dest, int size)
 {
-	return sb_read_string(SB_DEVICE_NAME, dest, size);
+	return sb_read_cached_string(SB_DEVICE_NAME, dest, size);
 }
 
 /* Read battery type/chemistry */
 test_mockable int battery_device_chemistry(char *dest, int size)
 {
-	return sb_read_string(SB_DEVICE_CHEMISTRY, dest, size);
+	return sb_read_cached_string(SB_DEVICE_CHEMISTRY, dest, size);
 }
 
 #ifdef CONFIG_CMD_PWR_AVG
@@ -422,6 +471,13 @@ void battery_get_params(struct batt_params *batt)
 		batt_new.is_present = BP_NOT_SURE;
 #endif
 
+#ifdef CONFIG_BATTERY_SMART_STRING_CACHE
+	/* The next battery may be a different one */
+	if (batt_new.is_present == BP_NO ||
+	    !(batt_new.flags & BATT_FLAG_RESPONSIVE))
+		sb_string_cache_clear();
+#endif
+
 	/*
 	 * Charging allowed if both desired voltage and current are nonzero
 	 * and battery isn't full (and we read them all correctly).
@@ -636,7 +692,10 @@ host_command_sb_read_block(struct host_cmd_handler_args *args)
 	    (p->reg != SB_DEVICE_CHEMISTRY) &&
 	    (p->reg != SB_MANUFACTURER_DATA))
 		return EC_RES_INVALID_PARAM;
-	rv = sb_read_string(p->reg, r->data, 32);
+	if (p->reg == SB_MANUFACTURER_DATA)
+		rv = sb_read_string(p->reg, r->data, 32);
+	else
+		rv = sb_read_cached_string(p->reg, r->data, 32);
 	if (rv)
 		return EC_RES_ERROR;
 
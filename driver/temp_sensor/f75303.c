@@ -24,30 +24,6 @@ void f75303_set_enabled(uint8_t enabled)
 	f75303_enabled = enabled;
 }
 
-/**
- * Read 8 bits register from temp sensor.
- */
-static int raw_read8(const int offset, int *data)
-{
-	return i2c_read8(I2C_PORT_THERMAL, F75303_I2C_ADDR_FLAGS,
-			 offset, data);
-}
-
-static int get_temp(const int offset, int *temp)
-{
-	int rv;
-	int temp_raw = 0;
-
-	rv = raw_read8(offset, &temp_raw);
-	if (rv != 0) {
-		*temp = 0;
-		return rv;
-	}
-	temp_raw = (int8_t)temp_raw;
-	*temp = C_TO_K(temp_raw);
-	return EC_SUCCESS;
-}
-
 int f75303_get_val(int idx, int *temp)
 {
 	if (idx < 0 || F75303_IDX_COUNT <= idx)
@@ -64,15 +40,37 @@ int f75303_get_val(int idx, int *temp)
 	return EC_SUCCESS;
 }
 
-static void f75303_sensor_poll(void)
+static const uint8_t temp_regs[F75303_IDX_COUNT] = {
+	[F75303_IDX_LOCAL] = F75303_TEMP_LOCAL,
+	[F75303_IDX_REMOTE1] = F75303_TEMP_REMOTE1,
+	[F75303_IDX_REMOTE2] = F75303_TEMP_REMOTE2,
+};
+
+void f75303_update_temps(void)
 {
-	if (f75303_enabled) {
-		get_temp(F75303_TEMP_LOCAL, &temps[F75303_IDX_LOCAL]);
-		get_temp(F75303_TEMP_REMOTE1, &temps[F75303_IDX_REMOTE1]);
-		get_temp(F75303_TEMP_REMOTE2, &temps[F75303_IDX_REMOTE2]);
+	uint8_t reg, raw;
+	int i, rv;
+
+	if (!f75303_enabled)
+		return;
+
+	/*
+	 * The part doesn't auto-increment across the remote 2 register, so
+	 * read each channel separately but hold the bus for all of them.
+	 */
+	i2c_lock(I2C_PORT_THERMAL, 1);
+	for (i = 0; i < F75303_IDX_COUNT; i++) {
+		reg = temp_regs[i];
+		rv = i2c_xfer_unlocked(I2C_PORT_THERMAL, F75303_I2C_ADDR_FLAGS,
+				       &reg, 1, &raw, 1, I2C_XFER_SINGLE);
+		temps[i] = rv ? 0 : C_TO_K((int8_t)raw);
 	}
+	i2c_lock(I2C_PORT_THERMAL, 0);
 }
-DECLARE_HOOK(HOOK_SECOND, f75303_sensor_poll, HOOK_PRIO_TEMP_SENSOR);
+
+#ifndef CONFIG_TEMP_SENSOR_CACHE
+DECLARE_HOOK(HOOK_SECOND, f75303_update_temps, HOOK_PRIO_TEMP_SENSOR);
+#endif
 
 static int f75303_set_fake_temp(int argc, char **argv)
 {
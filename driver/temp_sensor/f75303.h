@@ -38,6 +38,16 @@ enum f75303_index {
  */
 int f75303_get_val(int idx, int *temp);
 
+/**
+ * Read all channels of the sensor into the values returned by
+ * f75303_get_val().
+ *
+ * This runs every second on its own, unless CONFIG_TEMP_SENSOR_CACHE is
+ * enabled; the board must then hook it up as the update() callback of
+ * its F75303 sensors.
+ */
+void f75303_update_temps(void);
+
 /**
  * Set if the underlying polling task will read the sensor
  * or if it will skip, as the rail this sensor is on
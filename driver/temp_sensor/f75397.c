@@ -24,30 +24,6 @@ void f75397_set_enabled(uint8_t enabled)
 	f75397_enabled = enabled;
 }
 
-/**
- * Read 8 bits register from temp sensor.
- */
-static int raw_read8(const int offset, int *data)
-{
-	return i2c_read8(I2C_PORT_THERMAL, F75397_I2C_ADDR_FLAGS,
-			 offset, data);
-}
-
-static int get_temp(const int offset, int *temp)
-{
-	int rv;
-	int temp_raw = 0;
-
-	rv = raw_read8(offset, &temp_raw);
-	if (rv != 0) {
-		*temp = 0;
-		return rv;
-	}
-	temp_raw = (int8_t)temp_raw;
-	*temp = C_TO_K(temp_raw);
-	return EC_SUCCESS;
-}
-
 int f75397_get_val(int idx, int *temp)
 {
 	if (idx < 0 || F75397_IDX_COUNT <= idx)
@@ -64,14 +40,33 @@ int f75397_get_val(int idx, int *temp)
 	return EC_SUCCESS;
 }
 
-static void f75397_sensor_poll(void)
+static const uint8_t temp_regs[F75397_IDX_COUNT] = {
+	[F75397_IDX_LOCAL] = F75397_TEMP_LOCAL,
+	[F75397_IDX_REMOTE1] = F75397_TEMP_REMOTE1,
+};
+
+void f75397_update_temps(void)
 {
-	if (f75397_enabled) {
-		get_temp(F75397_TEMP_LOCAL, &temps[F75397_IDX_LOCAL]);
-		get_temp(F75397_TEMP_REMOTE1, &temps[F75397_IDX_REMOTE1]);
+	uint8_t reg, raw;
+	int i, rv;
+
+	if (!f75397_enabled)
+		return;
+
+	/* Hold the bus across both channels. */
+	i2c_lock(I2C_PORT_THERMAL, 1);
+	for (i = 0; i < F75397_IDX_COUNT; i++) {
+		reg = temp_regs[i];
+		rv = i2c_xfer_unlocked(I2C_PORT_THERMAL, F75397_I2C_ADDR_FLAGS,
+				       &reg, 1, &raw, 1, I2C_XFER_SINGLE);
+		temps[i] = rv ? 0 : C_TO_K((int8_t)raw);
 	}
+	i2c_lock(I2C_PORT_THERMAL, 0);
 }
-DECLARE_HOOK(HOOK_SECOND, f75397_sensor_poll, HOOK_PRIO_TEMP_SENSOR);
+
+#ifndef CONFIG_TEMP_SENSOR_CACHE
+DECLARE_HOOK(HOOK_SECOND, f75397_update_temps, HOOK_PRIO_TEMP_SENSOR);
+#endif
 
 static int f75397_set_fake_temp(int argc, char **argv)
 {
@@ -32,6 +32,16 @@ enum f75397_index {
  */
 int f75397_get_val(int idx, int *temp);
 
+/**
+ * Read all channels of the sensor into the values returned by
+ * f75397_get_val().
+ *
+ * This runs every second on its own, unless CONFIG_TEMP_SENSOR_CACHE is
+ * enabled; the board must then hook it up as the update() callback of
+ * its F75397 sensors.
+ */
+void f75397_update_temps(void);
+
 /**
  * Set if the underlying polling task will read the sensor
  * or if it will skip, as the rail this sensor is on
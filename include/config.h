@@ -390,6 +390,12 @@
  */
 #undef CONFIG_ASSEMBLY_MULA32
 
+/*
+ * Use the UMAAL instruction for mulaa32(). Only available on cores with the
+ * ARMv7E-M DSP extension (Cortex-M4 and up); speeds up RSA verification.
+ */
+#undef CONFIG_MULA32_UMAAL
+
 /* Support audio codec. */
 #undef CONFIG_AUDIO_CODEC
 /* Audio codec caps. */
@@ -514,6 +520,12 @@
  */
 #undef CONFIG_BATTERY_SMART
 
+/*
+ * Keep the smart battery manufacturer name, device name and chemistry after
+ * the first read, until the battery is seen missing or unresponsive.
+ */
+#undef CONFIG_BATTERY_SMART_STRING_CACHE
+
 /* Chemistry of the battery device */
 #undef CONFIG_BATTERY_DEVICE_CHEMISTRY
 
@@ -1333,6 +1345,7 @@
 #undef  CONFIG_CMD_I2CWEDGE
 #undef  CONFIG_CMD_I2C_PROTECT
 #define CONFIG_CMD_I2C_SCAN
+#undef  CONFIG_CMD_I2C_SCHED
 #undef  CONFIG_CMD_I2C_STRESS_TEST
 #undef  CONFIG_CMD_I2C_STRESS_TEST_ACCEL
 #undef  CONFIG_CMD_I2C_STRESS_TEST_ALS
@@ -1538,9 +1551,23 @@
  */
 #undef CONFIG_EXPERIMENTAL_CONSOLE
 
+/*
+ * Accept CRC-protected request frames on the UART console and answer them
+ * with framed output, for scripted access (see util/ec3po/framed.py). The
+ * interactive console keeps working alongside it. Not compatible with
+ * CONFIG_EXPERIMENTAL_CONSOLE.
+ */
+#undef CONFIG_CONSOLE_FRAMED
+
 /* Include CRC-8 utility function */
 #undef CONFIG_CRC8
 
+/*
+ * Compute CRC-8 a byte at a time with a 256-byte table, instead of a nibble
+ * at a time with a 16-byte one.
+ */
+#undef CONFIG_CRC8_TABLE_256
+
 /*****************************************************************************/
 /*
  * Debugging config
@@ -1693,6 +1720,12 @@
 /* Support fan control while in low-power idle */
 #undef CONFIG_FAN_DSLEEP
 
+/*
+ * Build the software RPM controller in common/fan_pid.c, for fan drivers
+ * which only have a PWM output and a tachometer.
+ */
+#undef CONFIG_FAN_PID
+
 /*
  * Fans have non-const configuration.
  */
@@ -1727,6 +1760,14 @@
 #undef CONFIG_FLASH_ERASE_SIZE
 /* Allow deferred (async) flash erase */
 #undef CONFIG_FLASH_DEFERRED_ERASE
+/*
+ * Run deferred flash erases in the background: the chip erases each block on
+ * its own while the EC keeps running, and flash reads suspend the erase
+ * rather than wait for it.  Requires CONFIG_FLASH_DEFERRED_ERASE and a chip
+ * implementing flash_physical_erase_background(); for SPI flash, the part
+ * must support erase suspend/resume.
+ */
+#undef CONFIG_FLASH_BACKGROUND_ERASE
 /* Flash must be selected for write/erase operations to succeed. */
 #undef CONFIG_FLASH_SELECT_REQUIRED
 
@@ -1754,6 +1795,18 @@
  */
 #undef CONFIG_MAPPED_STORAGE_BASE
 
+/*
+ * Cache recently read flash pages in RAM, for platforms without
+ * CONFIG_MAPPED_STORAGE where each flash_read() goes out to the SPI flash.
+ * The least recently used page is evicted first.  Reads larger than half the
+ * cache, such as vboot hashing, bypass it.  The flash driver drops the pages
+ * it writes or erases with flash_cache_invalidate(); common/spi_flash.c does
+ * this, so writers that bypass flash_write() are covered too.
+ */
+#undef CONFIG_FLASH_READ_CACHE
+#define CONFIG_FLASH_READ_CACHE_PAGES 8
+#define CONFIG_FLASH_READ_CACHE_PAGE_SIZE 256
+
 #undef CONFIG_FLASH_PROTECT_NEXT_BOOT
 
 /*
@@ -2094,6 +2147,30 @@
 /* Config option to support 64-bit hostevents and wake-masks. */
 #define CONFIG_HOST_EVENT64
 
+/*
+ * Hold back host events that are set within this many ms of the previous
+ * delivery and deliver them together, so that a burst of events costs the
+ * host at most one SCI (or MKBP event) instead of one per event.
+ */
+#undef CONFIG_HOST_EVENT_COALESCE_MS
+
+/*
+ * Host events that are always delivered right away, even with
+ * CONFIG_HOST_EVENT_COALESCE_MS. Events in the wake mask are never held back
+ * either.
+ */
+#define CONFIG_HOST_EVENT_URGENT_MASK				\
+	(EC_HOST_EVENT_MASK(EC_HOST_EVENT_LID_CLOSED) |		\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_LID_OPEN) |		\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_POWER_BUTTON) |	\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_MODE_CHANGE) |	\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_KEYBOARD_RECOVERY) |	\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_BATTERY_CRITICAL) |	\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_BATTERY_SHUTDOWN) |	\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_THERMAL_SHUTDOWN) |	\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_HANG_DETECT) |	\
+	 EC_HOST_EVENT_MASK(EC_HOST_EVENT_PANIC))
+
 /*
  * The host commands are sorted in the .rodata.hcmds section so use the binary
  * search algorithm to match a command to its handler
@@ -2215,6 +2292,12 @@
 /* Enable debugging and profiling statistics for hook functions */
 #undef CONFIG_HOOK_DEBUG
 
+/*
+ * Allow timing each routine of a hook_notify() call, see
+ * hook_timing_start().
+ */
+#undef CONFIG_HOOK_TIMING
+
 /*****************************************************************************/
 /* CRC configuration */
 
@@ -2224,6 +2307,20 @@
 /* Enable the software routine for CRC computation */
 #undef CONFIG_SW_CRC
 
+/*
+ * Table used by the software CRC-32.  By default a 256-entry table (1 KB of
+ * flash) is used to process a byte at a time.  Define one of these to pick
+ * another size:
+ *
+ * CONFIG_SW_CRC_TABLE_NIBBLE - a 16-entry table processing a nibble at a
+ * time, for images tight on flash.  About half the speed of the default.
+ *
+ * CONFIG_SW_CRC_SLICE_BY_4 - processes aligned buffers a word at a time
+ * with three more tables, which are built in RAM (3 KB) on first use.
+ */
+#undef CONFIG_SW_CRC_TABLE_NIBBLE
+#undef CONFIG_SW_CRC_SLICE_BY_4
+
 /*****************************************************************************/
 
 /* Enable system hibernate */
@@ -2292,6 +2389,18 @@
 #undef CONFIG_I2C
 #undef CONFIG_I2C_DEBUG
 #undef CONFIG_I2C_DEBUG_PASSTHRU
+/*
+ * Number of transactions kept by the CONFIG_I2C_DEBUG capture ring. Must be a
+ * power of two.
+ */
+#define CONFIG_I2C_TRACE_ENTRIES 32
+
+/*
+ * Keep per-device I2C transfer counts, bus time and error counts, read with
+ * EC_CMD_I2C_STATS. Up to CONFIG_I2C_STATS_DEVICES devices are tracked.
+ */
+#undef CONFIG_I2C_STATS
+#define CONFIG_I2C_STATS_DEVICES 16
 #undef CONFIG_I2C_PASSTHRU_RESTRICTED
 #undef CONFIG_I2C_VIRTUAL_BATTERY
 
@@ -2324,6 +2433,21 @@
  */
 #undef CONFIG_I2C_XFER_BOARD_CALLBACK
 
+/*
+ * Chip driver can start a transfer and collect its result later
+ * (chip_i2c_xfer_start() / chip_i2c_xfer_finish()), so i2c_xfer_submit()
+ * returns while the bus is busy. Without it, i2c_xfer_submit() runs the
+ * transfer synchronously.
+ */
+#undef CONFIG_I2C_XFER_ASYNC
+
+/*
+ * Serve I2C port lock waiters highest priority first (see
+ * i2c_set_priority()) rather than in task priority order. Costs a few
+ * timestamps and interrupt disables per transfer, and per-port state.
+ */
+#undef CONFIG_I2C_SCHED
+
 /*
  * EC uses an I2C master interface.
  * Note: if this is defined, i2c_init() will be called
@@ -2399,6 +2523,14 @@
  */
 #undef CONFIG_SMBUS_PEC
 
+/*
+ * Read SMBus blocks (i2c_read_string) in a single transfer: the length byte,
+ * the largest block that fits the buffer and the PEC. Blocks shorter than
+ * that are followed by filler bytes, so only define this if the devices read
+ * this way tolerate being read past the end of a block.
+ */
+#undef CONFIG_SMBUS_BLOCK_READ_SINGLE_XFER
+
 /* Support I2C HID touchpad interface. */
 #undef CONFIG_I2C_HID_TOUCHPAD
 
@@ -2897,6 +3029,16 @@
 /* Provide rudimentary malloc/free like services for shared memory. */
 #undef CONFIG_MALLOC
 
+/*
+ * Serve small shared_mem_acquire() requests (up to 256 bytes) from
+ * power-of-two size-class slabs carved out of the shared memory pool at init,
+ * in O(1) and without fragmenting the first-fit chain. Requests which do not
+ * fit a class, or whose class is exhausted, fall back to the chain.
+ * CONFIG_MALLOC_SLAB_OBJS sets the number of objects in each class.
+ */
+#undef CONFIG_MALLOC_SLAB
+#undef CONFIG_MALLOC_SLAB_OBJS
+
 /* Need for a math library */
 #undef CONFIG_MATH_UTIL
 
@@ -2937,6 +3079,13 @@
 #undef CONFIG_MCHP_I2C2_SLAVE_ADDRS
 #undef CONFIG_MCHP_I2C3_SLAVE_ADDRS
 
+/*
+ * Microchip: run complete I2C master transactions on controllers with a
+ * master DMA channel through the network layer, with one interrupt per
+ * transfer. Boards usually pair it with CONFIG_I2C_XFER_ASYNC.
+ */
+#undef CONFIG_MCHP_I2C_DMA
+
 /* Microchip EC SRAM start address */
 #undef CONFIG_MEC_SRAM_BASE_START
 
@@ -3155,6 +3304,13 @@
 /* Support S0ix */
 #undef CONFIG_POWER_S0IX
 
+/*
+ * On S0ix exit, only run the HOOK_CHIPSET_RESUME routines up to this
+ * priority before reporting S0, and defer the rest. Boards enabling it must
+ * make sure their time-critical resume hooks are within the limit.
+ */
+#undef CONFIG_POWER_S0IX_FAST_RESUME_PRIO
+
 /* Support detecting failure to enter a sleep state (S0ix/S3) */
 #undef CONFIG_POWER_SLEEP_FAILURE_DETECTION
 
@@ -3366,6 +3522,12 @@
 /* Unroll some loops in SHA256_transform for better performance. */
 #undef CONFIG_SHA256_UNROLLED
 
+/*
+ * The chip has a hash accelerator and provides sha256_hw_transform() (see
+ * sha256.h). Blocks the engine declines are hashed in software.
+ */
+#undef CONFIG_SHA256_HW_ACCELERATE
+
 /* Emulate the CLZ (Count Leading Zeros) in software for CPU lacking support */
 #undef CONFIG_SOFTWARE_CLZ
 
@@ -3420,6 +3582,15 @@
 /* SPI flash part supports SR2 register */
 #undef CONFIG_SPI_FLASH_HAS_SR2
 
+/*
+ * Read SPI flash with a fast read command, streaming each transaction
+ * straight into the caller's buffer. Needs spi_transaction_fast_read() from
+ * the chip. Define to the number of data lines to read on: 1 (0x0B), 2 (0x3B)
+ * or 4 (0x6B). Quad output also needs the flash QE bit set and IO2/IO3 wired
+ * to the controller.
+ */
+#undef CONFIG_SPI_FLASH_FAST_READ
+
 /* Define the SPI port to use to access the fingerprint sensor */
 #undef CONFIG_SPI_FP_PORT
 
@@ -3638,6 +3809,32 @@
 /* Compile common code for temperature sensor support */
 #undef CONFIG_TEMP_SENSOR
 
+/*
+ * Keep the last reading of every sensor in common code, refreshed every
+ * CONFIG_TEMP_SENSOR_UPDATE_PERIOD seconds (default 1). temp_sensor_read()
+ * and the host memory map are then served from the cache instead of the
+ * drivers, and drivers providing an update() callback are polled from there
+ * rather than from their own HOOK_SECOND.
+ */
+#undef CONFIG_TEMP_SENSOR_CACHE
+#undef CONFIG_TEMP_SENSOR_UPDATE_PERIOD
+
+/*
+ * Thermal engine poll period for each sensor type, in seconds. Sensors with
+ * a period longer than one second are staggered so they don't all get read
+ * in the same second. The default period is one second.
+ */
+#undef CONFIG_THERMAL_POLL_PERIOD_CPU
+#undef CONFIG_THERMAL_POLL_PERIOD_BOARD
+#undef CONFIG_THERMAL_POLL_PERIOD_CASE
+#undef CONFIG_THERMAL_POLL_PERIOD_BATTERY
+
+/*
+ * While a sensor is within this many degrees K of its lowest host threshold,
+ * poll it every HOOK_TICK and evaluate the thresholds as soon as it reports.
+ */
+#undef CONFIG_THERMAL_FAST_POLL_MARGIN
+
 /* Support particular temperature sensor chips */
 #undef CONFIG_TEMP_SENSOR_ADT7481	/* ADT 7481 sensor, on I2C bus */
 #undef CONFIG_TEMP_SENSOR_BD99992GW	/* BD99992GW PMIC, on I2C bus */
@@ -4072,6 +4269,12 @@
 /* Record main PD events in a circular buffer */
 #undef CONFIG_USB_PD_LOGGING
 
+/*
+ * Generic event log FIFO (common/event_log.c). Selected automatically by the
+ * features logging into it, such as CONFIG_USB_PD_LOGGING.
+ */
+#undef CONFIG_EVENT_LOG
+
 /* The size in bytes of the FIFO used for event logging */
 #define CONFIG_EVENT_LOG_SIZE 512
 
@@ -5115,6 +5318,15 @@
 #define CONFIG_CRC8
 #endif /* defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
+/* The framed console protects frames with CRC8 too. */
+#ifdef CONFIG_CONSOLE_FRAMED
+#define CONFIG_CRC8
+#endif
+
+#ifdef CONFIG_USB_PD_LOGGING
+#define CONFIG_EVENT_LOG
+#endif
+
 
 /******************************************************************************/
 /*
@@ -5620,6 +5832,17 @@
 	CONFIG_EC_MAX_SENSOR_FREQ_DEFAULT_MILLIHZ
 #endif
 
+/* Default temperature sensor cache refresh period, in seconds. */
+#if defined(CONFIG_TEMP_SENSOR_CACHE) && \
+	!defined(CONFIG_TEMP_SENSOR_UPDATE_PERIOD)
+#define CONFIG_TEMP_SENSOR_UPDATE_PERIOD 1
+#endif
+
+/* Default number of objects in each shared memory slab size class. */
+#if defined(CONFIG_MALLOC_SLAB) && !defined(CONFIG_MALLOC_SLAB_OBJS)
+#define CONFIG_MALLOC_SLAB_OBJS 4
+#endif
+
 /* Enable BMI secondary port if needed. */
 #if defined(CONFIG_MAG_BMI_BMM150) || \
 	defined(CONFIG_MAG_BMI_LIS2MDL)
@@ -155,6 +155,52 @@ void cflush(void);
  */
 void console_has_input(void);
 
+/*
+ * Framed console (CONFIG_CONSOLE_FRAMED)
+ *
+ * Lets a script run console commands without parsing them back out of the
+ * text stream. Every frame, in either direction, is
+ *
+ *   SOF0 SOF1 type seq len_lo len_hi payload[len] crc8
+ *
+ * where the CRC-8 covers type through the end of the payload. The host sends
+ * a REQUEST holding a command line. The EC answers with any number of OUTPUT
+ * frames holding what the command printed, then a DONE frame holding the
+ * command's return code as a little endian int32. All of them echo the
+ * request's seq. A request that is corrupted or too long is answered with a
+ * NAK instead and not run.
+ *
+ * SOF0 is never part of console text, so frames can be picked out of the
+ * stream while log output from other tasks keeps flowing as plain text.
+ */
+#define CONSOLE_FRAME_SOF0		0xF0
+#define CONSOLE_FRAME_SOF1		0xEC
+#define CONSOLE_FRAME_HEADER_SIZE	6
+#define CONSOLE_FRAME_MAX_OUTPUT	64
+
+enum console_frame_type {
+	CONSOLE_FRAME_REQUEST = 1,
+	CONSOLE_FRAME_OUTPUT = 2,
+	CONSOLE_FRAME_DONE = 3,
+	CONSOLE_FRAME_NAK = 4,
+};
+
+/**
+ * Return non-zero if console output should go into the current response
+ * frame rather than to the UART, i.e. when called from a command run from a
+ * request frame.
+ */
+int console_frame_active(void);
+
+/**
+ * Add a character to the current response frame.
+ *
+ * @param context	Unused; matches the vfnprintf() callback
+ * @param c		Character to add
+ * @return 0
+ */
+int console_frame_putc(void *context, int c);
+
 /**
  * Register a console command handler.
  *
@@ -3782,6 +3782,31 @@ struct ec_response_get_next_event_v1 {
 	union ec_response_get_next_data_v1 data;
 } __ec_align1;
 
+/*
+ * Version 3 drains as many pending events as fit in the response buffer.
+ * Events from the same source (e.g. the keyboard FIFO) are returned in the
+ * order they were queued.
+ */
+struct ec_response_get_next_event_v3 {
+	/* Number of event records that follow */
+	uint8_t count;
+	/*
+	 * Number of event types still pending after this response. This is
+	 * not an event count: one type (e.g. the keyboard FIFO) may still hold
+	 * several events.
+	 */
+	uint8_t pending_types;
+	/* Followed by count x struct ec_mkbp_event_record */
+} __ec_align1;
+
+struct ec_mkbp_event_record {
+	uint8_t event_type;
+	/* Size of data, in bytes */
+	uint8_t size;
+	/* size bytes of event data, as in the v1 response */
+	uint8_t data[];
+} __ec_align1;
+
 /* Bit indices for buttons and switches.*/
 /* Buttons */
 #define EC_MKBP_POWER_BUTTON	0
@@ -5567,6 +5592,8 @@ struct ec_params_charge_port_override {
  * Read (and delete) one entry of PD event log.
  * TODO(crbug.com/751742): Make this host command more generic to accommodate
  * future non-PD logs that use the same internal EC event_log.
+ *
+ * Version 1 reads (and deletes) as many entries as fit in the response.
  */
 #define EC_CMD_PD_GET_LOG_ENTRY 0x0115
 
@@ -5578,6 +5605,22 @@ struct ec_response_pd_log {
 	uint8_t payload[0]; /* optional additional data payload: 0..16 bytes */
 } __ec_align4;
 
+/*
+ * The entries follow the header back to back. Each entry takes
+ * PD_LOG_ENTRY_SIZE(size_port) bytes: the payload is padded to a multiple of
+ * the entry header size. count is 0 when the log is empty.
+ */
+struct ec_response_pd_log_v1 {
+	uint32_t dropped;   /* entries lost to a full log since the last read */
+	uint8_t count;      /* number of entries following */
+	uint8_t reserved[3];
+	uint8_t entries[0]; /* count x struct ec_response_pd_log */
+} __ec_align4;
+
+#define PD_LOG_ENTRY_SIZE(size_port) (sizeof(struct ec_response_pd_log) + \
+	((PD_LOG_SIZE(size_port) + sizeof(struct ec_response_pd_log) - 1) & \
+	 ~(sizeof(struct ec_response_pd_log) - 1)))
+
 /* The timestamp is the microsecond counter shifted to get about a ms. */
 #define PD_LOG_TIMESTAMP_SHIFT 10 /* 1 LSB = 1024us */
 
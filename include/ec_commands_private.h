@@ -0,0 +1,134 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Host commands of common code which are not part of the upstream protocol.
+ * They live in the board-specific range (EC_CMD_BOARD_SPECIFIC_BASE), so a
+ * board enabling them must not reuse these values for its own commands.
+ */
+
+#ifndef __CROS_EC_EC_COMMANDS_PRIVATE_H
+#define __CROS_EC_EC_COMMANDS_PRIVATE_H
+
+#include "ec_commands.h"
+
+/*
+ * Get shared memory allocator statistics.
+ *
+ * Reports the state of the first-fit chain and, when the EC uses size-class
+ * slabs, the usage of each class.
+ */
+#define EC_CMD_SHARED_MEM_INFO 0x3E18
+
+#define EC_SHARED_MEM_SLAB_MAX_CLASSES 4
+
+struct ec_shared_mem_slab_info {
+	uint16_t obj_size;	/* Object size of this class in bytes */
+	uint8_t objs;		/* Number of objects in the class */
+	uint8_t in_use;		/* Objects currently allocated */
+	uint8_t high_water;	/* Most objects ever allocated at once */
+	uint8_t reserved[3];
+	uint32_t fallbacks;	/* Requests sent to the chain, class full */
+} __ec_align4;
+
+struct ec_response_shared_mem_info {
+	uint32_t total;		/* Size of the chain in bytes */
+	uint32_t allocated;	/* Bytes allocated from the chain */
+	uint32_t free;		/* Bytes free in the chain */
+	uint32_t max_free;	/* Largest free chain buffer */
+	uint32_t high_water;	/* Most chain bytes ever allocated at once */
+	uint32_t max_allocated;	/* Largest single request */
+	uint16_t free_buffers;	/* Number of free chain buffers */
+	uint16_t slab_classes;	/* Number of valid entries in slab[] */
+	struct ec_shared_mem_slab_info slab[EC_SHARED_MEM_SLAB_MAX_CLASSES];
+} __ec_align4;
+
+/*
+ * Read (and delete) captured I2C transactions, oldest first. Transactions are
+ * captured for the port/address ranges enabled with the i2ctrace console
+ * command. When the capture ring is full, the oldest entry is overwritten.
+ */
+#define EC_CMD_I2C_TRACE_READ 0x3E19
+
+#define EC_I2C_TRACE_DATA_MAX 8
+
+struct ec_i2c_trace_entry {
+	uint32_t start_us;	/* Low 32 bits of EC time at start */
+	uint32_t end_us;	/* Low 32 bits of EC time at end */
+	uint8_t port;
+	uint8_t result;		/* enum ec_error_list, 0 for success */
+	uint16_t addr_flags;	/* Address and I2C_FLAG_* bits */
+	uint16_t out_size;	/* Bytes written */
+	uint16_t in_size;	/* Bytes read */
+	/*
+	 * The first min(out_size, EC_I2C_TRACE_DATA_MAX) bytes written, then
+	 * as many of the bytes read as fit.
+	 */
+	uint8_t data[EC_I2C_TRACE_DATA_MAX];
+} __ec_align4;
+
+struct ec_response_i2c_trace_read {
+	uint32_t overwritten;	/* Entries lost since the last read */
+	uint8_t count;		/* Number of entries following */
+	uint8_t reserved[3];
+	struct ec_i2c_trace_entry entries[0];
+} __ec_align4;
+
+/*
+ * Per-device I2C bus statistics. Each attempt of a transaction, including
+ * NACK retries, counts as one transfer. An unwedge of a port is charged to
+ * the device of the transfer that ran on it last.
+ */
+#define EC_CMD_I2C_STATS 0x3E1A
+
+/* Reset all counters; no devices are returned */
+#define EC_I2C_STATS_CLEAR BIT(0)
+
+struct ec_params_i2c_stats {
+	uint8_t flags;		/* EC_I2C_STATS_* */
+	uint8_t offset;		/* Index of the first device to return */
+} __ec_align1;
+
+struct ec_i2c_stats_device {
+	uint8_t port;
+	uint8_t reserved;
+	uint16_t addr;		/* 7 or 10-bit address, no flags */
+	uint32_t xfers;
+	uint32_t bytes;		/* Bytes written plus bytes read */
+	uint32_t busy_us;	/* Total transfer time */
+	uint32_t max_us;	/* Longest transfer */
+	uint32_t nacks;		/* Transfers that ended with a NACK */
+	uint32_t timeouts;
+	uint32_t errors;	/* Other failed transfers */
+	uint32_t unwedges;
+} __ec_align4;
+
+struct ec_response_i2c_stats {
+	uint32_t period_ms;	/* Time since the counters were cleared */
+	uint32_t untracked;	/* Transfers of devices beyond the table */
+	uint8_t total;		/* Number of devices seen */
+	uint8_t count;		/* Number of devices following */
+	uint8_t reserved[2];
+	struct ec_i2c_stats_device devices[0];
+} __ec_align4;
+
+/*
+ * Get how far an asynchronous erase (EC_CMD_FLASH_ERASE v1 with
+ * FLASH_ERASE_SECTOR_ASYNC) has gone, on ECs erasing in the background.
+ * This does not consume the result of FLASH_ERASE_GET_RESULT.
+ */
+#define EC_CMD_FLASH_ERASE_PROGRESS 0x3E1B
+
+/**
+ * struct ec_response_flash_erase_progress - Response to FLASH_ERASE_PROGRESS.
+ * @erased: Bytes erased so far, including blank ones which were skipped.
+ * @size: Size of the current or last asynchronous erase.
+ */
+struct ec_response_flash_erase_progress {
+	uint32_t erased;
+	uint32_t size;
+} __ec_align4;
+
+#endif /* __CROS_EC_EC_COMMANDS_PRIVATE_H */
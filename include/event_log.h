@@ -22,7 +22,17 @@ struct event_log_entry {
 /* Returned in the "type" field, when there is no entry available */
 #define EVENT_LOG_NO_ENTRY 0xff
 
-/* Add an entry to the event log. */
+/* Size of a log entry in the FIFO, including its header and padding */
+#define EVENT_LOG_ENTRY_SIZE(size) (sizeof(struct event_log_entry) * \
+	(1 + DIV_ROUND_UP(EVENT_LOG_SIZE(size), \
+			  sizeof(struct event_log_entry))))
+
+/*
+ * Add an entry to the event log.
+ *
+ * Safe to call from any task or interrupt context. If the log is full, the
+ * entry is dropped and counted (see log_take_dropped()).
+ */
 void log_add_event(uint8_t type, uint8_t size, uint16_t data,
 		   void *payload, uint32_t timestamp);
 
@@ -32,4 +42,23 @@ void log_add_event(uint8_t type, uint8_t size, uint16_t data,
  */
 int log_dequeue_event(struct event_log_entry *r);
 
+/*
+ * Remove as many entries as fit in max_bytes from the event log.
+ *
+ * The entries are stored back to back in buf, each one taking
+ * EVENT_LOG_ENTRY_SIZE() bytes. Entries are only dequeued whole.
+ *
+ * @param buf		Destination buffer
+ * @param max_bytes	Size of the destination buffer
+ * @param count		Receives the number of entries written to buf
+ * @return number of bytes written to buf
+ */
+int log_dequeue_events(void *buf, int max_bytes, int *count);
+
+/*
+ * Return the number of entries dropped because the log was full since the
+ * last call, and reset the count.
+ */
+uint32_t log_take_dropped(void);
+
 #endif /* __CROS_EC_EVENT_LOG_H */
@@ -0,0 +1,58 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Software fan RPM controller, for fans driven by a bare PWM and tach */
+
+#ifndef __CROS_EC_FAN_PID_H
+#define __CROS_EC_FAN_PID_H
+
+/* Duty cycles inside the controller are in 1/FAN_PID_SCALE percent. */
+#define FAN_PID_SCALE 1000
+
+struct fan_pid_params {
+	/* Gains, in 1/FAN_PID_SCALE % duty per rpm of error */
+	int kp;
+	int ki;		/* per step the error persists */
+	int kd;		/* per rpm of change since the last step */
+	/* Largest contribution of the integral term */
+	int i_max;
+	/* Largest duty change in one step, 0 for no limit */
+	int slew;
+	/* Errors up to this many rpm are treated as none */
+	int deadband;
+};
+
+struct fan_pid {
+	const struct fan_pid_params *params;
+	/* Target of the previous step, 0 if the fan was off */
+	int target;
+	/* Measured speed at the previous step */
+	int last_rpm;
+	/* Accumulated error, in rpm * steps */
+	int integral;
+	/* Current output */
+	int duty;
+};
+
+/**
+ * Forget the controller history, e.g. when the fan is turned off.
+ */
+void fan_pid_reset(struct fan_pid *pid);
+
+/**
+ * Run one controller step.
+ *
+ * Called at a fixed rate, with the gains tuned for that rate.
+ *
+ * @param pid		Controller state
+ * @param target	Target speed in rpm; 0 turns the fan off
+ * @param feedforward	Open-loop duty in percent expected to give target
+ * @param rpm		Measured speed in rpm
+ *
+ * @return the duty cycle to apply, in percent [0, 100].
+ */
+int fan_pid_step(struct fan_pid *pid, int target, int feedforward, int rpm);
+
+#endif  /* __CROS_EC_FAN_PID_H */
@@ -153,6 +153,28 @@ int flash_physical_write(int offset, int size, const char *data);
  */
 int flash_physical_erase(int offset, int size);
 
+/**
+ * Start erasing physical flash in the background, for chips supporting
+ * CONFIG_FLASH_BACKGROUND_ERASE.
+ *
+ * Offset and size must be a multiple of CONFIG_FLASH_ERASE_SIZE.
+ *
+ * @param offset	Flash offset to erase.
+ * @param size		Number of bytes to erase.
+ * @param done		Called with the result once the erase is finished.
+ * @return EC_SUCCESS if the erase was started, or nonzero if error.
+ */
+int flash_physical_erase_background(int offset, int size,
+				    void (*done)(int rv));
+
+/**
+ * Get the progress of the current or last background erase.
+ *
+ * @param erased	Returns the number of bytes erased so far.
+ * @param size		Returns the total number of bytes to erase.
+ */
+void flash_physical_erase_progress(uint32_t *erased, uint32_t *size);
+
 /**
  * Read physical write protect setting for a flash bank.
  *
@@ -319,6 +341,28 @@ int flash_write(int offset, int size, const char *data);
  */
 int flash_erase(int offset, int size);
 
+/**
+ * Read from flash through the read cache (CONFIG_FLASH_READ_CACHE).
+ *
+ * Used by flash_read() on chips without mapped storage.  Reads that are too
+ * large to be worth caching go straight to flash_physical_read().
+ *
+ * @param offset	Flash offset to read.
+ * @param size		Number of bytes to read.
+ * @param data		Destination buffer for data.
+ * @return EC_SUCCESS, or non-zero if error.
+ */
+int flash_cache_read(int offset, int size, char *data);
+
+/**
+ * Drop cached pages overlapping a range of flash which has been modified.
+ * Called by the flash driver after every write and erase.
+ *
+ * @param offset	Flash offset of the modified range.
+ * @param size		Size of the modified range.
+ */
+void flash_cache_invalidate(int offset, int size);
+
 /**
  * Return the flash protect state.
  *
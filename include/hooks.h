@@ -54,8 +54,10 @@ enum hook_priority {
 
 	/* Specific values to lump temperature-related hooks together */
 	HOOK_PRIO_TEMP_SENSOR = 6000,
+	/* Common reading cache, after drivers polling on their own */
+	HOOK_PRIO_TEMP_SENSOR_CACHE = HOOK_PRIO_TEMP_SENSOR + 1,
 	/* After all sensors have been polled */
-	HOOK_PRIO_TEMP_SENSOR_DONE = HOOK_PRIO_TEMP_SENSOR + 1,
+	HOOK_PRIO_TEMP_SENSOR_DONE = HOOK_PRIO_TEMP_SENSOR + 2,
 };
 
 enum hook_type {
@@ -258,6 +260,42 @@ struct hook_data {
  */
 void hook_notify(enum hook_type type);
 
+/**
+ * Call the hook routines of a type whose priority is within a range.
+ *
+ * Same requirements as hook_notify().
+ *
+ * @param type		Type of hook routines to call.
+ * @param min_prio	First priority to call.
+ * @param max_prio	Last priority to call.
+ */
+void hook_notify_range(enum hook_type type, int min_prio, int max_prio);
+
+/* Run time of a routine, also used by boards to time their own steps */
+struct hook_timing {
+	void (*routine)(void);
+	uint32_t us;
+};
+
+#ifdef CONFIG_HOOK_TIMING
+/**
+ * Record how long each routine takes in hook_notify() calls made by the
+ * calling task until hook_timing_stop(). Notifies from other tasks, and
+ * notifies nested inside a timed routine, are not recorded.
+ *
+ * @param buf	Where to record routines and their run time.
+ * @param max	Size of buf; further routines are not recorded.
+ */
+void hook_timing_start(struct hook_timing *buf, int max);
+
+/**
+ * Stop recording hook routine timings.
+ *
+ * @return the number of routines recorded.
+ */
+int hook_timing_stop(void);
+#endif
+
 struct deferred_data {
 	/* Deferred function pointer */
 	void (*routine)(void);
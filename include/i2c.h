@@ -197,6 +197,47 @@ int i2c_xfer_unlocked(const int port,
 		      const uint8_t *out, int out_size,
 		      uint8_t *in, int in_size, int flags);
 
+/*
+ * Asynchronous transfer request. The caller fills in the first six fields,
+ * then calls i2c_xfer_submit() and later i2c_xfer_complete() from the same
+ * task. The buffers must stay valid until i2c_xfer_complete() returns.
+ */
+struct i2c_xfer_async {
+	int port;
+	uint16_t slave_addr_flags;
+	const uint8_t *out;
+	int out_size;
+	uint8_t *in;
+	int in_size;
+	/* Private to i2c_master.c */
+	int rv;
+	int pending;
+	uint32_t start_us;
+};
+
+/**
+ * Lock the port and start an I2C_XFER_SINGLE transfer.
+ *
+ * With CONFIG_I2C_XFER_ASYNC and a chip that can handle the transfer, this
+ * returns while the transfer is on the bus, so a task can start transfers on
+ * several ports and then wait for all of them. Otherwise the transfer runs to
+ * completion before returning.
+ *
+ * The port stays locked until i2c_xfer_complete(), so a task must not submit
+ * a second transfer on the same controller before completing the first one.
+ *
+ * @param x		Transfer request
+ */
+void i2c_xfer_submit(struct i2c_xfer_async *x);
+
+/**
+ * Wait for a transfer started by i2c_xfer_submit() and unlock the port.
+ *
+ * @param x		Transfer request
+ * @return EC_SUCCESS, or non-zero if error.
+ */
+int i2c_xfer_complete(struct i2c_xfer_async *x);
+
 #define I2C_LINE_SCL_HIGH BIT(0)
 #define I2C_LINE_SDA_HIGH BIT(1)
 #define I2C_LINE_IDLE (I2C_LINE_SCL_HIGH | I2C_LINE_SDA_HIGH)
@@ -268,8 +309,34 @@ void i2c_raw_set_sda(int port, int level);
  */
 int i2c_raw_mode(int port, int enable);
 
+/*
+ * Port lock priority. When a port is unlocked, waiting requests are served
+ * highest priority first.
+ */
+enum i2c_prio {
+	/* Polling and bulk reads that can wait, e.g. battery strings */
+	I2C_PRIO_BACKGROUND,
+	I2C_PRIO_NORMAL,
+	/* Interrupt servicing, e.g. TCPC alerts */
+	I2C_PRIO_URGENT,
+	I2C_PRIO_COUNT
+};
+
+/**
+ * Set the priority of the current task's I2C requests. Has no effect
+ * unless CONFIG_I2C_SCHED is defined.
+ *
+ * @param prio		New priority
+ * @return previous priority, to be restored by the caller.
+ */
+enum i2c_prio i2c_set_priority(enum i2c_prio prio);
+
 /**
  * Lock / unlock an I2C port.
+ *
+ * With CONFIG_I2C_SCHED, tasks waiting for the port defer to waiters of
+ * higher priority (see i2c_set_priority()).
+ *
  * @param port		Port to lock
  * @param lock		1 to lock, 0 to unlock
  */
@@ -561,10 +628,34 @@ void i2c_end_xfer_notify(const int port,
  * @param out_size: size of data written
  * @param in_data: pointer to data read
  * @param in_size: size of data read
+ * @param ret: result of the transaction
+ * @param start_us: low 32 bits of the time the transaction started
  */
 void i2c_trace_notify(int port, uint16_t slave_addr_flags,
 		      const uint8_t *out_data, size_t out_size,
-		      const uint8_t *in_data, size_t in_size);
+		      const uint8_t *in_data, size_t in_size,
+		      int ret, uint32_t start_us);
+
+/**
+ * Defined in common/i2c_stats.c, used by i2c master to account each transfer
+ * attempt to its device (CONFIG_I2C_STATS).
+ *
+ * @param port: I2C port number
+ * @param slave_addr_flags: slave device address
+ * @param out_size: size of data written
+ * @param in_size: size of data read
+ * @param ret: result of the transfer
+ * @param start_us: low 32 bits of the time the transfer started
+ */
+void i2c_stats_record(int port, uint16_t slave_addr_flags,
+		      int out_size, int in_size, int ret, uint32_t start_us);
+
+/**
+ * Count an unwedge of the port against the device that used it last.
+ *
+ * @param port: I2C port number
+ */
+void i2c_stats_unwedge(int port);
 
 /**
  * Set bus speed. Only support for ports with I2C_PORT_FLAG_DYNAMIC_SPEED
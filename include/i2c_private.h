@@ -34,6 +34,32 @@ int chip_i2c_xfer(const int port,
 		  const uint8_t *out, int out_size,
 		  uint8_t *in, int in_size, int flags);
 
+/**
+ * Chip-level function to start a transfer without waiting for it to finish.
+ *
+ * Only used with CONFIG_I2C_XFER_ASYNC. Takes the same arguments as
+ * chip_i2c_xfer(). The buffers must stay valid until chip_i2c_xfer_finish()
+ * returns, and the caller must hold the port lock throughout.
+ *
+ * @return EC_SUCCESS if the transfer was started, EC_ERROR_UNIMPLEMENTED if
+ * the chip can't run this transfer asynchronously (the caller should use
+ * chip_i2c_xfer() instead), or another error if the transfer could not start.
+ */
+int chip_i2c_xfer_start(const int port,
+			const uint16_t slave_addr_flags,
+			const uint8_t *out, int out_size,
+			uint8_t *in, int in_size, int flags);
+
+/**
+ * Chip-level function to wait for a transfer started by chip_i2c_xfer_start().
+ *
+ * Must be called from the task that started the transfer.
+ *
+ * @param port		Port the transfer was started on
+ * @return EC_SUCCESS, or non-zero if error.
+ */
+int chip_i2c_xfer_finish(const int port);
+
 /**
  * Chip level function to set bus speed.
  *
@@ -12,6 +12,7 @@
 #include "hooks.h"
 #include "host_command.h"
 #include "mkbp_event.h"
+#include "system.h"
 #include "task.h"
 #include "test_util.h"
 
@@ -83,6 +84,10 @@ extern const struct deferred_data __deferred_funcs_end[];
 extern uint64_t __deferred_until[];
 extern uint64_t __deferred_until_end[];
 
+/* State preserved across sysjumps */
+extern const struct preserved_state __preserved_state[];
+extern const struct preserved_state __preserved_state_end[];
+
 /* I2C fake devices for unit testing */
 extern const struct test_i2c_xfer __test_i2c_xfer[];
 extern const struct test_i2c_xfer __test_i2c_xfer_end[];
@@ -62,6 +62,14 @@ int peci_temp_sensor_get_val(int idx, int *temp_ptr);
  */
 int peci_transaction(struct peci_data *peci);
 
+/**
+ * Lock or unlock the PECI bus. Every caller of peci_transaction() holds it,
+ * so console commands can't interleave with the board's own transactions.
+ *
+ * @param lock		1 to lock the bus, 0 to unlock it
+ */
+void peci_lock(int lock);
+
 /**
  * calculate the Assured Write value based on the number of bytes in input
  * buffer
@@ -26,6 +26,20 @@ void SHA256_init(struct sha256_ctx *ctx);
 void SHA256_update(struct sha256_ctx *ctx, const uint8_t *data, uint32_t len);
 uint8_t *SHA256_final(struct sha256_ctx *ctx);
 
+#ifdef CONFIG_SHA256_HW_ACCELERATE
+/**
+ * Run the SHA-256 block function on a hash accelerator.
+ *
+ * Provided by the chip. Updates the state h[] with block_nb consecutive
+ * 64-byte blocks from data (which may be unaligned or in mapped flash).
+ *
+ * @return EC_SUCCESS, or an error code (e.g. engine busy) to have the blocks
+ *	   hashed in software instead.
+ */
+int sha256_hw_transform(uint32_t *h, const uint8_t *data,
+			unsigned int block_nb);
+#endif
+
 void hmac_SHA256(uint8_t *output, const uint8_t *key, const int key_len,
 		 const uint8_t *message, const int message_len);
 
@@ -83,6 +83,9 @@ struct shm_buffer {
 void set_map_bit(uint32_t mask);
 extern struct shm_buffer *free_buf_chain;
 extern struct shm_buffer *allocced_buf_chain;
+
+/* Return non-zero if ptr was served by a slab rather than the chain. */
+int shared_mem_is_slab(const void *ptr);
 #endif
 
 #endif  /* __CROS_EC_SHARED_MEM_H */
@@ -105,6 +105,25 @@ int spi_transaction_flush(const struct spi_device_t *spi_device);
 /* Wait for async response received but do not de-assert chip select */
 int spi_transaction_wait(const struct spi_device_t *spi_device);
 
+/*
+ * Read from a SPI flash with a fast read command, in one transaction.
+ *
+ * Sends <opcode> and the 24-bit <addr> on one data line, clocks 8 dummy
+ * cycles, then receives <rxlen> bytes on <data_pins> lines (1, 2 or 4)
+ * straight into <rxdata>. Only available when the chip supports
+ * CONFIG_SPI_FLASH_FAST_READ.
+ *
+ * @param spi_device  the SPI device to use
+ * @param opcode  fast read command matching data_pins (0x0B, 0x3B or 0x6B)
+ * @param data_pins  number of lines the data is received on
+ * @param addr  flash address to read from
+ * @param rxdata  receive buffer
+ * @param rxlen  number of bytes to read
+ */
+int spi_transaction_fast_read(const struct spi_device_t *spi_device,
+			      uint8_t opcode, int data_pins, uint32_t addr,
+			      uint8_t *rxdata, int rxlen);
+
 /*
  * Get SPI protocol information. This function is called in runtime if board's
  * host command transport is SPI.
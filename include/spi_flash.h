@@ -22,6 +22,9 @@
 #define SPI_FLASH_ERASE_64KB		0xD8
 #define SPI_FLASH_ERASE_CHIP		0xC7
 #define SPI_FLASH_READ			0x03
+#define SPI_FLASH_FAST_READ		0x0B
+#define SPI_FLASH_FAST_READ_DUAL	0x3B
+#define SPI_FLASH_FAST_READ_QUAD	0x6B
 #define SPI_FLASH_PAGE_PRGRM		0x02
 #define SPI_FLASH_REL_PWRDWN		0xAB
 #define SPI_FLASH_MFR_DEV_ID		0x90
@@ -33,6 +36,8 @@
 #define SPI_FLASH_READ_SEC_REG		0x48
 #define SPI_FLASH_ENABLE_RESET		0x66
 #define SPI_FLASH_RESET			0x99
+#define SPI_FLASH_ERASE_SUSPEND		0x75
+#define SPI_FLASH_ERASE_RESUME		0x7A
 
 /* Maximum single write size (in bytes) for the W25Q64FV SPI flash */
 #define SPI_FLASH_MAX_WRITE_SIZE	256
@@ -93,7 +98,7 @@ int spi_flash_set_status(int reg1, int reg2);
  *
  * @param buf Buffer to write flash contents
  * @param offset Flash offset to start reading from
- * @param bytes Number of bytes to read. Limited by receive buffer to 256.
+ * @param bytes Number of bytes to read.
  *
  * @return EC_SUCCESS, or non-zero if any error.
  */
@@ -109,6 +114,45 @@ int spi_flash_read(uint8_t *buf, unsigned int offset, unsigned int bytes);
  */
 int spi_flash_erase(unsigned int offset, unsigned int bytes);
 
+/**
+ * Start erasing SPI flash in the background.
+ *
+ * The flash is erased one unit at a time from deferred calls. Reads suspend
+ * the erase while they run; writes and other erases fail with
+ * EC_ERROR_BUSY until it is done. Needs a part supporting erase suspend.
+ *
+ * @param offset Flash offset to start erasing
+ * @param bytes Number of bytes to erase
+ * @param done Called with the result once finished, from the hook task or
+ *             from spi_flash_wait_background_erase()
+ *
+ * @return EC_SUCCESS if started, or non-zero if any error.
+ */
+int spi_flash_erase_background(unsigned int offset, unsigned int bytes,
+			       void (*done)(int rv));
+
+/**
+ * Get the progress of the current or last background erase.
+ *
+ * @param erased Returns the number of bytes erased so far
+ * @param size Returns the total number of bytes to erase
+ */
+void spi_flash_erase_progress(uint32_t *erased, uint32_t *size);
+
+/**
+ * Wait for a background erase to finish.
+ *
+ * For callers which cannot give up with EC_ERROR_BUSY: wait with this, then
+ * retry the write or erase, or use spi_flash_rewrite() which does both. The
+ * erase is stepped from the caller as well, so this can be called from the
+ * hook task.
+ *
+ * @param timeout_us Maximum time to wait
+ *
+ * @return EC_SUCCESS once no erase is running, or EC_ERROR_TIMEOUT.
+ */
+int spi_flash_wait_background_erase(int timeout_us);
+
 /**
  * Write to SPI flash. Assumes already erased.
  * Limited to SPI_FLASH_MAX_WRITE_SIZE by chip.
@@ -122,6 +166,26 @@ int spi_flash_erase(unsigned int offset, unsigned int bytes);
 int spi_flash_write(unsigned int offset, unsigned int bytes,
 	const uint8_t *data);
 
+/**
+ * Erase SPI flash, then write data to the start of the erased range.
+ *
+ * If a background erase is running, wait for it to finish first rather than
+ * failing with EC_ERROR_BUSY. Nothing else can start on the flash between
+ * the erase and the write. Unlike spi_flash_write(), data may be larger than
+ * SPI_FLASH_MAX_WRITE_SIZE.
+ *
+ * @param offset Flash offset to erase and write
+ * @param erase_bytes Number of bytes to erase
+ * @param data Data to write to flash
+ * @param bytes Number of bytes to write, at most erase_bytes
+ * @param timeout_us Maximum time to wait for a background erase
+ *
+ * @return EC_SUCCESS, EC_ERROR_BUSY if the background erase did not finish
+ * in time, or non-zero on other errors.
+ */
+int spi_flash_rewrite(unsigned int offset, unsigned int erase_bytes,
+		      const uint8_t *data, unsigned int bytes, int timeout_us);
+
 /**
  * Gets the SPI flash JEDEC ID (manufacturer ID, memory type, and capacity)
  *
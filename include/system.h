@@ -172,6 +172,56 @@ int system_add_jump_tag(uint16_t tag, int version, int size, const void *data);
  */
 const uint8_t *system_get_jump_tag(uint16_t tag, int *version, int *size);
 
+/*
+ * Preserved state
+ *
+ * A module that needs a variable to survive a jump between images declares
+ * it with DECLARE_PRESERVED_STATE() instead of adding its own jump tag. On
+ * sysjump, after the other HOOK_SYSJUMP handlers have run, all declared
+ * variables are packed into one checksummed jump tag. The next image copies
+ * them back in place before HOOK_INIT, so the module only has to check
+ * system_preserved_state_restored() to know whether to keep them.
+ */
+struct preserved_state {
+	/* Variable to preserve */
+	void *data;
+	/* Tag ID; images without the packed tag saved the state under it */
+	uint16_t tag;
+	/* Data version; state saved with another version is not restored */
+	uint8_t version;
+	/* Size of data, at most 255 bytes */
+	uint8_t size;
+	/* Name for the console */
+	const char *name;
+};
+
+#ifdef CONFIG_COMMON_RUNTIME
+/**
+ * Register a variable to be preserved across sysjumps.
+ *
+ * @param name		Name of the state, used for the console
+ * @param _tag		Tag ID, unique across all jump tags
+ * @param _version	Data version
+ * @param var		Variable to preserve, at most 255 bytes
+ */
+#define DECLARE_PRESERVED_STATE(name, _tag, _version, var)		\
+	BUILD_ASSERT(sizeof(var) <= 255);				\
+	const struct preserved_state __keep __no_sanitize_address	\
+	CONCAT2(__preserved_state_, name)				\
+	__attribute__((section(".rodata.preserved_state")))		\
+	     = {&(var), _tag, _version, sizeof(var), #name}
+#else
+#define DECLARE_PRESERVED_STATE(name, _tag, _version, var)		\
+	BUILD_ASSERT(sizeof(var) <= 255)
+#endif
+
+/**
+ * Return non-zero if the state registered with tag was restored from the
+ * previous image, zero if this is a cold boot or the previous image did not
+ * preserve it (or preserved another version).
+ */
+int system_preserved_state_restored(uint16_t tag);
+
 /**
  * Return the address just past the last usable byte in RAM.
  */
@@ -37,6 +37,13 @@ struct temp_sensor_t {
 	int (*read)(int idx, int *temp_ptr);
 	/* Index among the same kind of sensors. */
 	int idx;
+	/*
+	 * Optional: refresh every channel of the part in one go, ahead of
+	 * the read() calls for the same part.  Used by the
+	 * CONFIG_TEMP_SENSOR_CACHE refresh and by temp_sensor_read_fresh();
+	 * may be shared by several sensors.
+	 */
+	void (*update)(void);
 };
 
 #ifdef CONFIG_TEMP_SENSOR
@@ -57,4 +64,26 @@ extern const struct temp_sensor_t temp_sensors[];
  */
 int temp_sensor_read(enum temp_sensor_id id, int *temp_ptr);
 
+/**
+ * Read the sensor from the hardware now, bypassing the 1 Hz refresh of the
+ * driver and of the temperature cache. The cache is updated with the result.
+ *
+ * @param id		Sensor ID
+ * @param temp_ptr	Destination for temperature
+ *
+ * @return EC_SUCCESS, or non-zero if error.
+ */
+int temp_sensor_read_fresh(enum temp_sensor_id id, int *temp_ptr);
+
+#ifdef CONFIG_TEMP_SENSOR_CACHE
+/**
+ * Refresh the cached readings of all sensors from their drivers.
+ *
+ * This is done every CONFIG_TEMP_SENSOR_UPDATE_PERIOD seconds; call it
+ * directly when a fresh reading is needed sooner, e.g. right after a rail
+ * carrying the sensors has been powered.
+ */
+void temp_sensor_update_cache(void);
+#endif
+
 #endif  /* __CROS_EC_TEMP_SENSOR_H */
@@ -179,6 +179,12 @@ void task_trigger_test_interrupt(void (*isr)(void));
  */
 void interrupt_generator_udelay(unsigned us);
 
+/*
+ * Number of times a task has blocked and handed the CPU back to the emulator
+ * scheduler. Each of these is a task switch on real hardware.
+ */
+uint32_t task_get_switch_count(void);
+
 #ifdef EMU_BUILD
 void wait_for_task_started(void);
 void wait_for_task_started_nosleep(void);
@@ -211,6 +217,9 @@ void test_capture_console(int enabled);
 /* Get captured console output */
 const char *test_get_captured_console(void);
 
+/* Get the number of bytes of captured console output */
+int test_get_captured_console_size(void);
+
 /*
  * Flush emulator status. Must be called before emulator reboots or
  * exits.
@@ -65,6 +65,18 @@ int uart_put(const char *out, int len);
  */
 int uart_put_raw(const char *out, int len);
 
+/**
+ * Put a console frame to the UART as one unit
+ *
+ * Waits for room in the output buffer so the frame is never truncated, and
+ * never interleaved with other output.
+ *
+ * @param out		Pointer to frame to send
+ * @param len		Length of frame in bytes
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the frame can never fit.
+ */
+int uart_put_frame(const char *out, int len);
+
 /**
  * Print formatted output to the UART, like printf().
  *
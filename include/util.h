@@ -289,6 +289,14 @@ static inline uint64_t mula32(uint32_t a, uint32_t b, uint32_t c)
 
 static inline uint64_t mulaa32(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
 {
+#ifdef CONFIG_MULA32_UMAAL
+	/* RdHi:RdLo = Rn * Rm + RdHi + RdLo, this can never overflow. */
+	uint32_t lo = c, hi = d;
+
+	asm("umaal %0, %1, %2, %3" : "+r"(lo), "+r"(hi) : "r"(a), "r"(b));
+
+	return ((uint64_t)hi << 32) | lo;
+#else
 	uint64_t ret = a;
 
 	ret *= b;
@@ -296,6 +304,7 @@ static inline uint64_t mulaa32(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
 	ret += d;
 
 	return ret;
+#endif
 }
 #endif
 
@@ -26,11 +26,18 @@ test-list-host += charge_manager_drp_charging
 test-list-host += charge_ramp
 test-list-host += compile_time_macros
 test-list-host += console_edit
+test-list-host += console_frame
+test-list-host += console_lookup
 test-list-host += crc32
+test-list-host += crc32_nibble
+test-list-host += crc32_slice4
 test-list-host += entropy
+test-list-host += event_log
 test-list-host += extpwr_gpio
 test-list-host += fan
+test-list-host += fan_pid
 test-list-host += flash
+test-list-host += flash_cache
 test-list-host += float
 test-list-host += fp
 test-list-host += fpsensor
@@ -39,7 +46,12 @@ test-list-host += fpsensor_state
 test-list-host += gyro_cal
 test-list-host += hooks
 test-list-host += host_command
+test-list-host += host_event_coalesce
+test-list-host += i2c_async
 test-list-host += i2c_bitbang
+test-list-host += i2c_sched
+test-list-host += i2c_stats
+test-list-host += i2c_trace
 test-list-host += inductive_charging
 test-list-host += interrupt
 test-list-host += is_enabled
@@ -65,14 +77,21 @@ test-list-host += printf
 test-list-host += queue
 test-list-host += rsa
 test-list-host += rsa3
+test-list-host += rsa3072
+test-list-host += rsa3072_3
 test-list-host += rtc
 test-list-host += sbs_charging_v2
 test-list-host += sha256
 test-list-host += sha256_unrolled
+test-list-host += sha256_hw
 test-list-host += shmalloc
+test-list-host += shmalloc_slab
+test-list-host += smbus_block
+test-list-host += spi_flash_erase
 test-list-host += static_if
 test-list-host += static_if_error
 test-list-host += system
+test-list-host += temp_sensor
 test-list-host += thermal
 test-list-host += timer_dos
 test-list-host += uptime
@@ -134,11 +153,18 @@ charge_manager_drp_charging-y=charge_manager.o
 charge_ramp-y+=charge_ramp.o
 compile_time_macros-y=compile_time_macros.o
 console_edit-y=console_edit.o
+console_frame-y=console_frame.o
+console_lookup-y=console_lookup.o
 crc32-y=crc32.o
+crc32_nibble-y=crc32.o
+crc32_slice4-y=crc32.o
 entropy-y=entropy.o
+event_log-y=event_log.o
 extpwr_gpio-y=extpwr_gpio.o
 fan-y=fan.o
+fan_pid-y=fan_pid.o
 flash-y=flash.o
+flash_cache-y=flash_cache.o
 flash_physical-y=flash_physical.o
 flash_write_protect-y=flash_write_protect.o
 fpsensor-y=fpsensor.o
@@ -147,7 +173,12 @@ fpsensor_state-y=fpsensor_state.o
 gyro_cal-y=gyro_cal.o
 hooks-y=hooks.o
 host_command-y=host_command.o
+host_event_coalesce-y=host_event_coalesce.o
+i2c_async-y=i2c_async.o
 i2c_bitbang-y=i2c_bitbang.o
+i2c_sched-y=i2c_sched.o
+i2c_stats-y=i2c_stats.o
+i2c_trace-y=i2c_trace.o
 inductive_charging-y=inductive_charging.o
 interrupt-y=interrupt.o
 is_enabled-y=is_enabled.o
@@ -176,17 +207,24 @@ rollback-y=rollback.o
 rollback_entropy-y=rollback_entropy.o
 rsa-y=rsa.o
 rsa3-y=rsa.o
+rsa3072-y=rsa.o
+rsa3072_3-y=rsa.o
 rtc-y=rtc.o
 scratchpad-y=scratchpad.o
 sbs_charging-y=sbs_charging.o
 sbs_charging_v2-y=sbs_charging_v2.o
 sha256-y=sha256.o
 sha256_unrolled-y=sha256.o
+sha256_hw-y=sha256.o
 shmalloc-y=shmalloc.o
+shmalloc_slab-y=shmalloc.o
+smbus_block-y=smbus_block.o
+spi_flash_erase-y=spi_flash_erase.o
 static_if-y=static_if.o
 stm32f_rtc-y=stm32f_rtc.o
 stress-y=stress.o
 system-y=system.o
+temp_sensor-y=temp_sensor.o
 thermal-y=thermal.o
 timer_calib-y=timer_calib.o
 timer_dos-y=timer_dos.o
@@ -0,0 +1,257 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the framed console.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "crc8.h"
+#include "hooks.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+static int fcmd_call_cnt;
+
+static int command_fcmd(int argc, char **argv)
+{
+	fcmd_call_cnt++;
+	ccprintf("fcmd %d args\n", argc);
+	return argc == 3 ? EC_SUCCESS : EC_ERROR_PARAM_COUNT;
+}
+DECLARE_CONSOLE_COMMAND(fcmd, command_fcmd, "a b", NULL);
+
+static int command_fbig(int argc, char **argv)
+{
+	int i;
+
+	for (i = 0; i < 20; i++)
+		ccprintf("line %02d..\n", i);
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(fbig, command_fbig, NULL, NULL);
+
+static void async_log(void)
+{
+	ccprints("async log");
+}
+DECLARE_DEFERRED(async_log);
+
+static int command_fslow(int argc, char **argv)
+{
+	ccputs("before ");
+	hook_call_deferred(&async_log_data, 0);
+	msleep(5);
+	ccputs("after\n");
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(fslow, command_fslow, NULL, NULL);
+
+/*****************************************************************************/
+/* Test utilities */
+
+/* What came back from the EC, split into frames and plain text */
+static char text[1024];
+static char output[1024];
+static int output_len;
+static int done_rv;
+static int done_seq;
+static int done_cnt;
+static int nak_cnt;
+static int bad_frame_cnt;
+
+static void send_request(uint8_t seq, const char *cmd, int corrupt)
+{
+	uint8_t frame[CONSOLE_FRAME_HEADER_SIZE + 64 + 1];
+	int len = strlen(cmd);
+
+	frame[0] = CONSOLE_FRAME_SOF0;
+	frame[1] = CONSOLE_FRAME_SOF1;
+	frame[2] = CONSOLE_FRAME_REQUEST;
+	frame[3] = seq;
+	frame[4] = len;
+	frame[5] = 0;
+	memcpy(frame + CONSOLE_FRAME_HEADER_SIZE, cmd, len);
+	frame[CONSOLE_FRAME_HEADER_SIZE + len] =
+		crc8(frame + 2, CONSOLE_FRAME_HEADER_SIZE - 2 + len);
+	if (corrupt)
+		frame[CONSOLE_FRAME_HEADER_SIZE] ^= 1;
+
+	uart_inject_char((char *)frame, CONSOLE_FRAME_HEADER_SIZE + len + 1);
+}
+
+static void parse_response(void)
+{
+	const uint8_t *buf = (const uint8_t *)test_get_captured_console();
+	int size = test_get_captured_console_size();
+	int text_len = 0;
+	int i = 0, len;
+
+	output_len = 0;
+	done_cnt = nak_cnt = bad_frame_cnt = 0;
+
+	while (i < size) {
+		if (buf[i] != CONSOLE_FRAME_SOF0) {
+			if (buf[i] != '\r' && text_len < sizeof(text) - 1)
+				text[text_len++] = buf[i];
+			i++;
+			continue;
+		}
+
+		len = buf[i + 4] | buf[i + 5] << 8;
+		if (buf[i + 1] != CONSOLE_FRAME_SOF1 ||
+		    i + CONSOLE_FRAME_HEADER_SIZE + len + 1 > size ||
+		    crc8(buf + i + 2, CONSOLE_FRAME_HEADER_SIZE - 2 + len) !=
+		    buf[i + CONSOLE_FRAME_HEADER_SIZE + len]) {
+			bad_frame_cnt++;
+			i++;
+			continue;
+		}
+
+		switch (buf[i + 2]) {
+		case CONSOLE_FRAME_OUTPUT:
+			memcpy(output + output_len,
+			       buf + i + CONSOLE_FRAME_HEADER_SIZE, len);
+			output_len += len;
+			break;
+		case CONSOLE_FRAME_DONE:
+			memcpy(&done_rv, buf + i + CONSOLE_FRAME_HEADER_SIZE,
+			       sizeof(done_rv));
+			done_seq = buf[i + 3];
+			done_cnt++;
+			break;
+		case CONSOLE_FRAME_NAK:
+			done_seq = buf[i + 3];
+			nak_cnt++;
+			break;
+		default:
+			bad_frame_cnt++;
+		}
+		i += CONSOLE_FRAME_HEADER_SIZE + len + 1;
+	}
+
+	text[text_len] = '\0';
+	output[output_len] = '\0';
+}
+
+static void run_request(uint8_t seq, const char *cmd, int corrupt)
+{
+	test_capture_console(1);
+	send_request(seq, cmd, corrupt);
+	msleep(30);
+	test_capture_console(0);
+	parse_response();
+}
+
+/*****************************************************************************/
+/* Tests */
+
+static int test_request(void)
+{
+	fcmd_call_cnt = 0;
+	run_request(5, "fcmd a b", 0);
+
+	TEST_EQ(fcmd_call_cnt, 1, "%d");
+	TEST_EQ(bad_frame_cnt, 0, "%d");
+	TEST_EQ(done_cnt, 1, "%d");
+	TEST_EQ(done_seq, 5, "%d");
+	TEST_EQ(done_rv, EC_SUCCESS, "%d");
+	TEST_ASSERT(!strcasecmp(output, "fcmd 3 args\n"));
+
+	/* Nothing leaks out as text */
+	TEST_ASSERT(!strstr(text, "fcmd"));
+
+	return EC_SUCCESS;
+}
+
+static int test_request_error(void)
+{
+	run_request(6, "fcmd", 0);
+
+	TEST_EQ(done_cnt, 1, "%d");
+	TEST_EQ(done_seq, 6, "%d");
+	TEST_EQ(done_rv, EC_ERROR_PARAM_COUNT, "%d");
+	TEST_ASSERT(strstr(output, "Wrong number of params"));
+
+	run_request(7, "nosuchcmd", 0);
+	TEST_EQ(done_cnt, 1, "%d");
+	TEST_EQ(done_rv, EC_ERROR_UNKNOWN, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_long_output(void)
+{
+	run_request(8, "fbig", 0);
+
+	TEST_EQ(bad_frame_cnt, 0, "%d");
+	TEST_EQ(done_cnt, 1, "%d");
+	TEST_EQ(output_len, 20 * 10, "%d");
+	TEST_ASSERT(!memcmp(output, "line 00..\nline 01..\n", 20));
+	TEST_ASSERT(!memcmp(output + 190, "line 19..\n", 10));
+
+	return EC_SUCCESS;
+}
+
+static int test_bad_crc(void)
+{
+	fcmd_call_cnt = 0;
+	run_request(9, "fcmd a b", 1);
+
+	TEST_EQ(fcmd_call_cnt, 0, "%d");
+	TEST_EQ(nak_cnt, 1, "%d");
+	TEST_EQ(done_cnt, 0, "%d");
+	TEST_EQ(done_seq, 9, "%d");
+
+	/* The next good request goes through */
+	run_request(10, "fcmd a b", 0);
+	TEST_EQ(fcmd_call_cnt, 1, "%d");
+	TEST_EQ(done_seq, 10, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_async_output(void)
+{
+	run_request(11, "fslow", 0);
+
+	/* Logs from other tasks stay plain text, outside the frames */
+	TEST_EQ(bad_frame_cnt, 0, "%d");
+	TEST_EQ(done_cnt, 1, "%d");
+	TEST_ASSERT(!strcasecmp(output, "before after\n"));
+	TEST_ASSERT(strstr(text, "async log"));
+
+	return EC_SUCCESS;
+}
+
+static int test_interactive(void)
+{
+	fcmd_call_cnt = 0;
+	test_capture_console(1);
+	UART_INJECT("fcmd a b\n");
+	msleep(30);
+	test_capture_console(0);
+	parse_response();
+
+	TEST_EQ(fcmd_call_cnt, 1, "%d");
+	TEST_EQ(done_cnt, 0, "%d");
+	TEST_ASSERT(strstr(text, "fcmd 3 args"));
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_request);
+	RUN_TEST(test_request_error);
+	RUN_TEST(test_long_output);
+	RUN_TEST(test_bad_crc);
+	RUN_TEST(test_async_output);
+	RUN_TEST(test_interactive);
+
+	test_print_result();
+}
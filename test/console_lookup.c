@@ -0,0 +1,154 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test console command lookup.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "link_defs.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+const struct console_command *find_command(char *name);
+
+static int command_dummy(int argc, char **argv)
+{
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(lkup, command_dummy, NULL, NULL);
+DECLARE_CONSOLE_COMMAND(lkupa, command_dummy, NULL, NULL);
+DECLARE_CONSOLE_COMMAND(lkupab, command_dummy, NULL, NULL);
+DECLARE_CONSOLE_COMMAND(lkupb_x, command_dummy, NULL, NULL);
+DECLARE_CONSOLE_COMMAND(lkupc, command_dummy, NULL, NULL);
+DECLARE_CONSOLE_COMMAND(lkupc2, command_dummy, NULL, NULL);
+
+/* The linear scan find_command() used to do, as a reference */
+static const struct console_command *find_command_linear(char *name)
+{
+	const struct console_command *cmd, *match = NULL;
+	int match_length = strlen(name);
+
+	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
+		if (!strncasecmp(name, cmd->name, match_length)) {
+			if (match)
+				return NULL;
+			if (cmd->name[match_length] == '\0')
+				return cmd;
+			match = cmd;
+		}
+	}
+
+	return match;
+}
+
+static const char *cmd_name(const struct console_command *cmd)
+{
+	return cmd ? cmd->name : "(null)";
+}
+
+static int test_table_sorted(void)
+{
+	const struct console_command *cmd;
+	const char *c;
+
+	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
+		for (c = cmd->name; *c; c++)
+			TEST_ASSERT(!isupper(*c));
+		if (cmd > __cmds)
+			TEST_ASSERT(strncmp(cmd[-1].name, cmd->name, 16) < 0);
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_full_names(void)
+{
+	const struct console_command *cmd;
+	char name[16];
+	int i;
+
+	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
+		strzcpy(name, cmd->name, sizeof(name));
+		TEST_ASSERT(find_command(name) == cmd);
+
+		/* Case does not matter */
+		for (i = 0; name[i]; i++)
+			if (isalpha(name[i]))
+				name[i] &= ~0x20;
+		TEST_ASSERT(find_command(name) == cmd);
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_prefixes(void)
+{
+	const struct console_command *cmd;
+	char name[16];
+	int len;
+
+	/* Every prefix of every command resolves like the linear scan did */
+	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
+		for (len = 1; len <= strlen(cmd->name); len++) {
+			strzcpy(name, cmd->name, len + 1);
+			TEST_ASSERT(find_command(name) ==
+				    find_command_linear(name));
+		}
+	}
+
+	TEST_ASSERT_ARRAY_EQ(cmd_name(find_command("lkup")), "lkup", 5);
+	TEST_ASSERT_ARRAY_EQ(cmd_name(find_command("lkupa")), "lkupa", 6);
+	TEST_ASSERT_ARRAY_EQ(cmd_name(find_command("LKUPB")), "lkupb_x", 8);
+	TEST_ASSERT(find_command("lku") == NULL);
+	TEST_ASSERT(find_command("lkupc") != NULL);
+	TEST_ASSERT(find_command("lkupd") == NULL);
+	TEST_ASSERT(find_command("zzzzzz") == NULL);
+	TEST_ASSERT(find_command("!") == NULL);
+
+	return EC_SUCCESS;
+}
+
+static void benchmark_lookup(void)
+{
+	const struct console_command *cmd;
+	timestamp_t t0, t1, t2;
+	char name[16];
+	int i;
+
+	t0 = get_time();
+	for (i = 0; i < 100; i++)
+		for (cmd = __cmds; cmd < __cmds_end; cmd++) {
+			strzcpy(name, cmd->name, sizeof(name));
+			find_command_linear(name);
+		}
+	t1 = get_time();
+	for (i = 0; i < 100; i++)
+		for (cmd = __cmds; cmd < __cmds_end; cmd++) {
+			strzcpy(name, cmd->name, sizeof(name));
+			find_command(name);
+		}
+	t2 = get_time();
+
+	ccprintf("%d commands\n", (int)(__cmds_end - __cmds));
+	ccprintf("Linear lookup duration %lld us\n",
+		 (long long)(t1.val - t0.val));
+	ccprintf("Sorted lookup duration %lld us\n",
+		 (long long)(t2.val - t1.val));
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_table_sorted);
+	RUN_TEST(test_full_names);
+	RUN_TEST(test_prefixes);
+
+	/* do not check speed, just as a benchmark */
+	benchmark_lookup();
+
+	test_print_result();
+}
@@ -8,9 +8,16 @@
 #include "common.h"
 #include "console.h"
 #include "crc.h"
+#include "crc8.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
+#define BENCHMARK_SIZE 4096
+#define BENCHMARK_ITERATIONS 16
+
+static uint8_t buf[BENCHMARK_SIZE];
+
 // test that static version matches context version
 static int test_static_version(void)
 {
@@ -63,6 +70,113 @@ static int test_kat0(void)
 	return EC_SUCCESS;
 }
 
+// test that buffers hash the same as bytes, at any alignment and length
+static int test_buf(void)
+{
+	uint32_t crc, ref;
+	int offset, size, i;
+
+	for (i = 0; i < 64; i++)
+		buf[i] = i * 37 + 11;
+
+	for (offset = 0; offset < 4; offset++) {
+		for (size = 0; size <= 32; size++) {
+			crc32_ctx_init(&ref);
+			for (i = 0; i < size; i++)
+				crc32_ctx_hash8(&ref, buf[offset + i]);
+
+			crc32_ctx_init(&crc);
+			crc32_ctx_hash(&crc, buf + offset, size);
+
+			TEST_EQ(crc32_ctx_result(&crc), crc32_ctx_result(&ref),
+				"0x%08x");
+		}
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_kat_buf(void)
+{
+	uint32_t crc;
+	const char input[] = "The quick brown fox jumps over the lazy dog";
+
+	crc32_ctx_init(&crc);
+	crc32_ctx_hash(&crc, input, strlen(input));
+	TEST_EQ(crc32_ctx_result(&crc), 0x414fa339, "0x%08x");
+
+	return EC_SUCCESS;
+}
+
+static int test_kat_bufs(void)
+{
+	const char input[] = "The quick brown fox jumps over the lazy dog";
+	const struct crc32_buf bufs[] = {
+		{ input, 4 },
+		{ input + 4, 0 },
+		{ input + 4, 15 },
+		{ input + 19, strlen(input) - 19 },
+	};
+
+	TEST_EQ(crc32_bufs(bufs, ARRAY_SIZE(bufs)), 0x414fa339, "0x%08x");
+	TEST_EQ(crc32_bufs(bufs, 0), 0, "0x%08x");
+
+	return EC_SUCCESS;
+}
+
+static int test_crc8_kat(void)
+{
+	const char input[] = "123456789";
+
+	TEST_EQ(crc8((const uint8_t *)input, strlen(input)), 0xf4, "0x%02x");
+	TEST_EQ(crc8_arg((const uint8_t *)input + 4, strlen(input) - 4,
+			 crc8((const uint8_t *)input, 4)), 0xf4, "0x%02x");
+
+	return EC_SUCCESS;
+}
+
+static int test_benchmark(void)
+{
+	timestamp_t t0, t1;
+	uint32_t crc;
+	int i, j;
+
+	for (i = 0; i < BENCHMARK_SIZE; i++)
+		buf[i] = i;
+
+	t0 = get_time();
+	for (j = 0; j < BENCHMARK_ITERATIONS; j++) {
+		crc32_ctx_init(&crc);
+		for (i = 0; i < BENCHMARK_SIZE; i++)
+			crc32_ctx_hash8(&crc, buf[i]);
+	}
+	t1 = get_time();
+	/* do not check speed, just as a benchmark */
+	ccprintf("CRC32 bytes %d bytes duration %lld us\n",
+		 BENCHMARK_SIZE * BENCHMARK_ITERATIONS,
+		 (long long)(t1.val - t0.val));
+
+	t0 = get_time();
+	for (j = 0; j < BENCHMARK_ITERATIONS; j++) {
+		crc32_ctx_init(&crc);
+		crc32_ctx_hash(&crc, buf, BENCHMARK_SIZE);
+	}
+	t1 = get_time();
+	ccprintf("CRC32 buffer %d bytes duration %lld us\n",
+		 BENCHMARK_SIZE * BENCHMARK_ITERATIONS,
+		 (long long)(t1.val - t0.val));
+
+	t0 = get_time();
+	for (j = 0; j < BENCHMARK_ITERATIONS; j++)
+		crc8(buf, BENCHMARK_SIZE);
+	t1 = get_time();
+	ccprintf("CRC8 %d bytes duration %lld us\n",
+		 BENCHMARK_SIZE * BENCHMARK_ITERATIONS,
+		 (long long)(t1.val - t0.val));
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
@@ -70,6 +184,11 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_static_version);
 	RUN_TEST(test_8);
 	RUN_TEST(test_kat0);
+	RUN_TEST(test_buf);
+	RUN_TEST(test_kat_buf);
+	RUN_TEST(test_kat_bufs);
+	RUN_TEST(test_crc8_kat);
+	RUN_TEST(test_benchmark);
 
 	test_print_result();
 }
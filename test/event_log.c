@@ -0,0 +1,282 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the event log FIFO.
+ */
+
+#include "common.h"
+#include "event_log.h"
+#include "task.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define UNIT_SIZE sizeof(struct event_log_entry)
+#define UNIT_COUNT (CONFIG_EVENT_LOG_SIZE / UNIT_SIZE)
+
+/* Room for the largest entry */
+static union {
+	struct event_log_entry r;
+	uint8_t bytes[EVENT_LOG_ENTRY_SIZE(EVENT_LOG_SIZE_MASK)];
+} u;
+
+static uint8_t bulk[CONFIG_EVENT_LOG_SIZE];
+
+static uint32_t now(void)
+{
+	return get_time().val >> EVENT_LOG_TIMESTAMP_SHIFT;
+}
+
+static void fill_payload(uint8_t *payload, int size, uint16_t seed)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		payload[i] = seed + i;
+}
+
+static int check_payload(const uint8_t *payload, int size, uint16_t seed)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		if (payload[i] != (uint8_t)(seed + i))
+			return 0;
+	return 1;
+}
+
+static void add_event(uint8_t type, int size, uint16_t data)
+{
+	uint8_t payload[EVENT_LOG_SIZE_MASK];
+
+	fill_payload(payload, size, data);
+	log_add_event(type, size, data, payload, now());
+}
+
+static void drain(void)
+{
+	while (u.r.type = 0, log_dequeue_event(&u.r),
+	       u.r.type != EVENT_LOG_NO_ENTRY)
+		;
+	log_take_dropped();
+}
+
+static int test_empty(void)
+{
+	int count;
+
+	TEST_EQ(log_dequeue_event(&u.r), (int)UNIT_SIZE, "%d");
+	TEST_EQ(u.r.type, EVENT_LOG_NO_ENTRY, "%d");
+
+	TEST_EQ(log_dequeue_events(bulk, sizeof(bulk), &count), 0, "%d");
+	TEST_EQ(count, 0, "%d");
+	TEST_EQ(log_take_dropped(), 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_order_and_payload(void)
+{
+	int i, size;
+
+	/* Payloads of every size, wrapping around the FIFO a few times */
+	for (i = 0; i < 4 * UNIT_COUNT; i++) {
+		size = i % (EVENT_LOG_SIZE_MASK + 1);
+		add_event(i & 0x7f, size, 0x100 + i);
+
+		size = log_dequeue_event(&u.r);
+		TEST_EQ(size, (int)EVENT_LOG_ENTRY_SIZE(i), "%d");
+		TEST_EQ(u.r.type, i & 0x7f, "%d");
+		TEST_EQ(u.r.data, 0x100 + i, "%d");
+		TEST_EQ(EVENT_LOG_SIZE(u.r.size),
+			i % (EVENT_LOG_SIZE_MASK + 1), "%d");
+		TEST_ASSERT(check_payload(u.r.payload, EVENT_LOG_SIZE(u.r.size),
+					  u.r.data));
+		/* The timestamp is relative to now */
+		TEST_ASSERT(u.r.timestamp < 2);
+	}
+
+	log_dequeue_event(&u.r);
+	TEST_EQ(u.r.type, EVENT_LOG_NO_ENTRY, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_wrapped_payload_keeps_neighbour(void)
+{
+	int i;
+
+	/* Move the FIFO pointers to two units before the end */
+	for (i = 0; i < UNIT_COUNT - 2; i++) {
+		add_event(1, 0, i);
+		log_dequeue_event(&u.r);
+	}
+
+	/* This entry wraps: one unit at the end and two at the start */
+	add_event(2, 20, 0x2000);
+	/* This one lands right after the wrapped payload */
+	add_event(3, 8, 0x3000);
+
+	log_dequeue_event(&u.r);
+	TEST_EQ(u.r.type, 2, "%d");
+	TEST_ASSERT(check_payload(u.r.payload, 20, 0x2000));
+	log_dequeue_event(&u.r);
+	TEST_EQ(u.r.type, 3, "%d");
+	TEST_EQ(u.r.data, 0x3000, "%d");
+	TEST_ASSERT(check_payload(u.r.payload, 8, 0x3000));
+
+	return EC_SUCCESS;
+}
+
+static int test_full_drops_newest(void)
+{
+	int i;
+
+	/* Fill the FIFO exactly with two-unit entries */
+	for (i = 0; i < UNIT_COUNT / 2; i++)
+		add_event(4, 8, i);
+	add_event(5, 0, 0xdead);
+	add_event(5, 8, 0xbeef);
+	TEST_EQ(log_take_dropped(), 2, "%d");
+	TEST_EQ(log_take_dropped(), 0, "%d");
+
+	/* The oldest entries are all there */
+	for (i = 0; i < UNIT_COUNT / 2; i++) {
+		log_dequeue_event(&u.r);
+		TEST_EQ(u.r.type, 4, "%d");
+		TEST_EQ(u.r.data, i, "%d");
+	}
+	log_dequeue_event(&u.r);
+	TEST_EQ(u.r.type, EVENT_LOG_NO_ENTRY, "%d");
+
+	/* And the space is usable again */
+	add_event(6, 0, 0);
+	log_dequeue_event(&u.r);
+	TEST_EQ(u.r.type, 6, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_bulk_dequeue(void)
+{
+	const struct event_log_entry *r;
+	int i, count, bytes, offset;
+
+	for (i = 0; i < 10; i++)
+		add_event(7, i, i);
+
+	/* Entry 0 takes one unit, 1..8 take two and 9 takes three */
+	bytes = log_dequeue_events(bulk, 5 * UNIT_SIZE + 3, &count);
+	TEST_EQ(count, 3, "%d");
+	TEST_EQ(bytes, (int)(5 * UNIT_SIZE), "%d");
+
+	bytes = log_dequeue_events(bulk, sizeof(bulk), &count);
+	TEST_EQ(count, 7, "%d");
+	TEST_EQ(bytes, (int)(15 * UNIT_SIZE), "%d");
+
+	for (i = 3, offset = 0; i < 10; i++) {
+		r = (const void *)(bulk + offset);
+		TEST_EQ(r->type, 7, "%d");
+		TEST_EQ(r->data, i, "%d");
+		TEST_EQ(EVENT_LOG_SIZE(r->size), i, "%d");
+		TEST_ASSERT(check_payload(r->payload, i, i));
+		offset += EVENT_LOG_ENTRY_SIZE(r->size);
+	}
+
+	TEST_EQ(log_dequeue_events(bulk, sizeof(bulk), &count), 0, "%d");
+	TEST_EQ(count, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+/*
+ * Stress test: the interrupt generator logs events while the test task logs
+ * and dequeues events. Each producer uses its own type and sequence number.
+ */
+#define TYPE_TASK 0x10
+#define TYPE_ISR 0x20
+
+static volatile int stress_running;
+static uint32_t isr_added;
+
+static void log_isr(void)
+{
+	if (!stress_running)
+		return;
+	add_event(TYPE_ISR, isr_added % 12, isr_added);
+	isr_added++;
+}
+
+void interrupt_generator(void)
+{
+	while (1) {
+		udelay(50 + (prng_no_seed() % 200));
+		task_trigger_test_interrupt(log_isr);
+	}
+}
+
+static int test_concurrent_producers(void)
+{
+	const struct event_log_entry *r;
+	uint16_t next[2] = {0, 0};
+	uint32_t task_added = 0, received = 0, dropped = 0;
+	timestamp_t deadline = get_time();
+	int count, bytes, offset, src;
+
+	isr_added = 0;
+	stress_running = 1;
+	deadline.val += SECOND / 2;
+	while (!timestamp_expired(deadline, NULL)) {
+		add_event(TYPE_TASK, task_added % 7, task_added);
+		task_added++;
+
+		if (task_added % 8)
+			continue;
+
+		bytes = log_dequeue_events(bulk, 64, &count);
+		dropped += log_take_dropped();
+		for (offset = 0; offset < bytes; received++) {
+			r = (const void *)(bulk + offset);
+			src = r->type == TYPE_ISR;
+			TEST_ASSERT(r->type == TYPE_TASK || src);
+			/* Entries of a producer come out in order */
+			TEST_ASSERT((uint16_t)(r->data - next[src]) < 0x8000);
+			next[src] = r->data + 1;
+			TEST_ASSERT(check_payload(r->payload,
+						  EVENT_LOG_SIZE(r->size),
+						  r->data));
+			offset += EVENT_LOG_ENTRY_SIZE(r->size);
+		}
+		TEST_EQ(offset, bytes, "%d");
+	}
+	stress_running = 0;
+
+	do {
+		bytes = log_dequeue_events(bulk, sizeof(bulk), &count);
+		received += count;
+	} while (count);
+	dropped += log_take_dropped();
+
+	ccprintf("added %d+%d received %d dropped %d\n", task_added,
+		 isr_added, received, dropped);
+	TEST_ASSERT(isr_added > 0);
+	TEST_EQ(task_added + isr_added, received + dropped, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	drain();
+	RUN_TEST(test_empty);
+	RUN_TEST(test_order_and_payload);
+	RUN_TEST(test_wrapped_payload_keeps_neighbour);
+	RUN_TEST(test_full_drops_newest);
+	RUN_TEST(test_bulk_dequeue);
+	RUN_TEST(test_concurrent_producers);
+
+	test_print_result();
+}
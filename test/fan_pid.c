@@ -0,0 +1,218 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the software fan RPM controller against simulated fans.
+ */
+
+#include "common.h"
+#include "fan_pid.h"
+#include "math_util.h"
+#include "test_util.h"
+#include "util.h"
+
+static const struct fan_pid_params params = {
+	.kp = 2,
+	.ki = 10,
+	.kd = 1,
+	.i_max = 10 * FAN_PID_SCALE,
+	.slew = 10 * FAN_PID_SCALE,
+	.deadband = 50,
+};
+
+static struct fan_pid pid = {
+	.params = &params,
+};
+
+/*****************************************************************************/
+/* Simulated fan */
+
+struct sim_fan {
+	/* Duty below which the fan doesn't turn */
+	int stall_pct;
+	/* Speed just above the stall duty, and gain above it */
+	int rpm_base;
+	int rpm_per_pct;
+	/* Fraction of the remaining distance covered each step, in % */
+	int lag_pct;
+	/* Highest speed the fan manages to reach */
+	int rpm_limit;
+
+	int rpm;
+	int duty;
+	/* Number of duty changes the controller asked for */
+	int writes;
+};
+
+static int sim_steady_rpm(const struct sim_fan *f, int duty)
+{
+	if (duty < f->stall_pct)
+		return 0;
+
+	return MIN(f->rpm_base + (duty - f->stall_pct) * f->rpm_per_pct,
+		   f->rpm_limit);
+}
+
+/* Open-loop estimate, deliberately 5% low to give the loop work to do. */
+static int sim_feedforward(const struct sim_fan *f, int rpm)
+{
+	if (!rpm)
+		return 0;
+
+	return MAX(f->stall_pct + (rpm - f->rpm_base) / f->rpm_per_pct - 5, 0);
+}
+
+static void sim_step(struct sim_fan *f, int target)
+{
+	int duty;
+
+	duty = fan_pid_step(&pid, target, sim_feedforward(f, target), f->rpm);
+	if (duty != f->duty)
+		f->writes++;
+	f->duty = duty;
+
+	f->rpm += (sim_steady_rpm(f, duty) - f->rpm) * f->lag_pct / 100;
+}
+
+static void sim_init(struct sim_fan *f)
+{
+	f->stall_pct = 8;
+	f->rpm_base = 1000;
+	f->rpm_per_pct = 60;
+	f->lag_pct = 60;
+	f->rpm_limit = 10000;
+	f->rpm = 0;
+	f->duty = 0;
+	f->writes = 0;
+
+	fan_pid_reset(&pid);
+}
+
+/*****************************************************************************/
+/* Tests */
+
+static int test_converge(void)
+{
+	struct sim_fan f;
+	int i;
+
+	sim_init(&f);
+
+	for (i = 0; i < 30; i++)
+		sim_step(&f, 3000);
+	TEST_ASSERT(ABS(f.rpm - 3000) <= params.deadband * 2);
+
+	/* Settled: the duty stays put. */
+	f.writes = 0;
+	for (i = 0; i < 30; i++)
+		sim_step(&f, 3000);
+	TEST_ASSERT(f.writes == 0);
+	TEST_ASSERT(ABS(f.rpm - 3000) <= params.deadband * 2);
+
+	return EC_SUCCESS;
+}
+
+static int test_slow_fan(void)
+{
+	struct sim_fan f;
+	int i;
+
+	/* A sluggish fan with a shallower curve still gets there. */
+	sim_init(&f);
+	f.lag_pct = 20;
+	f.rpm_per_pct = 50;
+
+	for (i = 0; i < 60; i++)
+		sim_step(&f, 4000);
+	TEST_ASSERT(ABS(f.rpm - 4000) <= params.deadband * 2);
+
+	return EC_SUCCESS;
+}
+
+static int test_slew_limit(void)
+{
+	struct sim_fan f;
+	int i, last;
+
+	sim_init(&f);
+
+	for (i = 0; i < 30; i++)
+		sim_step(&f, 2000);
+
+	/* A big target step is spread over several steps. */
+	for (i = 0; i < 30; i++) {
+		last = f.duty;
+		sim_step(&f, 6000);
+		TEST_ASSERT(ABS(f.duty - last) <=
+			    params.slew / FAN_PID_SCALE + 1);
+	}
+	TEST_ASSERT(ABS(f.rpm - 6000) <= params.deadband * 2);
+
+	return EC_SUCCESS;
+}
+
+static int test_start_from_rest(void)
+{
+	struct sim_fan f;
+
+	sim_init(&f);
+
+	/* The first step isn't slew limited, so the fan can start. */
+	sim_step(&f, 5000);
+	TEST_ASSERT(f.duty >= sim_feedforward(&f, 5000));
+	TEST_ASSERT(f.duty > params.slew / FAN_PID_SCALE);
+
+	return EC_SUCCESS;
+}
+
+static int test_off(void)
+{
+	struct sim_fan f;
+	int i;
+
+	sim_init(&f);
+
+	for (i = 0; i < 10; i++)
+		sim_step(&f, 3000);
+	TEST_ASSERT(f.duty > 0);
+
+	sim_step(&f, 0);
+	TEST_ASSERT(f.duty == 0);
+	TEST_ASSERT(pid.integral == 0);
+	TEST_ASSERT(pid.target == 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_windup(void)
+{
+	struct sim_fan f;
+	int i;
+
+	/* The fan can't reach the target; the integral must stay bounded. */
+	sim_init(&f);
+	f.rpm_limit = 2500;
+
+	for (i = 0; i < 200; i++)
+		sim_step(&f, 5000);
+	TEST_ASSERT(ABS(pid.integral * params.ki) <= params.i_max);
+
+	/* Once asked for something reachable, it recovers. */
+	for (i = 0; i < 40; i++)
+		sim_step(&f, 2000);
+	TEST_ASSERT(ABS(f.rpm - 2000) <= params.deadband * 2);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	RUN_TEST(test_converge);
+	RUN_TEST(test_slow_fan);
+	RUN_TEST(test_slew_limit);
+	RUN_TEST(test_start_from_rest);
+	RUN_TEST(test_off);
+	RUN_TEST(test_windup);
+
+	test_print_result();
+}
@@ -0,0 +1,202 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the flash read cache.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "flash.h"
+#include "test_util.h"
+#include "util.h"
+
+#define PAGE_SIZE CONFIG_FLASH_READ_CACHE_PAGE_SIZE
+#define PAGE_COUNT CONFIG_FLASH_READ_CACHE_PAGES
+#define BASE 0x10000
+
+static int phys_reads;
+static int phys_bytes;
+static int fail_reads;
+
+/* The emulator has mapped storage, so the cache reads it back from here */
+int flash_physical_read(int offset, int size, char *data)
+{
+	phys_reads++;
+	phys_bytes += size;
+	if (fail_reads)
+		return EC_ERROR_UNKNOWN;
+	memcpy(data, __host_flash + offset, size);
+	return EC_SUCCESS;
+}
+
+static void fill_flash(void)
+{
+	int i;
+
+	for (i = 0; i < (PAGE_COUNT + 2) * PAGE_SIZE; i++)
+		__host_flash[BASE + i] = i * 7 + i / PAGE_SIZE;
+}
+
+static int check_read(int offset, int size)
+{
+	char buf[PAGE_SIZE * PAGE_COUNT];
+
+	TEST_ASSERT(size <= sizeof(buf));
+	TEST_EQ(flash_cache_read(offset, size, buf), EC_SUCCESS, "%d");
+	TEST_ASSERT_ARRAY_EQ(buf, __host_flash + offset, size);
+	return EC_SUCCESS;
+}
+
+static int test_hit(void)
+{
+	TEST_EQ(check_read(BASE + 0x10, 16), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 1, "%d");
+	TEST_EQ(phys_bytes, PAGE_SIZE, "%d");
+
+	TEST_EQ(check_read(BASE + 0x10, 16), EC_SUCCESS, "%d");
+	TEST_EQ(check_read(BASE, PAGE_SIZE), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_span(void)
+{
+	TEST_EQ(check_read(BASE + PAGE_SIZE - 8, 16), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 2, "%d");
+
+	TEST_EQ(check_read(BASE + 4, PAGE_SIZE), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_lru(void)
+{
+	int i;
+
+	for (i = 0; i < PAGE_COUNT; i++)
+		TEST_EQ(check_read(BASE + i * PAGE_SIZE, 4), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, PAGE_COUNT, "%d");
+
+	/* Touch the first page so the second becomes the oldest */
+	TEST_EQ(check_read(BASE, 4), EC_SUCCESS, "%d");
+	TEST_EQ(check_read(BASE + PAGE_COUNT * PAGE_SIZE, 4), EC_SUCCESS,
+		"%d");
+	TEST_EQ(phys_reads, PAGE_COUNT + 1, "%d");
+
+	TEST_EQ(check_read(BASE, 4), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, PAGE_COUNT + 1, "%d");
+	TEST_EQ(check_read(BASE + PAGE_SIZE, 4), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, PAGE_COUNT + 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_write_invalidates(void)
+{
+	const char data[4] = { 0x12, 0x34, 0x56, 0x78 };
+
+	TEST_EQ(check_read(BASE + 0x20, 8), EC_SUCCESS, "%d");
+	TEST_EQ(check_read(BASE + PAGE_SIZE, 8), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 2, "%d");
+
+	TEST_EQ(flash_write(BASE + 0x24, sizeof(data), data), EC_SUCCESS,
+		"%d");
+	TEST_EQ(check_read(BASE + 0x20, 8), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 3, "%d");
+
+	/* Other pages stay cached */
+	TEST_EQ(check_read(BASE + PAGE_SIZE, 8), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 3, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_erase_invalidates(void)
+{
+	TEST_EQ(check_read(BASE + PAGE_SIZE, 8), EC_SUCCESS, "%d");
+	TEST_EQ(flash_erase(BASE + PAGE_SIZE, CONFIG_FLASH_ERASE_SIZE),
+		EC_SUCCESS, "%d");
+	TEST_EQ(check_read(BASE + PAGE_SIZE, 8), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 2, "%d");
+	TEST_EQ(__host_flash[BASE + PAGE_SIZE], (char)0xff, "%d");
+
+	return EC_SUCCESS;
+}
+
+/* Writers below flash_write(), such as the pstate code, invalidate too */
+static int test_physical_write_invalidates(void)
+{
+	const char data[4] = { 0x9a, 0xbc, 0xde, 0xf0 };
+
+	TEST_EQ(check_read(BASE + 0x40, 8), EC_SUCCESS, "%d");
+	TEST_EQ(flash_physical_write(BASE + 0x40, sizeof(data), data),
+		EC_SUCCESS, "%d");
+	TEST_EQ(check_read(BASE + 0x40, 8), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 2, "%d");
+
+	/* Other pages stay cached */
+	TEST_EQ(flash_physical_erase(BASE - CONFIG_FLASH_ERASE_SIZE,
+				     CONFIG_FLASH_ERASE_SIZE), EC_SUCCESS, "%d");
+	TEST_EQ(check_read(BASE + 0x40, 8), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_bypass(void)
+{
+	int size = PAGE_SIZE * PAGE_COUNT;
+
+	TEST_EQ(check_read(BASE + 2, size), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 1, "%d");
+	TEST_EQ(phys_bytes, size, "%d");
+
+	/* Nothing was cached */
+	TEST_EQ(check_read(BASE + 2, 4), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_read_error(void)
+{
+	char buf[4];
+
+	fail_reads = 1;
+	TEST_NE(flash_cache_read(BASE, sizeof(buf), buf), EC_SUCCESS, "%d");
+	fail_reads = 0;
+
+	/* The failed page must not be served from the cache */
+	TEST_EQ(check_read(BASE, sizeof(buf)), EC_SUCCESS, "%d");
+	TEST_EQ(phys_reads, 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+void before_test(void)
+{
+	fill_flash();
+	flash_cache_invalidate(0, CONFIG_FLASH_SIZE);
+	phys_reads = 0;
+	phys_bytes = 0;
+	fail_reads = 0;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_hit);
+	RUN_TEST(test_span);
+	RUN_TEST(test_lru);
+	RUN_TEST(test_write_invalidates);
+	RUN_TEST(test_erase_invalidates);
+	RUN_TEST(test_physical_write_invalidates);
+	RUN_TEST(test_bypass);
+	RUN_TEST(test_read_error);
+
+	test_print_result();
+}
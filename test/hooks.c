@@ -66,6 +66,38 @@ static const struct deferred_data non_deferred_func_data = {
 	non_deferred_func
 };
 
+/* Resume hooks only run when the tests notify them. */
+static int resume_order[3];
+static int resume_count;
+
+static void resume_early_hook(void)
+{
+	resume_order[resume_count++ % 3] = 0;
+}
+DECLARE_HOOK(HOOK_CHIPSET_RESUME, resume_early_hook, HOOK_PRIO_DEFAULT - 1);
+
+static void resume_hook(void)
+{
+	resume_order[resume_count++ % 3] = 1;
+}
+DECLARE_HOOK(HOOK_CHIPSET_RESUME, resume_hook, HOOK_PRIO_DEFAULT);
+
+static void resume_late_hook(void)
+{
+	resume_order[resume_count++ % 3] = 2;
+}
+DECLARE_HOOK(HOOK_CHIPSET_RESUME, resume_late_hook, HOOK_PRIO_DEFAULT + 1);
+
+/* Notifies the resume hooks from inside a hook routine. */
+#define NESTING_PRIO (HOOK_PRIO_DEFAULT + 10)
+
+static void nesting_hook(void)
+{
+	hook_notify_range(HOOK_CHIPSET_RESUME, HOOK_PRIO_DEFAULT - 1,
+			  HOOK_PRIO_DEFAULT + 1);
+}
+DECLARE_HOOK(HOOK_CHIPSET_SUSPEND, nesting_hook, NESTING_PRIO);
+
 static int test_init_hook(void)
 {
 	TEST_ASSERT(init_hook_count == 1);
@@ -105,6 +137,62 @@ static int test_priority(void)
 	return EC_SUCCESS;
 }
 
+static int test_notify_range(void)
+{
+	resume_count = 0;
+	hook_notify_range(HOOK_CHIPSET_RESUME, HOOK_PRIO_DEFAULT - 1,
+			  HOOK_PRIO_DEFAULT);
+	TEST_ASSERT(resume_count == 2);
+	TEST_ASSERT(resume_order[0] == 0);
+	TEST_ASSERT(resume_order[1] == 1);
+
+	resume_count = 0;
+	hook_notify_range(HOOK_CHIPSET_RESUME, HOOK_PRIO_DEFAULT + 1,
+			  HOOK_PRIO_DEFAULT + 1);
+	TEST_ASSERT(resume_count == 1);
+	TEST_ASSERT(resume_order[0] == 2);
+
+	return EC_SUCCESS;
+}
+
+static int test_timing(void)
+{
+	struct hook_timing t[3];
+
+	hook_timing_start(t, ARRAY_SIZE(t));
+	hook_notify_range(HOOK_CHIPSET_RESUME, HOOK_PRIO_DEFAULT - 1,
+			  HOOK_PRIO_DEFAULT + 1);
+	TEST_ASSERT(hook_timing_stop() == 3);
+	TEST_ASSERT(t[0].routine == resume_early_hook);
+	TEST_ASSERT(t[1].routine == resume_hook);
+	TEST_ASSERT(t[2].routine == resume_late_hook);
+
+	/* Routines past the end of the buffer are not recorded. */
+	hook_timing_start(t, 1);
+	hook_notify_range(HOOK_CHIPSET_RESUME, HOOK_PRIO_DEFAULT - 1,
+			  HOOK_PRIO_DEFAULT + 1);
+	TEST_ASSERT(hook_timing_stop() == 1);
+
+	/* Nothing is recorded once stopped. */
+	t[0].routine = NULL;
+	hook_notify_range(HOOK_CHIPSET_RESUME, HOOK_PRIO_DEFAULT - 1,
+			  HOOK_PRIO_DEFAULT + 1);
+	TEST_ASSERT(t[0].routine == NULL);
+
+	/* Hooks run by the hook task meanwhile are not recorded. */
+	hook_timing_start(t, ARRAY_SIZE(t));
+	usleep(3 * HOOK_TICK_INTERVAL);
+	TEST_ASSERT(hook_timing_stop() == 0);
+
+	/* Only the outer routine of a nested notify is recorded. */
+	hook_timing_start(t, ARRAY_SIZE(t));
+	hook_notify_range(HOOK_CHIPSET_SUSPEND, NESTING_PRIO, NESTING_PRIO);
+	TEST_ASSERT(hook_timing_stop() == 1);
+	TEST_ASSERT(t[0].routine == nesting_hook);
+
+	return EC_SUCCESS;
+}
+
 static int test_deferred(void)
 {
 	deferred_call_count = 0;
@@ -166,6 +254,8 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_init_hook);
 	RUN_TEST(test_ticks);
 	RUN_TEST(test_priority);
+	RUN_TEST(test_notify_range);
+	RUN_TEST(test_timing);
 	RUN_TEST(test_deferred);
 	RUN_TEST(test_repeating_deferred);
 
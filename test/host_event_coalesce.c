@@ -0,0 +1,98 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test host event coalescing.
+ */
+
+#include "common.h"
+#include "host_command.h"
+#include "test_util.h"
+#include "timer.h"
+
+#define INTERVAL_US (CONFIG_HOST_EVENT_COALESCE_MS * MSEC)
+
+#define EVENT_AC ((uint32_t)EC_HOST_EVENT_MASK(EC_HOST_EVENT_AC_CONNECTED))
+#define EVENT_BATT ((uint32_t)EC_HOST_EVENT_MASK(EC_HOST_EVENT_BATTERY))
+#define EVENT_PD ((uint32_t)EC_HOST_EVENT_MASK(EC_HOST_EVENT_PD_MCU))
+#define EVENT_PWRBTN ((uint32_t)EC_HOST_EVENT_MASK(EC_HOST_EVENT_POWER_BUTTON))
+
+/* All the events used here live in the lower 32 bits */
+static uint32_t get_events(void)
+{
+	return (uint32_t)host_get_events();
+}
+
+static void reset_events(void)
+{
+	/* Let anything held back go out, then start from a clean slate */
+	usleep(2 * INTERVAL_US);
+	host_clear_events(~0);
+}
+
+static int test_first_event_immediate(void)
+{
+	reset_events();
+
+	host_set_single_event(EC_HOST_EVENT_BATTERY);
+	TEST_EQ(get_events(), EVENT_BATT, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_burst_coalesced(void)
+{
+	reset_events();
+
+	host_set_single_event(EC_HOST_EVENT_BATTERY);
+	host_set_single_event(EC_HOST_EVENT_AC_CONNECTED);
+	host_set_single_event(EC_HOST_EVENT_PD_MCU);
+	TEST_EQ(get_events(), EVENT_BATT, "0x%x");
+
+	/* Held back events all go out together once the interval expires */
+	usleep(INTERVAL_US + MSEC);
+	TEST_EQ(get_events(), EVENT_BATT | EVENT_AC | EVENT_PD, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_urgent_not_delayed(void)
+{
+	reset_events();
+
+	host_set_single_event(EC_HOST_EVENT_BATTERY);
+	host_set_single_event(EC_HOST_EVENT_AC_CONNECTED);
+	TEST_EQ(get_events(), EVENT_BATT, "0x%x");
+
+	/* An urgent event goes out right away and takes the rest along */
+	host_set_single_event(EC_HOST_EVENT_POWER_BUTTON);
+	TEST_EQ(get_events(), EVENT_BATT | EVENT_AC | EVENT_PWRBTN, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_cleared_before_delivery(void)
+{
+	reset_events();
+
+	host_set_single_event(EC_HOST_EVENT_BATTERY);
+	host_set_single_event(EC_HOST_EVENT_AC_CONNECTED);
+	host_clear_events(EVENT_AC);
+
+	usleep(INTERVAL_US + MSEC);
+	TEST_EQ(get_events(), EVENT_BATT, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_first_event_immediate);
+	RUN_TEST(test_burst_coalesced);
+	RUN_TEST(test_urgent_not_delayed);
+	RUN_TEST(test_cleared_before_delivery);
+
+	test_print_result();
+}
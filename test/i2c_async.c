@@ -0,0 +1,242 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the asynchronous I2C transfer API.
+ */
+
+#include "common.h"
+#include "i2c.h"
+#include "task.h"
+#include "test_util.h"
+#include "util.h"
+
+#define PORT I2C_PORT_EEPROM
+#define DEV_ADDR_FLAGS 0x2a
+#define READ_SIZE 32
+
+static int xfer_count;
+static int nack_count;
+
+/*
+ * Emulated device on both ports: the first byte written selects a register,
+ * reads return consecutive bytes starting at the register number. The next
+ * nack_count transfers are NACKed.
+ */
+static int dev_xfer(int port, uint16_t addr_flags,
+		    const uint8_t *out, int out_size,
+		    uint8_t *in, int in_size, int flags)
+{
+	static uint8_t reg[I2C_PORT_COUNT];
+	int i;
+
+	if ((port != PORT && port != I2C_PORT_AUX) ||
+	    addr_flags != DEV_ADDR_FLAGS)
+		return EC_ERROR_INVAL;
+
+	xfer_count++;
+	if (nack_count) {
+		nack_count--;
+		return EC_ERROR_BUSY;
+	}
+
+	if (out_size)
+		reg[port] = out[0];
+	for (i = 0; i < in_size; i++)
+		in[i] = reg[port]++;
+
+	return EC_SUCCESS;
+}
+DECLARE_TEST_I2C_XFER(dev_xfer);
+
+static int check_data(const uint8_t *buf, int size, uint8_t first)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		if (buf[i] != (uint8_t)(first + i))
+			return 0;
+	return 1;
+}
+
+static int test_submit_complete(void)
+{
+	uint8_t reg = 0x10;
+	uint8_t buf[READ_SIZE];
+	struct i2c_xfer_async x = {
+		.port = PORT,
+		.slave_addr_flags = DEV_ADDR_FLAGS,
+		.out = &reg,
+		.out_size = 1,
+		.in = buf,
+		.in_size = sizeof(buf),
+	};
+
+	memset(buf, 0, sizeof(buf));
+	xfer_count = 0;
+	i2c_xfer_submit(&x);
+	TEST_EQ(i2c_xfer_complete(&x), EC_SUCCESS, "%d");
+	TEST_EQ(xfer_count, 1, "%d");
+	TEST_ASSERT(check_data(buf, sizeof(buf), 0x10));
+
+	/* The port was unlocked, so a locked transfer goes through */
+	reg = 0x40;
+	TEST_EQ(i2c_xfer(PORT, DEV_ADDR_FLAGS, &reg, 1, buf, 4), EC_SUCCESS,
+		"%d");
+	TEST_ASSERT(check_data(buf, 4, 0x40));
+
+	return EC_SUCCESS;
+}
+
+static int test_back_to_back(void)
+{
+	const int port[2] = {PORT, I2C_PORT_AUX};
+	uint8_t reg[2] = {0x20, 0x80};
+	uint8_t buf[2][8];
+	struct i2c_xfer_async x[2];
+	uint32_t switches;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		x[i].port = port[i];
+		x[i].slave_addr_flags = DEV_ADDR_FLAGS;
+		x[i].out = &reg[i];
+		x[i].out_size = 1;
+		x[i].in = buf[i];
+		x[i].in_size = sizeof(buf[i]);
+	}
+
+	/* Both transfers are outstanding before either is collected */
+	switches = task_get_switch_count();
+	for (i = 0; i < 2; i++)
+		i2c_xfer_submit(&x[i]);
+	for (i = 0; i < 2; i++)
+		TEST_ASSERT(x[i].pending);
+	TEST_EQ(task_get_switch_count(), switches, "%d");
+
+	for (i = 0; i < 2; i++) {
+		TEST_EQ(i2c_xfer_complete(&x[i]), EC_SUCCESS, "%d");
+		TEST_ASSERT(check_data(buf[i], sizeof(buf[i]), reg[i]));
+	}
+
+	/* One wake-up collected both completions */
+	TEST_EQ(task_get_switch_count() - switches, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_error(void)
+{
+	uint8_t buf[4];
+	struct i2c_xfer_async x = {
+		.port = PORT,
+		.slave_addr_flags = DEV_ADDR_FLAGS,
+		.in = buf,
+		.in_size = sizeof(buf),
+	};
+
+	TEST_EQ(test_detach_i2c(PORT, DEV_ADDR_FLAGS), EC_SUCCESS, "%d");
+	i2c_xfer_submit(&x);
+	TEST_NE(i2c_xfer_complete(&x), EC_SUCCESS, "%d");
+	TEST_EQ(test_attach_i2c(PORT, DEV_ADDR_FLAGS), EC_SUCCESS, "%d");
+
+	i2c_xfer_submit(&x);
+	TEST_EQ(i2c_xfer_complete(&x), EC_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_pec_falls_back(void)
+{
+	uint8_t reg = 0x30;
+	uint8_t buf[4];
+	struct i2c_xfer_async x = {
+		.port = PORT,
+		.slave_addr_flags = DEV_ADDR_FLAGS | I2C_FLAG_PEC,
+		.out = &reg,
+		.out_size = 1,
+		.in = buf,
+		.in_size = sizeof(buf),
+	};
+	uint32_t switches = task_get_switch_count();
+
+	/* PEC is handled by the synchronous path, which drops the flag */
+	i2c_xfer_submit(&x);
+	TEST_EQ(task_get_switch_count(), switches, "%d");
+	TEST_EQ(i2c_xfer_complete(&x), EC_SUCCESS, "%d");
+	TEST_ASSERT(check_data(buf, sizeof(buf), 0x30));
+
+	return EC_SUCCESS;
+}
+
+static int test_nack_retry(void)
+{
+	uint8_t reg = 0x50;
+	uint8_t buf[4];
+	struct i2c_xfer_async x = {
+		.port = PORT,
+		.slave_addr_flags = DEV_ADDR_FLAGS,
+		.out = &reg,
+		.out_size = 1,
+		.in = buf,
+		.in_size = sizeof(buf),
+	};
+
+	/* A NACKed async transfer is retried on the synchronous path */
+	xfer_count = 0;
+	nack_count = 1;
+	i2c_xfer_submit(&x);
+	TEST_ASSERT(x.pending);
+	TEST_EQ(i2c_xfer_complete(&x), EC_SUCCESS, "%d");
+	TEST_EQ(xfer_count, 2, "%d");
+	TEST_ASSERT(check_data(buf, sizeof(buf), 0x50));
+
+	/* Give up after CONFIG_I2C_NACK_RETRY_COUNT retries */
+	xfer_count = 0;
+	nack_count = CONFIG_I2C_NACK_RETRY_COUNT + 2;
+	i2c_xfer_submit(&x);
+	TEST_EQ(i2c_xfer_complete(&x), EC_ERROR_BUSY, "%d");
+	TEST_EQ(xfer_count, CONFIG_I2C_NACK_RETRY_COUNT + 2, "%d");
+	nack_count = 0;
+
+	return EC_SUCCESS;
+}
+
+/* A register read blocks once, in i2c_xfer_complete() */
+static int test_switches_per_read(void)
+{
+	uint8_t reg = 0;
+	uint8_t buf[READ_SIZE];
+	struct i2c_xfer_async x = {
+		.port = PORT,
+		.slave_addr_flags = DEV_ADDR_FLAGS,
+		.out = &reg,
+		.out_size = 1,
+		.in = buf,
+		.in_size = sizeof(buf),
+	};
+	uint32_t switches = task_get_switch_count();
+
+	i2c_xfer_submit(&x);
+	TEST_ASSERT(x.pending);
+	TEST_EQ(task_get_switch_count(), switches, "%d");
+	TEST_EQ(i2c_xfer_complete(&x), EC_SUCCESS, "%d");
+	TEST_EQ(task_get_switch_count() - switches, 1, "%d");
+	TEST_ASSERT(check_data(buf, sizeof(buf), 0));
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_submit_complete);
+	RUN_TEST(test_back_to_back);
+	RUN_TEST(test_error);
+	RUN_TEST(test_pec_falls_back);
+	RUN_TEST(test_nack_retry);
+	RUN_TEST(test_switches_per_read);
+
+	test_print_result();
+}
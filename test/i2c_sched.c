@@ -0,0 +1,101 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test I2C port lock priorities.
+ */
+
+#include "common.h"
+#include "i2c.h"
+#include "task.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define PORT I2C_PORT_EEPROM
+
+static task_id_t order[3];
+static int order_len;
+
+/*
+ * Lock the port at the priority given by the task and record when the lock
+ * was granted. Tasks later in the task list have a higher task priority, the
+ * reverse of their I2C priority.
+ */
+int i2c_user_task(void *unused)
+{
+	task_id_t id = task_get_current();
+
+	if (id == TASK_ID_URGENT)
+		i2c_set_priority(I2C_PRIO_URGENT);
+	else if (id == TASK_ID_BACKGROUND)
+		i2c_set_priority(I2C_PRIO_BACKGROUND);
+
+	while (1) {
+		task_wait_event(-1);
+		i2c_lock(PORT, 1);
+		order[order_len++] = id;
+		i2c_lock(PORT, 0);
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_priority_order(void)
+{
+	order_len = 0;
+
+	/* Queue all three tasks behind the port holder */
+	i2c_lock(PORT, 1);
+	task_wake(TASK_ID_BACKGROUND);
+	task_wake(TASK_ID_NORMAL);
+	task_wake(TASK_ID_URGENT);
+	msleep(10);
+	TEST_EQ(order_len, 0, "%d");
+	i2c_lock(PORT, 0);
+	msleep(10);
+
+	TEST_EQ(order_len, 3, "%d");
+	TEST_EQ(order[0], TASK_ID_URGENT, "%d");
+	TEST_EQ(order[1], TASK_ID_NORMAL, "%d");
+	TEST_EQ(order[2], TASK_ID_BACKGROUND, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_uncontended(void)
+{
+	order_len = 0;
+
+	/* Without contention the port goes to whoever asks */
+	task_wake(TASK_ID_BACKGROUND);
+	msleep(10);
+	task_wake(TASK_ID_URGENT);
+	msleep(10);
+
+	TEST_EQ(order_len, 2, "%d");
+	TEST_EQ(order[0], TASK_ID_BACKGROUND, "%d");
+	TEST_EQ(order[1], TASK_ID_URGENT, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_set_priority(void)
+{
+	TEST_EQ(i2c_set_priority(I2C_PRIO_BACKGROUND), I2C_PRIO_NORMAL, "%d");
+	TEST_EQ(i2c_set_priority(I2C_PRIO_NORMAL), I2C_PRIO_BACKGROUND, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+	wait_for_task_started();
+
+	RUN_TEST(test_priority_order);
+	RUN_TEST(test_uncontended);
+	RUN_TEST(test_set_priority);
+
+	test_print_result();
+}
@@ -0,0 +1,162 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test per-device I2C bus statistics.
+ */
+
+#include "common.h"
+#include "ec_commands_private.h"
+#include "i2c.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define PORT I2C_PORT_EEPROM
+#define DEV_A 0x2a
+#define DEV_B 0x2b
+
+static int dev_b_rv;
+
+static int dev_xfer(int port, uint16_t addr_flags,
+		    const uint8_t *out, int out_size,
+		    uint8_t *in, int in_size, int flags)
+{
+	if (port != PORT)
+		return EC_ERROR_INVAL;
+
+	if (addr_flags == DEV_A) {
+		usleep(100);
+		return EC_SUCCESS;
+	}
+	if (addr_flags == DEV_B)
+		return dev_b_rv;
+
+	return EC_ERROR_INVAL;
+}
+DECLARE_TEST_I2C_XFER(dev_xfer);
+
+static struct {
+	struct ec_response_i2c_stats r;
+	struct ec_i2c_stats_device devices[CONFIG_I2C_STATS_DEVICES];
+} resp;
+
+static int read_stats(uint8_t flags, uint8_t offset, int size)
+{
+	struct ec_params_i2c_stats p = {
+		.flags = flags,
+		.offset = offset,
+	};
+
+	memset(&resp, 0, sizeof(resp));
+	TEST_EQ(test_send_host_command(EC_CMD_I2C_STATS, 0, &p, sizeof(p),
+				       &resp, size),
+		EC_RES_SUCCESS, "%d");
+	return EC_SUCCESS;
+}
+
+static const struct ec_i2c_stats_device *find_dev(int addr)
+{
+	int i;
+
+	for (i = 0; i < resp.r.count; i++)
+		if (resp.devices[i].port == PORT &&
+		    resp.devices[i].addr == addr)
+			return resp.devices + i;
+	return NULL;
+}
+
+static int test_counts(void)
+{
+	const struct ec_i2c_stats_device *d;
+	uint8_t buf[4] = {0};
+
+	TEST_EQ(read_stats(EC_I2C_STATS_CLEAR, 0, sizeof(resp)), EC_SUCCESS,
+		"%d");
+	TEST_EQ(resp.r.total, 0, "%d");
+
+	TEST_EQ(i2c_xfer(PORT, DEV_A, buf, 1, buf, 4), EC_SUCCESS, "%d");
+	TEST_EQ(i2c_xfer(PORT, DEV_A, buf, 2, NULL, 0), EC_SUCCESS, "%d");
+	dev_b_rv = EC_ERROR_BUSY;
+	TEST_EQ(i2c_xfer(PORT, DEV_B, buf, 1, NULL, 0), EC_ERROR_BUSY, "%d");
+	dev_b_rv = EC_ERROR_TIMEOUT;
+	TEST_EQ(i2c_xfer(PORT, DEV_B, buf, 1, NULL, 0), EC_ERROR_TIMEOUT,
+		"%d");
+	dev_b_rv = EC_ERROR_UNKNOWN;
+	TEST_EQ(i2c_xfer(PORT, DEV_B, buf, 1, NULL, 0), EC_ERROR_UNKNOWN,
+		"%d");
+	/* Charged to the device that used the port last */
+	i2c_unwedge(PORT);
+
+	TEST_EQ(read_stats(0, 0, sizeof(resp)), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.total, 2, "%d");
+	TEST_EQ(resp.r.count, 2, "%d");
+	TEST_EQ(resp.r.untracked, 0, "%u");
+
+	d = find_dev(DEV_A);
+	TEST_ASSERT(d);
+	TEST_EQ(d->xfers, 2, "%u");
+	TEST_EQ(d->bytes, 7, "%u");
+	TEST_ASSERT(d->busy_us >= 200);
+	TEST_ASSERT(d->max_us >= 100);
+	TEST_EQ(d->nacks + d->timeouts + d->errors + d->unwedges, 0, "%u");
+
+	d = find_dev(DEV_B);
+	TEST_ASSERT(d);
+	TEST_EQ(d->xfers, 3, "%u");
+	TEST_EQ(d->nacks, 1, "%u");
+	TEST_EQ(d->timeouts, 1, "%u");
+	TEST_EQ(d->errors, 1, "%u");
+	TEST_EQ(d->unwedges, 1, "%u");
+
+	return EC_SUCCESS;
+}
+
+static int test_paging(void)
+{
+	int size = sizeof(resp.r) + sizeof(resp.devices[0]);
+
+	/* Room for one device per response */
+	TEST_EQ(read_stats(0, 0, size), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.total, 2, "%d");
+	TEST_EQ(resp.r.count, 1, "%d");
+	TEST_EQ(resp.devices[0].addr, DEV_A, "0x%x");
+
+	TEST_EQ(read_stats(0, 1, size), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.count, 1, "%d");
+	TEST_EQ(resp.devices[0].addr, DEV_B, "0x%x");
+
+	TEST_EQ(read_stats(0, 2, size), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.count, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_table_full(void)
+{
+	int i;
+
+	TEST_EQ(read_stats(EC_I2C_STATS_CLEAR, 0, sizeof(resp)), EC_SUCCESS,
+		"%d");
+
+	/* Unknown addresses fail, but still use the bus */
+	for (i = 0; i < CONFIG_I2C_STATS_DEVICES + 3; i++)
+		i2c_xfer(PORT, 0x40 + i, NULL, 0, NULL, 0);
+
+	TEST_EQ(read_stats(0, 0, sizeof(resp)), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.total, CONFIG_I2C_STATS_DEVICES, "%d");
+	TEST_EQ(resp.r.untracked, 3, "%u");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_counts);
+	RUN_TEST(test_paging);
+	RUN_TEST(test_table_full);
+
+	test_print_result();
+}
@@ -0,0 +1,151 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the I2C transaction capture ring.
+ */
+
+#include "common.h"
+#include "ec_commands_private.h"
+#include "i2c.h"
+#include "test_util.h"
+#include "timer.h"
+#include "uart.h"
+#include "util.h"
+
+#define PORT I2C_PORT_EEPROM
+#define TRACED_ADDR 0x2a
+#define OTHER_ADDR 0x2b
+
+static struct {
+	struct ec_response_i2c_trace_read r;
+	struct ec_i2c_trace_entry entries[CONFIG_I2C_TRACE_ENTRIES];
+} resp;
+
+/* Emulated devices: reads return consecutive bytes from the register */
+static int dev_xfer(int port, uint16_t addr_flags,
+		    const uint8_t *out, int out_size,
+		    uint8_t *in, int in_size, int flags)
+{
+	int i;
+
+	if (port != PORT ||
+	    (addr_flags != TRACED_ADDR && addr_flags != OTHER_ADDR))
+		return EC_ERROR_INVAL;
+
+	for (i = 0; i < in_size; i++)
+		in[i] = (out_size ? out[0] : 0) + i;
+
+	return EC_SUCCESS;
+}
+DECLARE_TEST_I2C_XFER(dev_xfer);
+
+static int read_trace(void)
+{
+	memset(&resp, 0, sizeof(resp));
+	TEST_EQ(test_send_host_command(EC_CMD_I2C_TRACE_READ, 0, NULL, 0,
+				       &resp, sizeof(resp)),
+		EC_RES_SUCCESS, "%d");
+	return EC_SUCCESS;
+}
+
+static int test_capture(void)
+{
+	uint8_t out[10] = {0x10, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	uint8_t in[4];
+	const struct ec_i2c_trace_entry *e = resp.entries;
+
+	TEST_EQ(i2c_xfer(PORT, TRACED_ADDR, out, 1, in, sizeof(in)),
+		EC_SUCCESS, "%d");
+	/* Not in the enabled range */
+	TEST_EQ(i2c_xfer(PORT, OTHER_ADDR, out, 1, in, sizeof(in)),
+		EC_SUCCESS, "%d");
+	/* Long write, only the first bytes are kept */
+	TEST_EQ(i2c_xfer(PORT, TRACED_ADDR, out, sizeof(out), NULL, 0),
+		EC_SUCCESS, "%d");
+	/* Failed transaction */
+	TEST_EQ(test_detach_i2c(PORT, TRACED_ADDR), EC_SUCCESS, "%d");
+	TEST_NE(i2c_xfer(PORT, TRACED_ADDR, NULL, 0, in, 2), EC_SUCCESS,
+		"%d");
+	TEST_EQ(test_attach_i2c(PORT, TRACED_ADDR), EC_SUCCESS, "%d");
+
+	TEST_EQ(read_trace(), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.overwritten, 0, "%u");
+	TEST_EQ(resp.r.count, 3, "%d");
+
+	TEST_EQ(e[0].port, PORT, "%d");
+	TEST_EQ(e[0].addr_flags, TRACED_ADDR, "0x%x");
+	TEST_EQ(e[0].result, EC_SUCCESS, "%d");
+	TEST_EQ(e[0].out_size, 1, "%d");
+	TEST_EQ(e[0].in_size, 4, "%d");
+	TEST_EQ(e[0].data[0], 0x10, "0x%x");
+	TEST_EQ(e[0].data[1], 0x10, "0x%x");
+	TEST_EQ(e[0].data[4], 0x13, "0x%x");
+	TEST_ASSERT(e[0].end_us - e[0].start_us < 1000000);
+
+	TEST_EQ(e[1].out_size, (int)sizeof(out), "%d");
+	TEST_ASSERT_ARRAY_EQ(e[1].data, out, EC_I2C_TRACE_DATA_MAX);
+
+	TEST_NE(e[2].result, EC_SUCCESS, "%d");
+	TEST_EQ(e[2].in_size, 2, "%d");
+
+	/* Reading removes the entries */
+	TEST_EQ(read_trace(), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.count, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_overwrite(void)
+{
+	uint8_t reg;
+	uint8_t in;
+	int i;
+
+	for (i = 0; i < CONFIG_I2C_TRACE_ENTRIES + 5; i++) {
+		reg = i;
+		TEST_EQ(i2c_xfer(PORT, TRACED_ADDR, &reg, 1, &in, 1),
+			EC_SUCCESS, "%d");
+	}
+
+	/* The oldest entries are lost, the newest are kept in order */
+	TEST_EQ(read_trace(), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.overwritten, 5, "%u");
+	TEST_EQ(resp.r.count, CONFIG_I2C_TRACE_ENTRIES, "%d");
+	for (i = 0; i < CONFIG_I2C_TRACE_ENTRIES; i++)
+		TEST_EQ(resp.entries[i].data[0], i + 5, "%d");
+
+	TEST_EQ(read_trace(), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.overwritten, 0, "%u");
+
+	return EC_SUCCESS;
+}
+
+static int test_disable(void)
+{
+	uint8_t in;
+
+	UART_INJECT("i2ctrace disable 0\n");
+	msleep(30);
+
+	TEST_EQ(i2c_xfer(PORT, TRACED_ADDR, NULL, 0, &in, 1), EC_SUCCESS,
+		"%d");
+	TEST_EQ(read_trace(), EC_SUCCESS, "%d");
+	TEST_EQ(resp.r.count, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	UART_INJECT("i2ctrace enable 0 0x2a\n");
+	msleep(30);
+
+	RUN_TEST(test_capture);
+	RUN_TEST(test_overwrite);
+	RUN_TEST(test_disable);
+
+	test_print_result();
+}
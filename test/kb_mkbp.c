@@ -141,6 +141,60 @@ int verify_key_v2(int c, int r, int pressed, int expect_more)
 	return 1;
 }
 
+/* Room for one v3 event record */
+#define V3_RECORD_MAX (sizeof(struct ec_mkbp_event_record) + \
+		       sizeof(union ec_response_get_next_data_v1))
+
+static uint8_t v3_buf[sizeof(struct ec_response_get_next_event_v3) +
+		      8 * V3_RECORD_MAX];
+
+/* Drain events with GET_NEXT_EVENT v3, leaving room for max_events records */
+int get_next_events_v3(int max_events)
+{
+	struct host_cmd_handler_args args;
+
+	args.version = 3;
+	args.command = EC_CMD_GET_NEXT_EVENT;
+	args.params = NULL;
+	args.params_size = 0;
+	args.response = v3_buf;
+	args.response_max = sizeof(struct ec_response_get_next_event_v3) +
+			    max_events * V3_RECORD_MAX;
+	args.response_size = 0;
+
+	return host_command_process(&args);
+}
+
+/* Return the idx'th record of the last v3 response */
+struct ec_mkbp_event_record *v3_record(int idx)
+{
+	uint8_t *p = v3_buf + sizeof(struct ec_response_get_next_event_v3);
+	struct ec_mkbp_event_record *rec =
+		(struct ec_mkbp_event_record *)p;
+
+	while (idx--) {
+		p += sizeof(*rec) + rec->size;
+		rec = (struct ec_mkbp_event_record *)p;
+	}
+
+	return rec;
+}
+
+int verify_key_record(int idx, int c, int r, int pressed)
+{
+	struct ec_mkbp_event_record *rec = v3_record(idx);
+
+	ccprintf("Verify record %d: %s (%d, %d)\n", idx, action[pressed],
+		 c, r);
+	set_state(c, r, pressed);
+
+	if (rec->event_type != EC_MKBP_EVENT_KEY_MATRIX ||
+	    rec->size != KEYBOARD_COLS_MAX)
+		return 0;
+
+	return !memcmp(rec->data, state, KEYBOARD_COLS_MAX);
+}
+
 int mkbp_config(struct ec_params_mkbp_set_config params)
 {
 	struct host_cmd_handler_args args;
@@ -286,6 +340,97 @@ int fifo_underrun(void)
 	return EC_SUCCESS;
 }
 
+int multi_event_drain_v3(void)
+{
+	struct ec_response_get_next_event_v3 *r = (void *)v3_buf;
+
+	keyboard_clear_buffer();
+	clear_state();
+	TEST_ASSERT(press_key(0, 0, 1) == EC_SUCCESS);
+	TEST_ASSERT(press_key(1, 1, 1) == EC_SUCCESS);
+	TEST_ASSERT(press_key(0, 0, 0) == EC_SUCCESS);
+	TEST_ASSERT(FIFO_NOT_EMPTY());
+
+	/* Everything comes out in one go, in FIFO order */
+	clear_state();
+	TEST_ASSERT(get_next_events_v3(8) == EC_RES_SUCCESS);
+	TEST_EQ(r->count, 3, "%d");
+	TEST_EQ(r->pending_types, 0, "%d");
+	TEST_ASSERT(verify_key_record(0, 0, 0, 1));
+	TEST_ASSERT(verify_key_record(1, 1, 1, 1));
+	TEST_ASSERT(verify_key_record(2, 0, 0, 0));
+	TEST_ASSERT(FIFO_EMPTY());
+
+	TEST_ASSERT(get_next_events_v3(8) == EC_RES_UNAVAILABLE);
+
+	return EC_SUCCESS;
+}
+
+int partial_drain_v3(void)
+{
+	struct ec_response_get_next_event_v3 *r = (void *)v3_buf;
+
+	keyboard_clear_buffer();
+	clear_state();
+	TEST_ASSERT(press_key(0, 0, 1) == EC_SUCCESS);
+	TEST_ASSERT(press_key(1, 1, 1) == EC_SUCCESS);
+	TEST_ASSERT(press_key(0, 0, 0) == EC_SUCCESS);
+
+	/* Too small for even a single event */
+	TEST_ASSERT(get_next_events_v3(0) == EC_RES_RESPONSE_TOO_BIG);
+
+	clear_state();
+	TEST_ASSERT(get_next_events_v3(2) == EC_RES_SUCCESS);
+	TEST_EQ(r->count, 2, "%d");
+	TEST_EQ(r->pending_types, 1, "%d");
+	TEST_ASSERT(verify_key_record(0, 0, 0, 1));
+	TEST_ASSERT(verify_key_record(1, 1, 1, 1));
+	TEST_ASSERT(FIFO_NOT_EMPTY());
+
+	/* The rest picks up where we left off */
+	TEST_ASSERT(get_next_events_v3(2) == EC_RES_SUCCESS);
+	TEST_EQ(r->count, 1, "%d");
+	TEST_EQ(r->pending_types, 0, "%d");
+	TEST_ASSERT(verify_key_record(0, 0, 0, 0));
+	TEST_ASSERT(FIFO_EMPTY());
+
+	return EC_SUCCESS;
+}
+
+int mixed_drain_v3(void)
+{
+	struct ec_response_get_next_event_v3 *r = (void *)v3_buf;
+	struct ec_mkbp_event_record *rec;
+	int i, keys = 0, host_events = 0;
+
+	keyboard_clear_buffer();
+	clear_state();
+	TEST_ASSERT(press_key(2, 2, 1) == EC_SUCCESS);
+	host_set_single_event(EC_HOST_EVENT_AC_CONNECTED);
+	TEST_ASSERT(press_key(2, 2, 0) == EC_SUCCESS);
+
+	TEST_ASSERT(get_next_events_v3(8) == EC_RES_SUCCESS);
+	TEST_EQ(r->count, 3, "%d");
+	TEST_EQ(r->pending_types, 0, "%d");
+
+	/* Key events keep their order around the host event */
+	clear_state();
+	for (i = 0; i < r->count; i++) {
+		rec = v3_record(i);
+		if (rec->event_type == EC_MKBP_EVENT_HOST_EVENT) {
+			host_events++;
+			continue;
+		}
+		TEST_ASSERT(verify_key_record(i, 2, 2, !keys));
+		keys++;
+	}
+	TEST_EQ(keys, 2, "%d");
+	TEST_EQ(host_events, 1, "%d");
+	TEST_ASSERT(FIFO_EMPTY());
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	ec_int_level = 1;
@@ -298,6 +443,9 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_fifo_size);
 	RUN_TEST(test_enable);
 	RUN_TEST(fifo_underrun);
+	RUN_TEST(multi_event_drain_v3);
+	RUN_TEST(partial_drain_v3);
+	RUN_TEST(mixed_drain_v3);
 
 	test_print_result();
 }
@@ -9,16 +9,40 @@
 #include "common.h"
 #include "rsa.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
-#ifdef TEST_RSA3
+#if defined(TEST_RSA3)
 #include "rsa2048-3.h"
+#elif defined(TEST_RSA3072)
+#include "rsa3072-F4.h"
+#elif defined(TEST_RSA3072_3)
+#include "rsa3072-3.h"
 #else
 #include "rsa2048-F4.h"
 #endif
 
 static uint32_t rsa_workbuf[3 * RSANUMBYTES/4];
 
+#define BENCHMARK_ITERATIONS 20
+
+static void benchmark_verify(void)
+{
+	timestamp_t t0, t1;
+	int i;
+
+	t0 = get_time();
+	for (i = 0; i < BENCHMARK_ITERATIONS; i++)
+		rsa_verify(rsa_key, sig, hash, rsa_workbuf);
+	t1 = get_time();
+
+	/* do not check speed, just as a benchmark */
+	ccprintf("RSA-%d e=%s verify x%d duration %lld us\n",
+		 CONFIG_RSA_KEY_SIZE,
+		 IS_ENABLED(CONFIG_RSA_EXPONENT_3) ? "3" : "65537",
+		 BENCHMARK_ITERATIONS, (long long)(t1.val - t0.val));
+}
+
 void run_test(int argc, char **argv)
 {
 	int good;
@@ -49,6 +73,8 @@ void run_test(int argc, char **argv)
 	}
 	ccprintf("RSA verify FAILED (as expected)\n");
 
+	benchmark_verify();
+
 	test_pass();
 }
 
@@ -0,0 +1,140 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * RSA 3072 with 3 exponent public key and verification.
+ * Private key in rsa3072-3.pem.
+ */
+
+/* First generate a key:
+ * # openssl genrsa -3 -out key.pem 3072
+ * # openssl rsa -in key.pem -pubout > key.pub
+ * Then dump the key:
+ * # dumpRSAPublicKey -pub key.pub | xxd -i
+ */
+const uint8_t rsa_data[] = {
+	0x60, 0x00, 0x00, 0x00, 0xfb, 0x06, 0x6c, 0x5c, 0xcd, 0xeb, 0x62, 0xc5,
+	0x6c, 0x46, 0xe2, 0x15, 0xff, 0x8f, 0xfc, 0x61, 0x9f, 0x1c, 0xd5, 0x85,
+	0x2a, 0x0f, 0xde, 0x36, 0x41, 0x08, 0x8b, 0x5c, 0x0f, 0x09, 0x1d, 0xd1,
+	0x13, 0xa8, 0x75, 0x68, 0x54, 0x45, 0x67, 0x8e, 0xc2, 0x72, 0x8b, 0x2c,
+	0x49, 0xf4, 0x52, 0xc5, 0xd6, 0x73, 0xf3, 0x5a, 0xf9, 0x45, 0xf9, 0x01,
+	0xda, 0xbc, 0xb5, 0x1c, 0xbd, 0xc1, 0x37, 0x4b, 0x00, 0x03, 0x4c, 0x3b,
+	0xa2, 0xe3, 0xa4, 0xc5, 0x0d, 0x52, 0x0b, 0xdd, 0x2f, 0x4f, 0x8b, 0x02,
+	0x59, 0x49, 0xb9, 0xd2, 0x6d, 0xd1, 0x3e, 0x13, 0x47, 0x09, 0x91, 0xe3,
+	0xd5, 0xbe, 0xaa, 0x1e, 0xe2, 0xb4, 0xed, 0x6b, 0x82, 0xd9, 0xba, 0x2b,
+	0xd0, 0xf3, 0x38, 0x17, 0x0e, 0x88, 0x33, 0x75, 0x02, 0x93, 0x5c, 0x8e,
+	0x28, 0x48, 0x09, 0x55, 0xd1, 0x8b, 0xb2, 0x1e, 0xc2, 0xc9, 0x63, 0xef,
+	0x19, 0x38, 0x1e, 0x7c, 0xfa, 0xcf, 0xcc, 0x44, 0xe9, 0x6a, 0x97, 0x12,
+	0x0c, 0x9d, 0xc1, 0x23, 0xe5, 0xb1, 0x8c, 0xee, 0x61, 0x06, 0x4a, 0x92,
+	0xbb, 0x8f, 0x56, 0x44, 0x53, 0xb0, 0xe6, 0x53, 0x04, 0xb5, 0x62, 0x6c,
+	0x1b, 0xbf, 0x6d, 0x40, 0x6a, 0x57, 0x04, 0x78, 0xe8, 0xdc, 0xfb, 0x7d,
+	0x66, 0xe3, 0x4f, 0xdc, 0xbc, 0x5c, 0x3a, 0x5c, 0x89, 0xd6, 0xe3, 0x2b,
+	0x98, 0xa1, 0x80, 0x33, 0xe6, 0x5d, 0xd5, 0xec, 0x20, 0x7e, 0x8e, 0x9a,
+	0x7f, 0xda, 0x5a, 0xcf, 0xb4, 0x17, 0xad, 0xc0, 0x93, 0x55, 0x37, 0xa6,
+	0x3f, 0xfd, 0x4f, 0xbf, 0xb0, 0x58, 0x9e, 0x4d, 0xba, 0x2a, 0x21, 0xc2,
+	0x72, 0xc1, 0x6e, 0x81, 0x84, 0x7b, 0x56, 0x8e, 0x08, 0x2a, 0x5c, 0x61,
+	0x07, 0x09, 0x38, 0xb5, 0xb5, 0x97, 0x8f, 0xe9, 0xe3, 0xe2, 0x25, 0x8a,
+	0x20, 0x36, 0x9a, 0xbd, 0xd7, 0xb6, 0x60, 0x4c, 0x17, 0x91, 0xf8, 0x17,
+	0xb3, 0x55, 0x52, 0xfe, 0x2d, 0xde, 0x07, 0xa8, 0xde, 0xf2, 0x86, 0x47,
+	0x4a, 0x41, 0x94, 0x90, 0x2a, 0xad, 0x6c, 0x2f, 0x2d, 0x9e, 0x65, 0x58,
+	0x28, 0x7d, 0x6d, 0xf8, 0xc0, 0xb4, 0x14, 0x75, 0xff, 0xbe, 0xa6, 0x2e,
+	0xaa, 0xcb, 0x76, 0x63, 0xba, 0xdb, 0x03, 0xcb, 0xb2, 0xae, 0x7a, 0x3d,
+	0xfc, 0xde, 0x87, 0x2d, 0x53, 0xd7, 0x4e, 0x51, 0xa1, 0x6c, 0x34, 0xbf,
+	0xbd, 0x27, 0xc7, 0xb6, 0xbc, 0xc8, 0xe4, 0x8a, 0x03, 0xa6, 0x82, 0x60,
+	0xeb, 0xd8, 0x49, 0x9b, 0x86, 0x7b, 0x91, 0x9e, 0xd4, 0xe4, 0x69, 0xb2,
+	0x44, 0xa2, 0x37, 0xd3, 0x31, 0xba, 0x9f, 0x6c, 0xbf, 0xbb, 0x97, 0xb5,
+	0x7c, 0x63, 0x39, 0xb5, 0xcf, 0x1d, 0x10, 0xd1, 0xec, 0xa5, 0xfa, 0x57,
+	0xca, 0x7d, 0xe8, 0x3e, 0xce, 0xaf, 0x7a, 0xae, 0xb9, 0xd8, 0x12, 0x07,
+	0x66, 0x9b, 0xd3, 0x7e, 0x9e, 0xd2, 0x80, 0xba, 0x0a, 0x0e, 0xfc, 0x9e,
+	0xf2, 0x54, 0x34, 0x60, 0xd1, 0xfc, 0xd8, 0xd0, 0x44, 0x02, 0xbd, 0x64,
+	0x50, 0x92, 0x94, 0x3d, 0x5b, 0x04, 0x13, 0xfa, 0x17, 0x39, 0xb1, 0x0d,
+	0xe7, 0xbe, 0x41, 0xee, 0xe9, 0x3b, 0xe6, 0x41, 0x47, 0xc3, 0x11, 0x1b,
+	0x3a, 0xc9, 0x8c, 0x85, 0x33, 0x08, 0xcd, 0x56, 0x44, 0x46, 0xac, 0x77,
+	0x51, 0xb8, 0xf1, 0xb9, 0x6e, 0xd8, 0x8b, 0x72, 0xc8, 0x1a, 0x52, 0x13,
+	0x1d, 0xc9, 0x30, 0xc6, 0xb7, 0xcd, 0x4d, 0x85, 0x67, 0x87, 0x12, 0x86,
+	0x13, 0xcb, 0xd4, 0xfd, 0x10, 0x02, 0xc1, 0xf9, 0xdf, 0xe6, 0xb7, 0xa2,
+	0x17, 0x6c, 0x46, 0x60, 0x95, 0x59, 0x6a, 0xa2, 0x04, 0xb5, 0x54, 0x88,
+	0x28, 0x61, 0xf3, 0x6b, 0x26, 0x8a, 0x0d, 0xab, 0xea, 0x5a, 0xb1, 0x37,
+	0x72, 0xc6, 0x3e, 0x82, 0x04, 0x38, 0x17, 0x46, 0xda, 0x8d, 0xd4, 0xa6,
+	0xa2, 0x31, 0x32, 0x1a, 0xf3, 0xab, 0x45, 0x84, 0x20, 0xe7, 0x73, 0xcd,
+	0x2b, 0x97, 0x08, 0x80, 0x4b, 0xee, 0x54, 0xac, 0x32, 0xc6, 0xe3, 0x0e,
+	0x10, 0x7d, 0x6b, 0x6b, 0x9f, 0x85, 0x72, 0x0e, 0x4c, 0x93, 0x56, 0xc6,
+	0x26, 0xb3, 0x5c, 0x8f, 0xd1, 0x1f, 0x94, 0x5d, 0x7c, 0x3c, 0xf4, 0xc6,
+	0xde, 0xc8, 0x73, 0xc2, 0x8b, 0x61, 0x1c, 0x34, 0xae, 0xd8, 0xe2, 0x47,
+	0x17, 0xf4, 0x2d, 0xac, 0x2e, 0x5e, 0xda, 0xd9, 0xb6, 0x4d, 0x85, 0x21,
+	0x9e, 0x3b, 0x14, 0xa7, 0x4d, 0x07, 0x53, 0x53, 0x97, 0xc3, 0x36, 0xe5,
+	0x08, 0x1f, 0xbf, 0x3c, 0xc3, 0x1c, 0x2d, 0xd5, 0x12, 0x6f, 0xbe, 0xa3,
+	0x49, 0x3e, 0x4c, 0xcf, 0xae, 0xf0, 0x45, 0x5f, 0x42, 0x1d, 0x08, 0xf6,
+	0x7f, 0x5f, 0x12, 0x88, 0xed, 0xc0, 0xf4, 0xff, 0x38, 0x76, 0x74, 0xef,
+	0xaf, 0xe6, 0x7f, 0x1b, 0xa8, 0x9e, 0xf5, 0x5d, 0xe1, 0xe0, 0xaf, 0x74,
+	0x73, 0xe8, 0xb2, 0xda, 0x54, 0x10, 0xda, 0x70, 0x2a, 0x89, 0x13, 0x7f,
+	0x11, 0x04, 0xff, 0x53, 0x4b, 0x78, 0x0f, 0xca, 0x92, 0xf5, 0xec, 0x89,
+	0x29, 0x42, 0xb4, 0xc5, 0xeb, 0xa3, 0xd4, 0x84, 0xc6, 0x47, 0xb5, 0xce,
+	0x80, 0x12, 0x07, 0xb1, 0x8f, 0xed, 0x7c, 0x9c, 0x7c, 0x35, 0x21, 0xc5,
+	0xe8, 0xeb, 0xab, 0x19, 0xb8, 0xdc, 0x78, 0x87, 0x65, 0x51, 0x13, 0xa1,
+	0xc9, 0xe5, 0xbc, 0x6d, 0xfb, 0x90, 0xbb, 0x74, 0xa7, 0x98, 0x07, 0xbb,
+	0x90, 0x68, 0x60, 0x93, 0xb7, 0x27, 0x43, 0x21, 0xaf, 0xd4, 0xf5, 0x09,
+	0xcc, 0x10, 0x65, 0x63, 0x24, 0x18, 0xbd, 0xd6, 0xb2, 0x77, 0x9b, 0x23,
+	0xa9, 0x36, 0x7c, 0x3a, 0xaf, 0x73, 0x1b, 0xec, 0x4b, 0x27, 0x66, 0xbf,
+	0x06, 0x23, 0x29, 0x92, 0x19, 0x8e, 0xb7, 0xf3, 0xc2, 0xe3, 0x8b, 0xbc,
+	0x08, 0x77, 0x0b, 0xe3, 0xc0, 0xb9, 0xcf, 0x67
+};
+
+const struct rsa_public_key *rsa_key = (struct rsa_public_key *)rsa_data;
+BUILD_ASSERT(sizeof(*rsa_key) == sizeof(rsa_data));
+
+/* SHA-256 sum to verify:
+ * # sha256sum README | sed -e 's/\(..\)/0x\1, /mg'
+ */
+const uint8_t hash[] = {
+	0xb7, 0x3a, 0xa2, 0xf5, 0x38, 0xed, 0xc1, 0x4e, 0xe2, 0x97, 0xf9, 0x1e,
+	0x0e, 0x5f, 0xc0, 0xaa, 0xaa, 0x2d, 0x0f, 0x39, 0x8f, 0x2c, 0x5b, 0x6f,
+	0x01, 0x4e, 0x2c, 0xf6, 0x68, 0x09, 0x3c, 0xd8
+};
+
+/* Incorrect hash to test the negative case */
+const uint8_t hash_wrong[] = {
+	0x77, 0x5b, 0xe1, 0x11, 0xd0, 0xde, 0xf0, 0x19, 0x2d, 0x16, 0x92, 0xb1,
+	0x67, 0x31, 0xc7, 0xbf, 0xe7, 0x6c, 0x91, 0xd3, 0xd6, 0x7f, 0xc3, 0xf6,
+	0x6b, 0x49, 0x46, 0x56, 0x3b, 0x0f, 0xc5, 0x2b
+};
+
+/* Generate signature using openssl:
+ * # openssl dgst -sha256 -sign key.pem README | xxd -i
+ */
+const uint8_t sig[] = {
+	0x6f, 0x6f, 0xeb, 0xcd, 0x1d, 0xd2, 0x43, 0x17, 0xa0, 0x80, 0x2e, 0x36,
+	0xec, 0x95, 0x59, 0x59, 0xa5, 0xdd, 0xee, 0x2e, 0x06, 0xf3, 0xfd, 0x28,
+	0x0b, 0xa5, 0x66, 0xe7, 0xbb, 0x39, 0x77, 0x2f, 0xf1, 0x09, 0x0f, 0x89,
+	0xca, 0x0c, 0xea, 0xea, 0xfd, 0x29, 0xc7, 0xa2, 0xe3, 0xc7, 0x6c, 0x13,
+	0xda, 0x4d, 0x19, 0xfc, 0x58, 0x8d, 0xce, 0xd3, 0x6e, 0x69, 0x69, 0x5f,
+	0xc9, 0x09, 0x7f, 0x18, 0xcf, 0x5b, 0x84, 0x74, 0x19, 0x13, 0xe4, 0x0d,
+	0x9a, 0x70, 0x9c, 0x70, 0x3f, 0xa1, 0xf6, 0xb5, 0x03, 0xfc, 0xef, 0xaa,
+	0xe3, 0x12, 0x93, 0xfe, 0x36, 0x42, 0xf9, 0x6f, 0x47, 0x57, 0xf7, 0x5f,
+	0x43, 0xb2, 0x46, 0x28, 0x4b, 0x11, 0x26, 0x4c, 0xa1, 0x92, 0x36, 0x21,
+	0x14, 0x21, 0xa2, 0xd1, 0x12, 0xe4, 0x0b, 0xbe, 0xcf, 0xf5, 0x87, 0xd5,
+	0xc9, 0xdd, 0x96, 0xf2, 0x7e, 0xce, 0x41, 0x9c, 0xf6, 0xb8, 0xf2, 0xb1,
+	0x33, 0x26, 0x1e, 0x41, 0xd0, 0x85, 0x68, 0x3b, 0xf8, 0x49, 0x91, 0x41,
+	0x78, 0x88, 0xc7, 0xb7, 0x7c, 0x27, 0xe2, 0x98, 0x56, 0xf8, 0x5f, 0x88,
+	0xa3, 0x2c, 0x5b, 0xc6, 0xd8, 0x20, 0xf0, 0x13, 0x22, 0xcb, 0xed, 0x41,
+	0x9b, 0x93, 0x6d, 0x06, 0x6b, 0x4f, 0x1f, 0xe3, 0x72, 0x1d, 0x4e, 0xee,
+	0x5a, 0x99, 0xff, 0xb7, 0xb9, 0xb6, 0xe8, 0xe1, 0x2c, 0xfe, 0xe9, 0x01,
+	0x15, 0x00, 0x12, 0x1d, 0xbe, 0x4f, 0x41, 0x60, 0xab, 0x56, 0x78, 0xa0,
+	0xc2, 0xf4, 0x9b, 0x0d, 0x16, 0x15, 0x12, 0x9d, 0x73, 0x7c, 0x1c, 0xe0,
+	0xe5, 0x98, 0xc0, 0xad, 0x4d, 0x7e, 0x93, 0xda, 0xe9, 0xf1, 0x34, 0x14,
+	0xfd, 0xce, 0x97, 0xab, 0x9f, 0xa9, 0x43, 0x16, 0xf7, 0x6e, 0xdf, 0xeb,
+	0x80, 0xc2, 0xe2, 0xdb, 0xdd, 0xcd, 0x6e, 0x2c, 0x79, 0xa3, 0x90, 0xee,
+	0x47, 0x79, 0x5c, 0x51, 0x69, 0x31, 0x67, 0x0a, 0x17, 0x74, 0x73, 0xf4,
+	0x13, 0x4f, 0x63, 0x2c, 0xd6, 0x36, 0xef, 0xdf, 0xa4, 0x7d, 0xaa, 0xe7,
+	0xfd, 0xc7, 0xd6, 0xb7, 0xe1, 0x28, 0x5e, 0xbf, 0xed, 0x9f, 0xa3, 0x7a,
+	0x6a, 0x0a, 0xe1, 0xc8, 0x1b, 0xb4, 0xf0, 0xc0, 0xc6, 0x08, 0xc8, 0xc4,
+	0x78, 0x94, 0x6b, 0x3b, 0x04, 0x51, 0x38, 0x28, 0x3e, 0xbf, 0x9d, 0xc2,
+	0xfe, 0xc8, 0xc5, 0xc8, 0xf3, 0xbe, 0x69, 0x0a, 0x2f, 0x06, 0x99, 0x04,
+	0x03, 0xbd, 0xaa, 0xf4, 0x05, 0x40, 0x5e, 0x52, 0xba, 0x6d, 0xf3, 0x06,
+	0x6b, 0xb7, 0xe0, 0x0f, 0xdc, 0x0f, 0x06, 0xaa, 0xae, 0x24, 0xe6, 0x4f,
+	0xd7, 0xf5, 0x09, 0x95, 0xfb, 0x90, 0x76, 0x38, 0xf3, 0x05, 0x00, 0x85,
+	0xc7, 0xd4, 0xf9, 0x7b, 0xe6, 0xf8, 0x62, 0xee, 0x0a, 0xb1, 0x73, 0x09,
+	0x56, 0x55, 0x65, 0xc9, 0xfc, 0xb9, 0x41, 0x19, 0x2e, 0xf0, 0x5d, 0x08,
+	/* Padding */
+	0x00
+};
@@ -0,0 +1,140 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * RSA 3072 with F4 exponent public key and verification.
+ * Private key in rsa3072-F4.pem.
+ */
+
+/* First generate a key:
+ * # openssl genrsa -out key.pem 3072
+ * # openssl rsa -in key.pem -pubout > key.pub
+ * Then dump the key:
+ * # dumpRSAPublicKey -pub key.pub | xxd -i
+ */
+const uint8_t rsa_data[] = {
+	0x60, 0x00, 0x00, 0x00, 0x11, 0xa5, 0x47, 0xfb, 0x0f, 0x14, 0x68, 0xaf,
+	0x17, 0xf0, 0xa0, 0x16, 0x7d, 0xb5, 0xc5, 0x1b, 0xdd, 0x32, 0x56, 0x08,
+	0x4d, 0xbf, 0xe1, 0x3f, 0x8c, 0x4f, 0x23, 0xbe, 0x41, 0x0b, 0x66, 0x11,
+	0x75, 0x68, 0x4c, 0x21, 0xfd, 0x0b, 0x98, 0xaf, 0x54, 0xac, 0xef, 0xd9,
+	0x06, 0xe3, 0x5f, 0x71, 0x56, 0x3e, 0x4a, 0x2e, 0x7b, 0x03, 0xfc, 0x72,
+	0x5f, 0xe8, 0xc5, 0xe8, 0x3b, 0x52, 0xc8, 0x88, 0x17, 0x27, 0xb8, 0x6e,
+	0x17, 0xa8, 0x89, 0x71, 0x7b, 0x79, 0x3d, 0x37, 0x4c, 0x14, 0x68, 0xb8,
+	0x65, 0x82, 0x0a, 0x19, 0x19, 0xa9, 0x3f, 0x0b, 0x86, 0x21, 0x6f, 0x02,
+	0x38, 0xe1, 0xc5, 0x01, 0x73, 0x33, 0x56, 0xfd, 0x63, 0x79, 0xcd, 0xd2,
+	0xd4, 0x84, 0x2b, 0x63, 0xe3, 0xb5, 0xf1, 0xe2, 0xe9, 0x46, 0x22, 0x5a,
+	0xfe, 0x97, 0xb2, 0x04, 0x9c, 0xe6, 0x28, 0xd3, 0x7c, 0x6a, 0x8b, 0x2f,
+	0xfb, 0xd6, 0x43, 0xf5, 0x32, 0x28, 0x4b, 0x57, 0x16, 0x05, 0xf4, 0xab,
+	0x16, 0x8c, 0xdd, 0xbf, 0xa0, 0x97, 0x67, 0xbd, 0x21, 0xe6, 0xf0, 0x92,
+	0x3e, 0x21, 0x5a, 0xeb, 0x9a, 0x06, 0xce, 0x04, 0x05, 0x11, 0x22, 0x29,
+	0xdf, 0xb3, 0xd5, 0x0d, 0x96, 0x78, 0xd8, 0xb7, 0x39, 0xff, 0x71, 0x45,
+	0x43, 0xd3, 0x79, 0xf5, 0x0a, 0x0b, 0xcf, 0xce, 0x6b, 0x50, 0x2b, 0x97,
+	0x51, 0x1f, 0x48, 0xa0, 0x65, 0xde, 0xce, 0x51, 0x28, 0x88, 0xd4, 0xaa,
+	0xdb, 0xe7, 0x65, 0x7d, 0xa2, 0x5f, 0xed, 0x3d, 0xef, 0xdc, 0xcf, 0x02,
+	0x20, 0x01, 0x10, 0x4f, 0xc1, 0xbd, 0x52, 0xa5, 0xf7, 0xd0, 0x27, 0x4a,
+	0x88, 0xe7, 0xf7, 0xf4, 0x85, 0xc2, 0x1c, 0x11, 0x0e, 0xb2, 0x29, 0x05,
+	0xb0, 0x16, 0xcd, 0x0b, 0x3a, 0x8b, 0x33, 0x09, 0x7d, 0x70, 0xe3, 0x19,
+	0x01, 0xfd, 0x06, 0x76, 0x80, 0xfd, 0x4c, 0x7b, 0xed, 0x26, 0x14, 0x53,
+	0xc7, 0x9a, 0x45, 0xc2, 0x51, 0xe1, 0xf1, 0x8a, 0x9b, 0xcc, 0x6e, 0x17,
+	0x70, 0x6d, 0x28, 0xcf, 0x5b, 0xfb, 0xf4, 0x88, 0x98, 0xf0, 0xd4, 0xbd,
+	0x02, 0xa3, 0x78, 0x9e, 0x06, 0x10, 0xba, 0xed, 0xfd, 0x9c, 0xe4, 0x78,
+	0xf0, 0x33, 0xff, 0x11, 0x60, 0x41, 0xdf, 0x96, 0xa3, 0x70, 0x3a, 0xf2,
+	0xa5, 0x9e, 0x0d, 0xe1, 0x06, 0xf3, 0x6d, 0x91, 0x32, 0x1f, 0x69, 0x32,
+	0xb2, 0x31, 0xfd, 0x9d, 0xd0, 0xff, 0xb6, 0xc0, 0x21, 0x58, 0xb1, 0x54,
+	0x2b, 0x29, 0xca, 0x28, 0xeb, 0x97, 0x6a, 0xfd, 0xbe, 0x4f, 0x73, 0x62,
+	0x12, 0x77, 0x74, 0xb0, 0xa5, 0xf1, 0x76, 0x74, 0x08, 0xe6, 0xa5, 0x7a,
+	0x10, 0xe4, 0xc4, 0x39, 0xa0, 0x62, 0xb8, 0xa8, 0x46, 0x53, 0xdb, 0xe4,
+	0x33, 0x87, 0x34, 0xdf, 0xdd, 0xff, 0x49, 0x4e, 0xc7, 0xd1, 0x65, 0x84,
+	0xc1, 0x4a, 0x8b, 0x5f, 0xc6, 0x78, 0x97, 0xcb, 0x2e, 0x35, 0x6b, 0xd5,
+	0x66, 0xea, 0x3b, 0x1a, 0x40, 0x6e, 0xc4, 0x1c, 0x70, 0xc2, 0xd4, 0xa8,
+	0xae, 0x3a, 0xae, 0x52, 0x6e, 0x6c, 0xee, 0x9f, 0xd4, 0x07, 0xd4, 0x61,
+	0x6e, 0x7d, 0x00, 0x3c, 0x26, 0x44, 0xcb, 0xe6, 0x84, 0x03, 0x11, 0x68,
+	0xdd, 0xfd, 0x81, 0x60, 0x7c, 0x39, 0xfc, 0x00, 0x40, 0x70, 0xdb, 0x88,
+	0xd2, 0xbc, 0xce, 0xff, 0x8e, 0x9e, 0x9a, 0xfd, 0x0b, 0x0e, 0x65, 0x41,
+	0xb0, 0x4f, 0x69, 0x74, 0xd3, 0x50, 0x8b, 0xa5, 0xd8, 0x52, 0xd5, 0x80,
+	0xc4, 0xdf, 0x1a, 0xd2, 0x09, 0x02, 0x14, 0x53, 0x2e, 0x6a, 0x98, 0xae,
+	0x00, 0xc0, 0x3b, 0x56, 0x92, 0xed, 0x75, 0x5d, 0x73, 0x4e, 0xbf, 0xcf,
+	0x27, 0xe8, 0xa2, 0xae, 0xd6, 0x2a, 0x50, 0x25, 0xa2, 0xbc, 0x34, 0x68,
+	0xb2, 0x0a, 0xdf, 0x1a, 0xbc, 0x42, 0x61, 0x47, 0xdd, 0xfd, 0x7f, 0x5f,
+	0xbc, 0x7e, 0xb3, 0x73, 0xe4, 0xfd, 0x56, 0x8f, 0xa3, 0xe8, 0xaa, 0x24,
+	0x09, 0x50, 0xd8, 0x87, 0x77, 0x25, 0xcd, 0xdc, 0xcd, 0xa6, 0xd1, 0x44,
+	0xa2, 0x99, 0xd7, 0x24, 0xce, 0x72, 0xd3, 0x2f, 0xee, 0xf4, 0x5a, 0x6e,
+	0xa7, 0xba, 0x5c, 0x95, 0xbd, 0x16, 0xa4, 0x8d, 0x78, 0x85, 0xf7, 0x1b,
+	0x84, 0x37, 0x44, 0xc8, 0x6d, 0x4a, 0xa7, 0xdd, 0xdc, 0xf4, 0x94, 0x00,
+	0xf6, 0x52, 0x11, 0xf4, 0x6d, 0xcb, 0x57, 0x97, 0xee, 0x2f, 0xdc, 0x2c,
+	0xd8, 0xab, 0x63, 0xe0, 0xf8, 0xe2, 0x2f, 0xd8, 0xc6, 0xd1, 0xd7, 0x03,
+	0x9a, 0x5d, 0xf6, 0x55, 0x90, 0x6b, 0xe7, 0xb8, 0x12, 0xc8, 0xd4, 0x07,
+	0x2b, 0xfb, 0x34, 0x48, 0xd5, 0x44, 0x58, 0xdd, 0x47, 0x94, 0x3e, 0x6e,
+	0x25, 0x08, 0x18, 0x5c, 0xc9, 0xe6, 0x96, 0x03, 0x1e, 0x6b, 0xf2, 0x32,
+	0x5c, 0x7c, 0x2d, 0x4f, 0x4c, 0x5d, 0xfe, 0x5c, 0x47, 0x6d, 0xc5, 0x7b,
+	0x0f, 0xab, 0xcf, 0xbe, 0xd8, 0x3a, 0x6c, 0x42, 0x56, 0x75, 0x3f, 0x70,
+	0x77, 0xff, 0x3a, 0xe5, 0x23, 0xeb, 0xae, 0xa1, 0x23, 0xc5, 0xeb, 0xe0,
+	0x73, 0xb6, 0xc5, 0xa9, 0x91, 0x4f, 0x91, 0x6b, 0xe2, 0xb3, 0xf4, 0x73,
+	0xdf, 0xb5, 0xb2, 0x46, 0x8b, 0xf8, 0xd0, 0x82, 0x58, 0x93, 0x4a, 0xeb,
+	0x59, 0x2c, 0xb9, 0xb6, 0x27, 0x56, 0xdc, 0xc9, 0x82, 0xf9, 0xda, 0x76,
+	0x16, 0x69, 0x99, 0x91, 0xab, 0x16, 0x41, 0x39, 0xe6, 0x36, 0x5f, 0xf6,
+	0x07, 0x89, 0x96, 0xdb, 0x04, 0x2a, 0xda, 0x14, 0xac, 0x03, 0x36, 0x65,
+	0xc9, 0x37, 0x71, 0xf6, 0x89, 0x13, 0x07, 0x3b, 0xff, 0x92, 0x7b, 0x17,
+	0x93, 0x55, 0xb6, 0xc8, 0x48, 0x7a, 0x6c, 0xfe, 0xd8, 0xb6, 0xbd, 0xd0,
+	0x71, 0xb3, 0xe4, 0x46, 0x96, 0x69, 0xbd, 0x8b, 0x28, 0xe3, 0x25, 0x06,
+	0x05, 0x0d, 0x94, 0x87, 0x55, 0xb4, 0x06, 0x9a
+};
+
+const struct rsa_public_key *rsa_key = (struct rsa_public_key *)rsa_data;
+BUILD_ASSERT(sizeof(*rsa_key) == sizeof(rsa_data));
+
+/* SHA-256 sum to verify:
+ * # sha256sum README | sed -e 's/\(..\)/0x\1, /mg'
+ */
+const uint8_t hash[] = {
+	0xb7, 0x3a, 0xa2, 0xf5, 0x38, 0xed, 0xc1, 0x4e, 0xe2, 0x97, 0xf9, 0x1e,
+	0x0e, 0x5f, 0xc0, 0xaa, 0xaa, 0x2d, 0x0f, 0x39, 0x8f, 0x2c, 0x5b, 0x6f,
+	0x01, 0x4e, 0x2c, 0xf6, 0x68, 0x09, 0x3c, 0xd8
+};
+
+/* Incorrect hash to test the negative case */
+const uint8_t hash_wrong[] = {
+	0x77, 0x5b, 0xe1, 0x11, 0xd0, 0xde, 0xf0, 0x19, 0x2d, 0x16, 0x92, 0xb1,
+	0x67, 0x31, 0xc7, 0xbf, 0xe7, 0x6c, 0x91, 0xd3, 0xd6, 0x7f, 0xc3, 0xf6,
+	0x6b, 0x49, 0x46, 0x56, 0x3b, 0x0f, 0xc5, 0x2b
+};
+
+/* Generate signature using openssl:
+ * # openssl dgst -sha256 -sign key.pem README | xxd -i
+ */
+const uint8_t sig[] = {
+	0x27, 0x31, 0xc4, 0x78, 0x9b, 0x56, 0x3a, 0xb8, 0x62, 0x6a, 0x97, 0x1a,
+	0x6f, 0x40, 0x16, 0xb4, 0x8b, 0xdb, 0x9f, 0xb7, 0x4e, 0xe7, 0x15, 0xde,
+	0xb2, 0x54, 0x52, 0x40, 0x47, 0x60, 0x4f, 0xe1, 0x80, 0xa6, 0x7b, 0xd0,
+	0x51, 0xca, 0x38, 0xb0, 0x78, 0xf8, 0xf8, 0x18, 0x23, 0xbf, 0xc9, 0xee,
+	0xcb, 0x0a, 0x51, 0x33, 0x7c, 0xb3, 0x8a, 0xc7, 0xa6, 0x2d, 0x5c, 0x06,
+	0x3e, 0x99, 0xc5, 0x3d, 0xfa, 0x50, 0xb4, 0xdb, 0x9e, 0xf8, 0x69, 0x3c,
+	0xa6, 0x38, 0x7b, 0x67, 0x1d, 0xf2, 0x4e, 0x37, 0xda, 0x41, 0xa6, 0xf5,
+	0x75, 0xd7, 0x56, 0x6e, 0x41, 0x02, 0x9c, 0x0b, 0xd9, 0x47, 0x23, 0x6a,
+	0xcd, 0x1a, 0x98, 0x2b, 0x21, 0x30, 0x33, 0x21, 0x9d, 0x26, 0xf8, 0x7f,
+	0xde, 0x7c, 0xf6, 0x2a, 0x09, 0xa0, 0xfc, 0x6f, 0x75, 0xd4, 0x59, 0x57,
+	0x3d, 0x4e, 0x89, 0x76, 0x39, 0x37, 0x69, 0xa6, 0x27, 0x57, 0x81, 0x08,
+	0x44, 0x4b, 0x15, 0xf8, 0x62, 0xe8, 0xeb, 0x0c, 0xac, 0xf3, 0xe0, 0xbd,
+	0x86, 0xb3, 0x4a, 0xab, 0x50, 0x75, 0x0b, 0x56, 0xf0, 0x3a, 0xc8, 0x14,
+	0xee, 0xb0, 0x2a, 0xd8, 0xeb, 0x2c, 0xc3, 0x16, 0xdf, 0xa4, 0x55, 0xf3,
+	0xec, 0xdc, 0xdd, 0x96, 0x56, 0x02, 0x53, 0xd7, 0x0d, 0xd9, 0x2e, 0xc1,
+	0x02, 0xa1, 0x29, 0x7e, 0xe9, 0xe9, 0x70, 0x07, 0x95, 0xff, 0x72, 0x94,
+	0xa9, 0x42, 0xe8, 0xd4, 0xd8, 0x97, 0xca, 0xb7, 0x20, 0xf3, 0xfd, 0x9a,
+	0x34, 0xdb, 0xf2, 0x0f, 0x42, 0x73, 0xad, 0xa7, 0x91, 0x97, 0xcf, 0xbb,
+	0x8b, 0x63, 0xb3, 0x74, 0x3a, 0xe2, 0xd6, 0x00, 0x78, 0x6f, 0xf2, 0x7f,
+	0x4e, 0xc9, 0x7e, 0xd4, 0x29, 0x15, 0x42, 0x87, 0xca, 0xc0, 0xda, 0xd2,
+	0x5c, 0xaa, 0x6b, 0x33, 0x5c, 0x66, 0x20, 0x0c, 0x03, 0x2d, 0xe9, 0x7b,
+	0x6f, 0x76, 0x73, 0xdc, 0xc4, 0x2e, 0x8c, 0x3e, 0xf4, 0x60, 0xd3, 0xfb,
+	0xac, 0x8a, 0x3e, 0xa0, 0x48, 0x54, 0xfe, 0x52, 0xf9, 0x3d, 0x61, 0x78,
+	0x9d, 0x5d, 0xd4, 0x72, 0x18, 0xb9, 0x5b, 0x93, 0x59, 0x00, 0x04, 0x5c,
+	0x47, 0x7d, 0x28, 0x02, 0xb7, 0xf1, 0xba, 0x12, 0x66, 0x0f, 0x60, 0xde,
+	0xb7, 0x64, 0x41, 0x00, 0x68, 0x9b, 0xbc, 0x1e, 0xbe, 0xf0, 0x9d, 0x60,
+	0x17, 0x58, 0x10, 0x89, 0xe9, 0x3f, 0xae, 0x5c, 0xb2, 0x94, 0xb0, 0x90,
+	0x68, 0x94, 0xe3, 0x95, 0x16, 0x62, 0xa3, 0x40, 0x87, 0xda, 0xc3, 0x0b,
+	0xa6, 0x1f, 0x19, 0x88, 0x94, 0x75, 0xc3, 0x2a, 0x05, 0x7d, 0x28, 0xb2,
+	0xa4, 0x50, 0x0f, 0xcd, 0x82, 0x81, 0xb1, 0x3a, 0x59, 0xb9, 0x66, 0x7d,
+	0x79, 0x91, 0x42, 0x1f, 0x9a, 0xca, 0x02, 0x94, 0x7f, 0x39, 0x34, 0xb5,
+	0x60, 0x69, 0x34, 0x8e, 0xae, 0xb8, 0x65, 0x94, 0xae, 0x92, 0xd2, 0xf2,
+	/* Padding */
+	0x00
+};
@@ -9,6 +9,7 @@
 #include "common.h"
 #include "sha256.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
 /* Short Msg from NIST FIPS 180-4 (Len = 8) */
@@ -125,6 +126,20 @@ static const uint8_t hmac_medium_output[] = {
 	0xaa, 0x57, 0x17, 0x89, 0x6c, 0xb7, 0x0d, 0xdf
 };
 
+static uint8_t unaligned_buf[sizeof(sha256_2888_input) + 1] __aligned(4);
+
+#ifdef CONFIG_SHA256_HW_ACCELERATE
+static int hw_blocks;
+
+/* Mock accelerator: count the blocks offered and leave them to software. */
+int sha256_hw_transform(uint32_t *h, const uint8_t *data,
+			unsigned int block_nb)
+{
+	hw_blocks += block_nb;
+	return EC_ERROR_BUSY;
+}
+#endif
+
 static int test_sha256(const uint8_t *input, int input_len,
 		       const uint8_t *output)
 {
@@ -153,6 +168,28 @@ static int test_sha256(const uint8_t *input, int input_len,
 		return 0;
 	}
 
+	/* Chunks that straddle block boundaries. */
+	SHA256_init(&ctx);
+	for (i = 0; i < input_len; i += 65)
+		SHA256_update(&ctx, &input[i], MIN(65, input_len - i));
+	tmp = SHA256_final(&ctx);
+
+	if (memcmp(tmp, output, SHA256_DIGEST_SIZE) != 0) {
+		ccprintf("SHA256 test failed (65-byte chunks)\n");
+		return 0;
+	}
+
+	/* Unaligned input takes the byte-wise load path. */
+	memcpy(unaligned_buf + 1, input, input_len);
+	SHA256_init(&ctx);
+	SHA256_update(&ctx, unaligned_buf + 1, input_len);
+	tmp = SHA256_final(&ctx);
+
+	if (memcmp(tmp, output, SHA256_DIGEST_SIZE) != 0) {
+		ccprintf("SHA256 test failed (unaligned)\n");
+		return 0;
+	}
+
 	return 1;
 }
 
@@ -172,6 +209,29 @@ static int test_hmac(const uint8_t *key, int key_len,
 	return 1;
 }
 
+#define BENCHMARK_SIZE 4096
+#define BENCHMARK_ITERATIONS 16
+
+static void benchmark_sha256(void)
+{
+	static uint8_t buf[BENCHMARK_SIZE] __aligned(4);
+	struct sha256_ctx ctx;
+	timestamp_t t0, t1;
+	int i;
+
+	t0 = get_time();
+	SHA256_init(&ctx);
+	for (i = 0; i < BENCHMARK_ITERATIONS; i++)
+		SHA256_update(&ctx, buf, sizeof(buf));
+	SHA256_final(&ctx);
+	t1 = get_time();
+
+	/* do not check speed, just as a benchmark */
+	ccprintf("SHA256 %d bytes duration %lld us\n",
+		 BENCHMARK_SIZE * BENCHMARK_ITERATIONS,
+		 (long long)(t1.val - t0.val));
+}
+
 void run_test(int argc, char **argv)
 {
 	ccprintf("Testing short message (8 bytes)\n");
@@ -216,5 +276,17 @@ void run_test(int argc, char **argv)
 	 * 64 bytes keys.
 	 */
 
+#ifdef CONFIG_SHA256_HW_ACCELERATE
+	ccprintf("Testing hash engine offload\n");
+	hw_blocks = 0;
+	if (!test_sha256(sha256_2888_input, sizeof(sha256_2888_input),
+			 sha256_2888_output) || hw_blocks == 0) {
+		test_fail();
+		return;
+	}
+#endif
+
+	benchmark_sha256();
+
 	test_pass();
 }
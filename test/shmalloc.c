@@ -15,6 +15,8 @@
 #include "link_defs.h"
 #include "shared_mem.h"
 #include "test_util.h"
+#include "timer.h"
+#include "util.h"
 
 /*
  * Total size of memory in the malloc pool (shared between free and allocated
@@ -63,6 +65,12 @@ static int check_for_overlaps(void)
 		if (!allocations[i].buf)
 			continue;
 
+#ifdef CONFIG_MALLOC_SLAB
+		/* Slab objects never appear on the allocated chain. */
+		if (shared_mem_is_slab(allocations[i].buf))
+			continue;
+#endif
+
 		/*
 		 * Indication of finding the allocated buffer in internal
 		 * malloc structures.
@@ -200,6 +208,135 @@ static int shmem_is_ok(int line)
 	return 0;
 }
 
+/*
+ * Fragmentation benchmark. Runs a long sequence of mostly small allocations
+ * with random sizes and lifetimes, the way console, flash and hashing users
+ * hit shared memory over a long uptime, then verifies that everything
+ * coalesces back into a single free buffer. Runs on an idle pool, before the
+ * path coverage test.
+ */
+#define BENCH_ROUNDS 200000
+#define BENCH_SLOTS 16
+
+static int fragmentation_benchmark(void)
+{
+	char *live[BENCH_SLOTS] = { NULL };
+	int failures = 0;
+	int worst_frag = 0;
+	int pool_size = free_buf_chain->buffer_size;
+	timestamp_t start;
+	int elapsed;
+	int i;
+
+	start = get_time();
+
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		uint32_t r_data = myrand();
+		int slot = r_data % BENCH_SLOTS;
+		struct shm_buffer *pbuf;
+		int free_size = 0;
+		int max_free = 0;
+		int size;
+
+		if (live[slot]) {
+			shared_mem_release(live[slot]);
+			live[slot] = NULL;
+			continue;
+		}
+
+		/* 3 in 4 requests are small, the rest up to 1 KB. */
+		if (r_data & (3 << 8))
+			size = 8 + (myrand() % 249);
+		else
+			size = 257 + (myrand() % 768);
+
+		if (shared_mem_acquire(size, &live[slot]) != EC_SUCCESS)
+			failures++;
+
+		/* Sample fragmentation of the free chain now and then. */
+		if (i % 64)
+			continue;
+
+		for (pbuf = free_buf_chain; pbuf; pbuf = pbuf->next_buffer) {
+			free_size += pbuf->buffer_size;
+			max_free = MAX(max_free, (int)pbuf->buffer_size);
+		}
+		if (free_size)
+			worst_frag = MAX(worst_frag,
+					 100 - max_free * 100 / free_size);
+	}
+
+	for (i = 0; i < BENCH_SLOTS; i++)
+		if (live[i])
+			shared_mem_release(live[i]);
+
+	elapsed = get_time().val - start.val;
+	ccprintf("Fragmentation benchmark: %d rounds in %d us, %d failed, "
+		 "worst fragmentation %d%%\n",
+		 BENCH_ROUNDS, elapsed, failures, worst_frag);
+
+	if (allocced_buf_chain || !free_buf_chain ||
+	    free_buf_chain->next_buffer ||
+	    free_buf_chain->buffer_size != pool_size) {
+		ccprintf("Pool did not coalesce after the benchmark\n");
+		return 0;
+	}
+
+	return 1;
+}
+
+#ifdef CONFIG_MALLOC_SLAB
+/*
+ * Small requests are absorbed by the slabs, so the chain never splits into
+ * more than five free buffers; the path requiring that can't be reached.
+ */
+#define REQUIRED_PATHS_MASK (ALL_PATHS_MASK & ~BIT(24))
+
+/*
+ * Fill every size class, make sure the class falls back to the chain once it
+ * is exhausted, and that released objects are recycled.
+ */
+static int slab_classes_ok(void)
+{
+	char *objs[CONFIG_MALLOC_SLAB_OBJS];
+	char *extra;
+	int size, i;
+
+	for (size = 32; size <= 256; size <<= 1) {
+		for (i = 0; i < CONFIG_MALLOC_SLAB_OBJS; i++) {
+			if (shared_mem_acquire(size, &objs[i]) != EC_SUCCESS ||
+			    !shared_mem_is_slab(objs[i])) {
+				ccprintf("size %d obj %d not from slab\n",
+					 size, i);
+				return 0;
+			}
+			memset(objs[i], 0xa5, size);
+		}
+
+		if (shared_mem_acquire(size, &extra) != EC_SUCCESS ||
+		    shared_mem_is_slab(extra)) {
+			ccprintf("size %d did not fall back\n", size);
+			return 0;
+		}
+		shared_mem_release(extra);
+
+		shared_mem_release(objs[0]);
+		if (shared_mem_acquire(size - 1, &extra) != EC_SUCCESS ||
+		    extra != objs[0]) {
+			ccprintf("size %d object not recycled\n", size);
+			return 0;
+		}
+
+		for (i = 0; i < CONFIG_MALLOC_SLAB_OBJS; i++)
+			shared_mem_release(objs[i]);
+	}
+
+	return 1;
+}
+#else
+#define REQUIRED_PATHS_MASK ALL_PATHS_MASK
+#endif
+
 /*
  * Bitmap used to keep track of branches taken by malloc/free routines. Once
  * all bits in the 0..(MAX_MASK_BIT - 1) range are set, consider the test
@@ -212,6 +349,18 @@ void run_test(int argc, char **argv)
 	int index;
 	const int shmem_size = shared_mem_size();
 
+#ifdef CONFIG_MALLOC_SLAB
+	if (!slab_classes_ok()) {
+		test_fail();
+		return;
+	}
+#endif
+
+	if (!fragmentation_benchmark()) {
+		test_fail();
+		return;
+	}
+
 	while (counter--) {
 		char *shptr;
 		uint32_t r_data;
@@ -225,7 +374,7 @@ void run_test(int argc, char **argv)
 		 * If all bits we care about are set in the map - the test is
 		 * over.
 		 */
-		if ((test_map & ALL_PATHS_MASK) == ALL_PATHS_MASK) {
+		if ((test_map & REQUIRED_PATHS_MASK) == REQUIRED_PATHS_MASK) {
 			if (test_map & ~ALL_PATHS_MASK) {
 				ccprintf("Unexpected mask bits set: %x"
 					 ", counter %d\n",
@@ -295,7 +444,7 @@ void run_test(int argc, char **argv)
 		}
 
 	ccprintf("Did not pass all paths, map %x != %x\n",
-		 test_map, ALL_PATHS_MASK);
+		 test_map, REQUIRED_PATHS_MASK);
 	test_fail();
 }
 
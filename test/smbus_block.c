@@ -0,0 +1,139 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test SMBus block reads with PEC.
+ */
+
+#include "common.h"
+#include "crc8.h"
+#include "i2c.h"
+#include "test_util.h"
+#include "util.h"
+
+#define PORT I2C_PORT_EEPROM
+#define DEV_ADDR_FLAGS 0x0b
+#define REG_NAME 0x21
+
+static const char name[] = "EXAMPLE-BATT";
+
+/* Length byte, name, PEC */
+static uint8_t stream[1 + sizeof(name) - 1 + 1];
+static int pos;
+static int xfer_count;
+static int corrupt_pec;
+
+static void build_stream(void)
+{
+	uint8_t hdr[3] = {DEV_ADDR_FLAGS << 1, REG_NAME,
+			  (DEV_ADDR_FLAGS << 1) | 1};
+	int n = sizeof(name) - 1;
+
+	stream[0] = n;
+	memcpy(stream + 1, name, n);
+	stream[1 + n] = crc8_arg(stream, 1 + n, crc8(hdr, sizeof(hdr)));
+	if (corrupt_pec)
+		stream[1 + n] ^= 1;
+}
+
+/*
+ * Smart battery emulation: writing the register starts the block, reads
+ * continue where the previous one stopped, past the end reads 0xff.
+ */
+static int dev_xfer(int port, uint16_t addr_flags,
+		    const uint8_t *out, int out_size,
+		    uint8_t *in, int in_size, int flags)
+{
+	int i;
+
+	if (port != PORT || addr_flags != DEV_ADDR_FLAGS)
+		return EC_ERROR_INVAL;
+
+	xfer_count++;
+	if (out_size) {
+		if (out[0] != REG_NAME)
+			return EC_ERROR_UNKNOWN;
+		build_stream();
+		pos = 0;
+	}
+	for (i = 0; i < in_size; i++, pos++)
+		in[i] = pos < sizeof(stream) ? stream[pos] : 0xff;
+
+	return EC_SUCCESS;
+}
+DECLARE_TEST_I2C_XFER(dev_xfer);
+
+static int test_crc8(void)
+{
+	const uint8_t check[] = "123456789";
+
+	/* CRC-8/SMBUS check value */
+	TEST_EQ(crc8(check, sizeof(check) - 1), 0xf4, "0x%x");
+	TEST_EQ(crc8_arg(check + 4, 5, crc8(check, 4)), 0xf4, "0x%x");
+	TEST_EQ(crc8(check, 0), 0, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_whole_block(void)
+{
+	char buf[33];
+
+	xfer_count = 0;
+	memset(buf, 0x55, sizeof(buf));
+	TEST_EQ(i2c_read_string(PORT, DEV_ADDR_FLAGS | I2C_FLAG_PEC, REG_NAME,
+				buf, sizeof(buf)), EC_SUCCESS, "%d");
+	TEST_ASSERT_ARRAY_EQ(buf, name, sizeof(name));
+	/* Length byte, then data and PEC together; or all at once */
+	TEST_EQ(xfer_count,
+		IS_ENABLED(CONFIG_SMBUS_BLOCK_READ_SINGLE_XFER) ? 1 : 2, "%d");
+
+	/* Exactly the size of the block */
+	TEST_EQ(i2c_read_string(PORT, DEV_ADDR_FLAGS | I2C_FLAG_PEC, REG_NAME,
+				buf, sizeof(name)), EC_SUCCESS, "%d");
+	TEST_ASSERT_ARRAY_EQ(buf, name, sizeof(name));
+
+	return EC_SUCCESS;
+}
+
+static int test_truncated(void)
+{
+	char buf[5];
+
+	TEST_EQ(i2c_read_string(PORT, DEV_ADDR_FLAGS | I2C_FLAG_PEC, REG_NAME,
+				buf, sizeof(buf)), EC_SUCCESS, "%d");
+	TEST_ASSERT_ARRAY_EQ(buf, "EXAM", sizeof(buf));
+
+	/* Without PEC the rest of the block is not read */
+	TEST_EQ(i2c_read_string(PORT, DEV_ADDR_FLAGS, REG_NAME,
+				buf, sizeof(buf)), EC_SUCCESS, "%d");
+	TEST_ASSERT_ARRAY_EQ(buf, "EXAM", sizeof(buf));
+
+	return EC_SUCCESS;
+}
+
+static int test_bad_pec(void)
+{
+	char buf[33];
+
+	corrupt_pec = 1;
+	TEST_EQ(i2c_read_string(PORT, DEV_ADDR_FLAGS | I2C_FLAG_PEC, REG_NAME,
+				buf, sizeof(buf)), EC_ERROR_CRC, "%d");
+	TEST_EQ(i2c_read_string(PORT, DEV_ADDR_FLAGS | I2C_FLAG_PEC, REG_NAME,
+				buf, 5), EC_ERROR_CRC, "%d");
+	corrupt_pec = 0;
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_crc8);
+	RUN_TEST(test_whole_block);
+	RUN_TEST(test_truncated);
+	RUN_TEST(test_bad_pec);
+
+	test_print_result();
+}
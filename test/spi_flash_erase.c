@@ -0,0 +1,548 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the SPI flash background erase against an emulated flash part.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "ec_commands_private.h"
+#include "flash.h"
+#include "hooks.h"
+#include "spi.h"
+#include "spi_flash.h"
+#include "spi_flash_reg.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define SECTOR 0x1000
+#define BLOCK_64K 0x10000
+
+/* Emulated W25Q part */
+static uint8_t mock_flash[CONFIG_FLASH_SIZE];
+static struct {
+	int wel;
+	int erasing;
+	int suspended;
+	unsigned int erase_offset;
+	unsigned int erase_size;
+	/* Status polls until the erase is done, -1 for never */
+	int busy_polls;
+	int erase_polls;
+	/* Time each read takes */
+	int read_delay_us;
+	/* Commands seen */
+	int erases;
+	int programs;
+	unsigned int program_addr;
+	int program_len;
+	int suspends;
+	int resumes;
+	/* Accesses the part would have rejected or corrupted */
+	int bad_cmds;
+} mock;
+
+static void mock_finish_erase(void)
+{
+	memset(mock_flash + mock.erase_offset, 0xff, mock.erase_size);
+	mock.erasing = 0;
+}
+
+static unsigned int mock_addr(const uint8_t *txdata)
+{
+	return (txdata[1] << 16) | (txdata[2] << 8) | txdata[3];
+}
+
+int spi_transaction(const struct spi_device_t *spi_device,
+		    const uint8_t *txdata, int txlen,
+		    uint8_t *rxdata, int rxlen)
+{
+	int busy = mock.erasing && !mock.suspended;
+	unsigned int addr;
+	int i;
+
+	switch (txdata[0]) {
+	case SPI_FLASH_READ_SR1:
+		if (busy && mock.busy_polls > 0 && --mock.busy_polls == 0) {
+			mock_finish_erase();
+			busy = 0;
+		}
+		rxdata[0] = busy ? SPI_FLASH_SR1_BUSY : 0;
+		return EC_SUCCESS;
+	case SPI_FLASH_READ_SR2:
+		rxdata[0] = 0;
+		return EC_SUCCESS;
+	case SPI_FLASH_ERASE_SUSPEND:
+		if (busy) {
+			mock.suspended = 1;
+			mock.suspends++;
+		}
+		return EC_SUCCESS;
+	case SPI_FLASH_ERASE_RESUME:
+		if (mock.suspended) {
+			mock.suspended = 0;
+			mock.resumes++;
+		}
+		return EC_SUCCESS;
+	}
+
+	/* Everything else is ignored by the part while it erases */
+	if (busy) {
+		mock.bad_cmds++;
+		return EC_SUCCESS;
+	}
+
+	switch (txdata[0]) {
+	case SPI_FLASH_WRITE_ENABLE:
+		mock.wel = 1;
+		break;
+	case SPI_FLASH_ERASE_4KB:
+	case SPI_FLASH_ERASE_32KB:
+	case SPI_FLASH_ERASE_64KB:
+		if (!mock.wel || mock.erasing) {
+			mock.bad_cmds++;
+			break;
+		}
+		mock.wel = 0;
+		mock.erasing = 1;
+		mock.erase_offset = mock_addr(txdata);
+		mock.erase_size = txdata[0] == SPI_FLASH_ERASE_64KB ? BLOCK_64K :
+				  txdata[0] == SPI_FLASH_ERASE_32KB ?
+				  BLOCK_64K / 2 : SECTOR;
+		mock.busy_polls = mock.erase_polls;
+		mock.erases++;
+		break;
+	case SPI_FLASH_READ:
+		addr = mock_addr(txdata);
+		memcpy(rxdata, mock_flash + addr, rxlen);
+		if (mock.read_delay_us)
+			udelay(mock.read_delay_us);
+		break;
+	case SPI_FLASH_PAGE_PRGRM:
+		if (!mock.wel || mock.erasing) {
+			mock.bad_cmds++;
+			break;
+		}
+		mock.wel = 0;
+		addr = mock_addr(txdata);
+		mock.programs++;
+		mock.program_addr = addr;
+		mock.program_len = txlen - 4;
+		for (i = 4; i < txlen; i++)
+			mock_flash[addr + i - 4] &= txdata[i];
+		break;
+	case SPI_FLASH_WRITE_SR:
+	case SPI_FLASH_JEDEC_ID:
+	case SPI_FLASH_MFR_DEV_ID:
+	case SPI_FLASH_UNIQUE_ID:
+		if (mock.erasing)
+			mock.bad_cmds++;
+		if (rxdata)
+			memset(rxdata, 0xef, rxlen);
+		break;
+	}
+
+	return EC_SUCCESS;
+}
+
+/* Chip glue, as in chip/mchp/flash.c */
+int flash_physical_erase_background(int offset, int size,
+				    void (*done)(int rv))
+{
+	return spi_flash_erase_background(offset, size, done);
+}
+
+void flash_physical_erase_progress(uint32_t *erased, uint32_t *size)
+{
+	spi_flash_erase_progress(erased, size);
+}
+
+static int done_count;
+static int done_rv;
+
+static void erase_done(int rv)
+{
+	done_count++;
+	done_rv = rv;
+}
+
+/* Wait for the background erase to report back through erase_done() */
+static int wait_done(int timeout_ms)
+{
+	while (!done_count && timeout_ms-- > 0)
+		msleep(1);
+	return done_count;
+}
+
+static int check_blank(unsigned int offset, unsigned int size)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		if (mock_flash[offset + i] != 0xff)
+			return 0;
+	return 1;
+}
+
+static int test_blank_sectors_skipped(void)
+{
+	/*
+	 * Four sectors, not aligned to a block. Only the first and third hold
+	 * data written after they were erased.
+	 */
+	const unsigned int base = BLOCK_64K + 4 * SECTOR;
+	const uint8_t data = 0;
+
+	TEST_EQ(spi_flash_erase(base, 4 * SECTOR), EC_SUCCESS, "%d");
+	TEST_EQ(spi_flash_write(base, 1, &data), EC_SUCCESS, "%d");
+	TEST_EQ(spi_flash_write(base + 2 * SECTOR + 17, 1, &data), EC_SUCCESS,
+		"%d");
+	mock.erases = 0;
+
+	TEST_EQ(spi_flash_erase_background(base, 4 * SECTOR, erase_done),
+		EC_SUCCESS, "%d");
+	TEST_ASSERT(wait_done(1000));
+	TEST_EQ(done_rv, EC_SUCCESS, "%d");
+	TEST_EQ(mock.erases, 2, "%d");
+	TEST_ASSERT(check_blank(base, 4 * SECTOR));
+	TEST_EQ(mock.bad_cmds, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_blank_block_skipped(void)
+{
+	const uint8_t data = 0;
+
+	TEST_EQ(spi_flash_erase(BLOCK_64K, BLOCK_64K), EC_SUCCESS, "%d");
+	TEST_EQ(mock.erases, 1, "%d");
+	TEST_EQ(spi_flash_write(BLOCK_64K + 5 * SECTOR + 3, 1, &data),
+		EC_SUCCESS, "%d");
+
+	/* Only the sector written since is erased again */
+	TEST_EQ(spi_flash_erase(BLOCK_64K, BLOCK_64K), EC_SUCCESS, "%d");
+	TEST_EQ(mock.erases, 2, "%d");
+	TEST_EQ(mock.erase_offset, BLOCK_64K + 5 * SECTOR, "%d");
+	TEST_EQ(mock.erase_size, SECTOR, "%d");
+	TEST_ASSERT(check_blank(BLOCK_64K, BLOCK_64K));
+
+	/* Data written behind the driver's back is still seen */
+	mock_flash[BLOCK_64K + 7 * SECTOR] = 0;
+	TEST_EQ(spi_flash_erase(BLOCK_64K, BLOCK_64K), EC_SUCCESS, "%d");
+	TEST_EQ(mock.erases, 3, "%d");
+	TEST_EQ(mock.erase_offset, BLOCK_64K + 7 * SECTOR, "%d");
+	TEST_EQ(mock.bad_cmds, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_blank_not_erased_this_boot(void)
+{
+	/* Sectors no test erased before; they may be half erased */
+	const unsigned int base = 8 * SECTOR;
+
+	memset(mock_flash + base, 0xff, 4 * SECTOR);
+
+	TEST_EQ(spi_flash_erase(base, 2 * SECTOR), EC_SUCCESS, "%d");
+	TEST_EQ(mock.erases, 2, "%d");
+	TEST_EQ(spi_flash_erase_background(base + 2 * SECTOR, 2 * SECTOR,
+					   erase_done), EC_SUCCESS, "%d");
+	TEST_ASSERT(wait_done(1000));
+	TEST_EQ(done_rv, EC_SUCCESS, "%d");
+	TEST_EQ(mock.erases, 4, "%d");
+
+	/* Once erased, they are skipped */
+	done_count = 0;
+	TEST_EQ(spi_flash_erase(base, 2 * SECTOR), EC_SUCCESS, "%d");
+	TEST_EQ(spi_flash_erase_background(base + 2 * SECTOR, 2 * SECTOR,
+					   erase_done), EC_SUCCESS, "%d");
+	TEST_ASSERT(wait_done(1000));
+	TEST_EQ(mock.erases, 4, "%d");
+	TEST_EQ(mock.bad_cmds, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_write_skips_pages(void)
+{
+	const unsigned int base = 4 * SECTOR;
+	uint8_t data[2 * SPI_FLASH_MAX_WRITE_SIZE];
+	int i;
+
+	TEST_EQ(spi_flash_erase(base, SECTOR), EC_SUCCESS, "%d");
+
+	/* Only the bytes which aren't 0xff are programmed */
+	memset(data, 0xff, sizeof(data));
+	for (i = 16; i < 32; i++)
+		data[i] = i;
+	TEST_EQ(spi_flash_write(base, SPI_FLASH_MAX_WRITE_SIZE, data),
+		EC_SUCCESS, "%d");
+	TEST_EQ(mock.programs, 1, "%d");
+	TEST_EQ(mock.program_addr, base + 16, "%d");
+	TEST_EQ(mock.program_len, 16, "%d");
+
+	/* A blank page and a page the flash already holds are left alone */
+	TEST_EQ(spi_flash_write(base + SPI_FLASH_MAX_WRITE_SIZE,
+				SPI_FLASH_MAX_WRITE_SIZE, data + 64),
+		EC_SUCCESS, "%d");
+	TEST_EQ(spi_flash_write(base, SPI_FLASH_MAX_WRITE_SIZE, data),
+		EC_SUCCESS, "%d");
+	TEST_EQ(mock.programs, 1, "%d");
+
+	/* Across two pages, only the one which differs is programmed */
+	data[SPI_FLASH_MAX_WRITE_SIZE + 1] = 0x5a;
+	TEST_EQ(spi_flash_write(base + SPI_FLASH_MAX_WRITE_SIZE - 64, 128,
+				data + SPI_FLASH_MAX_WRITE_SIZE - 64),
+		EC_SUCCESS, "%d");
+	TEST_EQ(mock.programs, 2, "%d");
+	TEST_EQ(mock.program_addr, base + SPI_FLASH_MAX_WRITE_SIZE + 1, "%d");
+	TEST_EQ(mock.program_len, 1, "%d");
+	TEST_ASSERT_ARRAY_EQ(mock_flash + base, data, sizeof(data));
+	TEST_EQ(mock.bad_cmds, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_read_suspends_erase(void)
+{
+	struct ec_response_flash_erase_progress progress;
+	uint8_t buf[16];
+	timestamp_t start;
+	int i;
+
+	for (i = 0; i < sizeof(buf); i++)
+		mock_flash[i] = i;
+
+	mock.erase_polls = -1;
+	TEST_EQ(spi_flash_erase_background(BLOCK_64K, BLOCK_64K, erase_done),
+		EC_SUCCESS, "%d");
+	while (!mock.erasing)
+		msleep(1);
+
+	/* The read goes in between, rather than waiting for the erase */
+	start = get_time();
+	TEST_EQ(spi_flash_read(buf, 0, sizeof(buf)), EC_SUCCESS, "%d");
+	TEST_LT((int)(get_time().val - start.val), 10 * MSEC, "%d");
+	for (i = 0; i < sizeof(buf); i++)
+		TEST_EQ(buf[i], i, "%d");
+	TEST_EQ(mock.suspends, 1, "%d");
+	TEST_EQ(mock.resumes, 1, "%d");
+	TEST_ASSERT(mock.erasing);
+	TEST_ASSERT(!done_count);
+
+	/* The host sees the erase still on its first unit */
+	TEST_EQ(test_send_host_command(EC_CMD_FLASH_ERASE_PROGRESS, 0, NULL, 0,
+				       &progress, sizeof(progress)),
+		EC_RES_SUCCESS, "%d");
+	TEST_EQ(progress.erased, 0, "%d");
+	TEST_EQ(progress.size, BLOCK_64K, "%d");
+
+	/* The erase then runs to the end */
+	mock.busy_polls = 1;
+	TEST_ASSERT(wait_done(1000));
+	TEST_EQ(done_rv, EC_SUCCESS, "%d");
+	TEST_ASSERT(check_blank(BLOCK_64K, BLOCK_64K));
+	TEST_EQ(mock.bad_cmds, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_busy_while_erasing(void)
+{
+	const uint8_t data[4] = {1, 2, 3, 4};
+	uint8_t id[8];
+
+	mock.erase_polls = -1;
+	TEST_EQ(spi_flash_erase_background(BLOCK_64K, BLOCK_64K, erase_done),
+		EC_SUCCESS, "%d");
+	while (!mock.erasing)
+		msleep(1);
+
+	TEST_EQ(spi_flash_write(0, sizeof(data), data), EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_erase(0, SECTOR), EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_erase_background(0, SECTOR, erase_done),
+		EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_set_status(0, 0), EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_set_protect(0, 0), EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_set_wp(SPI_WP_NONE), EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_get_jedec_id(id), EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_get_mfr_dev_id(id), EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_get_unique_id(id), EC_ERROR_BUSY, "%d");
+	TEST_EQ(mock.bad_cmds, 0, "%d");
+
+	/* Data still to be erased is undefined while suspended */
+	TEST_EQ(spi_flash_read(id, 2 * BLOCK_64K - 4, sizeof(id)),
+		EC_ERROR_BUSY, "%d");
+	TEST_EQ(spi_flash_read(id, BLOCK_64K + SECTOR, sizeof(id)),
+		EC_ERROR_BUSY, "%d");
+	TEST_EQ(mock.suspends, 0, "%d");
+
+	/* Callers which can't give up wait, then retry */
+	mock.busy_polls = 1;
+	TEST_EQ(spi_flash_wait_background_erase(SECOND), EC_SUCCESS, "%d");
+	TEST_EQ(done_count, 1, "%d");
+	TEST_EQ(spi_flash_write(BLOCK_64K, sizeof(data), data), EC_SUCCESS,
+		"%d");
+	TEST_ASSERT_ARRAY_EQ(mock_flash + BLOCK_64K, data, sizeof(data));
+	TEST_EQ(spi_flash_get_jedec_id(id), EC_SUCCESS, "%d");
+	TEST_EQ(mock.bad_cmds, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_timeout(void)
+{
+	mock.erase_polls = -1;
+	TEST_EQ(spi_flash_erase_background(0, SECTOR, erase_done),
+		EC_SUCCESS, "%d");
+
+	/* A sector erase that never ends is given up after 800 ms */
+	TEST_ASSERT(wait_done(2000));
+	TEST_EQ(done_rv, EC_ERROR_TIMEOUT, "%d");
+
+	/*
+	 * The flash is no longer held. The sector reads blank but the erase
+	 * never finished, so it is erased again.
+	 */
+	mock_finish_erase();
+	mock.erase_polls = 1;
+	TEST_EQ(spi_flash_erase(0, SECTOR), EC_SUCCESS, "%d");
+	TEST_EQ(mock.erases, 2, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_suspended_time_not_counted(void)
+{
+	uint8_t buf[4];
+	int i;
+
+	mock.erase_polls = -1;
+	TEST_EQ(spi_flash_erase_background(BLOCK_64K, SECTOR, erase_done),
+		EC_SUCCESS, "%d");
+	while (!mock.erasing)
+		msleep(1);
+
+	/* 1 s of reads, past the 800 ms sector erase timeout */
+	mock.read_delay_us = 100 * MSEC;
+	for (i = 0; i < 10; i++) {
+		TEST_EQ(spi_flash_read(buf, 0, sizeof(buf)), EC_SUCCESS,
+			"%d");
+		/* Let the hook task poll the erase in between */
+		msleep(1);
+	}
+	mock.read_delay_us = 0;
+	TEST_EQ(mock.suspends, 10, "%d");
+
+	msleep(20);
+	TEST_ASSERT(!done_count);
+
+	mock.busy_polls = 1;
+	TEST_ASSERT(wait_done(1000));
+	TEST_EQ(done_rv, EC_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_rewrite_waits(void)
+{
+	uint8_t data[SECTOR / 2];
+	int i;
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i * 3;
+
+	mock.erase_polls = -1;
+	TEST_EQ(spi_flash_erase_background(BLOCK_64K, BLOCK_64K, erase_done),
+		EC_SUCCESS, "%d");
+	while (!mock.erasing)
+		msleep(1);
+	mock.busy_polls = 3;
+	mock.erase_polls = 1;
+
+	/* Waits for the erase, then erases and writes past one page */
+	TEST_EQ(spi_flash_rewrite(0, SECTOR, data, sizeof(data), SECOND),
+		EC_SUCCESS, "%d");
+	TEST_EQ(done_count, 1, "%d");
+	TEST_ASSERT_ARRAY_EQ(mock_flash, data, sizeof(data));
+	TEST_ASSERT(check_blank(sizeof(data), SECTOR - sizeof(data)));
+	TEST_EQ(mock.bad_cmds, 0, "%d");
+
+	/* Gives up if the erase doesn't finish in time */
+	mock.erase_polls = -1;
+	done_count = 0;
+	TEST_EQ(spi_flash_erase_background(BLOCK_64K, BLOCK_64K, erase_done),
+		EC_SUCCESS, "%d");
+	while (!mock.erasing)
+		msleep(1);
+	TEST_EQ(spi_flash_rewrite(0, SECTOR, data, sizeof(data), 50 * MSEC),
+		EC_ERROR_BUSY, "%d");
+
+	mock.busy_polls = 1;
+	TEST_ASSERT(wait_done(1000));
+
+	return EC_SUCCESS;
+}
+
+static int deferred_ran;
+
+static void deferred_probe(void)
+{
+	deferred_ran = 1;
+}
+DECLARE_DEFERRED(deferred_probe);
+
+static int test_hook_task_responsive(void)
+{
+	timestamp_t start;
+
+	mock.erase_polls = -1;
+	start = get_time();
+	TEST_EQ(spi_flash_erase_background(BLOCK_64K, BLOCK_64K, erase_done),
+		EC_SUCCESS, "%d");
+	TEST_LT((int)(get_time().val - start.val), 10 * MSEC, "%d");
+	while (!mock.erasing)
+		msleep(1);
+
+	/* Other deferred work keeps running during a 64 KB block erase */
+	hook_call_deferred(&deferred_probe_data, 0);
+	msleep(20);
+	TEST_ASSERT(deferred_ran);
+	TEST_ASSERT(mock.erasing);
+
+	mock.busy_polls = 1;
+	TEST_ASSERT(wait_done(1000));
+	TEST_EQ(done_rv, EC_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
+void before_test(void)
+{
+	memset(mock_flash, 0xa5, sizeof(mock_flash));
+	memset(&mock, 0, sizeof(mock));
+	mock.erase_polls = 1;
+	done_count = 0;
+	done_rv = -1;
+	deferred_ran = 0;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_blank_sectors_skipped);
+	RUN_TEST(test_blank_block_skipped);
+	RUN_TEST(test_blank_not_erased_this_boot);
+	RUN_TEST(test_write_skips_pages);
+	RUN_TEST(test_read_suspends_erase);
+	RUN_TEST(test_busy_while_erasing);
+	RUN_TEST(test_timeout);
+	RUN_TEST(test_suspended_time_not_counted);
+	RUN_TEST(test_rewrite_waits);
+	RUN_TEST(test_hook_task_responsive);
+
+	test_print_result();
+}
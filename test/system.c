@@ -15,6 +15,17 @@
 
 #define TEST_STATE_STEP_2	(1 << 0)
 #define TEST_STATE_FAIL		(1 << 1)
+#define TEST_STATE_STEP_3	(1 << 2)
+
+#define TEST_PRESERVED_TAG	0x5453 /* "TS" */
+#define TEST_PRESERVED_VERSION	1
+
+static struct {
+	uint32_t magic;
+	uint8_t bytes[6];
+} test_preserved;
+DECLARE_PRESERVED_STATE(test, TEST_PRESERVED_TAG, TEST_PRESERVED_VERSION,
+			test_preserved);
 
 static int test_reboot_on_shutdown(void)
 {
@@ -71,6 +82,41 @@ static int test_cancel_reboot(void)
 	return EC_SUCCESS;
 }
 
+static int test_preserved_state_save(void)
+{
+	/* Nothing was restored on a cold boot */
+	TEST_ASSERT(!system_preserved_state_restored(TEST_PRESERVED_TAG));
+
+	test_preserved.magic = 0x12345678;
+	memcpy(test_preserved.bytes, "abcdef", sizeof(test_preserved.bytes));
+
+	system_set_scratchpad(TEST_STATE_STEP_3);
+	system_run_image_copy(EC_IMAGE_RW);
+
+	/* Shouldn't reach here */
+	return EC_ERROR_UNKNOWN;
+}
+
+static int test_preserved_state_restore(void)
+{
+	int version, size;
+
+	TEST_ASSERT(system_jumped_to_this_image());
+	TEST_ASSERT(system_preserved_state_restored(TEST_PRESERVED_TAG));
+	TEST_EQ(test_preserved.magic, 0x12345678, "0x%08x");
+	TEST_ASSERT_ARRAY_EQ(test_preserved.bytes, (uint8_t *)"abcdef",
+			     sizeof(test_preserved.bytes));
+
+	/* Only the packed tag was written, not a tag per variable */
+	TEST_ASSERT(system_get_jump_tag(TEST_PRESERVED_TAG, &version,
+					&size) == NULL);
+
+	/* Unknown tags were never restored */
+	TEST_ASSERT(!system_preserved_state_restored(0xffff));
+
+	return EC_SUCCESS;
+}
+
 static void run_test_step1(void)
 {
 	if (test_reboot_on_shutdown() != EC_SUCCESS)
@@ -82,8 +128,18 @@ static void run_test_step2(void)
 	if (test_cancel_reboot() != EC_SUCCESS)
 		test_fail();
 
+	if (test_preserved_state_save() != EC_SUCCESS)
+		test_fail();
+}
+
+static void run_test_step3(void)
+{
 	system_set_scratchpad(0);
-	test_pass();
+
+	if (test_preserved_state_restore() != EC_SUCCESS)
+		test_fail();
+	else
+		test_pass();
 }
 
 static void fail_and_clean_up(void)
@@ -102,6 +158,8 @@ void run_test(int argc, char **argv)
 		run_test_step1();
 	else if (state & TEST_STATE_STEP_2)
 		run_test_step2();
+	else if (state & TEST_STATE_STEP_3)
+		run_test_step3();
 	else if (state & TEST_STATE_FAIL)
 		fail_and_clean_up();
 }
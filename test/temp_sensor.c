@@ -0,0 +1,166 @@
+/* Copyright 2021 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the common temperature sensor reading cache.
+ */
+
+#include "common.h"
+#include "ec_commands.h"
+#include "host_command.h"
+#include "temp_sensor.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+/* The tests below make some assumptions. */
+BUILD_ASSERT(TEMP_SENSOR_COUNT == 4);
+BUILD_ASSERT(CONFIG_TEMP_SENSOR_UPDATE_PERIOD == 2);
+
+/*****************************************************************************/
+/* Mock functions */
+
+static int mock_temp[TEMP_SENSOR_COUNT];
+static int mock_reads;
+static int mock_updates;
+
+int mock_temp_get_val(int idx, int *temp_ptr)
+{
+	mock_reads++;
+
+	if (mock_temp[idx] < 0)
+		return EC_ERROR_NOT_POWERED;
+
+	*temp_ptr = mock_temp[idx];
+	return EC_SUCCESS;
+}
+
+void mock_temp_update(void)
+{
+	mock_updates++;
+}
+
+static void set_temps(int t)
+{
+	int i;
+
+	for (i = 0; i < TEMP_SENSOR_COUNT; i++)
+		mock_temp[i] = t + i;
+}
+
+/* Wait for the next periodic cache refresh. */
+static void wait_for_refresh(void)
+{
+	int updates = mock_updates;
+	int i;
+
+	for (i = 0; i < 2 * CONFIG_TEMP_SENSOR_UPDATE_PERIOD; i++) {
+		sleep(1);
+		if (mock_updates != updates)
+			return;
+	}
+}
+
+/*****************************************************************************/
+/* Tests */
+
+static int test_read_from_cache(void)
+{
+	int i, t, reads;
+
+	set_temps(300);
+	temp_sensor_update_cache();
+
+	reads = mock_reads;
+	for (i = 0; i < TEMP_SENSOR_COUNT; i++) {
+		TEST_ASSERT(temp_sensor_read(i, &t) == EC_SUCCESS);
+		TEST_ASSERT(t == 300 + i);
+	}
+	TEST_ASSERT(mock_reads == reads);
+
+	/* A new driver value isn't seen until the next refresh. */
+	set_temps(310);
+	TEST_ASSERT(temp_sensor_read(0, &t) == EC_SUCCESS);
+	TEST_ASSERT(t == 300);
+
+	wait_for_refresh();
+	TEST_ASSERT(temp_sensor_read(0, &t) == EC_SUCCESS);
+	TEST_ASSERT(t == 310);
+
+	TEST_ASSERT(temp_sensor_read(TEMP_SENSOR_COUNT, &t) ==
+		    EC_ERROR_INVAL);
+
+	return EC_SUCCESS;
+}
+
+static int test_error_cached(void)
+{
+	int t = -1;
+
+	set_temps(300);
+	mock_temp[2] = -1;
+	temp_sensor_update_cache();
+
+	TEST_ASSERT(temp_sensor_read(2, &t) == EC_ERROR_NOT_POWERED);
+	TEST_ASSERT(t == -1);
+	TEST_ASSERT(temp_sensor_read(3, &t) == EC_SUCCESS);
+	TEST_ASSERT(t == 303);
+
+	return EC_SUCCESS;
+}
+
+static int test_shared_update(void)
+{
+	int updates, reads;
+
+	updates = mock_updates;
+	reads = mock_reads;
+	temp_sensor_update_cache();
+
+	/* Two sensors share the update callback, it is called once. */
+	TEST_ASSERT(mock_updates == updates + 1);
+	TEST_ASSERT(mock_reads == reads + TEMP_SENSOR_COUNT);
+
+	return EC_SUCCESS;
+}
+
+static int test_update_period(void)
+{
+	int updates;
+
+	wait_for_refresh();
+	updates = mock_updates;
+
+	sleep(4 * CONFIG_TEMP_SENSOR_UPDATE_PERIOD);
+	TEST_ASSERT(mock_updates == updates + 4);
+
+	return EC_SUCCESS;
+}
+
+static int test_memmap(void)
+{
+	uint8_t *mptr = host_get_memmap(EC_MEMMAP_TEMP_SENSOR);
+
+	set_temps(EC_TEMP_SENSOR_OFFSET + 20);
+	mock_temp[1] = -1;
+	temp_sensor_update_cache();
+
+	TEST_ASSERT(mptr[0] == 20);
+	TEST_ASSERT(mptr[1] == EC_TEMP_SENSOR_NOT_POWERED);
+	TEST_ASSERT(mptr[2] == 22);
+	TEST_ASSERT(mptr[3] == 23);
+	TEST_ASSERT(mptr[TEMP_SENSOR_COUNT] == EC_TEMP_SENSOR_NOT_PRESENT);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	RUN_TEST(test_read_from_cache);
+	RUN_TEST(test_error_cached);
+	RUN_TEST(test_shared_update);
+	RUN_TEST(test_update_period);
+	RUN_TEST(test_memmap);
+
+	test_print_result();
+}
@@ -219,10 +219,33 @@ enum sensor_id {
 
 #endif
 
+#ifdef TEST_FLASH_CACHE
+#define CONFIG_FLASH_READ_CACHE
+#endif
+
+#ifdef TEST_SPI_FLASH_ERASE
+#define CONFIG_SPI_FLASH
+#define CONFIG_SPI_FLASH_PORT 0
+#define CONFIG_SPI_FLASH_W25Q64
+#define CONFIG_FLASH_DEFERRED_ERASE
+#define CONFIG_FLASH_BACKGROUND_ERASE
+#endif
+
 #ifdef TEST_CRC32
 #define CONFIG_SW_CRC
 #endif
 
+#ifdef TEST_CRC32_NIBBLE
+#define CONFIG_SW_CRC
+#define CONFIG_SW_CRC_TABLE_NIBBLE
+#endif
+
+#ifdef TEST_CRC32_SLICE4
+#define CONFIG_SW_CRC
+#define CONFIG_SW_CRC_SLICE_BY_4
+#define CONFIG_CRC8_TABLE_256
+#endif
+
 #ifdef TEST_RSA
 #define CONFIG_RSA
 #undef CONFIG_RSA_KEY_SIZE
@@ -239,6 +262,22 @@ enum sensor_id {
 #define CONFIG_RWSIG_TYPE_RWSIG
 #endif
 
+#ifdef TEST_RSA3072
+#define CONFIG_RSA
+#undef CONFIG_RSA_KEY_SIZE
+#define CONFIG_RSA_KEY_SIZE 3072
+#undef CONFIG_RSA_EXPONENT_3
+#define CONFIG_RWSIG_TYPE_RWSIG
+#endif
+
+#ifdef TEST_RSA3072_3
+#define CONFIG_RSA
+#undef CONFIG_RSA_KEY_SIZE
+#define CONFIG_RSA_KEY_SIZE 3072
+#define CONFIG_RSA_EXPONENT_3
+#define CONFIG_RWSIG_TYPE_RWSIG
+#endif
+
 #ifdef TEST_SHA256
 #define CONFIG_SHA256
 #endif
@@ -248,6 +287,21 @@ enum sensor_id {
 #define CONFIG_SHA256_UNROLLED
 #endif
 
+#ifdef TEST_SHA256_HW
+#define CONFIG_SHA256
+#define CONFIG_SHA256_HW_ACCELERATE
+#endif
+
+#ifdef TEST_SHMALLOC_SLAB
+#define TEST_SHMALLOC
+#define CONFIG_MALLOC_SLAB
+#define CONFIG_MALLOC_SLAB_OBJS 2
+#endif
+
+#ifdef TEST_SMBUS_BLOCK
+#define CONFIG_SMBUS_PEC
+#endif
+
 #ifdef TEST_SHMALLOC
 #define CONFIG_MALLOC
 #endif
@@ -269,23 +323,51 @@ int board_discharge_on_ac(int enabled);
 #define I2C_PORT_CHARGER 0
 #endif
 
+#ifdef TEST_TEMP_SENSOR
+#define CONFIG_TEMP_SENSOR
+#define CONFIG_TEMP_SENSOR_CACHE
+#define CONFIG_TEMP_SENSOR_UPDATE_PERIOD 2
+#endif
+
 #ifdef TEST_THERMAL
 #define CONFIG_CHIPSET_CAN_THROTTLE
 #define CONFIG_FANS 1
 #define CONFIG_I2C
 #define CONFIG_I2C_MASTER
 #define CONFIG_TEMP_SENSOR
+#define CONFIG_TEMP_SENSOR_CACHE
 #define CONFIG_THROTTLE_AP
 #define CONFIG_THERMISTOR
 #define CONFIG_THERMISTOR_NCP15WB
+#define CONFIG_THERMAL_FAST_POLL_MARGIN 5
 #define I2C_PORT_THERMAL 0
 int ncp15wb_calculate_temp(uint16_t adc);
 #endif
 
+#ifdef TEST_CONSOLE_FRAME
+#define CONFIG_CONSOLE_FRAMED
+#endif
+
+#ifdef TEST_EVENT_LOG
+#define CONFIG_EVENT_LOG
+#endif
+
+#ifdef TEST_HOOKS
+#define CONFIG_HOOK_TIMING
+#endif
+
+#ifdef TEST_HOST_EVENT_COALESCE
+#define CONFIG_HOST_EVENT_COALESCE_MS 10
+#endif
+
 #ifdef TEST_FAN
 #define CONFIG_FANS 1
 #endif
 
+#ifdef TEST_FAN_PID
+#define CONFIG_FAN_PID
+#endif
+
 #ifdef TEST_BUTTON
 #define CONFIG_KEYBOARD_PROTOCOL_8042
 #undef CONFIG_KEYBOARD_VIVALDI
@@ -581,6 +663,25 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_CURVE25519
 #endif /* TEST_X25519 */
 
+#ifdef TEST_I2C_ASYNC
+#define CONFIG_I2C_XFER_ASYNC
+#define I2C_PORT_AUX 1
+#undef CONFIG_I2C_NACK_RETRY_COUNT
+#define CONFIG_I2C_NACK_RETRY_COUNT 2
+#endif
+
+#ifdef TEST_I2C_SCHED
+#define CONFIG_I2C_SCHED
+#endif
+
+#ifdef TEST_I2C_STATS
+#define CONFIG_I2C_STATS
+#endif
+
+#ifdef TEST_I2C_TRACE
+#define CONFIG_I2C_DEBUG
+#endif
+
 #ifdef TEST_I2C_BITBANG
 #define CONFIG_I2C
 #define CONFIG_I2C_MASTER
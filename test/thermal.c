@@ -32,6 +32,7 @@ BUILD_ASSERT(EC_TEMP_THRESH_COUNT == 3);
 /* Mock functions */
 
 static int mock_temp[TEMP_SENSOR_COUNT];
+static int mock_reads[TEMP_SENSOR_COUNT];
 static int host_throttled;
 static int cpu_throttled;
 static int cpu_shutdown;
@@ -40,11 +41,17 @@ static int no_temps_read;
 
 int mock_temp_get_val(int idx, int *temp_ptr)
 {
+	mock_reads[idx]++;
+
 	if (mock_temp[idx] >= 0) {
 		*temp_ptr = mock_temp[idx];
 		return EC_SUCCESS;
 	}
 
+	/* -2 is a transient bus error, anything else an unpowered sensor */
+	if (mock_temp[idx] == -2)
+		return EC_ERROR_UNKNOWN;
+
 	return EC_ERROR_NOT_POWERED;
 }
 
@@ -89,6 +96,15 @@ static void all_temps(int t)
 	set_temps(t, t, t, t);
 }
 
+/* Wait for the once a second pass, which is the only one reading sensor 0 */
+static void sync_to_second(void)
+{
+	int reads = mock_reads[0];
+
+	while (mock_reads[0] == reads)
+		msleep(10);
+}
+
 static void reset_mocks(void)
 {
 	/* Ignore all sensors */
@@ -481,6 +497,67 @@ static int test_several_limits(void)
 	return EC_SUCCESS;
 }
 
+static int test_fast_poll(void)
+{
+	reset_mocks();
+
+	thermal_params[1].temp_host[EC_TEMP_THRESH_WARN] = 200;
+	thermal_params[2].temp_host[EC_TEMP_THRESH_WARN] = 100;
+
+	/* Sensor 2 is now within the margin of its limit, sensor 1 is not */
+	set_temps(0, 98, 98, 0);
+	sleep(2);
+	TEST_ASSERT(host_throttled == 0);
+
+	/* Sensor 1 crossing its limit waits for the once a second pass */
+	sync_to_second();
+	set_temps(0, 201, 98, 0);
+	msleep(2 * HOOK_TICK_INTERVAL_MS);
+	TEST_ASSERT(host_throttled == 0);
+	sleep(1);
+	TEST_ASSERT(host_throttled == 1);
+
+	set_temps(0, 98, 98, 0);
+	sleep(2);
+	TEST_ASSERT(host_throttled == 0);
+
+	/* Sensor 2 is polled every hook tick and trips right away */
+	sync_to_second();
+	set_temps(0, 98, 101, 0);
+	msleep(2 * HOOK_TICK_INTERVAL_MS);
+	TEST_ASSERT(host_throttled == 1);
+
+	set_temps(0, 98, 98, 0);
+	sleep(2);
+	TEST_ASSERT(host_throttled == 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_stale_reading(void)
+{
+	reset_mocks();
+
+	thermal_params[1].temp_host[EC_TEMP_THRESH_WARN] = 100;
+	thermal_params[2].temp_host[EC_TEMP_THRESH_WARN] = 100;
+
+	set_temps(0, 50, 150, 0);
+	sleep(2);
+	TEST_ASSERT(host_throttled == 1);
+
+	/* A bus error is covered by the last good reading for a while */
+	sync_to_second();
+	set_temps(0, 50, -2, 0);
+	msleep(1500);
+	TEST_ASSERT(host_throttled == 1);
+
+	/* Until that reading is too old to be trusted */
+	sleep(3);
+	TEST_ASSERT(host_throttled == 0);
+
+	return EC_SUCCESS;
+}
+
 /* Tests for ncp15wb thermistor ADC-to-temp calculation */
 #define LOW_ADC_TEST_VALUE	887 /* 0 C */
 #define HIGH_ADC_TEST_VALUE	100 /* > 100C */
@@ -652,6 +729,8 @@ void run_test(int argc, char **argv)
 
 	RUN_TEST(test_one_limit);
 	RUN_TEST(test_several_limits);
+	RUN_TEST(test_fast_poll);
+	RUN_TEST(test_stale_reading);
 
 	RUN_TEST(test_ncp15wb_adc_to_temp);
 	RUN_TEST(test_thermistor_linear_interpolate);
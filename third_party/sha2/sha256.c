@@ -35,6 +35,7 @@
  * SUCH DAMAGE.
  */
 
+#include "endian.h"
 #include "sha256.h"
 #include "util.h"
 
@@ -65,18 +66,24 @@
 			| ((uint32_t) *((str) + 0) << 24);	\
 	}
 
-/* Macros used for loops unrolling */
+/*
+ * The message schedule only ever looks 16 words back, so it is kept in a
+ * rolling 16-word window instead of the full 64 words.
+ */
+#define W(i) w[(i) & 15]
 
 #define SHA256_SCR(i)						\
 	{							\
-		w[i] =  SHA256_F4(w[i -  2]) + w[i -  7]	\
-			+ SHA256_F3(w[i - 15]) + w[i - 16];	\
+		W(i) += SHA256_F4(W((i) -  2)) + W((i) -  7)	\
+			+ SHA256_F3(W((i) - 15));		\
 	}
 
+/* Macros used for loops unrolling */
+
 #define SHA256_EXP(a, b, c, d, e, f, g, h, j)				\
 	{								\
 		t1 = wv[h] + SHA256_F2(wv[e]) + CH(wv[e], wv[f], wv[g])	\
-			+ sha256_k[j] + w[j];				\
+			+ sha256_k[j] + W(j);				\
 		t2 = SHA256_F1(wv[a]) + MAJ(wv[a], wv[b], wv[c]);	\
 		wv[d] += t1;						\
 		wv[h] = t1 + t2;					\
@@ -115,11 +122,10 @@ void SHA256_init(struct sha256_ctx *ctx)
 	ctx->tot_len = 0;
 }
 
-static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
-			     unsigned int block_nb)
+static void SHA256_sw_transform(uint32_t *h, const uint8_t *message,
+				unsigned int block_nb)
 {
-	/* Note: this function requires a considerable amount of stack */
-	uint32_t w[64];
+	uint32_t w[16];
 	uint32_t wv[8];
 	uint32_t t1, t2;
 	const unsigned char *sub_block;
@@ -128,43 +134,54 @@ static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
 	for (i = 0; i < (int) block_nb; i++) {
 		sub_block = message + (i << 6);
 
-		for (j = 0; j < 16; j++)
-			PACK32(&sub_block[j << 2], &w[j]);
+		if (((uintptr_t)sub_block & 3) == 0) {
+			const uint32_t *words = (const uint32_t *)sub_block;
 
-#ifdef CONFIG_SHA256_UNROLLED
-		for (j = 16; j < 64; j += 8) {
-			SHA256_SCR(j);
-			SHA256_SCR(j+1);
-			SHA256_SCR(j+2);
-			SHA256_SCR(j+3);
-			SHA256_SCR(j+4);
-			SHA256_SCR(j+5);
-			SHA256_SCR(j+6);
-			SHA256_SCR(j+7);
+			for (j = 0; j < 16; j++)
+				w[j] = be32toh(words[j]);
+		} else {
+			for (j = 0; j < 16; j++)
+				PACK32(&sub_block[j << 2], &w[j]);
 		}
-#else
-		for (j = 16; j < 64; j++)
-			SHA256_SCR(j);
-#endif
 
 		for (j = 0; j < 8; j++)
-			wv[j] = ctx->h[j];
+			wv[j] = h[j];
 
 #ifdef CONFIG_SHA256_UNROLLED
-		for (j = 0; j < 64; j += 8) {
+		for (j = 0; j < 16; j += 8) {
+			SHA256_EXP(0, 1, 2, 3, 4, 5, 6, 7, j);
+			SHA256_EXP(7, 0, 1, 2, 3, 4, 5, 6, j+1);
+			SHA256_EXP(6, 7, 0, 1, 2, 3, 4, 5, j+2);
+			SHA256_EXP(5, 6, 7, 0, 1, 2, 3, 4, j+3);
+			SHA256_EXP(4, 5, 6, 7, 0, 1, 2, 3, j+4);
+			SHA256_EXP(3, 4, 5, 6, 7, 0, 1, 2, j+5);
+			SHA256_EXP(2, 3, 4, 5, 6, 7, 0, 1, j+6);
+			SHA256_EXP(1, 2, 3, 4, 5, 6, 7, 0, j+7);
+		}
+		for (j = 16; j < 64; j += 8) {
+			SHA256_SCR(j);
 			SHA256_EXP(0, 1, 2, 3, 4, 5, 6, 7, j);
+			SHA256_SCR(j+1);
 			SHA256_EXP(7, 0, 1, 2, 3, 4, 5, 6, j+1);
+			SHA256_SCR(j+2);
 			SHA256_EXP(6, 7, 0, 1, 2, 3, 4, 5, j+2);
+			SHA256_SCR(j+3);
 			SHA256_EXP(5, 6, 7, 0, 1, 2, 3, 4, j+3);
+			SHA256_SCR(j+4);
 			SHA256_EXP(4, 5, 6, 7, 0, 1, 2, 3, j+4);
+			SHA256_SCR(j+5);
 			SHA256_EXP(3, 4, 5, 6, 7, 0, 1, 2, j+5);
+			SHA256_SCR(j+6);
 			SHA256_EXP(2, 3, 4, 5, 6, 7, 0, 1, j+6);
+			SHA256_SCR(j+7);
 			SHA256_EXP(1, 2, 3, 4, 5, 6, 7, 0, j+7);
 		}
 #else
 		for (j = 0; j < 64; j++) {
+			if (j >= 16)
+				SHA256_SCR(j);
 			t1 = wv[7] + SHA256_F2(wv[4]) + CH(wv[4], wv[5], wv[6])
-				+ sha256_k[j] + w[j];
+				+ sha256_k[j] + W(j);
 			t2 = SHA256_F1(wv[0]) + MAJ(wv[0], wv[1], wv[2]);
 			wv[7] = wv[6];
 			wv[6] = wv[5];
@@ -178,40 +195,53 @@ static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
 #endif
 
 		for (j = 0; j < 8; j++)
-			ctx->h[j] += wv[j];
+			h[j] += wv[j];
 	}
 }
 
+static void SHA256_transform(struct sha256_ctx *ctx, const uint8_t *message,
+			     unsigned int block_nb)
+{
+#ifdef CONFIG_SHA256_HW_ACCELERATE
+	/* Let the hash engine have it first, fall back if it declines. */
+	if (sha256_hw_transform(ctx->h, message, block_nb) == EC_SUCCESS)
+		return;
+#endif
+	SHA256_sw_transform(ctx->h, message, block_nb);
+}
+
 void SHA256_update(struct sha256_ctx *ctx, const uint8_t *data, uint32_t len)
 {
 	unsigned int block_nb;
-	unsigned int new_len, rem_len, tmp_len;
-	const uint8_t *shifted_data;
-
-	tmp_len = SHA256_BLOCK_SIZE - ctx->len;
-	rem_len = len < tmp_len ? len : tmp_len;
-
-	memcpy(&ctx->block[ctx->len], data, rem_len);
-
-	if (ctx->len + len < SHA256_BLOCK_SIZE) {
-		ctx->len += len;
-		return;
+	unsigned int fill;
+
+	/* Top up a partially filled block first. */
+	if (ctx->len) {
+		fill = MIN(len, SHA256_BLOCK_SIZE - ctx->len);
+		memcpy(&ctx->block[ctx->len], data, fill);
+		ctx->len += fill;
+		data += fill;
+		len -= fill;
+
+		if (ctx->len < SHA256_BLOCK_SIZE)
+			return;
+
+		SHA256_transform(ctx, ctx->block, 1);
+		ctx->tot_len += SHA256_BLOCK_SIZE;
+		ctx->len = 0;
 	}
 
-	new_len = len - rem_len;
-	block_nb = new_len / SHA256_BLOCK_SIZE;
-
-	shifted_data = data + rem_len;
-
-	SHA256_transform(ctx, ctx->block, 1);
-	SHA256_transform(ctx, shifted_data, block_nb);
-
-	rem_len = new_len % SHA256_BLOCK_SIZE;
-
-	memcpy(ctx->block, &shifted_data[block_nb << 6], rem_len);
+	/* Whole blocks are hashed straight from the caller's buffer. */
+	block_nb = len / SHA256_BLOCK_SIZE;
+	if (block_nb) {
+		SHA256_transform(ctx, data, block_nb);
+		ctx->tot_len += block_nb << 6;
+		data += block_nb << 6;
+		len -= block_nb << 6;
+	}
 
-	ctx->len = rem_len;
-	ctx->tot_len += (block_nb + 1) << 6;
+	memcpy(ctx->block, data, len);
+	ctx->len = len;
 }
 
 /*
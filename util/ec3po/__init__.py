@@ -18,8 +18,13 @@ the user.  The user does not necessarily have to be the interactive console, but
 could be something like autotest.  The interpreter is also responsible for the
 automatic command retrying if the EC drops a character in a command.  This is a
 stopgap until all commands are communicated via host commands.
+
+The framed module is a client for scripts and test harnesses talking to an EC
+built with CONFIG_CONSOLE_FRAMED.  Commands and their output travel in CRC
+protected frames, separate from the EC's log output.
 """
 
 import console
+import framed
 import interpreter
 import threadproc_shim
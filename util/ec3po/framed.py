@@ -0,0 +1,229 @@
+# Copyright 2021 The Chromium OS Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""EC-3PO framed console client
+
+framed talks to an EC built with CONFIG_CONSOLE_FRAMED.  Each command is sent
+as a CRC protected request frame, and what it prints comes back in response
+frames carrying the same sequence number, followed by a frame holding the
+command's return code.  Log output from the rest of the EC keeps arriving as
+plain text around the frames, so it can never corrupt a command's output and
+no regex scraping of the console is needed.
+
+See include/console.h for the frame layout.
+"""
+
+# Note: This is a py2/3 compatible file.
+
+from __future__ import print_function
+
+import os
+import select
+import struct
+import time
+
+import six
+
+import interpreter
+
+
+SOF = b'\xf0\xec'  # Start of every frame.
+HEADER_SIZE = 6  # SOF, type, seq and 16-bit length.
+FRAME_REQUEST = 1
+FRAME_OUTPUT = 2
+FRAME_DONE = 3
+FRAME_NAK = 4
+MAX_COMMAND_LEN = 79  # CONFIG_CONSOLE_INPUT_LINE_SIZE - 1 on the EC.
+MAX_PAYLOAD = 255  # Anything longer is a corrupted header.
+COMMAND_RETRIES = 3  # Number of times to resend a command the EC NAKed.
+EC_MAX_READ = 1024  # Max bytes to read at a time from the EC.
+
+
+class FramedConsoleError(Exception):
+  """Raised when the EC does not answer a request."""
+
+
+def PackFrame(frame_type, seq, payload):
+  """Builds a frame.
+
+  Args:
+    frame_type: An integer frame type, such as FRAME_REQUEST.
+    seq: An integer sequence number, 0-255.
+    payload: The frame payload as bytes.
+
+  Returns:
+    The frame as bytes.
+  """
+  body = struct.pack('<BBH', frame_type, seq, len(payload)) + payload
+  return SOF + body + six.int2byte(interpreter.Crc8(body))
+
+
+class FrameParser(object):
+  """Splits the EC output stream into frames and plain text.
+
+  Data can be fed in arbitrary pieces; a frame split across reads is kept
+  until the rest of it arrives.
+  """
+
+  def __init__(self):
+    self._buf = b''
+
+  def Feed(self, data):
+    """Adds data read from the EC.
+
+    Args:
+      data: The bytes read from the EC.
+
+    Returns:
+      A tuple (frames, text) where frames is a list of (type, seq, payload)
+      tuples for every complete and intact frame, and text is the plain text
+      found around them.
+    """
+    self._buf += data
+    frames = []
+    text = b''
+
+    while self._buf:
+      start = self._buf.find(SOF[:1])
+      if start < 0:
+        text += self._buf
+        self._buf = b''
+        break
+      text += self._buf[:start]
+      self._buf = self._buf[start:]
+
+      if len(self._buf) < HEADER_SIZE:
+        if len(self._buf) > 1 and self._buf[:2] != SOF:
+          text += self._buf[:1]
+          self._buf = self._buf[1:]
+          continue
+        # Wait for the rest of the header.
+        break
+
+      frame_type, seq, length = struct.unpack('<BBH', self._buf[2:HEADER_SIZE])
+      if self._buf[:2] != SOF or length > MAX_PAYLOAD:
+        text += self._buf[:1]
+        self._buf = self._buf[1:]
+        continue
+
+      size = HEADER_SIZE + length + 1
+      if len(self._buf) < size:
+        break
+
+      body = self._buf[2:size - 1]
+      if interpreter.Crc8(body) != six.indexbytes(self._buf, size - 1):
+        # Corrupted; drop the start of frame and resync on what follows.
+        self._buf = self._buf[1:]
+        continue
+
+      frames.append((frame_type, seq, body[HEADER_SIZE - 2:]))
+      self._buf = self._buf[size:]
+
+    return frames, text
+
+
+class FramedConsole(object):
+  """Runs console commands on the EC using frames.
+
+  Attributes:
+    log: A bytearray with the EC log output received so far, if no log
+      callback was given.
+  """
+
+  def __init__(self, ec_uart_pty, timeout=1.0, log_callback=None):
+    """Initializes a FramedConsole.
+
+    Args:
+      ec_uart_pty: A string representing the EC UART to connect to, or an
+        already open file descriptor.
+      timeout: Seconds to wait for the EC to finish a command.
+      log_callback: An optional function called with every piece of plain text
+        log output from the EC.
+    """
+    if isinstance(ec_uart_pty, int):
+      self._fd = ec_uart_pty
+    else:
+      self._fd = os.open(ec_uart_pty, os.O_RDWR | os.O_NOCTTY)
+    self._timeout = timeout
+    self._log_callback = log_callback
+    self._parser = FrameParser()
+    self._seq = 0
+    self.log = bytearray()
+
+  def _HandleText(self, text):
+    if not text:
+      return
+    if self._log_callback:
+      self._log_callback(text)
+    else:
+      self.log += text
+
+  def _Read(self, deadline):
+    """Reads whatever the EC sent until the deadline and returns its frames."""
+    remaining = deadline - time.time()
+    if remaining <= 0:
+      return []
+    readable, _, _ = select.select([self._fd], [], [], remaining)
+    if not readable:
+      return []
+    frames, text = self._parser.Feed(os.read(self._fd, EC_MAX_READ))
+    self._HandleText(text)
+    return frames
+
+  def _WaitForResponse(self, seq):
+    """Collects the response to a request.
+
+    Args:
+      seq: The sequence number of the request.
+
+    Returns:
+      A tuple (rv, output), or None if the EC rejected the request.
+
+    Raises:
+      FramedConsoleError: If the EC did not answer in time.
+    """
+    output = b''
+    deadline = time.time() + self._timeout
+    while time.time() < deadline:
+      for frame_type, frame_seq, payload in self._Read(deadline):
+        if frame_seq != seq:
+          # Left over from a request we gave up on.
+          continue
+        if frame_type == FRAME_NAK:
+          return None
+        if frame_type == FRAME_OUTPUT:
+          output += payload
+        elif frame_type == FRAME_DONE:
+          return struct.unpack('<i', payload)[0], output
+
+    # The command may have run, so it must not simply be sent again.
+    raise FramedConsoleError('No response to request %d' % seq)
+
+  def Command(self, command):
+    """Runs a console command on the EC.
+
+    Args:
+      command: The command line, as a string or bytes.
+
+    Returns:
+      A tuple (rv, output) with the EC error code the command returned, 0 on
+      success, and everything it printed as bytes.
+
+    Raises:
+      FramedConsoleError: If the command is too long, or the EC did not answer
+        in time or kept rejecting the request.
+    """
+    if not isinstance(command, bytes):
+      command = command.encode('ascii')
+    if len(command) > MAX_COMMAND_LEN:
+      raise FramedConsoleError('Command too long: %r' % command)
+
+    for _ in range(COMMAND_RETRIES):
+      self._seq = (self._seq + 1) & 0xff
+      os.write(self._fd, PackFrame(FRAME_REQUEST, self._seq, command))
+      response = self._WaitForResponse(self._seq)
+      if response:
+        return response
+
+    raise FramedConsoleError('EC rejected %r' % command)
@@ -0,0 +1,156 @@
+#!/usr/bin/env python
+# Copyright 2021 The Chromium OS Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Unit tests for the EC-3PO framed console client."""
+
+# Note: This is a py2/3 compatible file.
+
+from __future__ import print_function
+
+import socket
+import struct
+import threading
+import unittest
+
+import framed
+
+
+def DoneFrame(seq, rv):
+  return framed.PackFrame(framed.FRAME_DONE, seq, struct.pack('<i', rv))
+
+
+class TestFrameParser(unittest.TestCase):
+  """Test splitting the EC output into frames and text."""
+
+  def setUp(self):
+    self.parser = framed.FrameParser()
+
+  def test_TextAroundFrames(self):
+    data = (b'[1.0 log]\r\n' +
+            framed.PackFrame(framed.FRAME_OUTPUT, 7, b'hello\n') +
+            b'more log' + DoneFrame(7, 0))
+    frames, text = self.parser.Feed(data)
+    self.assertEqual(frames, [(framed.FRAME_OUTPUT, 7, b'hello\n'),
+                              (framed.FRAME_DONE, 7, struct.pack('<i', 0))])
+    self.assertEqual(text, b'[1.0 log]\r\nmore log')
+
+  def test_SplitFeeds(self):
+    data = b'ab' + framed.PackFrame(framed.FRAME_OUTPUT, 1, b'xyz') + b'cd'
+    frames = []
+    text = b''
+    for i in range(len(data)):
+      f, t = self.parser.Feed(data[i:i + 1])
+      frames += f
+      text += t
+    self.assertEqual(frames, [(framed.FRAME_OUTPUT, 1, b'xyz')])
+    self.assertEqual(text, b'abcd')
+
+  def test_CorruptedFrame(self):
+    bad = bytearray(framed.PackFrame(framed.FRAME_OUTPUT, 2, b'oops'))
+    bad[-1] ^= 0xff
+    good = framed.PackFrame(framed.FRAME_OUTPUT, 3, b'fine')
+    frames, _ = self.parser.Feed(bytes(bad) + good)
+    self.assertEqual(frames, [(framed.FRAME_OUTPUT, 3, b'fine')])
+
+  def test_StrayStartByte(self):
+    frames, text = self.parser.Feed(b'\xf0abcdefgh')
+    self.assertEqual(frames, [])
+    self.assertEqual(text, b'\xf0abcdefgh')
+
+
+class FakeEC(threading.Thread):
+  """Answers request frames like an EC built with CONFIG_CONSOLE_FRAMED."""
+
+  def __init__(self, sock, nak_first=False):
+    super(FakeEC, self).__init__()
+    self.daemon = True
+    self.sock = sock
+    self.nak_first = nak_first
+    self.commands = []
+
+  def run(self):
+    parser = framed.FrameParser()
+    while True:
+      data = self.sock.recv(1024)
+      if not data:
+        return
+      frames, _ = parser.Feed(data)
+      for frame_type, seq, payload in frames:
+        assert frame_type == framed.FRAME_REQUEST
+        if self.nak_first:
+          self.nak_first = False
+          self.sock.sendall(framed.PackFrame(framed.FRAME_NAK, seq, b''))
+          continue
+        self.commands.append(payload)
+        # Interleave log output with the response.
+        self.sock.sendall(b'[0.1 async]\r\n' +
+                          framed.PackFrame(framed.FRAME_OUTPUT, seq,
+                                           b'ran ' + payload + b'\n') +
+                          b'[0.2 async]\r\n' +
+                          DoneFrame(seq, 0 if payload != b'bad' else 5))
+
+
+class TestFramedConsole(unittest.TestCase):
+  """Test running commands through the framed console."""
+
+  def setUp(self):
+    self.host, self.ec = socket.socketpair()
+    self.fake_ec = None
+
+  def tearDown(self):
+    # Closing our end lets the fake EC see EOF and exit.
+    self.host.shutdown(socket.SHUT_RDWR)
+    if self.fake_ec:
+      self.fake_ec.join()
+    self.host.close()
+    self.ec.close()
+
+  def StartEC(self, nak_first=False):
+    self.fake_ec = FakeEC(self.ec, nak_first)
+    self.fake_ec.start()
+    return self.fake_ec
+
+  def test_Command(self):
+    ec = self.StartEC()
+    console = framed.FramedConsole(self.host.fileno())
+    for i in range(100):
+      cmd = 'cmd %d' % i
+      rv, output = console.Command(cmd)
+      self.assertEqual(rv, 0)
+      self.assertEqual(output, b'ran ' + cmd.encode() + b'\n')
+    self.assertEqual(len(ec.commands), 100)
+    self.assertIn(b'[0.1 async]', console.log)
+
+  def test_CommandError(self):
+    self.StartEC()
+    console = framed.FramedConsole(self.host.fileno())
+    rv, _ = console.Command('bad')
+    self.assertEqual(rv, 5)
+
+  def test_RetryAfterNak(self):
+    ec = self.StartEC(nak_first=True)
+    console = framed.FramedConsole(self.host.fileno())
+    rv, output = console.Command(b'version')
+    self.assertEqual(rv, 0)
+    self.assertEqual(output, b'ran version\n')
+    self.assertEqual(ec.commands, [b'version'])
+
+  def test_Timeout(self):
+    console = framed.FramedConsole(self.host.fileno(), timeout=0.1)
+    with self.assertRaises(framed.FramedConsoleError):
+      console.Command('version')
+
+  def test_LogCallback(self):
+    self.StartEC()
+    logs = []
+    console = framed.FramedConsole(self.host.fileno(),
+                                   log_callback=logs.append)
+    console.Command('version')
+    self.assertIn(b'async', b''.join(logs))
+    self.assertEqual(console.log, bytearray())
+
+
+if __name__ == '__main__':
+  unittest.main()
@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "comm-host.h"
+#include "ec_commands_private.h"
 #include "misc_util.h"
 #include "timer.h"
 
@@ -196,11 +197,33 @@ int ec_flash_erase(int offset, int size)
 	return ec_command(EC_CMD_FLASH_ERASE, 0, &p, sizeof(p), NULL, 0);
 }
 
+/*
+ * Print how far an async erase has gone, if the EC can tell.
+ *
+ * @return bytes erased so far, or -1 if unknown.
+ */
+static int ec_flash_erase_progress(void)
+{
+	struct ec_response_flash_erase_progress r;
+	int rv;
+
+	rv = ec_command(EC_CMD_FLASH_ERASE_PROGRESS, 0, NULL, 0, &r,
+			sizeof(r));
+	if (rv < (int)sizeof(r) || !r.size)
+		return -1;
+
+	printf("\rErased %u of %u bytes", r.erased, r.size);
+	fflush(stdout);
+	return r.erased;
+}
+
 int ec_flash_erase_async(int offset, int size)
 {
 	struct ec_params_flash_erase_v1 p = { 0 };
 	uint32_t timeout = 0;
 	int rv = FLASH_ERASE_BUSY_RV;
+	int erased, last_erased = -1;
+	int has_progress = 1;
 
 	p.cmd = FLASH_ERASE_SECTOR_ASYNC;
 	p.params.offset = offset;
@@ -224,8 +247,24 @@ int ec_flash_erase_async(int offset, int size)
 		 */
 		usleep(ERASE_ASYNC_WAIT);
 		timeout += ERASE_ASYNC_WAIT;
+
+		/*
+		 * Keep waiting as long as the erase moves forward. ECs without
+		 * EC_CMD_FLASH_ERASE_PROGRESS are not asked again.
+		 */
+		erased = has_progress ? ec_flash_erase_progress() : -1;
+		if (erased < 0) {
+			has_progress = 0;
+		} else if (erased > last_erased) {
+			if (last_erased >= 0)
+				timeout = 0;
+			last_erased = erased;
+		}
+
 		p.cmd = FLASH_ERASE_GET_RESULT;
 		rv = ec_command(EC_CMD_FLASH_ERASE, 1, &p, sizeof(p), NULL, 0);
 	}
+	if (last_erased >= 0)
+		printf("\n");
 	return rv;
 }
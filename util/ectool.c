@@ -21,6 +21,7 @@
 #include "chipset.h"
 #include "compile_time_macros.h"
 #include "cros_ec_dev.h"
+#include "ec_commands_private.h"
 #include "ec_panicinfo.h"
 #include "ec_flash.h"
 #include "ec_version.h"
@@ -178,6 +179,10 @@ const char help_str[] =
 	"      Protect EC's I2C bus\n"
 	"  i2cread\n"
 	"      Read I2C bus\n"
+	"  i2cstats [clear]\n"
+	"      Show or clear per-device I2C bus statistics\n"
+	"  i2ctrace\n"
+	"      Read captured I2C transactions (see util/i2c_trace_decode.py)\n"
 	"  i2cwrite\n"
 	"      Write I2C bus\n"
 	"  i2cxfer <port> <slave_addr> <read_count> [write bytes...]\n"
@@ -214,8 +219,8 @@ const char help_str[] =
 	"      Controls the PD chip\n"
 	"  pdchipinfo <port>\n"
 	"      Get PD chip information\n"
-	"  pdlog\n"
-	"      Prints the PD event log entries\n"
+	"  pdlog [follow [interval_ms]]\n"
+	"      Prints the PD event log entries, or keeps streaming them\n"
 	"  pdwritelog <type> <port>\n"
 	"      Writes a PD event log of the given <type>\n"
 	"  pdgetmode <port>\n"
@@ -7141,6 +7146,99 @@ int cmd_i2c_write(int argc, char *argv[])
 	return 0;
 }
 
+int cmd_i2c_stats(int argc, char *argv[])
+{
+	struct ec_params_i2c_stats p = {0};
+	const struct ec_response_i2c_stats *r = ec_inbuf;
+	const struct ec_i2c_stats_device *d;
+	int rv, i;
+
+	if (argc > 2 || (argc == 2 && strcasecmp(argv[1], "clear"))) {
+		fprintf(stderr, "Usage: %s [clear]\n", argv[0]);
+		return -1;
+	}
+	if (argc == 2) {
+		p.flags = EC_I2C_STATS_CLEAR;
+		rv = ec_command(EC_CMD_I2C_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		return rv < 0 ? rv : 0;
+	}
+
+	do {
+		rv = ec_command(EC_CMD_I2C_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		if (rv < sizeof(*r) ||
+		    rv < sizeof(*r) + r->count * sizeof(r->devices[0])) {
+			fprintf(stderr, "Truncated stats response\n");
+			return -1;
+		}
+
+		if (!p.offset) {
+			printf("Over %u ms, %u transfers untracked\n",
+			       r->period_ms, r->untracked);
+			printf("port addr    xfers     bytes   busy_us  max_us"
+			       "  util  nack  tmo  err wedge\n");
+		}
+
+		for (i = 0; i < r->count; i++) {
+			d = &r->devices[i];
+			printf("%4u 0x%02x %8u %9u %9u %7u %4.1f%% %5u %4u "
+			       "%4u %5u\n", d->port, d->addr, d->xfers,
+			       d->bytes, d->busy_us, d->max_us,
+			       r->period_ms ?
+			       d->busy_us / (10.0 * r->period_ms) : 0.0,
+			       d->nacks, d->timeouts, d->errors, d->unwedges);
+		}
+		p.offset += r->count;
+	} while (r->count && p.offset < r->total);
+
+	return 0;
+}
+
+/*
+ * Print one line per captured transaction:
+ *   start_us end_us port addr_flags result out_size in_size [data...]
+ */
+int cmd_i2c_trace(int argc, char *argv[])
+{
+	const struct ec_response_i2c_trace_read *r = ec_inbuf;
+	const struct ec_i2c_trace_entry *e;
+	int rv, i, j, n;
+
+	printf("# start_us end_us port addr_flags result out_size in_size "
+	       "data\n");
+	do {
+		rv = ec_command(EC_CMD_I2C_TRACE_READ, 0, NULL, 0,
+				ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		if (rv < sizeof(*r) ||
+		    rv < sizeof(*r) + r->count * sizeof(r->entries[0])) {
+			fprintf(stderr, "Truncated trace response\n");
+			return -1;
+		}
+
+		if (r->overwritten)
+			printf("# overwritten %u\n", r->overwritten);
+
+		for (i = 0; i < r->count; i++) {
+			e = &r->entries[i];
+			printf("%u %u %u 0x%04x %u %u %u", e->start_us,
+			       e->end_us, e->port, e->addr_flags, e->result,
+			       e->out_size, e->in_size);
+			n = MIN(e->out_size, EC_I2C_TRACE_DATA_MAX);
+			n += MIN(e->in_size, EC_I2C_TRACE_DATA_MAX - n);
+			for (j = 0; j < n; j++)
+				printf(" %02x", e->data[j]);
+			printf("\n");
+		}
+	} while (r->count);
+
+	return 0;
+}
+
 int cmd_i2c_xfer(int argc, char *argv[])
 {
 	unsigned int port, addr;
@@ -9251,23 +9349,161 @@ int cmd_charge_port_override(int argc, char *argv[])
 	return 0;
 }
 
-int cmd_pd_log(int argc, char *argv[])
+static void print_pd_log_entry(const struct ec_response_pd_log *r,
+			       time_t now)
 {
-	union {
-		struct ec_response_pd_log r;
-		uint32_t words[8]; /* space for the payload */
-	} u;
 	struct mcdp_info minfo;
 	struct ec_response_usb_pd_power_info pinfo;
-	int rv;
 	unsigned long long milliseconds;
 	unsigned seconds;
-	time_t now;
 	struct tm ltime;
 	char time_str[64];
 
+	/* the timestamp is in 1024th of seconds */
+	milliseconds = ((uint64_t)r->timestamp <<
+				 PD_LOG_TIMESTAMP_SHIFT) / 1000;
+	/* the timestamp is the number of milliseconds in the past */
+	seconds = (milliseconds + 999) / 1000;
+	milliseconds -= seconds * 1000;
+	now -= seconds;
+	localtime_r(&now, &ltime);
+	strftime(time_str, sizeof(time_str), "%F %T", &ltime);
+	printf("%s.%03lld P%d ", time_str, -milliseconds,
+		PD_LOG_PORT(r->size_port));
+	if (r->type == PD_EVENT_MCU_CHARGE) {
+		if (r->data & CHARGE_FLAGS_OVERRIDE)
+			printf("override ");
+		if (r->data & CHARGE_FLAGS_DELAYED_OVERRIDE)
+			printf("pending_override ");
+		memcpy(&pinfo.meas, r->payload,
+			sizeof(struct usb_chg_measures));
+		pinfo.dualrole = !!(r->data & CHARGE_FLAGS_DUAL_ROLE);
+		pinfo.role = r->data & CHARGE_FLAGS_ROLE_MASK;
+		pinfo.type = (r->data & CHARGE_FLAGS_TYPE_MASK)
+				>> CHARGE_FLAGS_TYPE_SHIFT;
+		pinfo.max_power = 0;
+		print_pd_power_info(&pinfo);
+	} else if (r->type == PD_EVENT_MCU_CONNECT) {
+		printf("New connection\n");
+	} else if (r->type == PD_EVENT_MCU_BOARD_CUSTOM) {
+		printf("Board-custom event\n");
+	} else if (r->type == PD_EVENT_ACC_RW_FAIL) {
+		printf("RW signature check failed\n");
+	} else if (r->type == PD_EVENT_PS_FAULT) {
+		static const char * const fault_names[] = {
+			"---", "OCP", "fast OCP", "OVP", "Discharge"
+		};
+		const char *fault = r->data < ARRAY_SIZE(fault_names) ?
+				fault_names[r->data] : "???";
+		printf("Power supply fault: %s\n", fault);
+	} else if (r->type == PD_EVENT_VIDEO_DP_MODE) {
+		printf("DP mode %sabled\n", (r->data == 1) ?
+		       "en" : "dis");
+	} else if (r->type == PD_EVENT_VIDEO_CODEC) {
+		memcpy(&minfo, r->payload,
+		       sizeof(struct mcdp_info));
+		printf("HDMI info: family:%04x chipid:%04x "
+		       "irom:%d.%d.%d fw:%d.%d.%d\n",
+		       MCDP_FAMILY(minfo.family),
+		       MCDP_CHIPID(minfo.chipid),
+		       minfo.irom.major, minfo.irom.minor,
+		       minfo.irom.build, minfo.fw.major,
+		       minfo.fw.minor, minfo.fw.build);
+	} else { /* Unknown type */
+		int i;
+		printf("Event %02x (%04x) [", r->type, r->data);
+		for (i = 0; i < PD_LOG_SIZE(r->size_port); i++)
+			printf("%02x ", r->payload[i]);
+		printf("]\n");
+	}
+}
+
+/*
+ * Drain the log with one version 1 command per batch of entries. In follow
+ * mode, keep polling the log and print new entries as they come in.
+ */
+static int pd_log_stream(int follow, int interval_ms)
+{
+	struct ec_response_pd_log_v1 *r = ec_inbuf;
+	const struct ec_response_pd_log *entry;
+	time_t now;
+	int rv, i, offset;
+
 	while (1) {
 		now = time(NULL);
+		rv = ec_command(EC_CMD_PD_GET_LOG_ENTRY, 1,
+				NULL, 0, ec_inbuf, ec_max_insize);
+		if (rv < 0)
+			return rv;
+		if (rv < sizeof(*r)) {
+			fprintf(stderr, "Truncated log response\n");
+			return -1;
+		}
+
+		if (r->dropped)
+			printf("--- %u entries dropped ---\n", r->dropped);
+
+		offset = sizeof(*r);
+		for (i = 0; i < r->count; i++) {
+			entry = (const void *)((uint8_t *)ec_inbuf + offset);
+			if (offset + sizeof(*entry) > rv ||
+			    offset + PD_LOG_ENTRY_SIZE(entry->size_port) > rv) {
+				fprintf(stderr, "Truncated log entry\n");
+				return -1;
+			}
+			print_pd_log_entry(entry, now);
+			offset += PD_LOG_ENTRY_SIZE(entry->size_port);
+		}
+
+		if (!r->count) {
+			if (!follow) {
+				printf("--- END OF LOG ---\n");
+				break;
+			}
+			fflush(stdout);
+			usleep(interval_ms * 1000);
+		}
+	}
+
+	return 0;
+}
+
+int cmd_pd_log(int argc, char *argv[])
+{
+	union {
+		struct ec_response_pd_log r;
+		uint32_t words[10]; /* space for the payload */
+	} u;
+	int follow = 0;
+	int interval_ms = 100;
+	int rv;
+	char *e;
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "follow")) {
+			fprintf(stderr, "Usage: %s [follow [interval_ms]]\n",
+				argv[0]);
+			return -1;
+		}
+		follow = 1;
+		if (argc > 2) {
+			interval_ms = strtol(argv[2], &e, 0);
+			if ((e && *e) || interval_ms <= 0) {
+				fprintf(stderr, "Bad interval\n");
+				return -1;
+			}
+		}
+	}
+
+	if (ec_cmd_version_supported(EC_CMD_PD_GET_LOG_ENTRY, 1))
+		return pd_log_stream(follow, interval_ms);
+
+	if (follow) {
+		fprintf(stderr, "EC does not support streaming the log\n");
+		return -1;
+	}
+
+	while (1) {
 		rv = ec_command(EC_CMD_PD_GET_LOG_ENTRY, 0,
 				NULL, 0, &u, sizeof(u));
 		if (rv < 0)
@@ -9278,63 +9514,7 @@ int cmd_pd_log(int argc, char *argv[])
 			break;
 		}
 
-		/* the timestamp is in 1024th of seconds */
-		milliseconds = ((uint64_t)u.r.timestamp <<
-					 PD_LOG_TIMESTAMP_SHIFT) / 1000;
-		/* the timestamp is the number of milliseconds in the past */
-		seconds = (milliseconds + 999) / 1000;
-		milliseconds -= seconds * 1000;
-		now -= seconds;
-		localtime_r(&now, &ltime);
-		strftime(time_str, sizeof(time_str), "%F %T", &ltime);
-		printf("%s.%03lld P%d ", time_str, -milliseconds,
-			PD_LOG_PORT(u.r.size_port));
-		if (u.r.type == PD_EVENT_MCU_CHARGE) {
-			if (u.r.data & CHARGE_FLAGS_OVERRIDE)
-				printf("override ");
-			if (u.r.data & CHARGE_FLAGS_DELAYED_OVERRIDE)
-				printf("pending_override ");
-			memcpy(&pinfo.meas, u.r.payload,
-				sizeof(struct usb_chg_measures));
-			pinfo.dualrole = !!(u.r.data & CHARGE_FLAGS_DUAL_ROLE);
-			pinfo.role = u.r.data & CHARGE_FLAGS_ROLE_MASK;
-			pinfo.type = (u.r.data & CHARGE_FLAGS_TYPE_MASK)
-					>> CHARGE_FLAGS_TYPE_SHIFT;
-			pinfo.max_power = 0;
-			print_pd_power_info(&pinfo);
-		} else if (u.r.type == PD_EVENT_MCU_CONNECT) {
-			printf("New connection\n");
-		} else if (u.r.type == PD_EVENT_MCU_BOARD_CUSTOM) {
-			printf("Board-custom event\n");
-		} else if (u.r.type == PD_EVENT_ACC_RW_FAIL) {
-			printf("RW signature check failed\n");
-		} else if (u.r.type == PD_EVENT_PS_FAULT) {
-			static const char * const fault_names[] = {
-				"---", "OCP", "fast OCP", "OVP", "Discharge"
-			};
-			const char *fault = u.r.data < ARRAY_SIZE(fault_names) ?
-					fault_names[u.r.data] : "???";
-			printf("Power supply fault: %s\n", fault);
-		} else if (u.r.type == PD_EVENT_VIDEO_DP_MODE) {
-			printf("DP mode %sabled\n", (u.r.data == 1) ?
-			       "en" : "dis");
-		} else if (u.r.type == PD_EVENT_VIDEO_CODEC) {
-			memcpy(&minfo, u.r.payload,
-			       sizeof(struct mcdp_info));
-			printf("HDMI info: family:%04x chipid:%04x "
-			       "irom:%d.%d.%d fw:%d.%d.%d\n",
-			       MCDP_FAMILY(minfo.family),
-			       MCDP_CHIPID(minfo.chipid),
-			       minfo.irom.major, minfo.irom.minor,
-			       minfo.irom.build, minfo.fw.major,
-			       minfo.fw.minor, minfo.fw.build);
-		} else { /* Unknown type */
-			int i;
-			printf("Event %02x (%04x) [", u.r.type, u.r.data);
-			for (i = 0; i < PD_LOG_SIZE(u.r.size_port); i++)
-				printf("%02x ", u.r.payload[i]);
-			printf("]\n");
-		}
+		print_pd_log_entry(&u.r, time(NULL));
 	}
 
 	return 0;
@@ -10085,6 +10265,8 @@ const struct command commands[] = {
 	{"locatechip", cmd_locate_chip},
 	{"i2cprotect", cmd_i2c_protect},
 	{"i2cread", cmd_i2c_read},
+	{"i2cstats", cmd_i2c_stats},
+	{"i2ctrace", cmd_i2c_trace},
 	{"i2cwrite", cmd_i2c_write},
 	{"i2cxfer", cmd_i2c_xfer},
 	{"infopddev", cmd_pd_device_info},
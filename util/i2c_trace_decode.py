@@ -0,0 +1,318 @@
+#!/usr/bin/env python3
+# Copyright 2021 The Chromium OS Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Decode I2C transactions captured by the EC.
+
+Reads the output of `ectool i2ctrace` (one transaction per line), names the
+registers of known devices and reports the bus utilization of each device.
+
+Enable capture on the EC console first, e.g. `i2ctrace enable 1 0x08 0x40`.
+
+Example:
+  ectool i2ctrace | util/i2c_trace_decode.py --tcpci 1:0x4e
+"""
+
+from __future__ import print_function
+import argparse
+import collections
+import sys
+
+I2C_ADDR_MASK = 0x03FF
+I2C_FLAG_ADDR16_LITTLE_ENDIAN = 1 << 12
+I2C_FLAG_PEC = 1 << 13
+DATA_MAX = 8  # EC_I2C_TRACE_DATA_MAX
+
+SMART_BATTERY_REGS = {
+    0x00: 'ManufacturerAccess',
+    0x01: 'RemainingCapacityAlarm',
+    0x02: 'RemainingTimeAlarm',
+    0x03: 'BatteryMode',
+    0x04: 'AtRate',
+    0x05: 'AtRateTimeToFull',
+    0x06: 'AtRateTimeToEmpty',
+    0x07: 'AtRateOK',
+    0x08: 'Temperature',
+    0x09: 'Voltage',
+    0x0a: 'Current',
+    0x0b: 'AverageCurrent',
+    0x0c: 'MaxError',
+    0x0d: 'RelativeStateOfCharge',
+    0x0e: 'AbsoluteStateOfCharge',
+    0x0f: 'RemainingCapacity',
+    0x10: 'FullChargeCapacity',
+    0x11: 'RunTimeToEmpty',
+    0x12: 'AverageTimeToEmpty',
+    0x13: 'AverageTimeToFull',
+    0x14: 'ChargingCurrent',
+    0x15: 'ChargingVoltage',
+    0x16: 'BatteryStatus',
+    0x17: 'CycleCount',
+    0x18: 'DesignCapacity',
+    0x19: 'DesignVoltage',
+    0x1a: 'SpecificationInfo',
+    0x1b: 'ManufactureDate',
+    0x1c: 'SerialNumber',
+    0x20: 'ManufacturerName',
+    0x21: 'DeviceName',
+    0x22: 'DeviceChemistry',
+    0x23: 'ManufacturerData',
+    0x43: 'PackStatus',
+    0x44: 'ManufacturerBlockAccess',
+}
+
+# board/hx30/cypress5525.h, port registers repeat every 0x1000
+CCG_REGS = {
+    0x0000: 'DEVICE_MODE',
+    0x0001: 'BOOT_MODE_REASON',
+    0x0002: 'SILICON_ID',
+    0x0006: 'INTR_REG',
+    0x0008: 'RESET',
+    0x0010: 'READ_ALL_VERSION',
+    0x0020: 'FW2_VERSION',
+    0x002C: 'PDPORT_ENABLE',
+    0x002E: 'POWER_STAT',
+    0x0031: 'BATTERY_STAT',
+    0x0038: 'UCSI_STATUS',
+    0x0039: 'UCSI_CONTROL',
+    0x003B: 'SYS_PWR_STATE',
+    0x003C: 'HPI_VERSION',
+    0x0040: 'ICL_CTRL',
+    0x0042: 'ICL_STS',
+    0x0046: 'ICL_BB_RETIMER_CMD',
+    0x0048: 'ICL_BB_RETIMER_DAT',
+    0x004D: 'USER_DISABLE_LOCKOUT',
+    0x004E: 'USER_BB_POWER_EVT',
+    0x004F: 'USER_MAINBOARD_VERSION',
+    0x007E: 'RESPONSE',
+    0xF000: 'UCSI_VERSION',
+    0xF004: 'UCSI_CCI',
+    0xF008: 'UCSI_CONTROL',
+    0xF010: 'UCSI_MESSAGE_IN',
+    0xF020: 'UCSI_MESSAGE_OUT',
+}
+
+CCG_PORT_REGS = {
+    0x000: 'DM_CONTROL',
+    0x004: 'SELECT_SOURCE_PDO',
+    0x005: 'SELECT_SINK_PDO',
+    0x006: 'PD_CONTROL',
+    0x008: 'PD_STATUS',
+    0x00C: 'TYPE_C_STATUS',
+    0x00D: 'TYPE_C_VOLTAGE',
+    0x010: 'CURRENT_PDO',
+    0x014: 'CURRENT_RDO',
+    0x024: 'EVENT_MASK',
+    0x02A: 'VDM_EC_CONTROL',
+    0x02B: 'DP_ALT_MODE_CONFIG',
+    0x034: 'PORT_INTR_STATUS',
+    0x400: 'PD_RESPONSE',
+}
+
+TCPCI_REGS = {
+    0x00: 'VENDOR_ID',
+    0x02: 'PRODUCT_ID',
+    0x04: 'BCD_DEV',
+    0x06: 'TC_REV',
+    0x08: 'PD_REV',
+    0x0a: 'PD_INT_REV',
+    0x10: 'ALERT',
+    0x12: 'ALERT_MASK',
+    0x14: 'POWER_STATUS_MASK',
+    0x15: 'FAULT_STATUS_MASK',
+    0x16: 'EXT_STATUS_MASK',
+    0x17: 'ALERT_EXTENDED_MASK',
+    0x18: 'CONFIG_STD_OUTPUT',
+    0x19: 'TCPC_CTRL',
+    0x1a: 'ROLE_CTRL',
+    0x1b: 'FAULT_CTRL',
+    0x1c: 'POWER_CTRL',
+    0x1d: 'CC_STATUS',
+    0x1e: 'POWER_STATUS',
+    0x1f: 'FAULT_STATUS',
+    0x20: 'EXT_STATUS',
+    0x21: 'ALERT_EXT',
+    0x23: 'COMMAND',
+    0x28: 'STD_INPUT_CAP',
+    0x29: 'STD_OUTPUT_CAP',
+    0x2e: 'MSG_HDR_INFO',
+    0x2f: 'RX_DETECT',
+    0x30: 'RX_BYTE_CNT',
+    0x31: 'RX_BUF_FRAME_TYPE',
+    0x32: 'RX_HDR',
+    0x50: 'TRANSMIT',
+    0x51: 'TX_BYTE_CNT',
+}
+
+
+def ccg_reg_name(reg):
+  """Name a 16-bit CCG5 register."""
+  if reg in CCG_REGS:
+    return CCG_REGS[reg]
+  port, offset = (reg >> 12) - 1, reg & 0xFFF
+  if 0 <= port < 2:
+    if offset in CCG_PORT_REGS:
+      return 'P%d_%s' % (port, CCG_PORT_REGS[offset])
+    if 0x404 <= offset < 0x800:
+      return 'P%d_READ_DATA_MEM+0x%x' % (port, offset - 0x404)
+    if 0x800 <= offset < 0xC00:
+      return 'P%d_WRITE_DATA_MEM+0x%x' % (port, offset - 0x800)
+  return None
+
+
+class Device(object):
+  """A known device: name and register decoder."""
+
+  def __init__(self, name, reg_size, regs):
+    self.name = name
+    self.reg_size = reg_size
+    self.regs = regs
+
+  def reg_name(self, reg):
+    if callable(self.regs):
+      return self.regs(reg)
+    return self.regs.get(reg)
+
+
+SMART_BATTERY = Device('battery', 1, SMART_BATTERY_REGS)
+CCG5 = Device('ccg5', 2, ccg_reg_name)
+TCPCI = Device('tcpci', 1, TCPCI_REGS)
+
+# Devices recognized on any port by address
+DEFAULT_DEVICES = {
+    0x0b: SMART_BATTERY,
+    0x08: CCG5,
+    0x40: CCG5,
+}
+
+
+class Entry(object):
+  """One captured transaction."""
+
+  def __init__(self, fields):
+    (self.start_us, self.end_us, self.port, self.addr_flags, self.result,
+     self.out_size, self.in_size) = [int(f, 0) for f in fields[:7]]
+    data = [int(b, 16) for b in fields[7:]]
+    n = min(self.out_size, DATA_MAX)
+    self.out = data[:n]
+    self.inp = data[n:]
+
+  @property
+  def addr(self):
+    return self.addr_flags & I2C_ADDR_MASK
+
+  @property
+  def duration_us(self):
+    return (self.end_us - self.start_us) & 0xFFFFFFFF
+
+
+def parse(lines):
+  """Yield the entries in the ectool output, skipping comments."""
+  for line in lines:
+    fields = line.split()
+    if not fields or fields[0].startswith('#'):
+      continue
+    yield Entry(fields)
+
+
+def reg_of(entry, dev):
+  """Return the register an entry addresses, or None."""
+  if len(entry.out) < dev.reg_size:
+    return None
+  if dev.reg_size == 1:
+    return entry.out[0]
+  if entry.addr_flags & I2C_FLAG_ADDR16_LITTLE_ENDIAN:
+    return entry.out[0] | entry.out[1] << 8
+  return entry.out[0] << 8 | entry.out[1]
+
+
+def hexdump(data, size):
+  parts = ['%02x' % b for b in data]
+  if size > len(data):
+    parts.append('..(%d)' % size)
+  return ' '.join(parts)
+
+
+def describe(entry, dev):
+  """Return a one-line annotation of an entry."""
+  text = '%d:0x%02x' % (entry.port, entry.addr)
+  if dev:
+    text += ' %s' % dev.name
+    reg = reg_of(entry, dev)
+    if reg is not None:
+      name = dev.reg_name(reg)
+      text += ' %s' % (name if name else 'reg 0x%x' % reg)
+      payload = entry.out[dev.reg_size:]
+      if entry.out_size > dev.reg_size:
+        text += ' wr %s' % hexdump(payload, entry.out_size - dev.reg_size)
+    elif entry.out_size:
+      text += ' wr %s' % hexdump(entry.out, entry.out_size)
+  elif entry.out_size:
+    text += ' wr %s' % hexdump(entry.out, entry.out_size)
+  if entry.in_size:
+    text += ' rd %s' % hexdump(entry.inp, entry.in_size)
+  if entry.addr_flags & I2C_FLAG_PEC:
+    text += ' [pec]'
+  if entry.result:
+    text += ' ERROR %d' % entry.result
+  return text
+
+
+def parse_tcpci(arg):
+  port, addr = arg.split(':')
+  return int(port, 0), int(addr, 0)
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+  parser.add_argument('input', nargs='?', type=argparse.FileType('r'),
+                      default=sys.stdin,
+                      help='ectool i2ctrace output (default: stdin)')
+  parser.add_argument('--tcpci', action='append', default=[],
+                      type=parse_tcpci, metavar='PORT:ADDR',
+                      help='decode the device at PORT:ADDR as a TCPC')
+  parser.add_argument('-q', '--quiet', action='store_true',
+                      help='only print the utilization summary')
+  args = parser.parse_args(argv)
+
+  tcpcs = set(args.tcpci)
+  busy = collections.defaultdict(int)
+  count = collections.defaultdict(int)
+  errors = collections.defaultdict(int)
+  first = last = None
+
+  for entry in parse(args.input):
+    key = (entry.port, entry.addr)
+    dev = TCPCI if key in tcpcs else DEFAULT_DEVICES.get(entry.addr)
+
+    if not args.quiet:
+      print('%10u +%5uus %s' % (entry.start_us, entry.duration_us,
+                                describe(entry, dev)))
+
+    busy[key] += entry.duration_us
+    count[key] += 1
+    if entry.result:
+      errors[key] += 1
+    if first is None:
+      first = entry.start_us
+    last = entry.end_us
+
+  if first is None:
+    print('No transactions captured')
+    return 0
+
+  span = max((last - first) & 0xFFFFFFFF, 1)
+  print()
+  print('Captured %u us' % span)
+  print('port addr  device      xfers errors  busy_us  util')
+  for key in sorted(busy):
+    dev = TCPCI if key in tcpcs else DEFAULT_DEVICES.get(key[1])
+    print('%4d 0x%02x  %-10s %6d %6d %8d %5.1f%%' % (
+        key[0], key[1], dev.name if dev else '-', count[key], errors[key],
+        busy[key], 100.0 * busy[key] / span))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv[1:]))